@@ -36,7 +36,6 @@
 #include <qcc/Thread.h>
 #include <qcc/Util.h>
 #include <qcc/SocketStream.h>
-#include <qcc/StreamPump.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/DBusStd.h>
@@ -56,6 +55,7 @@
 #include "EndpointHelper.h"
 #include "ns/IpNameService.h"
 #include "AllJoynPeerObj.h"
+#include "DaemonConfig.h"
 
 #define QCC_MODULE "ALLJOYN_OBJ"
 
@@ -65,6 +65,8 @@ using namespace qcc;
 namespace ajn {
 
 void* AllJoynObj::NameMapEntry::truthiness = reinterpret_cast<void*>(true);
+void* AllJoynObj::nameChangesAlarmContext = &AllJoynObj::nameChangesAlarmContext;
+void* AllJoynObj::directChannelAlarmContext = &AllJoynObj::directChannelAlarmContext;
 int AllJoynObj::JoinSessionThread::jstCount = 0;
 
 void AllJoynObj::AcquireLocks()
@@ -96,6 +98,8 @@ AllJoynObj::AllJoynObj(Bus& bus, BusController* busController) :
     exchangeNamesSignal(NULL),
     detachSessionSignal(NULL),
     timer("NameReaper"),
+    nameChangesAlarmSet(false),
+    maxJoinSessionThreads(ALLJOYN_MAX_JOIN_SESSION_THREADS_DEFAULT),
     isStopping(false),
     busController(busController)
 {
@@ -108,12 +112,27 @@ AllJoynObj::~AllJoynObj()
 
     Stop();
     Join();
+
+    /* Requests for direct channels that were never answered */
+    for (SessionMapType::iterator it = sessionMap.begin(); it != sessionMap.end(); ++it) {
+        delete it->second.directRequest;
+        it->second.directRequest = NULL;
+    }
+    for (size_t i = 0; i < orphanedDirectRequests.size(); ++i) {
+        delete orphanedDirectRequests[i];
+    }
+    orphanedDirectRequests.clear();
 }
 
 QStatus AllJoynObj::Init()
 {
     QStatus status;
 
+    maxJoinSessionThreads = DaemonConfig::Access()->Get("limit@max_join_session_threads", ALLJOYN_MAX_JOIN_SESSION_THREADS_DEFAULT);
+    if (maxJoinSessionThreads == 0) {
+        maxJoinSessionThreads = 1;
+    }
+
     /* Make this object implement org.alljoyn.Bus */
     const InterfaceDescription* alljoynIntf = bus.GetInterface(org::alljoyn::Bus::InterfaceName);
     if (!alljoynIntf) {
@@ -135,6 +154,7 @@ QStatus AllJoynObj::Init()
         { alljoynIntf->GetMember("JoinSession"),              static_cast<MessageReceiver::MethodHandler>(&AllJoynObj::JoinSession) },
         { alljoynIntf->GetMember("LeaveSession"),             static_cast<MessageReceiver::MethodHandler>(&AllJoynObj::LeaveSession) },
         { alljoynIntf->GetMember("GetSessionFd"),             static_cast<MessageReceiver::MethodHandler>(&AllJoynObj::GetSessionFd) },
+        { alljoynIntf->GetMember("GetSessionChannel"),        static_cast<MessageReceiver::MethodHandler>(&AllJoynObj::GetSessionChannel) },
         { alljoynIntf->GetMember("SetLinkTimeout"),           static_cast<MessageReceiver::MethodHandler>(&AllJoynObj::SetLinkTimeout) },
         { alljoynIntf->GetMember("AliasUnixUser"),            static_cast<MessageReceiver::MethodHandler>(&AllJoynObj::AliasUnixUser) },
         { alljoynIntf->GetMember("OnAppSuspend"),             static_cast<MessageReceiver::MethodHandler>(&AllJoynObj::OnAppSuspend) },
@@ -208,6 +228,17 @@ QStatus AllJoynObj::Init()
         }
     }
 
+    /* Register a signal handler for NameChanges bus-to-bus signal */
+    if (ER_OK == status) {
+        status = bus.RegisterSignalHandler(this,
+                                           static_cast<MessageReceiver::SignalHandler>(&AllJoynObj::NameChangesSignalHandler),
+                                           daemonIface->GetMember("NameChanges"),
+                                           NULL);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to register NameChangesSignalHandler"));
+        }
+    }
+
     /* Register a signal handler for DetachSession bus-to-bus signal */
     if (ER_OK == status) {
         status = bus.RegisterSignalHandler(this,
@@ -243,15 +274,26 @@ QStatus AllJoynObj::Init()
 
 QStatus AllJoynObj::Stop()
 {
-    /* Stop any outstanding JoinSessionThreads */
+    /* Stop any outstanding JoinSessionThreads and drop requests that have not started */
     joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     isStopping = true;
+    joinPool.requests.clear();
+    attachPool.requests.clear();
+    joinPool.wakeEvent.SetEvent();
+    attachPool.wakeEvent.SetEvent();
     vector<JoinSessionThread*>::iterator it = joinSessionThreads.begin();
     while (it != joinSessionThreads.end()) {
         (*it)->Stop();
         ++it;
     }
     joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+
+    /* Stop relaying raw sessions */
+    rawRelaysLock.Lock(MUTEX_CONTEXT);
+    for (vector<RawRelay*>::iterator rit = rawRelays.begin(); rit != rawRelays.end(); ++rit) {
+        (*rit)->Stop();
+    }
+    rawRelaysLock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 
@@ -265,9 +307,38 @@ QStatus AllJoynObj::Join()
         joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     }
     joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+
+    /* Wait for the raw session relays */
+    rawRelaysLock.Lock(MUTEX_CONTEXT);
+    while (!rawRelays.empty()) {
+        rawRelaysLock.Unlock(MUTEX_CONTEXT);
+        qcc::Sleep(50);
+        rawRelaysLock.Lock(MUTEX_CONTEXT);
+    }
+    rawRelaysLock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 
+void AllJoynObj::ThreadExit(Thread* thread)
+{
+    RawRelay* relay = NULL;
+    rawRelaysLock.Lock(MUTEX_CONTEXT);
+    vector<RawRelay*>::iterator it = find(rawRelays.begin(), rawRelays.end(), thread);
+    if (it != rawRelays.end()) {
+        relay = *it;
+        rawRelays.erase(it);
+    }
+    rawRelaysLock.Unlock(MUTEX_CONTEXT);
+
+    if (relay) {
+        Log(LOG_INFO, "Raw session %u relayed %llu/%llu bytes (%s)\n", relay->GetSessionId(),
+            (unsigned long long)relay->GetBytesRelayed(0), (unsigned long long)relay->GetBytesRelayed(1),
+            relay->IsZeroCopy() ? "spliced" : "copied");
+        relay->Join();
+        delete relay;
+    }
+}
+
 void AllJoynObj::ObjectRegistered(void)
 {
     QStatus status;
@@ -440,7 +511,7 @@ void AllJoynObj::UnbindSessionPort(const InterfaceDescription::Member* member, M
     SessionMapType::iterator it = SessionMapLowerBound(sender, 0);
     while ((it != sessionMap.end()) && (it->first.first == sender) && (it->first.second == 0)) {
         if (it->second.sessionPort == sessionPort) {
-            sessionMap.erase(it);
+            SessionMapErase(it);
             replyCode = ALLJOYN_UNBINDSESSIONPORT_REPLY_SUCCESS;
             break;
         }
@@ -462,13 +533,41 @@ void AllJoynObj::UnbindSessionPort(const InterfaceDescription::Member* member, M
 
 ThreadReturn STDCALL AllJoynObj::JoinSessionThread::Run(void* arg)
 {
-    if (isJoin) {
-        QCC_DbgTrace(("JoinSessionThread::RunJoin()"));
-        return RunJoin();
-    } else {
-        QCC_DbgTrace(("JoinSessionThread::RunAttach()"));
-        return RunAttach();
+    JoinSessionPool& pool = isJoin ? ajObj.joinPool : ajObj.attachPool;
+
+    ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+    while (!ajObj.isStopping && !IsStopping()) {
+        if (pool.requests.empty()) {
+            /* Wait for a request. Exit if none arrives within the idle timeout */
+            pool.wakeEvent.ResetEvent();
+            ++pool.numIdle;
+            QStatus status = Event::Wait(pool.wakeEvent, ajObj.joinSessionThreadsLock, JOIN_SESSION_THREAD_IDLE_TIMEOUT);
+            ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+            --pool.numIdle;
+            if ((status == ER_TIMEOUT) && pool.requests.empty()) {
+                break;
+            }
+            continue;
+        }
+        msg = pool.requests.front();
+        pool.requests.pop_front();
+        ajObj.joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+
+        if (isJoin) {
+            QCC_DbgTrace(("JoinSessionThread::RunJoin()"));
+            RunJoin();
+        } else {
+            QCC_DbgTrace(("JoinSessionThread::RunAttach()"));
+            RunAttach();
+        }
+
+        /* Don't hold a reference to the request while idle */
+        msg = Message(ajObj.bus);
+        ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     }
+    --pool.numThreads;
+    ajObj.joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+    return 0;
 }
 
 ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
@@ -794,7 +893,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                                 continue;
                             }
                             BusEndpoint newEp;
-                            status = trans->Connect(busAddrs[i].c_str(), optsIn, newEp);
+                            status = ajObj.ConnectBusToBus(trans, busAddrs[i], optsIn, newEp);
                             if (status == ER_OK) {
                                 b2bEp = RemoteEndpoint::cast(newEp);
                                 if (b2bEp->IsValid()) {
@@ -1089,36 +1188,98 @@ void AllJoynObj::JoinSessionThread::ThreadExit(Thread* thread)
     }
 }
 
-void AllJoynObj::JoinSession(const InterfaceDescription::Member* member, Message& msg)
+void AllJoynObj::QueueJoinSessionRequest(const Message& msg, bool isJoin)
 {
-    /* Handle JoinSession on another thread since JoinThread can block waiting for NameOwnerChanged */
+    JoinSessionPool& pool = isJoin ? joinPool : attachPool;
+
     joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     if (!isStopping) {
-        JoinSessionThread* jst = new JoinSessionThread(*this, msg, true);
-        QStatus status = jst->Start(NULL, jst);
-        if (status == ER_OK) {
-            joinSessionThreads.push_back(jst);
+        pool.requests.push_back(msg);
+        if ((pool.numIdle < pool.requests.size()) && (pool.numThreads < maxJoinSessionThreads)) {
+            JoinSessionThread* jst = new JoinSessionThread(*this, isJoin);
+            QStatus status = jst->Start(NULL, jst);
+            if (status == ER_OK) {
+                joinSessionThreads.push_back(jst);
+                ++pool.numThreads;
+            } else {
+                delete jst;
+                QCC_LogError(status, ("%s: Failed to start JoinSessionThread", isJoin ? "Join" : "Attach"));
+            }
+        }
+        if (pool.numThreads == 0) {
+            /* Nobody will ever service this request */
+            pool.requests.pop_back();
+            QCC_LogError(ER_FAIL, ("%s: No JoinSessionThread available", isJoin ? "Join" : "Attach"));
         } else {
-            QCC_LogError(status, ("Join: Failed to start JoinSessionThread"));
+            pool.wakeEvent.SetEvent();
         }
     }
     joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
 }
 
+void AllJoynObj::JoinSession(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Handle JoinSession on a worker thread since JoinSession can block waiting for NameOwnerChanged */
+    QueueJoinSessionRequest(msg, true);
+}
+
 void AllJoynObj::AttachSession(const InterfaceDescription::Member* member, Message& msg)
 {
-    /* Handle AttachSession on another thread since AttachSession can block when connecting through an intermediate node */
-    joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
-    if (!isStopping) {
-        JoinSessionThread* jst = new JoinSessionThread(*this, msg, false);
-        QStatus status = jst->Start(NULL, jst);
-        if (status == ER_OK) {
-            joinSessionThreads.push_back(jst);
-        } else {
-            QCC_LogError(status, ("Attach: Failed to start JoinSessionThread"));
+    /*
+     * Handle AttachSession on a worker thread since AttachSession can block when connecting through an
+     * intermediate node. AttachSession workers are pooled separately from JoinSession workers so that a
+     * daemon whose join workers are all waiting on remote attaches can still service incoming attaches.
+     */
+    QueueJoinSessionRequest(msg, false);
+}
+
+QStatus AllJoynObj::ConnectBusToBus(Transport* trans, const qcc::String& busAddr, const SessionOpts& opts, BusEndpoint& newEp)
+{
+    /* Raw sessions consume the connection so they must never share one */
+    if (opts.traffic != SessionOpts::TRAFFIC_MESSAGES) {
+        return trans->Connect(busAddr.c_str(), opts, newEp);
+    }
+
+    pendingConnectsLock.Lock(MUTEX_CONTEXT);
+    map<String, PendingConnect*>::iterator it = pendingConnects.find(busAddr);
+    if (it != pendingConnects.end()) {
+        /* Another request is already connecting to this address so wait for it to finish */
+        PendingConnect* pc = it->second;
+        ++pc->refs;
+        QStatus status = Event::Wait(pc->done, pendingConnectsLock);
+        pendingConnectsLock.Lock(MUTEX_CONTEXT);
+        if (pc->complete) {
+            status = pc->status;
+            newEp = pc->ep;
+        } else if (status == ER_OK) {
+            status = ER_FAIL;
         }
+        bool deleteMe = (--pc->refs == 0);
+        pendingConnectsLock.Unlock(MUTEX_CONTEXT);
+        if (deleteMe) {
+            delete pc;
+        }
+        QCC_DbgPrintf(("ConnectBusToBus(%s) shared pending connect (%s)", busAddr.c_str(), QCC_StatusText(status)));
+        return status;
     }
-    joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+    PendingConnect* pc = new PendingConnect();
+    pendingConnects[busAddr] = pc;
+    pendingConnectsLock.Unlock(MUTEX_CONTEXT);
+
+    QStatus status = trans->Connect(busAddr.c_str(), opts, newEp);
+
+    pendingConnectsLock.Lock(MUTEX_CONTEXT);
+    pendingConnects.erase(busAddr);
+    pc->status = status;
+    pc->ep = newEp;
+    pc->complete = true;
+    pc->done.SetEvent();
+    bool deleteMe = (--pc->refs == 0);
+    pendingConnectsLock.Unlock(MUTEX_CONTEXT);
+    if (deleteMe) {
+        delete pc;
+    }
+    return status;
 }
 
 void AllJoynObj::LeaveSession(const InterfaceDescription::Member* member, Message& msg)
@@ -1411,7 +1572,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                 } else {
                     ajObj.ReleaseLocks();
                     BusEndpoint ep;
-                    status = trans->Connect(busAddr, optsIn, ep);
+                    status = ajObj.ConnectBusToBus(trans, busAddr, optsIn, ep);
                     ajObj.AcquireLocks();
                     if (status == ER_OK) {
                         b2bEp = RemoteEndpoint::cast(ep);
@@ -1568,7 +1729,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                 }
             }
         } else {
-            /* Indirect raw route (middle-man). Create a pump to copy raw data between endpoints */
+            /* Indirect raw route (middle-man). Create a relay to move raw data between endpoints */
             QStatus tStatus;
             SocketFd srcB2bFd, b2bFd;
             ajObj.ReleaseLocks();
@@ -1578,15 +1739,20 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
             ajObj.AcquireLocks();
             status = (status == ER_OK) ? tStatus : status;
             if (status == ER_OK) {
-                SocketStream* ss1 = new SocketStream(srcB2bFd);
-                SocketStream* ss2 = new SocketStream(b2bFd);
-                size_t chunkSize = 4096;
-                String threadNameStr = id;
-                threadNameStr.append("-pump");
-                const char* threadName = threadNameStr.c_str();
-                bool isManaged = true;
-                ManagedObj<StreamPump> pump(ss1, ss2, chunkSize, threadName, isManaged);
-                status = pump->Start();
+                RawRelay* relay = new RawRelay(id, srcB2bFd, b2bFd);
+                ajObj.rawRelaysLock.Lock(MUTEX_CONTEXT);
+                ajObj.rawRelays.push_back(relay);
+                ajObj.rawRelaysLock.Unlock(MUTEX_CONTEXT);
+                status = relay->Start(NULL, &ajObj);
+                if (status != ER_OK) {
+                    ajObj.rawRelaysLock.Lock(MUTEX_CONTEXT);
+                    vector<RawRelay*>::iterator rit = find(ajObj.rawRelays.begin(), ajObj.rawRelays.end(), relay);
+                    if (rit != ajObj.rawRelays.end()) {
+                        ajObj.rawRelays.erase(rit);
+                    }
+                    ajObj.rawRelaysLock.Unlock(MUTEX_CONTEXT);
+                    delete relay;
+                }
             }
             if (status != ER_OK) {
                 QCC_LogError(status, ("Raw relay creation failed"));
@@ -1644,51 +1810,49 @@ void AllJoynObj::RemoveSessionRefs(const char* epName, SessionId id)
 
     String epNameStr = endpoint->GetUniqueName();
     vector<pair<String, SessionId> > changedSessionMembers;
-    SessionMapType::iterator it = sessionMap.begin();
     /* Look through sessionMap for entries matching id */
-    while (it != sessionMap.end()) {
-        if (it->first.second == id) {
-            if (it->first.first == epNameStr) {
-                /* Exact key matches are removed */
-                sessionMap.erase(it++);
-            } else {
-                if (endpoint == router.FindEndpoint(it->second.sessionHost)) {
-                    /* Modify entry to remove matching sessionHost */
-                    it->second.sessionHost.clear();
+    vector<String> names;
+    SessionMapGetNames(id, names);
+    for (size_t i = 0; i < names.size(); ++i) {
+        SessionMapType::iterator it = sessionMap.find(pair<String, SessionId>(names[i], id));
+        if (it == sessionMap.end()) {
+            /* Entry was removed while locks were released */
+            continue;
+        }
+        if (it->first.first == epNameStr) {
+            /* Exact key matches are removed */
+            SessionMapErase(it);
+            continue;
+        }
+        if (endpoint == router.FindEndpoint(it->second.sessionHost)) {
+            /* Modify entry to remove matching sessionHost */
+            it->second.sessionHost.clear();
+            if (it->second.opts.isMultipoint) {
+                changedSessionMembers.push_back(it->first);
+            }
+        } else {
+            /* Remove matching session members */
+            vector<String>::iterator mit = it->second.memberNames.begin();
+            while (mit != it->second.memberNames.end()) {
+                if (epNameStr == *mit) {
+                    mit = it->second.memberNames.erase(mit);
                     if (it->second.opts.isMultipoint) {
                         changedSessionMembers.push_back(it->first);
                     }
                 } else {
-                    /* Remove matching session members */
-                    vector<String>::iterator mit = it->second.memberNames.begin();
-                    while (mit != it->second.memberNames.end()) {
-                        if (epNameStr == *mit) {
-                            mit = it->second.memberNames.erase(mit);
-                            if (it->second.opts.isMultipoint) {
-                                changedSessionMembers.push_back(it->first);
-                            }
-                        } else {
-                            ++mit;
-                        }
-                    }
-                }
-                /* Session is lost when members + sessionHost together contain only one entry */
-                if ((it->second.fd == -1) && (it->second.memberNames.empty() || ((it->second.memberNames.size() == 1) && it->second.sessionHost.empty()))) {
-                    SessionMapEntry tsme = it->second;
-                    pair<String, SessionId> key = it->first;
-                    if (!it->second.isInitializing) {
-                        sessionMap.erase(it);
-                    }
-                    ReleaseLocks();
-                    SendSessionLost(tsme);
-                    AcquireLocks();
-                    it = sessionMap.upper_bound(key);
-                } else {
-                    ++it;
+                    ++mit;
                 }
             }
-        } else {
-            ++it;
+        }
+        /* Session is lost when members + sessionHost together contain only one entry */
+        if ((it->second.fd == -1) && (it->second.memberNames.empty() || ((it->second.memberNames.size() == 1) && it->second.sessionHost.empty()))) {
+            SessionMapEntry tsme = it->second;
+            if (!it->second.isInitializing) {
+                SessionMapErase(it);
+            }
+            ReleaseLocks();
+            SendSessionLost(tsme);
+            AcquireLocks();
         }
     }
     ReleaseLocks();
@@ -1722,58 +1886,59 @@ void AllJoynObj::RemoveSessionRefs(const String& vepName, const String& b2bEpNam
     }
 
     vector<pair<String, SessionId> > changedSessionMembers;
-    SessionMapType::iterator it = sessionMap.begin();
-    while (it != sessionMap.end()) {
+    /* Only the sessions that vep routes through b2bEp can be affected */
+    set<SessionId> sessionIds;
+    vep->GetSessionIdsForB2B(b2bEp, sessionIds);
+    for (set<SessionId>::const_iterator sit = sessionIds.begin(); sit != sessionIds.end(); ++sit) {
+        const SessionId id = *sit;
+        /* Only sessions that route through a single (matching) b2bEp are affected */
         int count;
-        /* Skip binding reservations */
-        if (it->first.second == 0) {
-            ++it;
+        if ((id == 0) || (vep->GetBusToBusEndpoint(id, &count) != b2bEp) || (count != 1)) {
             continue;
         }
-        /* Examine sessions with ids that are affected by removal of vep through b2bep */
-        /* Only sessions that route through a single (matching) b2bEp are affected */
-        if ((vep->GetBusToBusEndpoint(it->first.second, &count) == b2bEp) && (count == 1)) {
+        vector<String> names;
+        SessionMapGetNames(id, names);
+        for (size_t i = 0; i < names.size(); ++i) {
+            SessionMapType::iterator it = sessionMap.find(pair<String, SessionId>(names[i], id));
+            if (it == sessionMap.end()) {
+                /* Entry was removed while locks were released */
+                continue;
+            }
             if (it->first.first == vepName) {
                 /* Key matches can be removed from sessionMap */
-                sessionMap.erase(it++);
+                SessionMapErase(it);
+                continue;
+            }
+            if (BusEndpoint::cast(vep) == router.FindEndpoint(it->second.sessionHost)) {
+                /* If the session's sessionHost is vep, then clear it out of the session */
+                it->second.sessionHost.clear();
+                if (it->second.opts.isMultipoint) {
+                    changedSessionMembers.push_back(it->first);
+                }
             } else {
-                if (BusEndpoint::cast(vep) == router.FindEndpoint(it->second.sessionHost)) {
-                    /* If the session's sessionHost is vep, then clear it out of the session */
-                    it->second.sessionHost.clear();
-                    if (it->second.opts.isMultipoint) {
-                        changedSessionMembers.push_back(it->first);
-                    }
-                } else {
-                    /* Clear vep from any session members */
-                    vector<String>::iterator mit = it->second.memberNames.begin();
-                    while (mit != it->second.memberNames.end()) {
-                        if (vepName == *mit) {
-                            mit = it->second.memberNames.erase(mit);
-                            if (it->second.opts.isMultipoint) {
-                                changedSessionMembers.push_back(it->first);
-                            }
-                        } else {
-                            ++mit;
+                /* Clear vep from any session members */
+                vector<String>::iterator mit = it->second.memberNames.begin();
+                while (mit != it->second.memberNames.end()) {
+                    if (vepName == *mit) {
+                        mit = it->second.memberNames.erase(mit);
+                        if (it->second.opts.isMultipoint) {
+                            changedSessionMembers.push_back(it->first);
                         }
+                    } else {
+                        ++mit;
                     }
                 }
-                /* A session with only one member and no sessionHost or only a sessionHost are "lost" */
-                if ((it->second.fd == -1) && (it->second.memberNames.empty() || ((it->second.memberNames.size() == 1) && it->second.sessionHost.empty()))) {
-                    SessionMapEntry tsme = it->second;
-                    pair<String, SessionId> key = it->first;
-                    if (!it->second.isInitializing) {
-                        sessionMap.erase(it);
-                    }
-                    ReleaseLocks();
-                    SendSessionLost(tsme);
-                    AcquireLocks();
-                    it = sessionMap.upper_bound(key);
-                } else {
-                    ++it;
+            }
+            /* A session with only one member and no sessionHost or only a sessionHost are "lost" */
+            if ((it->second.fd == -1) && (it->second.memberNames.empty() || ((it->second.memberNames.size() == 1) && it->second.sessionHost.empty()))) {
+                SessionMapEntry tsme = it->second;
+                if (!it->second.isInitializing) {
+                    SessionMapErase(it);
                 }
+                ReleaseLocks();
+                SendSessionLost(tsme);
+                AcquireLocks();
             }
-        } else {
-            ++it;
         }
     }
     ReleaseLocks();
@@ -2150,6 +2315,137 @@ void AllJoynObj::GetSessionFd(const InterfaceDescription::Member* member, Messag
     }
 }
 
+/*
+ * A direct channel can only be handed to a client that is connected to this daemon over a
+ * transport that passes handles, i.e. an application running on this device.
+ */
+static bool CanUseDirectChannel(BusEndpoint ep)
+{
+    if (ep->GetEndpointType() != ENDPOINT_TYPE_REMOTE) {
+        return false;
+    }
+    RemoteEndpoint rep = RemoteEndpoint::cast(ep);
+    return rep->GetFeatures().handlePassing;
+}
+
+void AllJoynObj::GetSessionChannel(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Parse args */
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    SessionId id = args[0].v_uint32;
+    String sender = msg->GetSender();
+    String peerName;
+    QStatus status = ER_OK;
+    Message* peerRequest = NULL;
+    bool pending = false;
+
+    QCC_DbgTrace(("AllJoynObj::GetSessionChannel(%u)", id));
+
+    AcquireLocks();
+    SessionMapEntry* smEntry = SessionMapFind(sender, id);
+    SessionMapEntry* peerEntry = NULL;
+    if (!smEntry) {
+        status = ER_BUS_NO_SESSION;
+    } else if ((smEntry->opts.traffic != SessionOpts::TRAFFIC_MESSAGES) || smEntry->opts.isMultipoint || (smEntry->memberNames.size() != 1)) {
+        status = ER_BUS_NOT_ALLOWED;
+    } else {
+        peerName = (smEntry->sessionHost == sender) ? smEntry->memberNames[0] : smEntry->sessionHost;
+        peerEntry = SessionMapFind(peerName, id);
+        if (!peerEntry) {
+            status = ER_BUS_NO_SESSION;
+        } else if (smEntry->directRequest || !CanUseDirectChannel(router.FindEndpoint(sender)) || !CanUseDirectChannel(router.FindEndpoint(peerName))) {
+            status = ER_BUS_NOT_ALLOWED;
+        }
+    }
+    if (status == ER_OK) {
+        if (peerEntry->directRequest) {
+            /* The other member is already waiting, answer both */
+            peerRequest = peerEntry->directRequest;
+            peerEntry->directRequest = NULL;
+        } else {
+            /* Hold the request until the other member asks for the channel */
+            Alarm alarm(DIRECT_CHANNEL_TIMEOUT, this, directChannelAlarmContext);
+            status = timer.AddAlarm(alarm);
+            if (status == ER_OK) {
+                smEntry->directRequest = new Message(msg);
+                smEntry->directRequestTime = GetTimestamp64();
+                pending = true;
+            }
+        }
+    }
+    ReleaseLocks();
+
+    if (pending) {
+        return;
+    }
+
+    SocketFd fds[2] = { -1, -1 };
+    if (peerRequest) {
+        status = SocketPair(fds);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("SocketPair failed"));
+        }
+    }
+    if (status == ER_OK) {
+        /* Send the fds and transfer ownership */
+        MsgArg replyArgs[2];
+        replyArgs[0].Set("h", fds[0]);
+        replyArgs[1].Set("s", peerName.c_str());
+        status = MethodReply(msg, replyArgs, ArraySize(replyArgs));
+        if (status == ER_OK) {
+            replyArgs[0].Set("h", fds[1]);
+            replyArgs[1].Set("s", sender.c_str());
+            status = MethodReply(*peerRequest, replyArgs, ArraySize(replyArgs));
+        } else {
+            MethodReply(*peerRequest, status);
+        }
+        qcc::Close(fds[0]);
+        qcc::Close(fds[1]);
+    } else {
+        QCC_DbgPrintf(("No direct channel for session %u: %s", id, QCC_StatusText(status)));
+        if (peerRequest) {
+            MethodReply(*peerRequest, status);
+        }
+        status = MethodReply(msg, status);
+    }
+    delete peerRequest;
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to respond to org.alljoyn.Bus.GetSessionChannel"));
+    }
+}
+
+void AllJoynObj::ExpireDirectRequests()
+{
+    vector<pair<Message*, QStatus> > expired;
+
+    AcquireLocks();
+    uint64_t now = GetTimestamp64();
+    for (SessionMapType::iterator it = sessionMap.begin(); it != sessionMap.end(); ++it) {
+        SessionMapEntry& sme = it->second;
+        if (sme.directRequest && ((now - sme.directRequestTime) >= DIRECT_CHANNEL_TIMEOUT)) {
+            expired.push_back(pair<Message*, QStatus>(sme.directRequest, ER_TIMEOUT));
+            sme.directRequest = NULL;
+        }
+    }
+    for (size_t i = 0; i < orphanedDirectRequests.size(); ++i) {
+        expired.push_back(pair<Message*, QStatus>(orphanedDirectRequests[i], ER_BUS_NO_SESSION));
+    }
+    orphanedDirectRequests.clear();
+    ReleaseLocks();
+
+    for (size_t i = 0; i < expired.size(); ++i) {
+        QCC_DbgPrintf(("No direct channel for %s: %s", (*expired[i].first)->GetSender(), QCC_StatusText(expired[i].second)));
+        QStatus status = MethodReply(*expired[i].first, expired[i].second);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to respond to org.alljoyn.Bus.GetSessionChannel"));
+        }
+        delete expired[i].first;
+    }
+}
+
 AllJoynObj::SessionMapEntry* AllJoynObj::SessionMapFind(const qcc::String& name, SessionId session)
 {
     pair<String, SessionId> key(name, session);
@@ -2167,16 +2463,66 @@ AllJoynObj::SessionMapType::iterator AllJoynObj::SessionMapLowerBound(const qcc:
     return sessionMap.lower_bound(key);
 }
 
+void AllJoynObj::SessionMapGetNames(SessionId session, vector<String>& names)
+{
+    SessionIdIndexType::const_iterator it = sessionIdIndex.find(session);
+    if (it != sessionIdIndex.end()) {
+        names.assign(it->second.begin(), it->second.end());
+    } else {
+        names.clear();
+    }
+}
+
 void AllJoynObj::SessionMapInsert(SessionMapEntry& sme)
 {
     pair<String, SessionId> key(sme.endpointName, sme.id);
-    sessionMap.insert(pair<pair<String, SessionId>, SessionMapEntry>(key, sme));
+    SessionMapType::iterator it = sessionMap.insert(pair<pair<String, SessionId>, SessionMapEntry>(key, sme));
+    /* A pending direct channel request belongs to the entry it was made on, never to a copy */
+    it->second.directRequest = NULL;
+    if (sme.id != 0) {
+        sessionIdIndex[sme.id].insert(sme.endpointName);
+    }
 }
 
 void AllJoynObj::SessionMapErase(SessionMapEntry& sme)
 {
     pair<String, SessionId> key(sme.endpointName, sme.id);
-    sessionMap.erase(key);
+    pair<SessionMapType::iterator, SessionMapType::iterator> range = sessionMap.equal_range(key);
+    for (SessionMapType::iterator it = range.first; it != range.second; ++it) {
+        if (it->second.directRequest) {
+            /* Answered when the request's timeout alarm fires */
+            orphanedDirectRequests.push_back(it->second.directRequest);
+        }
+    }
+    sessionMap.erase(range.first, range.second);
+    if (key.second != 0) {
+        SessionIdIndexType::iterator iit = sessionIdIndex.find(key.second);
+        if (iit != sessionIdIndex.end()) {
+            iit->second.erase(key.first);
+            if (iit->second.empty()) {
+                sessionIdIndex.erase(iit);
+            }
+        }
+    }
+}
+
+void AllJoynObj::SessionMapErase(SessionMapType::iterator it)
+{
+    pair<String, SessionId> key = it->first;
+    if (it->second.directRequest) {
+        /* Answered when the request's timeout alarm fires */
+        orphanedDirectRequests.push_back(it->second.directRequest);
+    }
+    sessionMap.erase(it);
+    if ((key.second != 0) && (sessionMap.find(key) == sessionMap.end())) {
+        SessionIdIndexType::iterator iit = sessionIdIndex.find(key.second);
+        if (iit != sessionIdIndex.end()) {
+            iit->second.erase(key.first);
+            if (iit->second.empty()) {
+                sessionIdIndex.erase(iit);
+            }
+        }
+    }
 }
 
 void AllJoynObj::SetLinkTimeout(const InterfaceDescription::Member* member, Message& msg)
@@ -2797,7 +3143,37 @@ QStatus AllJoynObj::AddBusToBusEndpoint(RemoteEndpoint& endpoint)
     AddVirtualEndpoint(remoteControllerName, endpoint->GetUniqueName());
 
     /* Exchange existing bus names if connected to another daemon */
-    return ExchangeNames(endpoint);
+    QStatus status = ExchangeNames(endpoint);
+
+    /*
+     * An empty NameChanges announces that this daemon accepts batched name changes. Daemons that
+     * predate NameChanges drop the signal and keep being sent NameChanged.
+     */
+    if (ER_OK == status) {
+        MsgArg argArray;
+        status = argArray.Set("a(sss)", 0, NULL);
+        if (ER_OK == status) {
+            Message sigMsg(bus);
+            status = sigMsg->SignalMsg("a(sss)",
+                                       org::alljoyn::Daemon::WellKnownName,
+                                       0,
+                                       org::alljoyn::Daemon::ObjectPath,
+                                       org::alljoyn::Daemon::InterfaceName,
+                                       "NameChanges",
+                                       &argArray,
+                                       1,
+                                       0,
+                                       0);
+            if (ER_OK == status) {
+                status = endpoint->PushMessage(sigMsg);
+            }
+        }
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to announce NameChanges support to %s", endpoint->GetUniqueName().c_str()));
+            status = ER_OK;
+        }
+    }
+    return status;
 }
 
 void AllJoynObj::RemoveBusToBusEndpoint(RemoteEndpoint& endpoint)
@@ -2848,58 +3224,14 @@ void AllJoynObj::RemoveBusToBusEndpoint(RemoteEndpoint& endpoint)
         if (it->second->RemoveBusToBusEndpoint(endpoint)) {
             String exitingEpName = it->second->GetUniqueName();
 
-            /* Let directly connected daemons know that this virtual endpoint is gone. */
-            map<qcc::StringMapKey, RemoteEndpoint>::iterator it2 = b2bEndpoints.begin();
-            const qcc::GUID128& otherSideGuid = endpoint->GetRemoteGUID();
-            while ((it2 != b2bEndpoints.end()) && (it != virtualEndpoints.end())) {
-                if ((it2->second != endpoint) && (it2->second->GetRemoteGUID() != otherSideGuid)) {
-                    Message sigMsg(bus);
-                    MsgArg args[3];
-                    args[0].Set("s", exitingEpName.c_str());
-                    args[1].Set("s", exitingEpName.c_str());
-                    args[2].Set("s", "");
-
-                    QStatus status = sigMsg->SignalMsg("sss",
-                                                       org::alljoyn::Daemon::WellKnownName,
-                                                       0,
-                                                       org::alljoyn::Daemon::ObjectPath,
-                                                       org::alljoyn::Daemon::InterfaceName,
-                                                       "NameChanged",
-                                                       args,
-                                                       ArraySize(args),
-                                                       0,
-                                                       0);
-                    if (ER_OK == status) {
-                        String key = it->first;
-                        String key2 = it2->first.c_str();
-                        RemoteEndpoint ep = it2->second;
-                        ReleaseLocks();
-                        status = ep->PushMessage(sigMsg);
-                        if (ER_OK != status) {
-                            QCC_LogError(status, ("Failed to send NameChanged to %s", ep->GetUniqueName().c_str()));
-                        }
-                        AcquireLocks();
-                        it2 = b2bEndpoints.lower_bound(key2);
-                        if ((it2 != b2bEndpoints.end()) && (it2->first == key2)) {
-                            ++it2;
-                        }
-                        it = virtualEndpoints.find(key);
-                    } else {
-                        ++it2;;
-                    }
-                } else {
-                    ++it2;
-                }
-            }
+            /* Let the other directly connected daemons know that this virtual endpoint is gone. */
+            QueueNameChanged(exitingEpName, exitingEpName, "", endpoint->GetRemoteGUID().ToString());
 
             /* Remove virtual endpoint with no more b2b eps */
-            if (it != virtualEndpoints.end()) {
-                String vepName = it->first;
-                ReleaseLocks();
-                RemoveVirtualEndpoint(vepName);
-                AcquireLocks();
-                it = virtualEndpoints.upper_bound(vepName);
-            }
+            ReleaseLocks();
+            RemoveVirtualEndpoint(vepName);
+            AcquireLocks();
+            it = virtualEndpoints.upper_bound(vepName);
 
         } else {
             ++it;
@@ -3001,6 +3333,7 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
     AcquireLocks();
     map<qcc::StringMapKey, RemoteEndpoint>::iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
     const size_t numItems = args[0].v_array.GetNumElements();
+    vector<bool> changedItems(numItems, false);
     if (bit != b2bEndpoints.end()) {
         qcc::GUID128 otherGuid = bit->second->GetRemoteGUID();
         bit = b2bEndpoints.begin();
@@ -3036,6 +3369,7 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
 
                     if (madeChange) {
                         madeChanges = true;
+                        changedItems[i] = true;
                     }
 
                     /* Add virtual aliases (remote well-known names) */
@@ -3054,6 +3388,7 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
                             }
                             if (madeChange) {
                                 madeChanges = true;
+                                changedItems[i] = true;
                             }
                         }
                     }
@@ -3073,10 +3408,52 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
     }
     ReleaseLocks();
 
-    /* If there were changes, forward message to all directly connected controllers except the one that
-     * sent us this ExchangeNames
+    /* If there were changes, forward the entries that changed to all directly connected controllers except
+     * the one that sent us this ExchangeNames
      */
     if (madeChanges) {
+        Message fwdMsg = msg;
+        size_t numChanged = 0;
+        for (size_t i = 0; i < numItems; ++i) {
+            if (changedItems[i]) {
+                ++numChanged;
+            }
+        }
+        if (numChanged < numItems) {
+            MsgArg* entries = new MsgArg[numChanged];
+            size_t numEntries = 0;
+            for (size_t i = 0; i < numItems; ++i) {
+                if (changedItems[i]) {
+                    entries[numEntries++] = items[i];
+                }
+            }
+            MsgArg argArray;
+            QStatus status = argArray.Set("a(sas)", numEntries, entries);
+            if (ER_OK == status) {
+                Message deltaMsg(bus);
+                status = deltaMsg->SignalMsg("a(sas)",
+                                             org::alljoyn::Daemon::WellKnownName,
+                                             0,
+                                             org::alljoyn::Daemon::ObjectPath,
+                                             org::alljoyn::Daemon::InterfaceName,
+                                             "ExchangeNames",
+                                             &argArray,
+                                             1,
+                                             0,
+                                             0);
+                if (ER_OK == status) {
+                    fwdMsg = deltaMsg;
+                }
+            }
+            if (ER_OK != status) {
+                QCC_LogError(status, ("Failed to build ExchangeNames delta, forwarding all names"));
+            }
+            delete [] entries;
+        }
+
+        /* Queued changes were made before these so they must reach the other daemons first */
+        nameChangesSendLock.Lock(MUTEX_CONTEXT);
+        SendPendingNameChanges();
         AcquireLocks();
         map<qcc::StringMapKey, RemoteEndpoint>::const_iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
         map<qcc::StringMapKey, RemoteEndpoint>::iterator it = b2bEndpoints.begin();
@@ -3086,7 +3463,7 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
                 StringMapKey key = it->first;
                 RemoteEndpoint ep = it->second;
                 ReleaseLocks();
-                QStatus status = ep->PushMessage(msg);
+                QStatus status = ep->PushMessage(fwdMsg);
                 if (ER_OK != status) {
                     QCC_LogError(status, ("Failed to forward ExchangeNames to %s", ep->GetUniqueName().c_str()));
                 }
@@ -3101,36 +3478,28 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
             }
         }
         ReleaseLocks();
+        nameChangesSendLock.Unlock(MUTEX_CONTEXT);
     }
 }
 
-void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* member, const char* sourcePath, Message& msg)
+bool AllJoynObj::ApplyNameChanged(const qcc::String& alias, const qcc::String& oldOwner, const qcc::String& newOwner, const char* rcvEndpointName, const char* sender)
 {
-    size_t numArgs;
-    const MsgArg* args;
-    msg->GetArgs(numArgs, args);
-
-    assert(daemonIface);
-
-    const qcc::String alias = args[0].v_string.str;
-    const qcc::String oldOwner = args[1].v_string.str;
-    const qcc::String newOwner = args[2].v_string.str;
-
     const String& shortGuidStr = guid.ToShortString();
     bool madeChanges = false;
 
-    QCC_DbgPrintf(("AllJoynObj::NameChangedSignalHandler: alias = \"%s\"   oldOwner = \"%s\"   newOwner = \"%s\"  sent from \"%s\"",
-                   alias.c_str(), oldOwner.c_str(), newOwner.c_str(), msg->GetSender()));
+    QCC_DbgPrintf(("AllJoynObj::ApplyNameChanged: alias = \"%s\"   oldOwner = \"%s\"   newOwner = \"%s\"  sent from \"%s\"",
+                   alias.c_str(), oldOwner.c_str(), newOwner.c_str(), sender));
 
     /* Don't allow a NameChange that attempts to change a local name */
-    if ((!oldOwner.empty() && (0 == ::strncmp(oldOwner.c_str() + 1, shortGuidStr.c_str(), shortGuidStr.size()))) ||
+    if (alias.empty() ||
+        (!oldOwner.empty() && (0 == ::strncmp(oldOwner.c_str() + 1, shortGuidStr.c_str(), shortGuidStr.size()))) ||
         (!newOwner.empty() && (0 == ::strncmp(newOwner.c_str() + 1, shortGuidStr.c_str(), shortGuidStr.size())))) {
-        return;
+        return false;
     }
 
     if (alias[0] == ':') {
         AcquireLocks();
-        map<qcc::StringMapKey, RemoteEndpoint>::iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
+        map<qcc::StringMapKey, RemoteEndpoint>::iterator bit = b2bEndpoints.find(rcvEndpointName);
         if (bit != b2bEndpoints.end()) {
             /* Change affects a remote unique name (i.e. a VirtualEndpoint) */
             if (newOwner.empty()) {
@@ -3159,12 +3528,12 @@ void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* me
             }
         } else {
             ReleaseLocks();
-            QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find bus-to-bus endpoint %s", msg->GetRcvEndpointName()));
+            QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find bus-to-bus endpoint %s", rcvEndpointName));
         }
     } else {
         AcquireLocks();
         /* Change affects a well-known name (name table only) */
-        VirtualEndpoint remoteController = FindVirtualEndpoint(msg->GetSender());
+        VirtualEndpoint remoteController = FindVirtualEndpoint(sender);
         if (remoteController->IsValid()) {
             ReleaseLocks();
             if (newOwner.empty()) {
@@ -3175,13 +3544,31 @@ void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* me
             }
             AcquireLocks();
         } else {
-            QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find virtual endpoint %s", msg->GetSender()));
+            QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find virtual endpoint %s", sender));
         }
         ReleaseLocks();
     }
+    return madeChanges;
+}
+
+void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* member, const char* sourcePath, Message& msg)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+
+    assert(daemonIface);
+
+    const qcc::String alias = args[0].v_string.str;
+    const qcc::String oldOwner = args[1].v_string.str;
+    const qcc::String newOwner = args[2].v_string.str;
+
+    bool madeChanges = ApplyNameChanged(alias, oldOwner, newOwner, msg->GetRcvEndpointName(), msg->GetSender());
 
     if (madeChanges) {
         /* Forward message to all directly connected controllers except the one that sent us this NameChanged */
+        nameChangesSendLock.Lock(MUTEX_CONTEXT);
+        SendPendingNameChanges();
         AcquireLocks();
         map<qcc::StringMapKey, RemoteEndpoint>::const_iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
         map<qcc::StringMapKey, RemoteEndpoint>::iterator it = b2bEndpoints.begin();
@@ -3206,6 +3593,250 @@ void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* me
             }
         }
         ReleaseLocks();
+        nameChangesSendLock.Unlock(MUTEX_CONTEXT);
+    }
+}
+
+void AllJoynObj::NameChangesSignalHandler(const InterfaceDescription::Member* member, const char* sourcePath, Message& msg)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    assert((1 == numArgs) && (ALLJOYN_ARRAY == args[0].typeId));
+
+    const MsgArg* items = args[0].v_array.GetElements();
+    const size_t numItems = args[0].v_array.GetNumElements();
+    vector<size_t> changed;
+
+    QCC_DbgPrintf(("AllJoynObj::NameChangesSignalHandler: %u changes sent from \"%s\"", (unsigned int)numItems, msg->GetSender()));
+
+    /* Any NameChanges, including the empty one sent when the link comes up, shows the sender accepts them */
+    AcquireLocks();
+    map<qcc::StringMapKey, RemoteEndpoint>::iterator rit = b2bEndpoints.find(msg->GetRcvEndpointName());
+    if (rit != b2bEndpoints.end()) {
+        rit->second->GetFeatures().nameChanges = true;
+    }
+    ReleaseLocks();
+
+    for (size_t i = 0; i < numItems; ++i) {
+        assert(items[i].typeId == ALLJOYN_STRUCT);
+        const qcc::String alias = items[i].v_struct.members[0].v_string.str;
+        const qcc::String oldOwner = items[i].v_struct.members[1].v_string.str;
+        const qcc::String newOwner = items[i].v_struct.members[2].v_string.str;
+        if (ApplyNameChanged(alias, oldOwner, newOwner, msg->GetRcvEndpointName(), msg->GetSender())) {
+            changed.push_back(i);
+        }
+    }
+
+    if (changed.empty()) {
+        return;
+    }
+
+    /*
+     * Forward the batch to all directly connected controllers except the one that sent it. Controllers
+     * that predate NameChanges are sent the changes one NameChanged signal at a time. These must carry the
+     * original sender since well-known name changes are only accepted from the daemon that owns the name.
+     */
+    vector<Message> legacyMsgs;
+    nameChangesSendLock.Lock(MUTEX_CONTEXT);
+    SendPendingNameChanges();
+    AcquireLocks();
+    map<qcc::StringMapKey, RemoteEndpoint>::const_iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
+    map<qcc::StringMapKey, RemoteEndpoint>::iterator it = b2bEndpoints.begin();
+    while (it != b2bEndpoints.end()) {
+        if ((bit == b2bEndpoints.end()) || (bit->second->GetRemoteGUID() != it->second->GetRemoteGUID())) {
+            QCC_DbgPrintf(("Propagating NameChanges signal to %s", it->second->GetUniqueName().c_str()));
+            String key = it->first.c_str();
+            RemoteEndpoint ep = it->second;
+            ReleaseLocks();
+            QStatus status = ER_OK;
+            if (ep->GetFeatures().nameChanges) {
+                status = ep->PushMessage(msg);
+            } else {
+                for (size_t i = legacyMsgs.size(); (ER_OK == status) && (i < changed.size()); ++i) {
+                    Message sigMsg(bus);
+                    status = sigMsg->SignalMsg("sss",
+                                               org::alljoyn::Daemon::WellKnownName,
+                                               0,
+                                               org::alljoyn::Daemon::ObjectPath,
+                                               org::alljoyn::Daemon::InterfaceName,
+                                               "NameChanged",
+                                               items[changed[i]].v_struct.members,
+                                               3,
+                                               0,
+                                               0);
+                    if (ER_OK == status) {
+                        status = sigMsg->ReMarshal(msg->GetSender());
+                    }
+                    if (ER_OK == status) {
+                        legacyMsgs.push_back(sigMsg);
+                    }
+                }
+                for (size_t i = 0; (ER_OK == status) && (i < legacyMsgs.size()); ++i) {
+                    status = ep->PushMessage(legacyMsgs[i]);
+                }
+            }
+            if (ER_OK != status) {
+                QCC_LogError(status, ("Failed to forward NameChanges to %s", ep->GetUniqueName().c_str()));
+            }
+            AcquireLocks();
+            bit = b2bEndpoints.find(msg->GetRcvEndpointName());
+            it = b2bEndpoints.lower_bound(key);
+            if ((it != b2bEndpoints.end()) && (it->first == key)) {
+                ++it;
+            }
+        } else {
+            ++it;
+        }
+    }
+    ReleaseLocks();
+    nameChangesSendLock.Unlock(MUTEX_CONTEXT);
+}
+
+void AllJoynObj::QueueNameChanged(const qcc::String& alias, const qcc::String& oldOwner, const qcc::String& newOwner, const qcc::String& excludeGuid)
+{
+    NameChange change;
+    change.alias = alias;
+    change.oldOwner = oldOwner;
+    change.newOwner = newOwner;
+    change.excludeGuid = excludeGuid;
+
+    /*
+     * Coalesce with a change to the same name that has not been sent yet. The earlier entry is dropped
+     * and the combined change is appended so it stays ordered after the changes it depends on.
+     */
+    map<qcc::String, size_t>::iterator it = pendingNameChangeIndex.find(alias);
+    if (it != pendingNameChangeIndex.end()) {
+        NameChange& prev = pendingNameChanges[it->second];
+        if (prev.excludeGuid == excludeGuid) {
+            change.oldOwner = prev.oldOwner;
+            prev.alias.clear();
+            if (change.oldOwner == change.newOwner) {
+                /* The name is back where it started so there is nothing to send */
+                pendingNameChangeIndex.erase(it);
+                return;
+            }
+        }
+    }
+    pendingNameChangeIndex[alias] = pendingNameChanges.size();
+    pendingNameChanges.push_back(change);
+
+    if (!nameChangesAlarmSet) {
+        Alarm alarm(NAME_CHANGES_BATCH_DELAY, this, nameChangesAlarmContext);
+        QStatus status = timer.AddAlarm(alarm);
+        if (ER_OK == status) {
+            nameChangesAlarmSet = true;
+        } else {
+            QCC_LogError(status, ("Failed to schedule NameChanges batch"));
+        }
+    }
+}
+
+void AllJoynObj::SendNameChanges()
+{
+    nameChangesSendLock.Lock(MUTEX_CONTEXT);
+    SendPendingNameChanges();
+    nameChangesSendLock.Unlock(MUTEX_CONTEXT);
+}
+
+void AllJoynObj::SendPendingNameChanges()
+{
+    vector<NameChange> changes;
+    vector<RemoteEndpoint> eps;
+
+    AcquireLocks();
+    changes.swap(pendingNameChanges);
+    pendingNameChangeIndex.clear();
+    nameChangesAlarmSet = false;
+    map<qcc::StringMapKey, RemoteEndpoint>::iterator bit = b2bEndpoints.begin();
+    while (bit != b2bEndpoints.end()) {
+        eps.push_back(bit->second);
+        ++bit;
+    }
+    ReleaseLocks();
+
+    /*
+     * Every bus-to-bus endpoint to the same remote daemon is sent the same messages so build them
+     * once per remote daemon.
+     */
+    map<qcc::String, vector<Message> > msgsByGuid;
+    for (size_t e = 0; e < eps.size(); ++e) {
+        RemoteEndpoint& ep = eps[e];
+        const String guidStr = ep->GetRemoteGUID().ToString();
+        map<qcc::String, vector<Message> >::iterator mit = msgsByGuid.find(guidStr);
+        if (mit == msgsByGuid.end()) {
+            mit = msgsByGuid.insert(pair<qcc::String, vector<Message> >(guidStr, vector<Message>())).first;
+            vector<const NameChange*> relevant;
+            for (size_t i = 0; i < changes.size(); ++i) {
+                if (!changes[i].alias.empty() && (changes[i].excludeGuid != guidStr)) {
+                    relevant.push_back(&changes[i]);
+                }
+            }
+            QStatus status = ER_OK;
+            if (ep->GetFeatures().nameChanges) {
+                for (size_t start = 0; (ER_OK == status) && (start < relevant.size()); start += NAME_CHANGES_MAX_BATCH) {
+                    size_t numEntries = relevant.size() - start;
+                    if (numEntries > NAME_CHANGES_MAX_BATCH) {
+                        numEntries = NAME_CHANGES_MAX_BATCH;
+                    }
+                    MsgArg* entries = new MsgArg[numEntries];
+                    for (size_t i = 0; i < numEntries; ++i) {
+                        const NameChange* nc = relevant[start + i];
+                        entries[i].Set("(sss)", nc->alias.c_str(), nc->oldOwner.c_str(), nc->newOwner.c_str());
+                    }
+                    MsgArg argArray;
+                    status = argArray.Set("a(sss)", numEntries, entries);
+                    if (ER_OK == status) {
+                        Message sigMsg(bus);
+                        status = sigMsg->SignalMsg("a(sss)",
+                                                   org::alljoyn::Daemon::WellKnownName,
+                                                   0,
+                                                   org::alljoyn::Daemon::ObjectPath,
+                                                   org::alljoyn::Daemon::InterfaceName,
+                                                   "NameChanges",
+                                                   &argArray,
+                                                   1,
+                                                   0,
+                                                   0);
+                        if (ER_OK == status) {
+                            mit->second.push_back(sigMsg);
+                        }
+                    }
+                    delete [] entries;
+                }
+            } else {
+                for (size_t i = 0; (ER_OK == status) && (i < relevant.size()); ++i) {
+                    MsgArg args[3];
+                    args[0].Set("s", relevant[i]->alias.c_str());
+                    args[1].Set("s", relevant[i]->oldOwner.c_str());
+                    args[2].Set("s", relevant[i]->newOwner.c_str());
+                    Message sigMsg(bus);
+                    status = sigMsg->SignalMsg("sss",
+                                               org::alljoyn::Daemon::WellKnownName,
+                                               0,
+                                               org::alljoyn::Daemon::ObjectPath,
+                                               org::alljoyn::Daemon::InterfaceName,
+                                               "NameChanged",
+                                               args,
+                                               ArraySize(args),
+                                               0,
+                                               0);
+                    if (ER_OK == status) {
+                        mit->second.push_back(sigMsg);
+                    }
+                }
+            }
+            if (ER_OK != status) {
+                QCC_LogError(status, ("Failed to build name changes for %s", guidStr.c_str()));
+            }
+        }
+        for (size_t i = 0; i < mit->second.size(); ++i) {
+            QStatus status = ep->PushMessage(mit->second[i]);
+            if (ER_OK != status) {
+                QCC_LogError(status, ("Failed to send name changes to %s", ep->GetUniqueName().c_str()));
+                break;
+            }
+        }
     }
 }
 
@@ -3278,7 +3909,6 @@ VirtualEndpoint AllJoynObj::FindVirtualEndpoint(const qcc::String& uniqueName)
 
 void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* oldOwner, const qcc::String* newOwner)
 {
-    QStatus status;
     const String& shortGuidStr = guid.ToShortString();
 
     /* Validate that there is either a new owner or an old owner */
@@ -3307,7 +3937,7 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
         while (it != sessionMap.end()) {
             if (it->first.first == alias) {
                 /* If endpoint has gone then just delete the session map entry */
-                sessionMap.erase(it++);
+                SessionMapErase(it++);
             } else if (it->first.second != 0) {
                 /* Remove member entries from existing sessions */
                 if (it->second.sessionHost == alias) {
@@ -3354,7 +3984,7 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
                     SessionMapEntry tsme = it->second;
                     pair<String, SessionId> key = it->first;
                     if (!it->second.isInitializing) {
-                        sessionMap.erase(it);
+                        SessionMapErase(it);
                     }
                     ReleaseLocks();
                     SendSessionLost(tsme);
@@ -3380,43 +4010,9 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
     /* Only if local name */
     if (0 == ::strncmp(shortGuidStr.c_str(), un->c_str() + 1, shortGuidStr.size())) {
 
-        /* Send NameChanged to all directly connected controllers */
+        /* Queue the change for the next batch sent to all directly connected controllers */
         AcquireLocks();
-        map<qcc::StringMapKey, RemoteEndpoint>::iterator it = b2bEndpoints.begin();
-        while (it != b2bEndpoints.end()) {
-            Message sigMsg(bus);
-            MsgArg args[3];
-            args[0].Set("s", alias.c_str());
-            args[1].Set("s", oldOwner ? oldOwner->c_str() : "");
-            args[2].Set("s", newOwner ? newOwner->c_str() : "");
-
-            status = sigMsg->SignalMsg("sss",
-                                       org::alljoyn::Daemon::WellKnownName,
-                                       0,
-                                       org::alljoyn::Daemon::ObjectPath,
-                                       org::alljoyn::Daemon::InterfaceName,
-                                       "NameChanged",
-                                       args,
-                                       ArraySize(args),
-                                       0,
-                                       0);
-            if (ER_OK == status) {
-                StringMapKey key = it->first;
-                RemoteEndpoint ep = it->second;
-                ReleaseLocks();
-                status = ep->PushMessage(sigMsg);
-                AcquireLocks();
-                it = b2bEndpoints.lower_bound(key);
-                if ((it != b2bEndpoints.end()) && (it->first == key)) {
-                    ++it;
-                }
-            } else {
-                ++it;
-            }
-            if (ER_OK != status) {
-                QCC_LogError(status, ("Failed to send NameChanged"));
-            }
-        }
+        QueueNameChanged(alias, oldOwner ? *oldOwner : "", newOwner ? *newOwner : "", "");
         ReleaseLocks();
 
         /* If a local unique name dropped, then remove any refs it had in the connnect, advertise and discover maps */
@@ -3707,7 +4303,15 @@ QStatus AllJoynObj::SendLostAdvertisedName(const String& name, TransportMask tra
 
 void AllJoynObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
 {
-    if (ER_OK == reason) {
+    if (alarm->GetContext() == nameChangesAlarmContext) {
+        if (ER_OK == reason) {
+            SendNameChanges();
+        }
+    } else if (alarm->GetContext() == directChannelAlarmContext) {
+        if (ER_OK == reason) {
+            ExpireDirectRequests();
+        }
+    } else if (ER_OK == reason) {
         AcquireLocks();
         if ((bool)alarm->GetContext()) {
             multimap<String, NameMapEntry>::iterator it = nameMap.begin();
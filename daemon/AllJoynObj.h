@@ -23,17 +23,21 @@
 #define _ALLJOYN_ALLJOYNOBJ_H
 
 #include <qcc/platform.h>
+#include <deque>
 #include <vector>
 #include <map>
+#include <set>
 
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/StringMapKey.h>
 #include <qcc/Thread.h>
+#include <qcc/Event.h>
 #include <qcc/time.h>
 #include <qcc/SocketTypes.h>
 #include <qcc/Timer.h>
 #include <qcc/GUID.h>
+#include <qcc/STLContainer.h>
 
 #include <alljoyn/BusObject.h>
 #include <alljoyn/Message.h>
@@ -44,6 +48,7 @@
 #include "Transport.h"
 #include "VirtualEndpoint.h"
 #include "PermissionMgr.h"
+#include "RawRelay.h"
 
 namespace ajn {
 
@@ -54,7 +59,7 @@ class BusController;
  * BusObject responsible for implementing the standard AllJoyn methods at org.alljoyn.Bus
  * for messages directed to the bus.
  */
-class AllJoynObj : public BusObject, public NameListener, public TransportListener, public qcc::AlarmListener {
+class AllJoynObj : public BusObject, public NameListener, public TransportListener, public qcc::AlarmListener, public qcc::ThreadListener {
     friend class _RemoteEndpoint;
 
   public:
@@ -262,6 +267,24 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void GetSessionFd(const InterfaceDescription::Member* member, Message& msg);
 
+    /**
+     * Respond to a bus request for a direct channel to the other member of a point-to-point
+     * message session between two applications on this device. The request is held in the
+     * session map and both members are answered when the second one asks for the channel, or
+     * with ER_TIMEOUT if the other member does not ask within DIRECT_CHANNEL_TIMEOUT.
+     *
+     * The input Message (METHOD_CALL) is expected to contain the following parameters:
+     *   sessionId   uint32    A session id that identifies an existing point-to-point message session.
+     *
+     * The output Message (METHOD_REPLY) contains the following parameters:
+     *   handle      handle    This member's end of a socket pair connecting the two members.
+     *   peer        string    Unique name of the other member.
+     *
+     * @param member  Member.
+     * @param msg     The incoming message.
+     */
+    void GetSessionChannel(const InterfaceDescription::Member* member, Message& msg);
+
     /**
      * Respond to a bus request to set the link timeout for a given session.
      *
@@ -421,6 +444,17 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void NameChangedSignalHandler(const InterfaceDescription::Member* member, const char* sourcePath, Message& msg);
 
+    /**
+     * Process incoming NameChanges signals from remote daemons. NameChanges carries a batch of
+     * NameChanged updates. A daemon that supports it sends an empty NameChanges when a bus-to-bus
+     * link comes up, and receiving one marks the link as accepting NameChanges.
+     *
+     * @param member        Interface member for signal
+     * @param sourcePath    object path sending the signal.
+     * @param msg           The signal message.
+     */
+    void NameChangesSignalHandler(const InterfaceDescription::Member* member, const char* sourcePath, Message& msg);
+
     /**
      * Process incoming SessionDetach signals from remote daemons.
      *
@@ -521,24 +555,44 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
         std::vector<qcc::String> memberNames;
         bool isInitializing;
         bool isRawReady;
+        Message* directRequest;      /**< GetSessionChannel request waiting for the other member */
+        uint64_t directRequestTime;  /**< When directRequest was received */
         SessionMapEntry() :
             id(0),
             sessionPort(0),
             opts(),
             fd(-1),
             isInitializing(false),
-            isRawReady(false) { }
+            isRawReady(false),
+            directRequest(NULL),
+            directRequestTime(0) { }
     };
 
     typedef std::multimap<std::pair<qcc::String, SessionId>, SessionMapEntry> SessionMapType;
 
     SessionMapType sessionMap;  /**< Map (endpointName,sessionId) to session info */
 
+    /**
+     * Index of session id to the endpoint names that have a sessionMap entry for that id.
+     * Session port bindings (id 0) are not indexed. Maintained by SessionMapInsert/SessionMapErase.
+     */
+    typedef std::unordered_map<SessionId, std::set<qcc::String> > SessionIdIndexType;
+
+    SessionIdIndexType sessionIdIndex;
+
     /*
      * Helper function to get session map interator
      */
     SessionMapEntry* SessionMapFind(const qcc::String& name, SessionId session);
 
+    /**
+     * Helper function to get the endpoint names of all sessionMap entries for a session id.
+     *
+     * @param session   Session id (must not be 0).
+     * @param names     [OUT] Endpoint names with an entry for session.
+     */
+    void SessionMapGetNames(SessionId session, std::vector<qcc::String>& names);
+
     /*
      * Helper function to get session map range interator
      */
@@ -554,6 +608,11 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void SessionMapErase(SessionMapEntry& sme);
 
+    /**
+     * Helper function to erase a single sesssion map entry
+     */
+    void SessionMapErase(SessionMapType::iterator it);
+
     const qcc::GUID128& guid;                                  /**< Global GUID of this daemon */
 
     const InterfaceDescription::Member* exchangeNamesSignal;   /**< org.alljoyn.Daemon.ExchangeNames signal member */
@@ -565,7 +624,45 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
 
     std::multimap<qcc::String, std::pair<qcc::String, TransportMask> > advAliasMap;  /**< Map remote daemon guid/transport to advertised name alias */
 
-    qcc::Timer timer;           /**< Timer object for reaping expired names */
+    qcc::Timer timer;           /**< Timer object for reaping expired names and sending batched name changes */
+
+    /** A name table change waiting to be sent to directly connected daemons */
+    struct NameChange {
+        qcc::String alias;          /**< Name that changed (cleared if superseded by a later change) */
+        qcc::String oldOwner;       /**< Previous owner or empty */
+        qcc::String newOwner;       /**< New owner or empty */
+        qcc::String excludeGuid;    /**< GUID of the remote daemon that should not be sent this change or empty */
+    };
+
+    std::vector<NameChange> pendingNameChanges;               /**< Name changes waiting for the next batch */
+    std::map<qcc::String, size_t> pendingNameChangeIndex;     /**< Map of alias to its latest entry in pendingNameChanges */
+    bool nameChangesAlarmSet;                                 /**< True if the batch alarm is pending */
+    static void* nameChangesAlarmContext;                     /**< Alarm context for the batch alarm */
+    qcc::Mutex nameChangesSendLock;                           /**< Serializes sending name changes so they reach each peer in order */
+
+    std::vector<Message*> orphanedDirectRequests;             /**< GetSessionChannel requests whose session went away */
+    static void* directChannelAlarmContext;                   /**< Alarm context for GetSessionChannel timeouts */
+
+    /**
+     * @brief The number of milliseconds a GetSessionChannel request waits for the other member.
+     */
+    static const uint32_t DIRECT_CHANNEL_TIMEOUT = 5000;
+
+    /**
+     * Reply to GetSessionChannel requests that have timed out or whose session went away.
+     */
+    void ExpireDirectRequests();
+
+    /**
+     * @brief The number of milliseconds that name changes are held so that they can be sent to
+     * remote daemons as a single batch.
+     */
+    static const uint32_t NAME_CHANGES_BATCH_DELAY = 20;
+
+    /**
+     * @brief The maximum number of name changes sent in a single NameChanges signal.
+     */
+    static const size_t NAME_CHANGES_MAX_BATCH = 256;
 
     /**
      * Name reaper timeout alarm handler.
@@ -574,13 +671,24 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
-    /** JoinSessionThread handles a JoinSession request from a local client on a separate thread */
+    /**
+     * Called when a raw session relay exits. Reports the bytes it moved and deletes it.
+     *
+     * @param thread  The RawRelay that exited.
+     */
+    void ThreadExit(qcc::Thread* thread);
+
+    /**
+     * JoinSessionThread is a pooled worker that services queued JoinSession (or AttachSession) requests
+     * from local clients and remote daemons. Workers are started on demand up to a configured limit and
+     * exit after they have been idle for a while.
+     */
     class JoinSessionThread : public qcc::Thread, public qcc::ThreadListener {
       public:
-        JoinSessionThread(AllJoynObj& ajObj, const Message& msg, bool isJoin) :
-            qcc::Thread(qcc::String("JoinS-") + qcc::U32ToString(qcc::IncrementAndFetch(&jstCount))),
+        JoinSessionThread(AllJoynObj& ajObj, bool isJoin) :
+            qcc::Thread(qcc::String(isJoin ? "JoinS-" : "AttachS-") + qcc::U32ToString(qcc::IncrementAndFetch(&jstCount))),
             ajObj(ajObj),
-            msg(msg),
+            msg(ajObj.bus),
             isJoin(isJoin) { }
 
         void ThreadExit(Thread* thread);
@@ -594,13 +702,57 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
         qcc::ThreadReturn STDCALL RunAttach();
 
         AllJoynObj& ajObj;
-        Message msg;
+        Message msg;            /**< Request currently being serviced */
         bool isJoin;
     };
 
-    std::vector<JoinSessionThread*> joinSessionThreads;  /**< List of outstanding join session requests */
-    qcc::Mutex joinSessionThreadsLock;                   /**< Lock that protects joinSessionThreads */
+    /**
+     * @brief The default value for the maximum number of JoinSession (and separately
+     * AttachSession) worker threads.
+     *
+     * Requests beyond this limit are queued until a worker becomes free. To override
+     * this value, change the limit, "max_join_session_threads".
+     */
+    static const uint32_t ALLJOYN_MAX_JOIN_SESSION_THREADS_DEFAULT = 16;
+
+    /**
+     * @brief The number of milliseconds a join session worker waits for a new request
+     * before exiting.
+     */
+    static const uint32_t JOIN_SESSION_THREAD_IDLE_TIMEOUT = 30000;
+
+    /** Queue of pending requests and bookkeeping for the workers of one kind (JoinSession or AttachSession) */
+    struct JoinSessionPool {
+        std::deque<Message> requests;   /**< Requests waiting for a worker */
+        size_t numThreads;              /**< Number of running workers */
+        size_t numIdle;                 /**< Number of workers waiting for a request */
+        qcc::Event wakeEvent;           /**< Set when requests is non-empty */
+        JoinSessionPool() : numThreads(0), numIdle(0) { }
+    };
+
+    /**
+     * An outstanding bus-to-bus connect attempt. Concurrent joins that need a connection to the same
+     * bus address wait for and share the result of the first attempt rather than each opening a connection.
+     */
+    struct PendingConnect {
+        qcc::Event done;                /**< Set when the connect attempt completes */
+        QStatus status;                 /**< Result of the connect attempt */
+        BusEndpoint ep;                 /**< Endpoint created by the connect attempt */
+        bool complete;                  /**< True once status and ep are valid */
+        uint32_t refs;                  /**< Number of threads referencing this entry */
+        PendingConnect() : status(ER_OK), complete(false), refs(1) { }
+    };
+
+    std::vector<JoinSessionThread*> joinSessionThreads;  /**< List of running join/attach session workers */
+    qcc::Mutex joinSessionThreadsLock;                   /**< Lock that protects joinSessionThreads and the worker pools */
+    JoinSessionPool joinPool;                            /**< Pending JoinSession requests */
+    JoinSessionPool attachPool;                          /**< Pending AttachSession requests */
+    uint32_t maxJoinSessionThreads;                      /**< Maximum number of workers per pool */
     bool isStopping;                                     /**< True while waiting for threads to exit */
+    std::map<qcc::String, PendingConnect*> pendingConnects;  /**< Map of busAddr to in-progress connect attempt */
+    qcc::Mutex pendingConnectsLock;                      /**< Lock that protects pendingConnects */
+    std::vector<RawRelay*> rawRelays;                    /**< Relays for raw sessions bridged by this daemon */
+    qcc::Mutex rawRelaysLock;                            /**< Lock that protects rawRelays */
     BusController* busController;                        /**< BusController that created this BusObject */
 
     /**
@@ -613,6 +765,27 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void ReleaseLocks();
 
+    /**
+     * Queue a JoinSession or AttachSession request for a pooled worker, starting a new worker if
+     * none are idle and the pool limit has not been reached.
+     *
+     * @param msg      The JoinSession or AttachSession method call.
+     * @param isJoin   true for JoinSession, false for AttachSession.
+     */
+    void QueueJoinSessionRequest(const Message& msg, bool isJoin);
+
+    /**
+     * Connect to a remote daemon on behalf of a join or attach request. Message based sessions that
+     * target a bus address that is already being connected to share the result of that attempt.
+     *
+     * @param trans     Transport that will perform the connect.
+     * @param busAddr   Bus address (connect spec) of the remote daemon.
+     * @param opts      Session options for the connection.
+     * @param newEp     [OUT] Endpoint for the connection (valid if return is ER_OK).
+     * @return ER_OK if successful.
+     */
+    QStatus ConnectBusToBus(Transport* trans, const qcc::String& busAddr, const SessionOpts& opts, BusEndpoint& newEp);
+
     /**
      * Utility function used to send a single FoundName signal.
      *
@@ -770,6 +943,40 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     QStatus ExchangeNames(RemoteEndpoint& endpoint);
 
+    /**
+     * Queue a name table change for the next batch sent to directly connected daemons. A change to
+     * an alias that is already queued replaces the queued change. Must be called with locks held.
+     *
+     * @param alias        Name that changed.
+     * @param oldOwner     Previous owner or empty.
+     * @param newOwner     New owner or empty.
+     * @param excludeGuid  GUID of a remote daemon that should not be sent this change or empty.
+     */
+    void QueueNameChanged(const qcc::String& alias, const qcc::String& oldOwner, const qcc::String& newOwner, const qcc::String& excludeGuid);
+
+    /**
+     * Send all queued name changes to the directly connected daemons.
+     */
+    void SendNameChanges();
+
+    /**
+     * Send all queued name changes to the directly connected daemons. Must be called with
+     * nameChangesSendLock held.
+     */
+    void SendPendingNameChanges();
+
+    /**
+     * Apply a name change received from a remote daemon.
+     *
+     * @param alias            Name that changed.
+     * @param oldOwner         Previous owner or empty.
+     * @param newOwner         New owner or empty.
+     * @param rcvEndpointName  Name of the bus-to-bus endpoint the change was received on.
+     * @param sender           Sender of the message carrying the change.
+     * @return  true if the change modified the name table.
+     */
+    bool ApplyNameChanged(const qcc::String& alias, const qcc::String& oldOwner, const qcc::String& newOwner, const char* rcvEndpointName, const char* sender);
+
     /**
      * Process a request to cancel advertising a name from a given (locally-connected) endpoint.
      *
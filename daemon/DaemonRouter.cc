@@ -114,6 +114,22 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
     }
 
     bool destinationEmpty = destination[0] == '\0';
+
+    /*
+     * Locally generated broadcast and session multicast messages are encrypted with the group key
+     * before they are fanned out so all the endpoints share one encrypted message instead of each
+     * encrypting its own copy on delivery.
+     */
+    if (destinationEmpty && msg->IsModifiedOnDelivery()) {
+        status = msg->EncryptGroupMessage();
+        if (status == ER_BUS_AUTHENTICATION_PENDING) {
+            /* Delivery is retried when the authentication completes */
+            return ER_OK;
+        } else if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to encrypt %s", msg->Description().c_str()));
+            return status;
+        }
+    }
     if (!destinationEmpty) {
         nameTable.Lock();
         BusEndpoint destEndpoint = nameTable.FindEndpoint(destination);
@@ -273,44 +289,20 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
          * session multicast message.
          */
         sessionCastSetLock.Lock(MUTEX_CONTEXT);
-        RemoteEndpoint lastB2b;
-        /* We need to obtain the first entry in the sessionCastSet that has the id equal to 'sessionId'
-         * and the src equal to 'msg->GetSender()'.
-         * Note: sce.id has been set to sessionId - 1. Since the src is compared first, and session Ids
-         * are integers, upper_bound will return the iterator to the first element with the desired or
-         * greater src(if not present) and desired or greater id in most cases.
-         */
-        SessionCastEntry sce(sessionId - 1, msg->GetSender());
-        set<SessionCastEntry>::iterator sit = sessionCastSet.upper_bound(sce);
-        bool foundDest = false;
-
-        /* In other cases, it may return the iterator to an element that has the desired src and
-         * (sessionId - 1). In that case iterate, until the id is less than the desired one.
-         */
-        while ((sit != sessionCastSet.end()) && (sit->src == sce.src) && (sit->id < sessionId)) {
-            sit++;
-        }
-
-        while ((sit != sessionCastSet.end()) && (sit->id == sessionId) && (sit->src == sce.src)) {
-            if (sit->b2bEp != lastB2b) {
-                foundDest = true;
-                lastB2b = sit->b2bEp;
-                SessionCastEntry entry = *sit;
-                BusEndpoint ep = sit->destEp;
-                sessionCastSetLock.Unlock(MUTEX_CONTEXT);
+        SessionCastListMap::const_iterator lit = sessionCastLists.find(SessionCastKey(msg->GetSender(), sessionId));
+        if (lit == sessionCastLists.end()) {
+            sessionCastSetLock.Unlock(MUTEX_CONTEXT);
+            status = ER_BUS_NO_ROUTE;
+        } else {
+            /* Published lists are immutable so the lock isn't needed while sending */
+            SessionCastList dests = lit->second;
+            sessionCastSetLock.Unlock(MUTEX_CONTEXT);
+            for (size_t i = 0; i < dests->size(); ++i) {
+                BusEndpoint ep = (*dests)[i];
                 QStatus tStatus = SendThroughEndpoint(msg, ep, sessionId);
                 status = (status == ER_OK) ? tStatus : status;
-                sessionCastSetLock.Lock(MUTEX_CONTEXT);
-                sit = sessionCastSet.lower_bound(entry);
-            }
-            if (sit != sessionCastSet.end()) {
-                ++sit;
             }
         }
-        if (!foundDest) {
-            status = ER_BUS_NO_ROUTE;
-        }
-        sessionCastSetLock.Unlock(MUTEX_CONTEXT);
     }
 
     return status;
@@ -422,14 +414,19 @@ void DaemonRouter::UnregisterEndpoint(const qcc::String& epName, EndpointType ep
 
         /* Remove entries from sessionCastSet with same b2bEp */
         sessionCastSetLock.Lock(MUTEX_CONTEXT);
+        set<SessionCastKey> changed;
         set<SessionCastEntry>::iterator sit = sessionCastSet.begin();
         while (sit != sessionCastSet.end()) {
             set<SessionCastEntry>::iterator doomed = sit;
             ++sit;
             if (doomed->b2bEp == endpoint) {
+                changed.insert(SessionCastKey(doomed->src, doomed->id));
                 sessionCastSet.erase(doomed);
             }
         }
+        for (set<SessionCastKey>::const_iterator cit = changed.begin(); cit != changed.end(); ++cit) {
+            UpdateSessionCastList(cit->first, cit->second);
+        }
         sessionCastSetLock.Unlock(MUTEX_CONTEXT);
     } else {
         /* Remove any session routes */
@@ -501,6 +498,8 @@ QStatus DaemonRouter::AddSessionRoute(SessionId id, BusEndpoint& srcEp, RemoteEn
             RemoteEndpoint none;
             sessionCastSet.insert(SessionCastEntry(id, destEp->GetUniqueName(), none, srcEp));
         }
+        UpdateSessionCastList(srcEp->GetUniqueName(), id);
+        UpdateSessionCastList(destEp->GetUniqueName(), id);
         sessionCastSetLock.Unlock(MUTEX_CONTEXT);
     }
     return status;
@@ -541,6 +540,8 @@ QStatus DaemonRouter::RemoveSessionRoute(SessionId id, BusEndpoint& srcEp, BusEn
         if (it2 != sessionCastSet.end()) {
             sessionCastSet.erase(it2);
         }
+        UpdateSessionCastList(srcEp->GetUniqueName(), id);
+        UpdateSessionCastList(destEp->GetUniqueName(), id);
         sessionCastSetLock.Unlock(MUTEX_CONTEXT);
     }
     return status;
@@ -552,6 +553,7 @@ void DaemonRouter::RemoveSessionRoutes(const char* src, SessionId id)
     BusEndpoint ep = FindEndpoint(srcStr);
 
     sessionCastSetLock.Lock(MUTEX_CONTEXT);
+    set<SessionCastKey> changed;
     set<SessionCastEntry>::const_iterator it = sessionCastSet.begin();
     while (it != sessionCastSet.end()) {
         if (((it->id == id) || (id == 0)) && ((it->src == src) || (it->destEp == ep))) {
@@ -559,13 +561,46 @@ void DaemonRouter::RemoveSessionRoutes(const char* src, SessionId id)
                 BusEndpoint destEp = it->destEp;
                 VirtualEndpoint::cast(destEp)->RemoveSessionRef(it->id);
             }
+            changed.insert(SessionCastKey(it->src, it->id));
             sessionCastSet.erase(it++);
         } else {
             ++it;
         }
     }
+    for (set<SessionCastKey>::const_iterator cit = changed.begin(); cit != changed.end(); ++cit) {
+        UpdateSessionCastList(cit->first, cit->second);
+    }
     sessionCastSetLock.Unlock(MUTEX_CONTEXT);
 }
 
+void DaemonRouter::UpdateSessionCastList(const qcc::String& src, SessionId id)
+{
+    /*
+     * Entries for (src, id) are contiguous in sessionCastSet and ordered by b2bEp so only the first
+     * destination behind each bus-to-bus link is kept. The remote daemon does its own fan-out.
+     */
+    SessionCastList dests;
+    RemoteEndpoint lastB2b;
+    /* See SessionCastEntry::operator< for why upper_bound is used with (id - 1) */
+    set<SessionCastEntry>::const_iterator sit = sessionCastSet.upper_bound(SessionCastEntry(id - 1, src));
+    while ((sit != sessionCastSet.end()) && (sit->src == src) && (sit->id < id)) {
+        ++sit;
+    }
+    while ((sit != sessionCastSet.end()) && (sit->id == id) && (sit->src == src)) {
+        if (sit->b2bEp != lastB2b) {
+            lastB2b = sit->b2bEp;
+            dests->push_back(sit->destEp);
+        }
+        ++sit;
+    }
+
+    SessionCastKey key(src, id);
+    if (dests->empty()) {
+        sessionCastLists.erase(key);
+    } else {
+        sessionCastLists[key] = dests;
+    }
+}
+
 }
 
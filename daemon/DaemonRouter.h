@@ -24,6 +24,11 @@
 
 #include <qcc/platform.h>
 
+#include <set>
+#include <vector>
+
+#include <qcc/ManagedObj.h>
+#include <qcc/STLContainer.h>
 #include <qcc/Thread.h>
 
 #include "Transport.h"
@@ -387,7 +392,39 @@ class DaemonRouter : public Router {
     };
 
     std::set<SessionCastEntry> sessionCastSet; /**< Session multicast set */
-    qcc::Mutex sessionCastSetLock;             /**< Lock that protects sessionCastSet */
+    qcc::Mutex sessionCastSetLock;             /**< Lock that protects sessionCastSet and sessionCastLists */
+
+    /**
+     * Precomputed destinations for session multicast messages from one sender, holding a single
+     * destination per bus-to-bus link. A published list is never modified; membership changes
+     * replace it so the router can walk a list without holding sessionCastSetLock.
+     */
+    typedef qcc::ManagedObj<std::vector<BusEndpoint> > SessionCastList;
+
+    /** Session multicast fan-out key (src, sessionId) */
+    typedef std::pair<qcc::String, SessionId> SessionCastKey;
+
+    /**
+     * Hash functor for SessionCastKey
+     */
+    struct SessionCastKeyHash {
+        inline size_t operator()(const SessionCastKey& key) const {
+            return qcc::hash_string(key.first.c_str()) ^ key.second;
+        }
+    };
+
+    typedef std::unordered_map<SessionCastKey, SessionCastList, SessionCastKeyHash> SessionCastListMap;
+
+    SessionCastListMap sessionCastLists;       /**< Fan-out lists derived from sessionCastSet */
+
+    /**
+     * Rebuild the fan-out list for (src, id) from sessionCastSet.
+     * Must be called with sessionCastSetLock held.
+     *
+     * @param src   Unique name of the sender.
+     * @param id    Session id.
+     */
+    void UpdateSessionCastList(const qcc::String& src, SessionId id);
 };
 
 }
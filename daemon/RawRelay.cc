@@ -0,0 +1,286 @@
+/**
+ * @file
+ * RawRelay copies the bytes of a raw session between two sockets on a daemon that bridges
+ * the session.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_GROUP_POSIX)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+#if defined(QCC_OS_ANDROID) || defined(QCC_OS_LINUX)
+#include <fcntl.h>
+#define RAW_RELAY_SPLICE
+#endif
+
+#include <assert.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Event.h>
+#include <qcc/Socket.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+
+#include "RawRelay.h"
+
+#define QCC_MODULE "ALLJOYN_OBJ"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+struct RawRelay::Direction {
+    Direction(SocketFd in, SocketFd out) :
+        in(in), out(out), buf(NULL), pending(0), offset(0), eof(false), done(false), bytes(0)
+    {
+        pipeFds[0] = -1;
+        pipeFds[1] = -1;
+#ifdef RAW_RELAY_SPLICE
+        if (::pipe(pipeFds) < 0) {
+            QCC_LogError(ER_OS_ERROR, ("pipe failed: %d - %s", errno, strerror(errno)));
+            pipeFds[0] = -1;
+            pipeFds[1] = -1;
+        }
+#endif
+    }
+
+    ~Direction()
+    {
+        ClosePipe();
+        delete [] buf;
+    }
+
+    void ClosePipe()
+    {
+#ifdef RAW_RELAY_SPLICE
+        if (pipeFds[0] != -1) {
+            ::close(pipeFds[0]);
+            ::close(pipeFds[1]);
+        }
+#endif
+        pipeFds[0] = -1;
+        pipeFds[1] = -1;
+    }
+
+    /*
+     * Stop splicing, bytes are copied through buf from now on. Only called when the pipe is empty.
+     */
+    void UseCopy()
+    {
+        ClosePipe();
+        if (!buf) {
+            buf = new uint8_t[ChunkSize];
+        }
+    }
+
+    bool IsSplicing() const { return pipeFds[0] != -1; }
+
+    SocketFd in;               /**< Socket bytes are read from */
+    SocketFd out;              /**< Socket bytes are written to */
+    int pipeFds[2];            /**< Pipe the bytes are spliced through or -1 if copying */
+    uint8_t* buf;              /**< Buffer the bytes are copied through or NULL if splicing */
+    size_t pending;            /**< Bytes read from in that have not been written to out */
+    size_t offset;             /**< Offset of the pending bytes in buf */
+    bool eof;                  /**< in has been closed */
+    bool done;                 /**< All bytes have been written and out has been shut down */
+    volatile uint64_t bytes;   /**< Bytes written to out */
+};
+
+RawRelay::RawRelay(SessionId sessionId, SocketFd fd0, SocketFd fd1) :
+    Thread(U32ToString(sessionId) + "-relay"),
+    sessionId(sessionId)
+{
+    fd[0] = fd0;
+    fd[1] = fd1;
+    dir[0] = new Direction(fd0, fd1);
+    dir[1] = new Direction(fd1, fd0);
+}
+
+RawRelay::~RawRelay()
+{
+    Stop();
+    Join();
+    delete dir[0];
+    delete dir[1];
+    qcc::Close(fd[0]);
+    qcc::Close(fd[1]);
+}
+
+uint64_t RawRelay::GetBytesRelayed(size_t from) const
+{
+    return (from < 2) ? dir[from]->bytes : 0;
+}
+
+bool RawRelay::IsZeroCopy() const
+{
+    return (dir[0]->buf == NULL) && (dir[1]->buf == NULL);
+}
+
+/*
+ * Read the next chunk from d.in. Returns ER_WOULDBLOCK if there is nothing to read.
+ */
+QStatus RawRelay::Fill(Direction& d)
+{
+    assert(d.pending == 0);
+#ifdef RAW_RELAY_SPLICE
+    if (d.IsSplicing()) {
+        ssize_t ret = ::splice(d.in, NULL, d.pipeFds[1], NULL, ChunkSize, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (ret > 0) {
+            d.pending = ret;
+            return ER_OK;
+        } else if (ret == 0) {
+            d.eof = true;
+            return ER_OK;
+        } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return ER_WOULDBLOCK;
+        } else if (errno != EINVAL) {
+            QCC_LogError(ER_OS_ERROR, ("splice failed: %d - %s", errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        /* The socket cannot be spliced, fall back to copying */
+        QCC_DbgPrintf(("Raw session %u cannot splice, copying instead", sessionId));
+    }
+#endif
+    d.UseCopy();
+    size_t recvd = 0;
+    QStatus status = qcc::Recv(d.in, d.buf, ChunkSize, recvd);
+    if (status == ER_OK) {
+        d.eof = (recvd == 0);
+        d.pending = recvd;
+        d.offset = 0;
+    } else if (status == ER_SOCK_OTHER_END_CLOSED) {
+        d.eof = true;
+        status = ER_OK;
+    }
+    return status;
+}
+
+/*
+ * Write the pending bytes to d.out. Returns ER_WOULDBLOCK if d.out cannot take all of them.
+ */
+QStatus RawRelay::Drain(Direction& d)
+{
+    while (d.pending) {
+#ifdef RAW_RELAY_SPLICE
+        if (d.IsSplicing()) {
+            ssize_t ret = ::splice(d.pipeFds[0], NULL, d.out, NULL, d.pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (ret > 0) {
+                d.pending -= ret;
+                d.bytes += ret;
+                continue;
+            } else if ((ret < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                return ER_WOULDBLOCK;
+            }
+            QCC_LogError(ER_OS_ERROR, ("splice failed: %d - %s", errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+#endif
+        size_t sent = 0;
+        QStatus status = qcc::Send(d.out, d.buf + d.offset, d.pending, sent);
+        if (status != ER_OK) {
+            return status;
+        }
+        d.pending -= sent;
+        d.offset += sent;
+        d.bytes += sent;
+    }
+    return ER_OK;
+}
+
+ThreadReturn STDCALL RawRelay::Run(void* arg)
+{
+    QStatus status = ER_OK;
+
+    qcc::SetBlocking(fd[0], false);
+    qcc::SetBlocking(fd[1], false);
+
+    /* readable[i] is signalled when dir[i] can read, writable[i] when dir[i] can write */
+    Event readable0(fd[0], Event::IO_READ, false);
+    Event readable1(fd[1], Event::IO_READ, false);
+    Event writable0(fd[1], Event::IO_WRITE, false);
+    Event writable1(fd[0], Event::IO_WRITE, false);
+    Event* readable[2] = { &readable0, &readable1 };
+    Event* writable[2] = { &writable0, &writable1 };
+
+    while ((status == ER_OK) && !IsStopping()) {
+        vector<Event*> checkEvents, signaledEvents;
+        checkEvents.push_back(&stopEvent);
+
+        /* Move bytes in each direction until a socket would block */
+        for (size_t i = 0; (status == ER_OK) && (i < 2); ++i) {
+            Direction& d = *dir[i];
+            while (!d.done) {
+                if (d.pending) {
+                    status = Drain(d);
+                    if (status == ER_WOULDBLOCK) {
+                        checkEvents.push_back(writable[i]);
+                    }
+                } else if (d.eof) {
+                    /* Pass the end of stream on to the other member */
+#if defined(QCC_OS_GROUP_POSIX)
+                    ::shutdown(d.out, SHUT_WR);
+#endif
+                    d.done = true;
+                } else {
+                    status = Fill(d);
+                    if (status == ER_WOULDBLOCK) {
+                        checkEvents.push_back(readable[i]);
+                    }
+                }
+                if (status != ER_OK) {
+                    break;
+                }
+            }
+            if (status == ER_WOULDBLOCK) {
+                status = ER_OK;
+            }
+        }
+        if ((status != ER_OK) || (dir[0]->done && dir[1]->done)) {
+            break;
+        }
+
+        status = Event::Wait(checkEvents, signaledEvents);
+        for (vector<Event*>::iterator it = signaledEvents.begin(); it != signaledEvents.end(); ++it) {
+            if (*it == &stopEvent) {
+                stopEvent.ResetEvent();
+            }
+        }
+    }
+
+    if ((status != ER_OK) && (status != ER_STOPPING_THREAD)) {
+        QCC_LogError(status, ("Raw session %u relay failed", sessionId));
+    }
+    QCC_DbgPrintf(("Raw session %u relayed %llu and %llu bytes (%s)", sessionId,
+                   (unsigned long long)dir[0]->bytes, (unsigned long long)dir[1]->bytes,
+                   IsZeroCopy() ? "spliced" : "copied"));
+
+    /* Unblock the members if the relay stopped before they closed the session */
+    qcc::Shutdown(fd[0]);
+    qcc::Shutdown(fd[1]);
+    return (ThreadReturn) 0;
+}
+
+}
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * RawRelay copies the bytes of a raw session between two sockets on a daemon that bridges
+ * the session.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_RAWRELAY_H
+#define _ALLJOYN_RAWRELAY_H
+
+#include <qcc/platform.h>
+
+#include <qcc/Socket.h>
+#include <qcc/Thread.h>
+
+#include <alljoyn/Session.h>
+
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * %RawRelay moves the bytes of a raw session between the two bus-to-bus connections that were
+ * shut down to carry it. Where the platform supports it the bytes are spliced from one socket to
+ * the other through a pipe so they never enter user space. Otherwise, or if a socket cannot be
+ * spliced, the bytes are copied through a buffer.
+ */
+class RawRelay : public qcc::Thread {
+  public:
+
+    /**
+     * Maximum number of bytes moved by each read
+     */
+    static const size_t ChunkSize = 64 * 1024;
+
+    /**
+     * Create a relay. The relay takes ownership of both sockets and closes them when it exits.
+     *
+     * @param sessionId  The raw session being relayed.
+     * @param fd0        Socket connected to one member of the session.
+     * @param fd1        Socket connected to the other member of the session.
+     */
+    RawRelay(SessionId sessionId, qcc::SocketFd fd0, qcc::SocketFd fd1);
+
+    /**
+     * Destructor
+     */
+    ~RawRelay();
+
+    /**
+     * Get the session being relayed.
+     *
+     * @return  The session id.
+     */
+    SessionId GetSessionId() const { return sessionId; }
+
+    /**
+     * Get the number of bytes relayed in one direction.
+     *
+     * @param from  0 for bytes read from fd0 and written to fd1, 1 for the other direction.
+     *
+     * @return  The number of bytes written so far.
+     */
+    uint64_t GetBytesRelayed(size_t from) const;
+
+    /**
+     * Indicates if any bytes were copied through user space because a socket could not be spliced.
+     *
+     * @return  true if all bytes were spliced.
+     */
+    bool IsZeroCopy() const;
+
+  protected:
+
+    /**
+     * Relay bytes until both directions have been closed, an error occurs or the thread is stopped.
+     */
+    qcc::ThreadReturn STDCALL Run(void* arg);
+
+  private:
+
+    struct Direction;
+
+    /** Private copy constructor, RawRelay cannot be copied */
+    RawRelay(const RawRelay& other);
+
+    /** Private assignment operator, RawRelay cannot be assigned */
+    RawRelay& operator=(const RawRelay& other);
+
+    QStatus Fill(Direction& d);
+    QStatus Drain(Direction& d);
+
+    SessionId sessionId;  /**< The raw session being relayed */
+    qcc::SocketFd fd[2];  /**< The sockets connected to the two members */
+    Direction* dir[2];    /**< dir[0] reads fd[0] and writes fd[1], dir[1] the reverse */
+};
+
+}
+
+#endif
@@ -21,11 +21,15 @@
 
 #include <qcc/platform.h>
 
+#include <vector>
+
 #include <alljoyn/AllJoynStd.h>
+#include <alljoyn/ProxyBusObject.h>
 #include <alljoyn/Session.h>
 
 #include "SessionlessObj.h"
 #include "BusController.h"
+#include "DaemonConfig.h"
 
 #define QCC_MODULE "SESSIONLESS"
 
@@ -74,12 +78,16 @@ SessionlessObj::SessionlessObj(Bus& bus, BusController* busController) :
     sessionlessIface(NULL),
     requestSignalsSignal(NULL),
     requestRangeSignal(NULL),
+    requestRangeBatchMethod(NULL),
     timer("sessionless"),
     messageMap(),
     ruleCountMap(),
     changeIdMap(),
     lock(),
     nextChangeId(0),
+    maxMessages(ALLJOYN_MAX_SESSIONLESS_MESSAGES_DEFAULT),
+    workerPending(false),
+    expireAlarmTime(0),
     lastAdvChangeId(-1),
     isDiscoveryStarted(false),
     sessionOpts(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY),
@@ -114,6 +122,11 @@ QStatus SessionlessObj::Init()
 
     QStatus status;
 
+    maxMessages = DaemonConfig::Access()->Get("limit@max_sessionless_messages", ALLJOYN_MAX_SESSIONLESS_MESSAGES_DEFAULT);
+    if (maxMessages == 0) {
+        maxMessages = 1;
+    }
+
     /* Create the org.alljoyn.Sessionless interface */
     InterfaceDescription* intf = NULL;
     status = bus.CreateInterface(InterfaceName, intf);
@@ -123,6 +136,7 @@ QStatus SessionlessObj::Init()
     }
     intf->AddSignal("RequestSignals", "u", NULL, 0);
     intf->AddSignal("RequestRange", "uu", NULL, 0);
+    intf->AddMethod("RequestRangeBatch", "uu", "uay", "fromId,toId,nextId,batch", 0);
     intf->Activate();
 
     /* Make this object implement org.alljoyn.Sessionless */
@@ -138,6 +152,16 @@ QStatus SessionlessObj::Init()
     assert(requestSignalsSignal);
     requestRangeSignal = sessionlessIntf->GetMember("RequestRange");
     assert(requestRangeSignal);
+    requestRangeBatchMethod = sessionlessIntf->GetMember("RequestRangeBatch");
+    assert(requestRangeBatchMethod);
+    sessionlessIface = sessionlessIntf;
+
+    /* Implement RequestRangeBatch */
+    AddInterface(*sessionlessIntf);
+    status = AddMethodHandler(requestRangeBatchMethod, static_cast<MessageReceiver::MethodHandler>(&SessionlessObj::RequestRangeBatchMethodHandler));
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to register RequestRangeBatch method handler"));
+    }
 
     /* Register a signal handler for requestSignals */
     status = bus.RegisterSignalHandler(this,
@@ -320,19 +344,52 @@ QStatus SessionlessObj::PushMessage(Message& msg)
     /* Put the message in the map and kick the worker */
     MessageMapKey key(msg->GetSender(), msg->GetInterface(), msg->GetMemberName(), msg->GetObjectPath());
     lock.Lock();
-    pair<uint32_t, Message> val(nextChangeId++, msg);
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.find(key);
+    uint32_t changeId = nextChangeId++;
+    pair<uint32_t, Message> val(changeId, msg);
+    MessageMap::iterator it = messageMap.find(key);
     if (it == messageMap.end()) {
-        messageMap.insert(pair<MessageMapKey, pair<uint32_t, Message> >(key, val));
+        it = messageMap.insert(pair<MessageMapKey, pair<uint32_t, Message> >(key, val)).first;
     } else {
+        changeIdIndex.erase(it->second.first);
         it->second = val;
     }
+    changeIdIndex[changeId] = it;
+
+    /* Discard the oldest signals if over the limit. Change ids at or above nextChangeId were issued before the last wrap. */
+    while (messageMap.size() > maxMessages) {
+        map<uint32_t, MessageMap::iterator>::iterator oit = changeIdIndex.lower_bound(nextChangeId);
+        if (oit == changeIdIndex.end()) {
+            oit = changeIdIndex.begin();
+        }
+        QCC_DbgPrintf(("Discarding sessionless signal with change id %u", oit->first));
+        EraseMessage(oit->second);
+    }
     lock.Unlock();
-    uint32_t zero = 0;
-    SessionlessObj* slObj = this;
-    QStatus status = timer.AddAlarm(Alarm(zero, slObj));
 
-    return status;
+    ScheduleWorker();
+    return ER_OK;
+}
+
+void SessionlessObj::EraseMessage(MessageMap::iterator it)
+{
+    changeIdIndex.erase(it->second.first);
+    messageMap.erase(it);
+}
+
+void SessionlessObj::ScheduleWorker()
+{
+    QStatus status = ER_OK;
+    lock.Lock();
+    if (!workerPending) {
+        uint32_t zero = 0;
+        SessionlessObj* slObj = this;
+        status = timer.AddAlarm(Alarm(zero, slObj));
+        workerPending = (status == ER_OK);
+    }
+    lock.Unlock();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Timer::AddAlarm failed"));
+    }
 }
 
 bool SessionlessObj::RouteSessionlessMessage(uint32_t sessionId, Message& msg)
@@ -346,15 +403,30 @@ bool SessionlessObj::RouteSessionlessMessage(uint32_t sessionId, Message& msg)
      */
     bool ret = false;
     lock.Lock();
-    map<uint32_t, CatchupState>::const_iterator it = catchupMap.find(sessionId);
+    map<uint32_t, CatchupState>::iterator it = catchupMap.find(sessionId);
     if (it != catchupMap.end()) {
+        /*
+         * A catchup delivers a run of signals to the same endpoint so the endpoint is looked up in the
+         * name table once and reused for the rest of the run.
+         */
         String epName = it->second.sender;
+        BusEndpoint ep = it->second.ep;
         lock.Unlock();
-        router.LockNameTable();
-        BusEndpoint ep = router.FindEndpoint(epName);
+        if (!ep->IsValid()) {
+            router.LockNameTable();
+            ep = router.FindEndpoint(epName);
+            router.UnlockNameTable();
+            if (ep->IsValid()) {
+                lock.Lock();
+                it = catchupMap.find(sessionId);
+                if (it != catchupMap.end()) {
+                    it->second.ep = ep;
+                }
+                lock.Unlock();
+            }
+        }
         if (ep->IsValid()) {
             QStatus status;
-            router.UnlockNameTable();
             if (ep->GetEndpointType() == ENDPOINT_TYPE_VIRTUAL) {
                 status = VirtualEndpoint::cast(ep)->PushMessage(msg, sessionId);
             } else {
@@ -363,8 +435,6 @@ bool SessionlessObj::RouteSessionlessMessage(uint32_t sessionId, Message& msg)
             if (status != ER_OK) {
                 QCC_LogError(status, ("PushMessage to %s failed", epName.c_str()));
             }
-        } else {
-            router.UnlockNameTable();
         }
         ret = true;
     } else {
@@ -382,13 +452,13 @@ QStatus SessionlessObj::CancelMessage(const qcc::String& sender, uint32_t serial
 
     lock.Lock();
     MessageMapKey key(sender.c_str(), "", "", "");
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.lower_bound(key);
+    MessageMap::iterator it = messageMap.lower_bound(key);
     while ((it != messageMap.end()) && (sender == it->second.second->GetSender())) {
         if (it->second.second->GetCallSerial() == serialNum) {
             if (!it->second.second->IsExpired()) {
                 status = ER_OK;
             }
-            messageMap.erase(it);
+            EraseMessage(it);
             messageErased = true;
             break;
         }
@@ -398,9 +468,7 @@ QStatus SessionlessObj::CancelMessage(const qcc::String& sender, uint32_t serial
 
     /* Alert the advertiser worker */
     if (messageErased) {
-        uint32_t zero = 0;
-        SessionlessObj* slObj = this;
-        status = timer.AddAlarm(Alarm(zero, slObj));
+        ScheduleWorker();
     }
 
     return status;
@@ -488,18 +556,15 @@ void SessionlessObj::NameOwnerChanged(const String& name,
 
         /* Remove stored sessionless messages sent by toldOwner */
         MessageMapKey key(oldOwner->c_str(), "", "", "");
-        map<MessageMapKey, pair<uint32_t, Message> >::iterator mit = messageMap.lower_bound(key);
+        MessageMap::iterator mit = messageMap.lower_bound(key);
         while ((mit != messageMap.end()) && (::strcmp(oldOwner->c_str(), mit->second.second->GetSender()) == 0)) {
-            messageMap.erase(mit++);
+            EraseMessage(mit++);
         }
         /* Alert the advertiser worker if messageMap is empty */
         if (messageMap.empty()) {
-            uint32_t zero = 0;
-            SessionlessObj* slObj = this;
-            QStatus status = timer.AddAlarm(Alarm(zero, slObj));
-            if (status != ER_OK) {
-                QCC_LogError(status, ("Timer::AddAlarm failed"));
-            }
+            lock.Unlock();
+            ScheduleWorker();
+            lock.Lock();
         }
 
         /* Stop discovery if nobody is looking for sessionless signals */
@@ -663,48 +728,89 @@ void SessionlessObj::RequestRangeSignalHandler(const InterfaceDescription::Membe
     }
 }
 
-void SessionlessObj::HandleRangeRequest(const char* sender, SessionId sessionId, uint32_t fromChangeId, uint32_t toChangeId)
+void SessionlessObj::RequestRangeBatchMethodHandler(const InterfaceDescription::Member* member, Message& msg)
 {
-    QStatus status = ER_OK;
-    bool messageErased = false;
-    QCC_DbgTrace(("SessionlessObj::HandleControlSignal(%d, %d)", fromChangeId, toChangeId));
+    QCC_DbgTrace(("SessionlessObj::RequestRangeBatchMethodHandler(...)"));
+    uint32_t fromId, toId;
+    QStatus status = msg->GetArgs("uu", &fromId, &toId);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Message::GetArgs failed"));
+        MethodReply(msg, status);
+        return;
+    }
 
     /* Enable concurrency since PushMessage could block */
     bus.EnableConcurrentCallbacks();
 
-    /* Send all messages in messageMap in range [fromChangeId, toChangeId) */
+    vector<pair<uint32_t, Message> > range;
+    CollectRange(fromId, toId, range);
+
+    /*
+     * Pack the marshaled messages back to back into the reply until MAX_CATCHUP_BATCH_LEN is reached. The
+     * requestor calls again from nextId for the rest of the range. A message that cannot be shipped as
+     * plain bytes (it carries handles, is waiting to be encrypted, has a compressed header or is too large)
+     * is pushed on its own if it is at the head of the batch and otherwise ends the batch so that the
+     * requestor sees the range in change id order.
+     */
+    vector<uint8_t> packed;
+    uint32_t nextId = toId;
+    vector<Message> unpacked;
+    for (size_t i = 0; i < range.size(); ++i) {
+        Message& m = range[i].second;
+        const uint8_t* buf = reinterpret_cast<const uint8_t*>(m->msgBuf);
+        size_t len = m->bufEOD - buf;
+        bool packable = !m->handles && !m->encrypt && !(m->GetFlags() & ALLJOYN_FLAG_COMPRESSED) && (len <= MAX_CATCHUP_BATCH_LEN);
+        if (packable && ((packed.size() + len) <= MAX_CATCHUP_BATCH_LEN)) {
+            packed.insert(packed.end(), buf, buf + len);
+        } else if (!packable && packed.empty()) {
+            unpacked.push_back(m);
+        } else {
+            nextId = range[i].first;
+            break;
+        }
+    }
+    PushRange(msg->GetSender(), msg->GetSessionId(), unpacked);
+
+    MsgArg replyArgs[2];
+    replyArgs[0].Set("u", nextId);
+    replyArgs[1].Set("ay", packed.size(), packed.empty() ? NULL : &packed[0]);
+    QCC_DbgPrintf(("Sending %u bytes of sessionless signals to %s (next=%d)", (unsigned int)packed.size(), msg->GetSender(), nextId));
+    status = MethodReply(msg, replyArgs, ArraySize(replyArgs));
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to send RequestRangeBatch reply to %s", msg->GetSender()));
+    }
+}
+
+void SessionlessObj::CollectRange(uint32_t fromChangeId, uint32_t toChangeId, vector<pair<uint32_t, Message> >& range)
+{
+    bool messageErased = false;
+
+    /*
+     * Collect all messages in messageMap in range [fromChangeId, toChangeId) in change id order. If the
+     * range wraps around it is made up of [fromChangeId, max] followed by [0, toChangeId) in changeIdIndex.
+     */
     lock.Lock();
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.begin();
     uint32_t rangeLen = toChangeId - fromChangeId;
-    while (it != messageMap.end()) {
-        if (IN_WINDOW(uint32_t, fromChangeId, rangeLen, it->second.first)) {
-            MessageMapKey key = it->first;
-            if (it->second.second->IsExpired()) {
-                /* Remove expired message without sending */
-                messageMap.erase(++it);
-                messageErased = true;
-            } else {
-                /* Send message */
-                lock.Unlock();
-                router.LockNameTable();
-                BusEndpoint ep = router.FindEndpoint(sender);
-                if (ep->IsValid()) {
-                    router.UnlockNameTable();
-                    if (ep->GetEndpointType() == ENDPOINT_TYPE_VIRTUAL) {
-                        status = VirtualEndpoint::cast(ep)->PushMessage(it->second.second, sessionId);
-                    } else {
-                        status = ep->PushMessage(it->second.second);
-                    }
-                } else {
-                    router.UnlockNameTable();
-                }
-                lock.Lock();
-                it = messageMap.upper_bound(key);
-            }
-            if (status != ER_OK) {
-                QCC_LogError(status, ("Failed to push sessionless signal to %s", sender));
+    bool wraps = (toChangeId < fromChangeId);
+    map<uint32_t, MessageMap::iterator>::iterator it = changeIdIndex.lower_bound(fromChangeId);
+    while (rangeLen > 0) {
+        if (it == changeIdIndex.end()) {
+            if (!wraps) {
+                break;
             }
+            wraps = false;
+            it = changeIdIndex.begin();
+            continue;
+        }
+        if (!IN_WINDOW(uint32_t, fromChangeId, rangeLen, it->first)) {
+            break;
+        }
+        if (it->second->second.second->IsExpired()) {
+            /* Remove expired message without sending */
+            EraseMessage((it++)->second);
+            messageErased = true;
         } else {
+            range.push_back(pair<uint32_t, Message>(it->first, it->second->second.second));
             ++it;
         }
     }
@@ -712,21 +818,62 @@ void SessionlessObj::HandleRangeRequest(const char* sender, SessionId sessionId,
 
     /* Alert the advertiser worker */
     if (messageErased) {
-        uint32_t zero = 0;
-        SessionlessObj* slObj = this;
-        status = timer.AddAlarm(Alarm(zero, slObj));
+        ScheduleWorker();
+    }
+}
+
+void SessionlessObj::PushRange(const char* sender, SessionId sessionId, const vector<Message>& msgs)
+{
+    if (msgs.empty()) {
+        return;
+    }
+    router.LockNameTable();
+    BusEndpoint ep = router.FindEndpoint(sender);
+    router.UnlockNameTable();
+    bool isVirtual = ep->IsValid() && (ep->GetEndpointType() == ENDPOINT_TYPE_VIRTUAL);
+    for (size_t i = 0; ep->IsValid() && (i < msgs.size()); ++i) {
+        Message msg = msgs[i];
+        QStatus status;
+        if (isVirtual) {
+            status = VirtualEndpoint::cast(ep)->PushMessage(msg, sessionId);
+        } else {
+            status = ep->PushMessage(msg);
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to push sessionless signal to %s", sender));
+            if (status == ER_BUS_ENDPOINT_CLOSING) {
+                break;
+            }
+        }
     }
+    QCC_DbgPrintf(("Sent %u sessionless signals to %s", (unsigned int)msgs.size(), sender));
+}
+
+void SessionlessObj::HandleRangeRequest(const char* sender, SessionId sessionId, uint32_t fromChangeId, uint32_t toChangeId)
+{
+    QCC_DbgTrace(("SessionlessObj::HandleControlSignal(%d, %d)", fromChangeId, toChangeId));
+
+    /* Enable concurrency since PushMessage could block */
+    bus.EnableConcurrentCallbacks();
+
+    vector<pair<uint32_t, Message> > range;
+    CollectRange(fromChangeId, toChangeId, range);
+    vector<Message> msgs;
+    msgs.reserve(range.size());
+    for (size_t i = 0; i < range.size(); ++i) {
+        msgs.push_back(range[i].second);
+    }
+    PushRange(sender, sessionId, msgs);
 
     /* Close the session */
     if (sessionId != 0) {
-        status = bus.LeaveSession(sessionId);
+        QStatus status = bus.LeaveSession(sessionId);
         if (status != ER_OK) {
             QCC_LogError(status, ("LeaveSession failed"));
         }
     }
 }
 
-
 void SessionlessObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
 {
     QCC_DbgTrace(("SessionlessObj::AlarmTriggered(alarm, %s)", QCC_StatusText(reason)));
@@ -741,10 +888,17 @@ void SessionlessObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
 
         /* Purge the messageMap of expired messages */
         lock.Lock();
-        map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.begin();
+        if (alarm->GetContext()) {
+            if (GetTimestamp64() >= expireAlarmTime) {
+                expireAlarmTime = 0;
+            }
+        } else {
+            workerPending = false;
+        }
+        MessageMap::iterator it = messageMap.begin();
         while (it != messageMap.end()) {
             if (it->second.second->IsExpired(&expire)) {
-                messageMap.erase(it++);
+                EraseMessage(it++);
             } else {
                 maxChangeId = max(maxChangeId, it->second.first);
                 tilExpire = min(tilExpire, expire);
@@ -791,10 +945,17 @@ void SessionlessObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
             }
         }
 
-        /* Rearm alarm */
+        /* Rearm the expiration alarm unless one that fires sooner is already pending */
         if (tilExpire != ::numeric_limits<uint32_t>::max()) {
-            SessionlessObj* slObj = this;
-            timer.AddAlarm(Alarm(tilExpire, slObj));
+            uint64_t expireTime = GetTimestamp64() + tilExpire;
+            lock.Lock();
+            if ((expireAlarmTime == 0) || (expireTime < expireAlarmTime)) {
+                SessionlessObj* slObj = this;
+                if (timer.AddAlarm(Alarm(tilExpire, slObj, slObj)) == ER_OK) {
+                    expireAlarmTime = expireTime;
+                }
+            }
+            lock.Unlock();
         }
     }
 }
@@ -891,14 +1052,10 @@ void SessionlessObj::JoinSessionCB(QStatus status, SessionId id, const SessionOp
                 /* Put catchup on catchupMap */
                 catchupMap[id] = catchup;
 
-                MsgArg args[2];
-                args[0].Set("u", catchup.changeId);
-                args[1].Set("u", requestChangeId);
-                QCC_DbgPrintf(("Sending RequestRange (from=%d, to=%d) to %s\n", catchup.changeId, requestChangeId, advName.c_str()));
-                status = Signal(advName.c_str(), id, *requestRangeSignal, args, ArraySize(args));
+                status = RequestRangeBatch(new RangeBatchContext(advName, id, catchup.changeId, requestChangeId));
                 if (status != ER_OK) {
                     catchupMap.erase(id);
-                    QCC_LogError(status, ("RequestRange to %s failed", advName.c_str()));
+                    QCC_LogError(status, ("RequestRangeBatch to %s failed", advName.c_str()));
                     /* Reset inProgress */
                     cit = changeIdMap.find(guid);
                     if (cit != changeIdMap.end()) {
@@ -923,4 +1080,122 @@ void SessionlessObj::JoinSessionCB(QStatus status, SessionId id, const SessionOp
     delete ctx1;
 }
 
+QStatus SessionlessObj::RequestRangeBatch(RangeBatchContext* ctx)
+{
+    ProxyBusObject remoteObj(bus, ctx->advName.c_str(), ObjectPath, ctx->sessionId);
+    remoteObj.AddInterface(*sessionlessIface);
+
+    MsgArg args[2];
+    args[0].Set("u", ctx->fromId);
+    args[1].Set("u", ctx->toId);
+    QCC_DbgPrintf(("Sending RequestRangeBatch (from=%d, to=%d) to %s", ctx->fromId, ctx->toId, ctx->advName.c_str()));
+    QStatus status = remoteObj.MethodCallAsync(*requestRangeBatchMethod,
+                                               this,
+                                               static_cast<MessageReceiver::ReplyHandler>(&SessionlessObj::RequestRangeBatchReplyHandler),
+                                               args,
+                                               ArraySize(args),
+                                               reinterpret_cast<void*>(ctx));
+    if (status != ER_OK) {
+        delete ctx;
+    }
+    return status;
+}
+
+void SessionlessObj::RequestRangeBatchReplyHandler(Message& reply, void* context)
+{
+    RangeBatchContext* ctx = reinterpret_cast<RangeBatchContext*>(context);
+    String advName = ctx->advName;
+    SessionId sessionId = ctx->sessionId;
+
+    QCC_DbgTrace(("SessionlessObj::RequestRangeBatchReplyHandler(%s, 0x%x)", advName.c_str(), sessionId));
+
+    /* Enable concurrency since PushMessage and LeaveSession could block */
+    bus.EnableConcurrentCallbacks();
+
+    /* Nothing more to do if the session was lost while the call was outstanding */
+    lock.Lock();
+    bool isCatchup = (catchupMap.find(sessionId) != catchupMap.end());
+    lock.Unlock();
+    if (!isCatchup) {
+        delete ctx;
+        return;
+    }
+
+    QStatus status;
+    if (reply->GetType() == MESSAGE_METHOD_RET) {
+        uint32_t nextId;
+        size_t packedLen;
+        uint8_t* packed;
+        status = reply->GetArgs("uay", &nextId, &packedLen, &packed);
+        if (status == ER_OK) {
+            DeliverCatchupBatch(sessionId, reply, packed, packedLen);
+            if (nextId != ctx->toId) {
+                /* Ask for the rest of the range. RequestRangeBatch takes ownership of ctx */
+                ctx->fromId = nextId;
+                status = RequestRangeBatch(ctx);
+                ctx = NULL;
+            } else {
+                /* Catchup is complete */
+                QStatus tStatus = bus.LeaveSession(sessionId);
+                if (tStatus != ER_OK) {
+                    QCC_LogError(tStatus, ("LeaveSession failed"));
+                }
+                DoSessionLost(sessionId);
+            }
+        }
+    } else {
+        /*
+         * Remote daemons that predate RequestRangeBatch reply with an error. Fall back to the RequestRange
+         * signal in which case the remote daemon pushes the signals one by one and closes the session.
+         */
+        MsgArg args[2];
+        args[0].Set("u", ctx->fromId);
+        args[1].Set("u", ctx->toId);
+        QCC_DbgPrintf(("Sending RequestRange (from=%d, to=%d) to %s", ctx->fromId, ctx->toId, advName.c_str()));
+        status = Signal(advName.c_str(), sessionId, *requestRangeSignal, args, ArraySize(args));
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Sessionless catchup from %s failed", advName.c_str()));
+        bus.LeaveSession(sessionId);
+        DoSessionLost(sessionId);
+    }
+    delete ctx;
+}
+
+void SessionlessObj::DeliverCatchupBatch(SessionId sessionId, Message& reply, const uint8_t* packed, size_t packedLen)
+{
+    /*
+     * The packed messages are unmarshaled as if they had been received on the bus-to-bus endpoint the
+     * reply arrived on.
+     */
+    router.LockNameTable();
+    BusEndpoint ep = router.FindEndpoint(reply->GetRcvEndpointName());
+    router.UnlockNameTable();
+    if (!ep->IsValid() || (ep->GetEndpointType() != ENDPOINT_TYPE_BUS2BUS)) {
+        QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find bus-to-bus endpoint %s", reply->GetRcvEndpointName()));
+        return;
+    }
+    RemoteEndpoint b2bEp = RemoteEndpoint::cast(ep);
+
+    size_t count = 0;
+    while (packedLen > 0) {
+        Message msg(bus);
+        size_t used;
+        QStatus status = msg->ReadFromBuffer(b2bEp, packed, packedLen, used);
+        if (used == 0) {
+            QCC_LogError(status, ("Malformed sessionless catchup batch from %s", b2bEp->GetUniqueName().c_str()));
+            break;
+        }
+        packed += used;
+        packedLen -= used;
+        if (status == ER_OK) {
+            RouteSessionlessMessage(sessionId, msg);
+            ++count;
+        } else if (status != ER_BUS_TIME_TO_LIVE_EXPIRED) {
+            QCC_LogError(status, ("Dropping sessionless signal from catchup batch"));
+        }
+    }
+    QCC_DbgPrintf(("Delivered %u sessionless signals from catchup batch", (unsigned int)count));
+}
+
 }
@@ -26,6 +26,7 @@
 #include <map>
 #include <set>
 #include <queue>
+#include <vector>
 
 #include <qcc/String.h>
 #include <qcc/Timer.h>
@@ -202,6 +203,17 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
                                    const char* sourcePath,
                                    Message& msg);
 
+    /**
+     * Process incoming RequestRangeBatch method calls from remote daemons.
+     *
+     * Replies with as many of the cached sessionless signals in [fromId, toId) as fit in one
+     * packed batch and the change id the requestor should continue from.
+     *
+     * @param member        Interface member for method
+     * @param msg           The method call message.
+     */
+    void RequestRangeBatchMethodHandler(const InterfaceDescription::Member* member, Message& msg);
+
     /**
      * Trigger (re)reception of sessionless signals from a single or from all
      * remote daemons.
@@ -234,6 +246,63 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
      */
     void HandleRangeRequest(const char* sender, SessionId sessionId, uint32_t fromId, uint32_t toId);
 
+    /**
+     * Collect the unexpired cached sessionless signals in [fromId, toId) in change id order.
+     * Expired signals found along the way are removed.
+     *
+     * @param fromId    Beginning of changeId range (inclusive)
+     * @param toId      End of changeId range (exclusive)
+     * @param range     Returns the (changeId, signal) pairs in the range
+     */
+    void CollectRange(uint32_t fromId, uint32_t toId, std::vector<std::pair<uint32_t, Message> >& range);
+
+    /**
+     * Push sessionless signals one by one to a requestor.
+     *
+     * @param sender    Unique name of requestor
+     * @param sessionId Session id
+     * @param msgs      Signals to push
+     */
+    void PushRange(const char* sender, SessionId sessionId, const std::vector<Message>& msgs);
+
+    /** State of an outstanding RequestRangeBatch call */
+    struct RangeBatchContext {
+        RangeBatchContext(const qcc::String& advName, SessionId sessionId, uint32_t fromId, uint32_t toId) :
+            advName(advName), sessionId(sessionId), fromId(fromId), toId(toId) { }
+        qcc::String advName;
+        SessionId sessionId;
+        uint32_t fromId;
+        uint32_t toId;
+    };
+
+    /**
+     * Call RequestRangeBatch on the remote daemon for the range in ctx.
+     *
+     * @param ctx   Range to request. Ownership is passed to this method.
+     * @return ER_OK if the call was sent.
+     */
+    QStatus RequestRangeBatch(RangeBatchContext* ctx);
+
+    /**
+     * Reply handler for RequestRangeBatch. Delivers the batch and requests the rest of the range or,
+     * if the remote daemon does not implement RequestRangeBatch, falls back to RequestRange.
+     *
+     * @param reply     The reply message.
+     * @param context   The RangeBatchContext of the call.
+     */
+    void RequestRangeBatchReplyHandler(Message& reply, void* context);
+
+    /**
+     * Unmarshal the signals packed in a RequestRangeBatch reply and route them to the catchup
+     * requestor.
+     *
+     * @param sessionId  Session id of the catchup
+     * @param reply      The reply message carrying the batch
+     * @param packed     Marshaled signals placed back to back
+     * @param packedLen  Length of packed in bytes
+     */
+    void DeliverCatchupBatch(SessionId sessionId, Message& reply, const uint8_t* packed, size_t packedLen);
+
     /**
      * Internal helper for FoundAdvertisedName.
      *
@@ -250,6 +319,24 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
      */
     void DoSessionLost(uint32_t sessionId);
 
+    /**
+     * Wake the worker so that it updates the advertised change id. Multiple requests made
+     * before the worker runs are coalesced into a single wake up.
+     */
+    void ScheduleWorker();
+
+    /**
+     * @brief The default value for the maximum number of sessionless signals retained for
+     * delivery to remote daemons.
+     *
+     * When the limit is reached the oldest signal is discarded. To override this value,
+     * change the limit, "max_sessionless_messages".
+     */
+    static const uint32_t ALLJOYN_MAX_SESSIONLESS_MESSAGES_DEFAULT = 1024;
+
+    /** Maximum number of bytes of marshaled signals packed into one RequestRangeBatch reply */
+    static const size_t MAX_CATCHUP_BATCH_LEN = 64 * 1024;
+
     Bus& bus;                             /**< The bus */
     BusController* busController;         /**< BusController that created this BusObject */
     DaemonRouter& router;                 /**< The router */
@@ -258,6 +345,7 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
 
     const InterfaceDescription::Member* requestSignalsSignal;   /**< org.alljoyn.Sessionless.RequestSignal signal */
     const InterfaceDescription::Member* requestRangeSignal;     /**< org.alljoyn.Sessionless.RequestRange signal */
+    const InterfaceDescription::Member* requestRangeBatchMethod; /**< org.alljoyn.Sessionless.RequestRangeBatch method */
 
     qcc::Timer timer;                     /**< Timer object for reaping expired names */
 
@@ -277,7 +365,18 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
     };
 
     /** Storage for sessionless messages waiting to be delivered */
-    std::map<MessageMapKey, std::pair<uint32_t, Message> > messageMap;
+    typedef std::map<MessageMapKey, std::pair<uint32_t, Message> > MessageMap;
+    MessageMap messageMap;
+
+    /** Index of messageMap by change id. Used to serve range requests without scanning messageMap */
+    std::map<uint32_t, MessageMap::iterator> changeIdIndex;
+
+    /**
+     * Remove an entry from messageMap and changeIdIndex.
+     *
+     * @param it   The messageMap entry to remove.
+     */
+    void EraseMessage(MessageMap::iterator it);
 
     /** Count the number of rules (per endpoint) that specify sesionless=TRUE */
     std::map<qcc::String, uint32_t> ruleCountMap;
@@ -290,6 +389,7 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
         qcc::String guid;
         uint32_t changeId;
         uint32_t sessionId;
+        BusEndpoint ep;         /**< Endpoint of sender, resolved when the first catchup signal arrives */
     };
     /** Map sessionIds to catupStates */
     std::map<uint32_t, CatchupState> catchupMap;
@@ -311,6 +411,9 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
 
     qcc::Mutex lock;            /**< Mutex that protects messageMap this obj's data structures */
     uint32_t nextChangeId;      /**< Change id assoc with next pushed signal */
+    uint32_t maxMessages;       /**< Maximum number of entries in messageMap */
+    bool workerPending;         /**< True if a worker wake up is already scheduled */
+    uint64_t expireAlarmTime;   /**< Absolute time of the earliest pending expiration alarm or 0 if none */
     uint32_t lastAdvChangeId;   /**< Last advertised change id */
     qcc::String lastAdvName;    /**< Last advertised name */
     qcc::String findPrefix;     /**< FindAdvertiseName prefix */
@@ -35,6 +35,7 @@
 #include "RemoteEndpoint.h"
 #include "Router.h"
 #include "DaemonTransport.h"
+#include "SharedMemoryStream.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -116,18 +117,38 @@ class _DaemonEndpoint : public _RemoteEndpoint {
      */
     bool SupportsUnixIDs() const { return true; }
 
+    /**
+     * Switch the endpoint over to the shared memory offered by the client.
+     *
+     * @param shmFd    The shared memory offered by the client.
+     * @param spaceFd  This end of the space available wake-up socket pair.
+     *
+     * @return  ER_OK if successful.
+     */
+    QStatus AttachSharedMemory(SocketFd shmFd, SocketFd spaceFd) { return stream.Attach(shmFd, spaceFd, false); }
+
+    /**
+     * Let the shared memory stream accept file descriptors once handle passing has been negotiated.
+     */
+    void EnableHandlePassing() { stream.EnableHandlePassing(GetFeatures().handlePassing); }
+
   private:
     uint32_t userId;
     uint32_t groupId;
     uint32_t processId;
-    SocketStream stream;
+    SharedMemoryStream stream;
 };
 
 static const int CRED_TIMEOUT = 5000;  /**< Times out credentials exchange to avoid denial of service attack */
 
-static QStatus GetSocketCreds(SocketFd sockFd, uid_t* uid, gid_t* gid, pid_t* pid)
+/*
+ * Receive the client's credentials. If the client is offering shared memory the shared memory and
+ * wake-up socket descriptors are returned in shmFds.
+ */
+static QStatus GetSocketCreds(SocketFd sockFd, uid_t* uid, gid_t* gid, pid_t* pid, SocketFd* shmFds, size_t& numShmFds)
 {
     QStatus status = ER_OK;
+    numShmFds = 0;
 #if defined(QCC_OS_DARWIN)
     *pid = 0;
     int ret = getpeereid(sockFd, uid, gid);
@@ -150,14 +171,14 @@ static QStatus GetSocketCreds(SocketFd sockFd, uid_t* uid, gid_t* gid, pid_t* pi
         struct cmsghdr* cmsg;
         struct iovec iov[] = { { &nulbuf, sizeof(nulbuf) } };
         struct msghdr msg;
-        char cbuf[CMSG_SPACE(sizeof(struct ucred))];
+        char cbuf[CMSG_SPACE(sizeof(struct ucred)) + CMSG_SPACE(2 * sizeof(int))];
         msg.msg_name = NULL;
         msg.msg_namelen = 0;
         msg.msg_iov = iov;
         msg.msg_iovlen = ArraySize(iov);
         msg.msg_flags = 0;
         msg.msg_control = cbuf;
-        msg.msg_controllen = CMSG_LEN(sizeof(struct ucred));
+        msg.msg_controllen = sizeof(cbuf);
 
         while (true) {
             ret = recvmsg(sockFd, &msg, 0);
@@ -190,9 +211,24 @@ static QStatus GetSocketCreds(SocketFd sockFd, uid_t* uid, gid_t* gid, pid_t* pi
                     *gid = cred->gid;
                     *pid = cred->pid;
                     QCC_DbgHLPrintf(("Received UID: %u  GID: %u  PID %u", cred->uid, cred->gid, cred->pid));
+                } else if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS)) {
+                    size_t num = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                    int* fds = reinterpret_cast<int*>(CMSG_DATA(cmsg));
+                    for (size_t i = 0; i < num; ++i) {
+                        if ((nulbuf == SharedMemoryStream::Offer) && (numShmFds < 2)) {
+                            shmFds[numShmFds++] = fds[i];
+                        } else {
+                            qcc::Close(fds[i]);
+                        }
+                    }
                 }
             }
         }
+        /* A shared memory offer is a shared memory descriptor and a wake-up socket */
+        if (numShmFds == 1) {
+            qcc::Close(shmFds[0]);
+            numShmFds = 0;
+        }
     }
 #endif
 
@@ -221,9 +257,11 @@ void* DaemonTransport::Run(void* arg)
         uid_t uid;
         gid_t gid;
         pid_t pid;
+        SocketFd shmFds[2];
+        size_t numShmFds = 0;
 
         if (status == ER_OK) {
-            status = GetSocketCreds(newSock, &uid, &gid, &pid);
+            status = GetSocketCreds(newSock, &uid, &gid, &pid, shmFds, numShmFds);
         }
 
         if (status == ER_OK) {
@@ -235,6 +273,16 @@ void* DaemonTransport::Run(void* arg)
             conn->SetGroupId(gid);
             conn->SetProcessId(pid);
 
+            if (numShmFds) {
+                /* Let the client know if it can switch to shared memory */
+                uint8_t reply = SharedMemoryStream::Accept;
+                size_t sent;
+                if (conn->AttachSharedMemory(shmFds[0], shmFds[1]) != ER_OK) {
+                    reply = SharedMemoryStream::Decline;
+                }
+                status = qcc::Send(newSock, &reply, 1, sent);
+            }
+
             /* Initialized the features for this endpoint */
             conn->GetFeatures().isBusToBus = false;
             conn->GetFeatures().allowRemote = false;
@@ -245,6 +293,7 @@ void* DaemonTransport::Run(void* arg)
             endpointListLock.Unlock(MUTEX_CONTEXT);
             status = conn->Establish("EXTERNAL", authName, redirection);
             if (status == ER_OK) {
+                conn->EnableHandlePassing();
                 conn->SetListener(this);
                 status = conn->Start();
             }
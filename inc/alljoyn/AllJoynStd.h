@@ -61,6 +61,16 @@ namespace Session {
 extern const char* InterfaceName;                      /**<Interface name */
 }
 }
+
+/** Interface definitions for org.alljoyn.Bus.Introspectable */
+namespace Introspectable {
+extern const char* InterfaceName;                      /**<Interface name */
+}
+
+/** Interface definitions for org.alljoyn.Bus.Properties */
+namespace Properties {
+extern const char* InterfaceName;                      /**<Interface name */
+}
 }
 
 /** Interface definitions for org.alljoyn.Daemon */
@@ -262,6 +272,20 @@ QStatus CreateInterfaces(BusAttachment& bus);          /**< Create the org.alljo
  *  Returns the socket descriptor request or an error response
  */
 
+/**
+ * @name org.alljoyn.Bus.GetSessionChannel
+ *  Interface: org.alljoyn.Bus
+ *  Method: Handle, String GetSessionChannel(uint32_t sessionId)
+ *
+ *  sessionId - Existing sessionId for a point-to-point message session between two applications
+ *              connected to the same daemon.
+ *
+ *  Get a socket descriptor connected directly to the other member of the session. Both members
+ *  must ask for the channel; the reply is sent once they have, or after a five second timeout.
+ *
+ *  Returns the socket descriptor and the unique name of the other member or an error response
+ */
+
 /**
  * @name org.alljoyn.Bus.SetLinkTimeout
  *  Interface: org.alljoyn.Bus
@@ -1009,6 +1009,21 @@ class BusAttachment : public MessageReceiver {
      */
     void ClearKeyStore();
 
+    /**
+     * Enable caching of the introspection data of remote objects. Once enabled, introspecting a
+     * remote object first asks the object for a digest of its introspection data and only
+     * transfers the introspection data if the digest is not in the cache. The cache is kept in a
+     * file so it is reused when the application restarts.
+     *
+     * @param fileName  An optional parameter to specify the filename of the cache file relative
+     *                  to the user's home directory. The default location is
+     *                  $HOME/.alljoyn_introspection/<application name>.
+     *
+     * @return  - ER_OK if the introspection cache was enabled
+     *          - An error status if the cache file could not be read
+     */
+    QStatus EnableIntrospectionCache(const char* fileName = NULL);
+
     /**
      * Clear the keys associated with a specific remote peer as identified by its peer GUID. The
      * peer GUID associated with a bus name can be obtained by calling GetPeerGUID().
@@ -1555,6 +1570,30 @@ class BusAttachment : public MessageReceiver {
      */
     QStatus GetSessionFd(SessionId sessionId, qcc::SocketFd& sockFd);
 
+    /**
+     * Ask the local daemon for a direct channel to the other member of a point-to-point message
+     * session with an application on the same device. Both members of the session must make this
+     * call; it blocks for up to five seconds waiting for the other member. Once it succeeds,
+     * messages on the session that are addressed to the other member's unique name and signals
+     * sent to the whole session are exchanged over the channel instead of being routed through
+     * the daemon. The channel is closed when the session is left or lost, and method calls still
+     * waiting for a reply over the channel then fail with #ER_BUS_ENDPOINT_CLOSING.
+     *
+     * Messages addressed to the other member by a well-known name still go through the daemon.
+     * They are not ordered with respect to messages sent over the channel, so an application
+     * that relies on ordering should address the other member by its unique name.
+     *
+     * @param sessionId   Id of an existing point-to-point message session.
+     *
+     * @return
+     *      - #ER_OK if successful.
+     *      - #ER_BUS_NOT_CONNECTED if a connection has not been made with a local bus.
+     *      - #ER_NOT_IMPLEMENTED if this bus attachment is using a bundled daemon.
+     *      - #ER_BUS_NOT_ALLOWED if the session or either member cannot use a direct channel.
+     *      - Other error status codes indicating a failure.
+     */
+    QStatus EnableDirectSession(SessionId sessionId);
+
     /**
      * Set the link timeout for a session.
      *
@@ -618,6 +618,70 @@ class BusObject : public MessageReceiver {
      */
     void InstallMethods(MethodTable& methodTable);
 
+    /**
+     * Handler for a peer asking for the digest of the object's introspection data. The digest is
+     * computed from the reply sent by Introspect() so it also covers classes that override it.
+     *
+     * @param member   Identifies the @c org.alljoyn.Bus.Introspectable.IntrospectDigest method.
+     * @param msg      The IntrospectDigest request.
+     */
+    void IntrospectDigest(const InterfaceDescription::Member* member, Message& msg);
+
+    /**
+     * Read a property of this object checking it exists, is readable and is accessed securely if
+     * the interface is secure.
+     *
+     * @param ifcName    Name of the interface.
+     * @param propName   Name of the property.
+     * @param encrypted  true if the request was encrypted.
+     * @param[out] val   Returns the property value.
+     *
+     * @return ER_OK or an error status explaining why the property could not be read.
+     */
+    QStatus ReadProp(const char* ifcName, const char* propName, bool encrypted, MsgArg& val);
+
+    /**
+     * Write a property of this object checking it exists, is writeable, has the right type and
+     * is accessed securely if the interface is secure.
+     *
+     * @param ifcName    Name of the interface.
+     * @param propName   Name of the property.
+     * @param val        The new property value.
+     * @param encrypted  true if the request was encrypted.
+     * @param id         Session to notify if the property emits a changed signal.
+     *
+     * @return ER_OK or an error status explaining why the property could not be written.
+     */
+    QStatus WriteProp(const char* ifcName, const char* propName, MsgArg& val, bool encrypted, SessionId id);
+
+    /**
+     * Look up an object registered with the same bus attachment and mark it in use. The caller
+     * must call InUseDecrement() on the returned object when it is done with it.
+     *
+     * @param objectPath  Path of the object.
+     *
+     * @return The object or NULL if there is no object registered at that path.
+     */
+    BusObject* AcquireLocalObject(const char* objectPath);
+
+    /**
+     * Handler for the org.alljoyn.Bus.Properties.GetMultiple method that reads properties from
+     * any number of objects of this bus attachment in one call.
+     *
+     * @param member   Identifies the @c org.alljoyn.Bus.Properties.GetMultiple method.
+     * @param msg      The GetMultiple request.
+     */
+    void GetMultipleProps(const InterfaceDescription::Member* member, Message& msg);
+
+    /**
+     * Handler for the org.alljoyn.Bus.Properties.SetMultiple method that writes properties on
+     * any number of objects of this bus attachment in one call.
+     *
+     * @param member   Identifies the @c org.alljoyn.Bus.Properties.SetMultiple method.
+     * @param msg      The SetMultiple request.
+     */
+    void SetMultipleProps(const InterfaceDescription::Member* member, Message& msg);
+
     /**
      * This utility method is called by the bus during object registration.
      * Do not call this object explicitly.
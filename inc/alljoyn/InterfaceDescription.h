@@ -597,7 +597,8 @@ class InterfaceDescription {
 
     /**
      * Activate this interface. An interface must be activated before it can be used. Activating an
-     * interface locks the interface so that is can no longer be modified.
+     * interface locks the interface so that is can no longer be modified. Member and property
+     * lookups on an activated interface use a hash index built at activation.
      *
      * See also these sample file(s): @n
      * basic/basic_client.cc @n
@@ -653,7 +654,7 @@ class InterfaceDescription {
      * csharp/Sessions/Sessions/App.xaml.cs @n
      * csharp/Sessions/Sessions/Common/MyBusObject.cs @n
      */
-    void Activate() { isActivated = true; }
+    void Activate();
 
     /**
      * Indicates if this interface is secure. Secure interfaces require end-to-end authentication.
@@ -189,6 +189,7 @@ class _Message {
     friend class AllJoynObj;
     friend class DeferredMsg;
     friend class AllJoynPeerObj;
+    friend class SessionlessObj;
 
   public:
     /**
@@ -790,6 +791,25 @@ class _Message {
      */
     QStatus ReadNonBlocking(RemoteEndpoint& endpoint, bool checkSender, bool pedantic = true);
 
+    /**
+     * @internal
+     * Reads and unmarshals a message from a buffer holding one or more marshaled messages that were
+     * received from a remote endpoint. Handles cannot be carried in the buffer. This may be called
+     * from any thread; the sender's peer state is looked up in the peer state table rather than
+     * in the endpoint's receive path cache.
+     *
+     * @param endpoint       The endpoint the buffer was received from.
+     * @param buf            The buffer to read the message from.
+     * @param len            Number of bytes available in buf.
+     * @param used           Returns the number of bytes of buf consumed by the message.
+     * @param pedantic       Perform detailed checks on the header fields.
+     * @return
+     *      - #ER_OK if successful
+     *      - #ER_BUS_BAD_LENGTH if buf does not hold a complete message
+     *      - An error status otherwise
+     */
+    QStatus ReadFromBuffer(RemoteEndpoint& endpoint, const uint8_t* buf, size_t len, size_t& used, bool pedantic = true);
+
     /**
      * @internal
      * Unmarshals a message from a remote endpoint. Only the message header is unmarshaled at this
@@ -799,11 +819,13 @@ class _Message {
      * @param checkSender    True if message's sender field should be validated against the endpoint's unique name.
      * @param pedantic       Perform detailed checks on the header fields.
      * @param timeout        If non-zero, a timeout in milliseconds to wait for a message to unmarshal.
+     * @param receivePath    True if called from the receive path of the endpoint so the endpoint's
+     *                       peer state cache can be used.
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
      */
-    QStatus Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool pedantic = true, uint32_t timeout = 0);
+    QStatus Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool pedantic = true, uint32_t timeout = 0, bool receivePath = true);
 
     /**
      * @internal
@@ -816,16 +838,52 @@ class _Message {
      */
     QStatus Deliver(RemoteEndpoint& endpoint);
 
+    /**
+     * @internal
+     * Write progress for a non-blocking delivery. The cursor is owned by the endpoint doing the
+     * write rather than by the message so that a single marshaled message can be queued on
+     * several endpoints at once without copying the message buffer.
+     */
+    struct WriteCursor {
+        AllJoynMessageState state;  ///< The current state of the message during write.
+        size_t countWrite;          ///< Number of bytes remaining to write for completion of the message.
+        WriteCursor() : state(MESSAGE_NEW), countWrite(0) { }
+    };
+
     /**
      * @internal
      * Deliver a marshaled message to a remote endpoint. Non-blocking
      *
      * @param endpoint   Endpoint to receive marshaled message.
+     * @param cursor     Write progress of this message on the endpoint.
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
      */
-    QStatus DeliverNonBlocking(RemoteEndpoint& endpoint);
+    QStatus DeliverNonBlocking(RemoteEndpoint& endpoint, WriteCursor& cursor);
+
+    /**
+     * @internal
+     * Check if delivering this message will modify the message buffer. Messages that are
+     * encrypted on delivery cannot be shared between endpoints.
+     *
+     * @return true if the message buffer is rewritten when the message is delivered.
+     */
+    bool IsModifiedOnDelivery() const { return encrypt; }
+
+    /**
+     * @internal
+     * Encrypt a message that has no destination before it is queued for delivery. These messages
+     * are encrypted with the local group key so the ciphertext is the same for every receiver;
+     * encrypting once up front lets all the endpoints the message is fanned out to share it.
+     * Messages that do not need encryption or have a destination are left unchanged.
+     *
+     * @return
+     *      - #ER_OK if the message was encrypted or was left unchanged
+     *      - #ER_BUS_AUTHENTICATION_PENDING if delivery will be retried when authentication completes
+     *      - An error status otherwise
+     */
+    QStatus EncryptGroupMessage();
     /**
      * @internal
      * Marshal the message again with the new sender name if one was provided.
@@ -953,10 +1011,6 @@ class _Message {
     size_t countRead;               ///< Number of bytes remaining to read for completion of the message.
     size_t maxFds;                  ///< Store the number of max FDs for the endpoint, so it doesnt need to be calculated each time.
 
-    AllJoynMessageState writeState; ///< The current state of the message during write.
-    uint8_t* writePtr;              ///< Pointer to the current write position in the buffer.
-    size_t countWrite;              ///< Number of bytes remaining to write for completion of the message.
-
     /**
      * The header fields for this message. Which header fields are present depends on the message
      * type defined in the message header.
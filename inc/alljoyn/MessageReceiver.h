@@ -79,6 +79,17 @@ class MessageReceiver {
      */
     typedef void (MessageReceiver::* ReplyHandler)(Message& message, void* context);
 
+    /**
+     * BatchReplyHandlers are %MessageReceiver methods which are called by AllJoyn library
+     * to forward all of the method_reply and error responses to a pipelined batch of method
+     * calls in one callback.
+     *
+     * @param replies     The received messages in the same order as the method calls.
+     * @param numReplies  The number of replies.
+     * @param context     User-defined context passed to MethodCallPipelined and returned upon reply.
+     */
+    typedef void (MessageReceiver::* BatchReplyHandler)(Message* replies, size_t numReplies, void* context);
+
     /**
      * SignalHandlers are %MessageReceiver methods which are called by AllJoyn library
      * to forward AllJoyn received signals to AllJoyn library users.
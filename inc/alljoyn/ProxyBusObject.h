@@ -355,6 +355,101 @@ class ProxyBusObject : public MessageReceiver {
                              void* context,
                              uint32_t timeout = DefaultCallTimeout);
 
+    /**
+     * Enable caching of the properties of an interface on the remote object. The cache is populated
+     * with the values returned by GetAllProperties() and is kept up to date by the PropertiesChanged
+     * signals the remote object emits. Once enabled, GetProperty() and GetAllProperties() for the
+     * interface are answered from the cache without a round trip to the remote object.
+     *
+     * Only properties annotated with org.freedesktop.DBus.Property.EmitsChangedSignal set to "true"
+     * or "invalidates" are cached, reads of other properties always go to the remote object.
+     *
+     * The cache follows the bus attachment that owned the service name when caching was enabled. If
+     * that owner goes away, the service name changes owner or the session is lost the cached values
+     * are discarded and reads go to the remote object until caching is enabled again.
+     *
+     * This call causes messages to be sent on the bus, therefore it cannot be called within AllJoyn
+     * callbacks (method/signal/reply handlers or ObjectRegistered callbacks, etc.)
+     *
+     * @param iface     Name of the interface to cache properties for.
+     * @param timeout   Timeout specified in milliseconds to wait for a reply
+     * @return
+     *      - #ER_OK if property caching was enabled and the cache was populated.
+     *      - #ER_BUS_OBJECT_NO_SUCH_INTERFACE if the no such interface on this remote object.
+     *      - An error status otherwise
+     */
+    QStatus EnablePropertyCaching(const char* iface, uint32_t timeout = DefaultCallTimeout);
+
+    /**
+     * Disable property caching for all interfaces of this proxy object and discard the cached values.
+     */
+    void DisablePropertyCaching();
+
+    /**
+     * Get the number of property reads that were answered from the property cache and the number
+     * that had to be sent to the remote object since property caching was enabled.
+     *
+     * @param[out] hits    Number of reads answered from the cache.
+     * @param[out] misses  Number of reads of cached interfaces sent to the remote object.
+     */
+    void GetPropertyCacheStats(uint32_t& hits, uint32_t& misses) const;
+
+    /**
+     * A property of this or another object of the same remote peer for use with GetProperties()
+     * and SetProperties().
+     */
+    struct BatchProperty {
+        const char* path;       /**< Path of the object or NULL for this object */
+        const char* iface;      /**< Name of the interface */
+        const char* property;   /**< Name of the property */
+        MsgArg value;           /**< The value read or the value to write */
+        QStatus status;         /**< The result for this property */
+
+        /** Constructor */
+        BatchProperty() : path(NULL), iface(NULL), property(NULL), status(ER_OK) { }
+    };
+
+    /**
+     * Read properties from any number of objects of the remote peer that implements this object.
+     * The properties are sent in as few messages as possible and the messages are pipelined so
+     * the cost is close to a single round trip rather than one round trip per property.
+     *
+     * This call causes messages to be sent on the bus, therefore it cannot be called within AllJoyn
+     * callbacks (method/signal/reply handlers or ObjectRegistered callbacks, etc.)
+     *
+     * @param props     The properties to read. On return the value and status of each entry is set.
+     * @param numProps  The number of properties.
+     * @param timeout   Timeout specified in milliseconds to wait for a reply
+     * @return
+     *      - #ER_OK if the request was answered. Check the status of each property for errors
+     *        reading individual properties.
+     *      - #ER_BUS_BLOCKING_CALL_NOT_ALLOWED if called from an AllJoyn callback without
+     *        concurrent callbacks enabled
+     *      - #ER_TIMEOUT if the replies did not arrive in time
+     *      - An error status otherwise
+     */
+    QStatus GetProperties(BatchProperty* props, size_t numProps, uint32_t timeout = DefaultCallTimeout) const;
+
+    /**
+     * Write properties on any number of objects of the remote peer that implements this object.
+     * The properties are sent in as few messages as possible and the messages are pipelined.
+     *
+     * This call causes messages to be sent on the bus, therefore it cannot be called within AllJoyn
+     * callbacks (method/signal/reply handlers or ObjectRegistered callbacks, etc.)
+     *
+     * @param props     The properties to write. On return the status of each entry is set.
+     * @param numProps  The number of properties.
+     * @param timeout   Timeout specified in milliseconds to wait for a reply
+     * @return
+     *      - #ER_OK if the request was answered. Check the status of each property for errors
+     *        writing individual properties.
+     *      - #ER_BUS_BLOCKING_CALL_NOT_ALLOWED if called from an AllJoyn callback without
+     *        concurrent callbacks enabled
+     *      - #ER_TIMEOUT if the replies did not arrive in time
+     *      - An error status otherwise
+     */
+    QStatus SetProperties(BatchProperty* props, size_t numProps, uint32_t timeout = DefaultCallTimeout) const;
+
     /**
      * Helper function to sychronously set a uint32 property on the remote object.
      *
@@ -831,6 +926,45 @@ class ProxyBusObject : public MessageReceiver {
                             uint32_t timeout = DefaultCallTimeout,
                             uint8_t flags = 0) const;
 
+    /**
+     * A method call for use with MethodCallPipelined().
+     */
+    struct PipelinedCall {
+        const InterfaceDescription::Member* method;  /**< Method to call */
+        const MsgArg* args;                          /**< The arguments for the method call (can be NULL) */
+        size_t numArgs;                              /**< The number of arguments */
+
+        /** Constructor */
+        PipelinedCall() : method(NULL), args(NULL), numArgs(0) { }
+    };
+
+    /**
+     * Make a batch of asynchronous method calls from this object. All of the calls are marshaled
+     * before any is sent and are then queued back to back so they are written together rather
+     * than one at a time. The reply handler is called once when the replies to all of the calls
+     * have been received.
+     *
+     * @param calls        The method calls.
+     * @param numCalls     The number of method calls.
+     * @param receiver     The object to be called when all of the method calls complete.
+     * @param replyFunc    The function that is called to deliver the replies. Replies are in the
+     *                     same order as the calls. Calls that could not be sent or timed out have
+     *                     an error reply.
+     * @param context      User-defined context that will be returned to the reply handler
+     * @param timeout      Timeout specified in milliseconds to wait for each reply
+     * @param flags        Logical OR of the message flags for the method calls.
+     * @return
+     *      - ER_OK if the calls were sent, the reply handler will be called exactly once.
+     *      - An error status otherwise, the reply handler will not be called.
+     */
+    QStatus MethodCallPipelined(const PipelinedCall* calls,
+                                size_t numCalls,
+                                MessageReceiver* receiver,
+                                MessageReceiver::BatchReplyHandler replyFunc,
+                                void* context = NULL,
+                                uint32_t timeout = DefaultCallTimeout,
+                                uint8_t flags = 0) const;
+
     /**
      * Initialize this proxy object from an XML string. Calling this method does several things:
      *
@@ -955,6 +1089,43 @@ class ProxyBusObject : public MessageReceiver {
      */
     void SetPropMethodCB(Message& message, void* context);
 
+    /**
+     * @internal
+     * PropertiesChanged signal handler used to keep the property cache up to date. (Internal use only)
+     */
+    void PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg);
+
+    /**
+     * @internal
+     * NameOwnerChanged and SessionLost signal handler used to discard the property cache when the
+     * remote object goes away. (Internal use only)
+     */
+    void PropertyCacheOwnerHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg);
+
+    /**
+     * @internal
+     * Register or unregister the signal handlers and the match rule that keep the property cache
+     * up to date. (Internal use only)
+     */
+    QStatus SubscribePropertyCache(const qcc::String& matchRule);
+    void UnsubscribePropertyCache(const qcc::String& matchRule);
+
+    /**
+     * @internal
+     * Helpers for reading and updating the property cache. (Internal use only)
+     */
+    bool GetCachedProperty(const char* iface, const char* property, MsgArg& value, uint32_t& generation) const;
+    bool GetCachedProperties(const char* iface, MsgArg& values, uint32_t& generation) const;
+    void CacheProperty(const char* iface, const char* property, const MsgArg& value, uint32_t generation) const;
+    void CacheProperties(const char* iface, const MsgArg& values, uint32_t generation) const;
+    void InvalidateCachedProperty(const char* iface, const char* property) const;
+
+    /**
+     * @internal
+     * Common implementation of GetProperties() and SetProperties(). (Internal use only)
+     */
+    QStatus BatchProperties(BatchProperty* props, size_t numProps, bool get, uint32_t timeout) const;
+
     /**
      * @internal
      * Set the B2B endpoint to use for all communication with remote object.
@@ -82,9 +82,10 @@ static qcc::String ConcatenateCompressedFields(uint8_t* hdr, size_t hdrLen, cons
     return result;
 }
 
-QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+QStatus Crypto::Encrypt(const _Message& message, const MessageCipher& cipher, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
 {
     QStatus status;
+    const KeyBlob& keyBlob = cipher->GetKey();
     switch (keyBlob.GetType()) {
     case KeyBlob::AES:
     {
@@ -102,16 +103,16 @@ QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
         QCC_DbgHLPrintf(("Encrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
         QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-        Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+        /* The key schedule was expanded when the cipher was created */
         if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
             /*
              * To prevent an attack where the attacker sends a bogus expansion rule we
              * authenticate the compressed headers even though we won't be sending them.
              */
             qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
+            status = cipher->Encrypt_CCM(body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
         } else {
-            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
+            status = cipher->Encrypt_CCM(body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
         }
     }
     break;
@@ -124,9 +125,10 @@ QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
     return status;
 }
 
-QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+QStatus Crypto::Decrypt(const _Message& message, const MessageCipher& cipher, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
 {
     QStatus status;
+    const KeyBlob& keyBlob = cipher->GetKey();
     switch (keyBlob.GetType()) {
     case KeyBlob::AES:
     {
@@ -144,16 +146,16 @@ QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
         QCC_DbgHLPrintf(("Decrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
         QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-        Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+        /* The key schedule was expanded when the cipher was created */
         if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
             /*
              * To prevent an attack where the attacker sends a bogus expansion rule we
              * authenticate the compressed headers even though we won't be sending them.
              */
             qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
+            status = cipher->Decrypt_CCM(body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
         } else {
-            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
+            status = cipher->Decrypt_CCM(body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
         }
     }
     break;
@@ -26,7 +26,10 @@
 #endif
 
 #include <qcc/platform.h>
+#include <qcc/Crypto.h>
 #include <qcc/KeyBlob.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/Mutex.h>
 
 #include <alljoyn/Message.h>
 
@@ -35,6 +38,107 @@
 
 namespace ajn {
 
+/**
+ * A message key together with an AES-CCM cipher for that key. Constructing the cipher expands the
+ * AES key schedule so the cipher is created once when a key is set and reused for every message
+ * encrypted or decrypted with the key. A cipher is shared by every thread using the key so
+ * encryption and decryption are serialized on a per-cipher lock.
+ */
+class _MessageCipher {
+
+  public:
+
+    /**
+     * Default constructor for an empty cipher.
+     */
+    _MessageCipher() : aes(NULL) { }
+
+    /**
+     * Construct a cipher for a message key.
+     *
+     * @param key  The key to expand. Keys that are not AES keys result in an invalid cipher.
+     */
+    _MessageCipher(const qcc::KeyBlob& key) :
+        key(key),
+        aes((key.GetType() == qcc::KeyBlob::AES) ? new qcc::Crypto_AES(key, qcc::Crypto_AES::CCM) : NULL) { }
+
+    /**
+     * Destructor
+     */
+    ~_MessageCipher() { delete aes; }
+
+    /**
+     * Tests if this cipher can be used for message encryption.
+     *
+     * @return  Returns true if the cipher has an expanded AES key.
+     */
+    bool IsValid() const { return aes != NULL; }
+
+    /**
+     * Get the key this cipher was created for.
+     *
+     * @return  The message key.
+     */
+    const qcc::KeyBlob& GetKey() const { return key; }
+
+    /**
+     * Encrypt in place with AES-CCM. Only valid if IsValid() returns true.
+     *
+     * @param buf           The data to encrypt.
+     * @param len[in/out]   On input the size of the plaintext, on output the size of the crypttext.
+     * @param nonce         The nonce for this encryption.
+     * @param addData       Additional data to authenticate.
+     * @param addLen        Length of the additional data.
+     * @param authLen       Length of the MAC appended to the crypttext.
+     *
+     * @return  Status returned by qcc::Crypto_AES::Encrypt_CCM().
+     */
+    QStatus Encrypt_CCM(void* buf, size_t& len, const qcc::KeyBlob& nonce, const void* addData, size_t addLen, uint8_t authLen) const
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        QStatus status = aes->Encrypt_CCM(buf, buf, len, nonce, addData, addLen, authLen);
+        lock.Unlock(MUTEX_CONTEXT);
+        return status;
+    }
+
+    /**
+     * Decrypt and authenticate in place with AES-CCM. Only valid if IsValid() returns true.
+     *
+     * @param buf           The data to decrypt.
+     * @param len[in/out]   On input the size of the crypttext, on output the size of the plaintext.
+     * @param nonce         The nonce for this decryption.
+     * @param addData       Additional data to authenticate.
+     * @param addLen        Length of the additional data.
+     * @param authLen       Length of the MAC at the end of the crypttext.
+     *
+     * @return  Status returned by qcc::Crypto_AES::Decrypt_CCM().
+     */
+    QStatus Decrypt_CCM(void* buf, size_t& len, const qcc::KeyBlob& nonce, const void* addData, size_t addLen, uint8_t authLen) const
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        QStatus status = aes->Decrypt_CCM(buf, buf, len, nonce, addData, addLen, authLen);
+        lock.Unlock(MUTEX_CONTEXT);
+        return status;
+    }
+
+  private:
+
+    /**
+     * Copy constructor and assignment are private, ciphers are shared through MessageCipher.
+     */
+    _MessageCipher(const _MessageCipher& other);
+    _MessageCipher& operator=(const _MessageCipher& other);
+
+    qcc::KeyBlob key;      /**< The message key */
+    qcc::Crypto_AES* aes;  /**< The AES-CCM cipher with the expanded key schedule */
+    mutable qcc::Mutex lock;  /**< Serializes use of aes */
+};
+
+/**
+ * MessageCipher is a reference counted (managed) version of _MessageCipher.
+ */
+typedef qcc::ManagedObj<_MessageCipher> MessageCipher;
+
 /**
  * Class for encapsulating AllJoyn message encryption and decryption operations.
  */
@@ -43,11 +147,10 @@ class Crypto {
   public:
 
     /**
-     * Encrypt a marshaled message inplace using the key blob provided and the encryption algorithm
-     * and key stored in the key blob.
+     * Encrypt a marshaled message inplace using the cipher provided.
      *
      * @param message         The message being encrypted
-     * @param keyBlob         The key blob containing the key for the encryption operation.
+     * @param cipher          The cipher for the key to use for the encryption operation.
      * @param msgBuf          The message data to be encrypted. The data buffer must be large enough to handle
      *                        the expansion specified in the ExpansionBytes member variable.
      * @param hdrLen          The length of the header part of the message that will not be encrypted.
@@ -55,27 +158,26 @@ class Crypto {
      *                        encrypted body.
      *
      * @return - ER_OK if the data was succesfully encrypted.
-     *         - ER_BUS_KEYBLOB_OP_INVALID if the key blob cannot be used for encryption.
+     *         - ER_BUS_KEYBLOB_OP_INVALID if the key cannot be used for encryption.
      *         - Other errors if the arguments are invalid.
      */
-    static QStatus Encrypt(const _Message& message, const qcc::KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen);
+    static QStatus Encrypt(const _Message& message, const MessageCipher& cipher, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen);
 
     /**
-     * Decrypt and authenticate marshaled message inplace using the key blob provided and the
-     * decryption algorithm and key stored in the key blob.
+     * Decrypt and authenticate marshaled message inplace using the cipher provided.
      *
      * @param message         The message being decrypted
-     * @param keyBlob         The key blob containing the key for the decryption operation.
+     * @param cipher          The cipher for the key to use for the decryption operation.
      * @param msgBuf          The message data to be decrypted.
      * @param hdrLen          The length of the non-encrypted header part of the message.
      * @param bodyLen[in/out] On input the size of the crypttext body, on output the size of the
      *                        decrypted body.
      *
      * @return - ER_OK if the data was succesfully decrypted.
-     *         - ER_BUS_KEYBLOB_OP_INVALID if the key blob cannot be used for decryption.
+     *         - ER_BUS_KEYBLOB_OP_INVALID if the key cannot be used for decryption.
      *         - Other errors if the arguments are invalid.
      */
-    static QStatus Decrypt(const _Message& message, const qcc::KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen);
+    static QStatus Decrypt(const _Message& message, const MessageCipher& cipher, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen);
 
     /**
      * Compute a SHA1 hash over the header fields and return the result in a key blob.
@@ -119,7 +119,8 @@ static void SetRights(PeerState& peerState, bool mutual, bool challenger)
 AllJoynPeerObj::AllJoynPeerObj(BusAttachment& bus) :
     BusObject(bus, org::alljoyn::Bus::Peer::ObjectPath, false),
     AlarmListener(),
-    dispatcher("PeerObjDispatcher", true, 3)
+    dispatcher("PeerObjDispatcher", true, 3),
+    authDispatcher("PeerObjAuth", true, bus.GetConcurrency())
 {
     /* Add org.alljoyn.Bus.Peer.HeaderCompression interface */
     {
@@ -137,6 +138,7 @@ AllJoynPeerObj::AllJoynPeerObj(BusAttachment& bus) :
             AddMethodHandler(ifc->GetMember("AuthChallenge"), static_cast<MessageReceiver::MethodHandler>(&AllJoynPeerObj::AuthChallenge));
             AddMethodHandler(ifc->GetMember("ExchangeGuids"), static_cast<MessageReceiver::MethodHandler>(&AllJoynPeerObj::ExchangeGuids));
             AddMethodHandler(ifc->GetMember("GenSessionKey"), static_cast<MessageReceiver::MethodHandler>(&AllJoynPeerObj::GenSessionKey));
+            AddMethodHandler(ifc->GetMember("ResumeSession"), static_cast<MessageReceiver::MethodHandler>(&AllJoynPeerObj::ResumeSession));
             AddMethodHandler(ifc->GetMember("ExchangeGroupKeys"), static_cast<MessageReceiver::MethodHandler>(&AllJoynPeerObj::ExchangeGroupKeys));
         }
     }
@@ -160,6 +162,7 @@ QStatus AllJoynPeerObj::Start()
     assert(bus);
     bus->RegisterBusListener(*this);
     dispatcher.Start();
+    authDispatcher.Start();
     return ER_OK;
 }
 
@@ -167,6 +170,7 @@ QStatus AllJoynPeerObj::Stop()
 {
     assert(bus);
     dispatcher.Stop();
+    authDispatcher.Stop();
     bus->UnregisterBusListener(*this);
     return ER_OK;
 }
@@ -183,6 +187,7 @@ QStatus AllJoynPeerObj::Join()
     lock.Unlock(MUTEX_CONTEXT);
 
     dispatcher.Join();
+    authDispatcher.Join();
     return ER_OK;
 }
 
@@ -380,8 +385,8 @@ void AllJoynPeerObj::ExchangeGroupKeys(const InterfaceDescription::Member* membe
     /*
      * We expect to know the peer that is making this method call
      */
-    if (peerStateTable->IsKnownPeer(msg->GetSender())) {
-        PeerState peerState = peerStateTable->GetPeerState(msg->GetSender());
+    PeerState peerState;
+    if (peerStateTable->FindPeerState(msg->GetSender(), peerState)) {
         uint8_t keyGenVersion = peerState->GetAuthVersion() & 0xFF;
         QCC_DbgHLPrintf(("ExchangeGroupKeys using key gen version %d", keyGenVersion));
         /*
@@ -519,9 +524,10 @@ QStatus AllJoynPeerObj::KeyGen(PeerState& peerState, String seed, qcc::String& v
         delete [] keymatter;
     }
     /*
-     * Store any changes to the key store.
+     * Store any changes to the key store. The store is deferred so the changes from authentications
+     * with several peers are coalesced.
      */
-    keyStore.Store();
+    keyStore.ScheduleStore();
     return status;
 }
 
@@ -552,6 +558,76 @@ void AllJoynPeerObj::GenSessionKey(const InterfaceDescription::Member* member, M
     }
 }
 
+void AllJoynPeerObj::ResumeSession(const InterfaceDescription::Member* member, Message& msg)
+{
+    assert(bus);
+    QStatus status;
+    KeyStore& keyStore = bus->GetInternal().GetKeyStore();
+    qcc::GUID128 remotePeerGuid(msg->GetArg(0)->v_string.str);
+    qcc::GUID128 localPeerGuid(msg->GetArg(1)->v_string.str);
+    uint32_t authVersion = msg->GetArg(2)->v_uint32;
+    /*
+     * We can only resume if the initiator is talking to us, proposes a version we support and we
+     * still have a master secret for the initiator. Otherwise the initiator falls back to
+     * exchanging GUIDs.
+     */
+    if (keyStore.GetGuid() != localPeerGuid.ToString()) {
+        MethodReply(msg, ER_BUS_NO_PEER_GUID);
+    } else if (!IsCompatibleVersion(authVersion)) {
+        MethodReply(msg, ER_BUS_PEER_AUTH_VERSION_MISMATCH);
+    } else if (!keyStore.HasKey(remotePeerGuid)) {
+        MethodReply(msg, ER_BUS_KEY_UNAVAILABLE);
+    } else {
+        PeerState peerState = bus->GetInternal().GetPeerStateTable()->GetPeerState(msg->GetSender());
+        peerState->SetGuidAndAuthVersion(remotePeerGuid, authVersion);
+        qcc::String nonce = RandHexString(NONCE_LEN);
+        qcc::String verifier;
+        status = KeyGen(peerState, msg->GetArg(3)->v_string.str + nonce, verifier, KeyBlob::RESPONDER);
+        if (status == ER_OK) {
+            MsgArg replyArgs[2];
+            replyArgs[0].Set("s", nonce.c_str());
+            replyArgs[1].Set("s", verifier.c_str());
+            MethodReply(msg, replyArgs, ArraySize(replyArgs));
+        } else {
+            MethodReply(msg, status);
+        }
+    }
+}
+
+bool AllJoynPeerObj::GetResumeTicket(const qcc::String& busName, ResumeTicket& ticket)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    std::map<qcc::String, ResumeTicket>::iterator it = resumeTickets.find(busName);
+    bool found = (it != resumeTickets.end());
+    if (found) {
+        resumeTicketLru.splice(resumeTicketLru.begin(), resumeTicketLru, it->second.lruPos);
+        ticket = it->second;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return found;
+}
+
+void AllJoynPeerObj::SetResumeTicket(const qcc::String& busName, const qcc::GUID128& remoteGuid, uint32_t authVersion, const qcc::String& uniqueName)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    std::map<qcc::String, ResumeTicket>::iterator it = resumeTickets.find(busName);
+    if (it == resumeTickets.end()) {
+        if (resumeTickets.size() >= MAX_RESUME_TICKETS) {
+            resumeTickets.erase(resumeTicketLru.back());
+            resumeTicketLru.pop_back();
+        }
+        it = resumeTickets.insert(std::pair<qcc::String, ResumeTicket>(busName, ResumeTicket())).first;
+        resumeTicketLru.push_front(busName);
+        it->second.lruPos = resumeTicketLru.begin();
+    } else {
+        resumeTicketLru.splice(resumeTicketLru.begin(), resumeTicketLru, it->second.lruPos);
+    }
+    it->second.remoteGuid = remoteGuid;
+    it->second.authVersion = authVersion;
+    it->second.uniqueName = uniqueName;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
 void AllJoynPeerObj::AuthAdvance(Message& msg)
 {
     assert(bus);
@@ -661,9 +737,9 @@ void AllJoynPeerObj::ForceAuthentication(const qcc::String& busName)
 {
     assert(bus);
     PeerStateTable* peerStateTable = bus->GetInternal().GetPeerStateTable();
-    if (peerStateTable->IsKnownPeer(busName)) {
+    PeerState peerState;
+    if (peerStateTable->FindPeerState(busName, peerState)) {
         lock.Lock(MUTEX_CONTEXT);
-        PeerState peerState = peerStateTable->GetPeerState(busName);
         peerState->ClearKeys();
         bus->ClearKeys(peerState->GetGuid().ToString());
         lock.Unlock(MUTEX_CONTEXT);
@@ -722,50 +798,87 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     ProxyBusObject remotePeerObj(*bus, busName.c_str(), org::alljoyn::Bus::Peer::ObjectPath, 0);
     remotePeerObj.AddInterface(*ifc);
 
+    KeyStore& keyStore = bus->GetInternal().GetKeyStore();
+    qcc::String localGuidStr = keyStore.GetGuid();
+    qcc::String sender;
+    qcc::GUID128 remotePeerGuid;
+    uint32_t authVersion = 0;
+    Message replyMsg(*bus);
     /*
-     * Exchange GUIDs with the peer, this will get us the GUID of the remote peer and also the
-     * unique bus name from which we can determine if we have already have a session key, a
-     * master secret or if we have to start an authentication conversation.
+     * If we have a resumption ticket for this peer and still have the master secret try to resume.
+     * ResumeSession exchanges the GUIDs and the nonces for a new session key in a single round
+     * trip. If the remote peer cannot resume (e.g. it has lost the master secret or is an older
+     * peer that doesn't implement ResumeSession) we fall back to the full exchange. Signals never
+     * start an authentication conversation so only method calls try to resume. Resuming replaces
+     * the session key at the remote peer so we don't resume if the unique name the ticket was
+     * issued for is already secure, ExchangeGuids below finds the existing session key instead.
      */
-    qcc::String localGuidStr = bus->GetInternal().GetKeyStore().GetGuid();
-    MsgArg args[2];
-    args[0].Set("s", localGuidStr.c_str());
-    args[1].Set("u", PREFERRED_AUTH_VERSION);
-    Message replyMsg(*bus);
-    status = remotePeerObj.MethodCall(*(ifc->GetMember("ExchangeGuids")), args, ArraySize(args), replyMsg, DEFAULT_TIMEOUT);
-    if (status != ER_OK) {
+    qcc::String localNonce;
+    bool resumed = false;
+    ResumeTicket ticket;
+    if ((msgType == MESSAGE_METHOD_CALL) && GetResumeTicket(busName, ticket) && keyStore.HasKey(ticket.remoteGuid) &&
+        !(peerStateTable->IsKnownPeer(ticket.uniqueName) && peerStateTable->GetPeerState(ticket.uniqueName)->IsSecure())) {
+        localNonce = RandHexString(NONCE_LEN);
+        MsgArg args[4];
+        args[0].Set("s", localGuidStr.c_str());
+        args[1].Set("s", ticket.remoteGuid.ToString().c_str());
+        args[2].Set("u", ticket.authVersion);
+        args[3].Set("s", localNonce.c_str());
+        status = remotePeerObj.MethodCall(*(ifc->GetMember("ResumeSession")), args, ArraySize(args), replyMsg, DEFAULT_TIMEOUT);
+        if (status == ER_OK) {
+            sender = replyMsg->GetSender();
+            remotePeerGuid = ticket.remoteGuid;
+            authVersion = ticket.authVersion;
+            resumed = true;
+        } else {
+            QCC_DbgHLPrintf(("ResumeSession with %s failed %s", busName.c_str(), QCC_StatusText(status)));
+            status = ER_OK;
+        }
+    }
+    if (!resumed) {
         /*
-         * ER_BUS_REPLY_IS_ERROR_MESSAGE has a specific meaning in the public API and should not be
-         * propogated to the caller from this context.
+         * Exchange GUIDs with the peer, this will get us the GUID of the remote peer and also the
+         * unique bus name from which we can determine if we have already have a session key, a
+         * master secret or if we have to start an authentication conversation.
          */
-        if (status == ER_BUS_REPLY_IS_ERROR_MESSAGE) {
-            if (replyMsg->GetErrorName() != NULL && strcmp(replyMsg->GetErrorName(), "org.freedesktop.DBus.Error.ServiceUnknown") == 0) {
-                status = ER_BUS_NO_SUCH_OBJECT;
-            } else {
-                status = ER_AUTH_FAIL;
+        MsgArg args[2];
+        args[0].Set("s", localGuidStr.c_str());
+        args[1].Set("u", PREFERRED_AUTH_VERSION);
+        status = remotePeerObj.MethodCall(*(ifc->GetMember("ExchangeGuids")), args, ArraySize(args), replyMsg, DEFAULT_TIMEOUT);
+        if (status != ER_OK) {
+            /*
+             * ER_BUS_REPLY_IS_ERROR_MESSAGE has a specific meaning in the public API and should not be
+             * propogated to the caller from this context.
+             */
+            if (status == ER_BUS_REPLY_IS_ERROR_MESSAGE) {
+                if (replyMsg->GetErrorName() != NULL && strcmp(replyMsg->GetErrorName(), "org.freedesktop.DBus.Error.ServiceUnknown") == 0) {
+                    status = ER_BUS_NO_SUCH_OBJECT;
+                } else {
+                    status = ER_AUTH_FAIL;
+                }
             }
+            QCC_LogError(status, ("ExchangeGuids failed"));
+            return status;
+        }
+        sender = replyMsg->GetSender();
+        /*
+         * Extract the remote guid from the message
+         */
+        remotePeerGuid = qcc::GUID128(replyMsg->GetArg(0)->v_string.str);
+        authVersion = replyMsg->GetArg(1)->v_uint32;
+        /*
+         * Check that we can support the version the remote peer proposed.
+         */
+        if (!IsCompatibleVersion(authVersion)) {
+            status = ER_BUS_PEER_AUTH_VERSION_MISMATCH;
+            QCC_LogError(status, ("ExchangeGuids incompatible authentication version %u", authVersion));
+            return status;
         }
-        QCC_LogError(status, ("ExchangeGuids failed"));
-        return status;
     }
-    const qcc::String sender = replyMsg->GetSender();
-    /*
-     * Extract the remote guid from the message
-     */
-    qcc::GUID128 remotePeerGuid(replyMsg->GetArg(0)->v_string.str);
-    uint32_t authVersion = replyMsg->GetArg(1)->v_uint32;
     qcc::String remoteGuidStr = remotePeerGuid.ToString();
-    /*
-     * Check that we can support the version the remote peer proposed.
-     */
-    if (!IsCompatibleVersion(authVersion)) {
-        status = ER_BUS_PEER_AUTH_VERSION_MISMATCH;
-        QCC_LogError(status, ("ExchangeGuids incompatible authentication version %u", authVersion));
-        return status;
-    }
-    QCC_DbgHLPrintf(("ExchangeGuids Local %s", localGuidStr.c_str()));
-    QCC_DbgHLPrintf(("ExchangeGuids Remote %s", remoteGuidStr.c_str()));
-    QCC_DbgHLPrintf(("ExchangeGuids AuthVersion %d", authVersion));
+    QCC_DbgHLPrintf(("%s Local %s", resumed ? "ResumeSession" : "ExchangeGuids", localGuidStr.c_str()));
+    QCC_DbgHLPrintf(("%s Remote %s", resumed ? "ResumeSession" : "ExchangeGuids", remoteGuidStr.c_str()));
+    QCC_DbgHLPrintf(("%s AuthVersion %d", resumed ? "ResumeSession" : "ExchangeGuids", authVersion));
     /*
      * Now we have the unique bus name in the reply try again to find out if we have a session key
      * for this peer.
@@ -773,9 +886,10 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     peerState = peerStateTable->GetPeerState(sender, busName);
     peerState->SetGuidAndAuthVersion(remotePeerGuid, authVersion);
     /*
-     * We can now return if the peer is authenticated.
+     * We can now return if the peer is authenticated. A resumed session must be completed even if
+     * the peer is secure because the remote peer has already replaced its session key.
      */
-    if (peerState->IsSecure()) {
+    if (peerState->IsSecure() && !resumed) {
         return ER_OK;
     }
     /*
@@ -834,9 +948,26 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
     peerState->SetAuthEvent(&authEvent);
     lock.Unlock(MUTEX_CONTEXT);
 
-    KeyStore& keyStore = bus->GetInternal().GetKeyStore();
     bool firstPass = true;
+    /*
+     * The ResumeSession reply completes the seed string for the session key.
+     */
+    if (resumed) {
+        qcc::String verifier;
+        status = KeyGen(peerState, localNonce + replyMsg->GetArg(0)->v_string.str, verifier, KeyBlob::INITIATOR);
+        if ((status == ER_OK) && (verifier != replyMsg->GetArg(1)->v_string.str)) {
+            status = ER_AUTH_FAIL;
+        }
+        if (status != ER_OK) {
+            QCC_DbgHLPrintf(("ResumeSession key generation failed %s", QCC_StatusText(status)));
+            status = ER_OK;
+            resumed = false;
+        }
+    }
     do {
+        if (resumed) {
+            break;
+        }
         /*
          * Try to load the master secret for the remote peer. It is possible that the master secret
          * has expired or been deleted either locally or remotely so if we fail to establish a
@@ -962,6 +1093,15 @@ QStatus AllJoynPeerObj::AuthenticatePeer(AllJoynMessageType msgType, const qcc::
             }
         }
     }
+    /*
+     * Remember the remote peer so the next authentication with this peer can be resumed.
+     */
+    if (status == ER_OK) {
+        SetResumeTicket(busName, remotePeerGuid, authVersion, sender);
+        if (sender != busName) {
+            SetResumeTicket(sender, remotePeerGuid, authVersion, sender);
+        }
+    }
     /*
      * Report the authentication completion to allow application to clear UI etc.
      */
@@ -997,11 +1137,16 @@ QStatus AllJoynPeerObj::DispatchRequest(Message& msg, RequestType reqType, const
 {
     QStatus status;
     QCC_DbgHLPrintf(("DispatchRequest %s", msg->Description().c_str()));
+    /*
+     * Authentication challenges are handled on their own dispatcher so the computations for
+     * concurrent authentications are not held up by requests that are waiting on a remote peer.
+     */
+    qcc::Timer& timer = (reqType == AUTH_CHALLENGE) ? authDispatcher : dispatcher;
     lock.Lock(MUTEX_CONTEXT);
-    if (dispatcher.IsRunning()) {
+    if (timer.IsRunning()) {
         Request* req = new Request(msg, reqType, data);
         qcc::AlarmListener* alljoynPeerListener = this;
-        status = dispatcher.AddAlarm(Alarm(alljoynPeerListener, req));
+        status = timer.AddAlarm(Alarm(alljoynPeerListener, req));
         if (status != ER_OK) {
             delete req;
         }
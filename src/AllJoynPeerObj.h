@@ -25,6 +25,7 @@
 #include <qcc/platform.h>
 
 #include <map>
+#include <list>
 #include <deque>
 
 #include <qcc/GUID.h>
@@ -249,6 +250,15 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
      */
     void GenSessionKey(const InterfaceDescription::Member* member, Message& msg);
 
+    /**
+     * ResumeSession method call handler. Combines ExchangeGuids and GenSessionKey for a peer that
+     * we already share a master secret with.
+     *
+     * @param member  The member that was called
+     * @param msg     The method call message
+     */
+    void ResumeSession(const InterfaceDescription::Member* member, Message& msg);
+
     /**
      * ExchangeGroupKeys method call handler
      *
@@ -288,6 +298,39 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
      */
     QStatus KeyGen(PeerState& peerState, qcc::String seed, qcc::String& verifier, qcc::KeyBlob::Role role);
 
+    /**
+     * A resumption ticket records the GUID and authentication version of a peer we have
+     * authenticated so the next authentication with that peer can be resumed from the master
+     * secret in a single round trip.
+     */
+    struct ResumeTicket {
+        qcc::GUID128 remoteGuid;   /**< GUID of the remote peer */
+        uint32_t authVersion;      /**< Authentication version negotiated with the remote peer */
+        qcc::String uniqueName;    /**< Unique name of the remote peer when the ticket was issued */
+        std::list<qcc::String>::iterator lruPos;  /**< Position of this ticket in resumeTicketLru */
+    };
+
+    /**
+     * Get the resumption ticket for a bus name.
+     *
+     * @param busName  The unique or well-known name of the peer
+     * @param ticket   [out]Returns the ticket.
+     *
+     * @return  Returns true if there is a ticket for the bus name.
+     */
+    bool GetResumeTicket(const qcc::String& busName, ResumeTicket& ticket);
+
+    /**
+     * Set the resumption ticket for a bus name. If the ticket table is full the least recently
+     * used ticket is discarded.
+     *
+     * @param busName      The unique or well-known name of the peer
+     * @param remoteGuid   The GUID of the remote peer
+     * @param authVersion  The authentication version negotiated with the remote peer
+     * @param uniqueName   The unique name of the remote peer
+     */
+    void SetResumeTicket(const qcc::String& busName, const qcc::GUID128& remoteGuid, uint32_t authVersion, const qcc::String& uniqueName);
+
     /**
      * Get a property from this object
      * @param ifcName the name of the interface
@@ -365,11 +408,23 @@ class AllJoynPeerObj : public BusObject, public BusListener, public qcc::AlarmLi
     /** Dispatcher for handling peer object requests */
     qcc::Timer dispatcher;
 
+    /** Dispatcher for handling authentication challenges, one worker per concurrent handler allowed by the bus */
+    qcc::Timer authDispatcher;
+
     /** Queue of encrypted messages waiting for an authentication to complete */
     std::deque<Message> msgsPendingAuth;
 
     /** Queue of compressed messages waiting for an expansion rule to be supplied */
     std::deque<Message> msgsPendingExpansion;
+
+    /** Maximum number of resumption tickets that are kept */
+    static const size_t MAX_RESUME_TICKETS = 256;
+
+    /** Resumption tickets for peers we have authenticated */
+    std::map<qcc::String, ResumeTicket> resumeTickets;
+
+    /** Bus names of the resumption tickets, most recently used first */
+    std::list<qcc::String> resumeTicketLru;
 };
 
 }
@@ -55,6 +55,8 @@ const char* org::alljoyn::Daemon::Debug::InterfaceName = "org.alljoyn.Debug";
 const char* org::alljoyn::Bus::Peer::HeaderCompression::InterfaceName = "org.alljoyn.Bus.Peer.HeaderCompression";
 const char* org::alljoyn::Bus::Peer::Authentication::InterfaceName = "org.alljoyn.Bus.Peer.Authentication";
 const char* org::alljoyn::Bus::Peer::Session::InterfaceName = "org.alljoyn.Bus.Peer.Session";
+const char* org::alljoyn::Bus::Introspectable::InterfaceName = "org.alljoyn.Bus.Introspectable";
+const char* org::alljoyn::Bus::Properties::InterfaceName = "org.alljoyn.Bus.Properties";
 
 
 QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
@@ -81,6 +83,7 @@ QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
         ifc->AddMethod("CancelFindAdvertisedName", "s",                 "u",                 "name,disposition",                           0);
         ifc->AddMethod("CancelFindAdvertisedNameByTransport", "sq",                "u",                 "name,transports,disposition",                0);
         ifc->AddMethod("GetSessionFd",             "u",                 "h",                 "sessionId,handle",                           0);
+        ifc->AddMethod("GetSessionChannel",        "u",                 "hs",                "sessionId,handle,peer",                      0);
         ifc->AddMethod("SetLinkTimeout",           "uu",                "uu",                "sessionId,inLinkTO,disposition,outLinkTO",   0);
         ifc->AddMethod("AliasUnixUser",            "u",                 "u",                 "aliasUID, disposition",                      0);
         ifc->AddMethod("OnAppSuspend",             "",                  "u",                 "disposition",                                0);
@@ -109,6 +112,7 @@ QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
         ifc->AddSignal("DetachSession",  "us",     "sessionId,joiner",       0);
         ifc->AddSignal("ExchangeNames",  "a(sas)", "uniqueName,aliases",     0);
         ifc->AddSignal("NameChanged",    "sss",    "name,oldOwner,newOwner", 0);
+        ifc->AddSignal("NameChanges",    "a(sss)", "changes",                0);
         ifc->AddSignal("ProbeReq",       "",       "",                       0);
         ifc->AddSignal("ProbeAck",       "",       "",                       0);
         ifc->Activate();
@@ -146,6 +150,7 @@ QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
         }
         ifc->AddMethod("ExchangeGuids",     "su",  "su", "localGuid,localVersion,remoteGuid,remoteVersion");
         ifc->AddMethod("GenSessionKey",     "sss", "ss", "localGuid,remoteGuid,localNonce,remoteNonce,verifier");
+        ifc->AddMethod("ResumeSession",     "ssus", "ss", "localGuid,remoteGuid,authVersion,localNonce,remoteNonce,verifier");
         ifc->AddMethod("ExchangeGroupKeys", "ay",  "ay", "localKeyMatter,remoteKeyMatter");
         ifc->AddMethod("AuthChallenge",     "s",   "s",  "challenge,response");
         ifc->AddProperty("Mechanisms",  "s", PROP_ACCESS_READ);
@@ -164,6 +169,29 @@ QStatus org::alljoyn::CreateInterfaces(BusAttachment& bus)
         ifc->AddSignal("SessionJoined", "qus", "port,id,src");
         ifc->Activate();
     }
+    {
+        /* Create the org.alljoyn.Bus.Introspectable interface */
+        InterfaceDescription* ifc = NULL;
+        status = bus.CreateInterface(org::alljoyn::Bus::Introspectable::InterfaceName, ifc);
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to create %s interface", org::alljoyn::Bus::Introspectable::InterfaceName));
+            return status;
+        }
+        ifc->AddMethod("IntrospectDigest", NULL, "ay", "digest");
+        ifc->Activate();
+    }
+    {
+        /* Create the org.alljoyn.Bus.Properties interface */
+        InterfaceDescription* ifc = NULL;
+        status = bus.CreateInterface(org::alljoyn::Bus::Properties::InterfaceName, ifc);
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to create %s interface", org::alljoyn::Bus::Properties::InterfaceName));
+            return status;
+        }
+        ifc->AddMethod("GetMultiple", "a(oss)",  "a(qv)", "properties,values");
+        ifc->AddMethod("SetMultiple", "a(ossv)", "aq",    "properties,results");
+        ifc->Activate();
+    }
     return status;
 }
 
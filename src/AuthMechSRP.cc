@@ -23,8 +23,11 @@
 #include <qcc/platform.h>
 
 #include <assert.h>
+#include <map>
+#include <list>
 
 #include <qcc/Crypto.h>
+#include <qcc/Mutex.h>
 #include <qcc/Util.h>
 #include <qcc/Debug.h>
 #include <qcc/String.h>
@@ -45,6 +48,77 @@ namespace ajn {
  */
 #define NONCE_LEN  28
 
+/*
+ * Maximum number of SRP verifiers cached by the responder
+ */
+#define MAX_CACHED_VERIFIERS  16
+
+/*
+ * Computing the SRP verifier from the password is one of the modular exponentiations the responder
+ * does for every authentication. A device that authenticates many peers with the same password can
+ * reuse the verifier in the same way a server with a stored verifier does (see AuthMechLogon).
+ * Verifiers are looked up by a hash of the password so the passwords are not kept.
+ */
+class VerifierCache {
+  public:
+
+    bool Get(const qcc::String& pwd, qcc::String& verifier)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        VerifierMap::iterator it = verifiers.find(PasswordHash(pwd));
+        bool found = (it != verifiers.end());
+        if (found) {
+            lru.splice(lru.begin(), lru, it->second.second);
+            verifier = it->second.first;
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        return found;
+    }
+
+    void Put(const qcc::String& pwd, const qcc::String& verifier)
+    {
+        qcc::String hash = PasswordHash(pwd);
+        lock.Lock(MUTEX_CONTEXT);
+        VerifierMap::iterator it = verifiers.find(hash);
+        if (it == verifiers.end()) {
+            /* Evict the least recently used verifier */
+            if (verifiers.size() >= MAX_CACHED_VERIFIERS) {
+                verifiers.erase(lru.back());
+                lru.pop_back();
+            }
+            lru.push_front(hash);
+            it = verifiers.insert(VerifierMap::value_type(hash, std::make_pair(verifier, lru.begin()))).first;
+        } else {
+            lru.splice(lru.begin(), lru, it->second.second);
+            it->second.first = verifier;
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+  private:
+
+    static qcc::String PasswordHash(const qcc::String& pwd)
+    {
+        static const char label[] = "SRP Verifier Cache";
+        Crypto_SHA1 sha1;
+        uint8_t digest[Crypto_SHA1::DIGEST_SIZE];
+        sha1.Init();
+        sha1.Update((const uint8_t*)label, sizeof(label));
+        sha1.Update(pwd);
+        sha1.GetDigest(digest);
+        return qcc::String((const char*)digest, sizeof(digest));
+    }
+
+    /** Verifiers keyed by password hash with the position of the hash in lru */
+    typedef std::map<qcc::String, std::pair<qcc::String, std::list<qcc::String>::iterator> > VerifierMap;
+
+    qcc::Mutex lock;
+    VerifierMap verifiers;
+    std::list<qcc::String> lru;   /**< Password hashes, most recently used first */
+};
+
+static VerifierCache verifierCache;
+
 AuthMechSRP::AuthMechSRP(KeyStore& keyStore, ProtectedAuthListener& listener) : AuthMechanism(keyStore, listener), step(255)
 {
 }
@@ -214,7 +288,15 @@ qcc::String AuthMechSRP::Challenge(const qcc::String& response,
             if (creds.IsSet(AuthListener::CRED_EXPIRATION)) {
                 expiration = creds.GetExpiration();
             }
-            status = srp.ServerInit("<anonymous>", creds.GetPassword(), challenge);
+            qcc::String verifier;
+            if (verifierCache.Get(creds.GetPassword(), verifier)) {
+                status = srp.ServerInit(verifier, challenge);
+            } else {
+                status = srp.ServerInit("<anonymous>", creds.GetPassword(), challenge);
+                if (status == ER_OK) {
+                    verifierCache.Put(creds.GetPassword(), srp.ServerGetVerifier());
+                }
+            }
         } else {
             result = ALLJOYN_AUTH_FAIL;
         }
@@ -25,8 +25,6 @@
 #include <qcc/String.h>
 #include <qcc/Timer.h>
 #include <qcc/atomic.h>
-#include <qcc/XmlElement.h>
-#include <qcc/StringSource.h>
 #include <qcc/FileStream.h>
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
@@ -115,6 +113,7 @@ BusAttachment::Internal::Internal(const char* appName,
     m_ioDispatch("iodisp", 128),
     transportList(bus, factories, &m_ioDispatch, concurrency),
     keyStore(application),
+    introspectionCacheEnabled(false),
     authManager(keyStore),
     globalGuid(qcc::GUID128()),
     msgSerial(1),
@@ -616,6 +615,11 @@ QStatus BusAttachment::StopInternal(bool blockUntilStopped)
             QCC_LogError(status, ("TransportList::Stop() failed"));
         }
 
+        /* Direct routes to session peers are not owned by any transport */
+        if (!busInternal->GetRouter().IsDaemon()) {
+            static_cast<ClientRouter&>(busInternal->GetRouter()).StopDirectRoutes();
+        }
+
         /* Stop the threads currently waiting for join to complete */
         busInternal->joinLock.Lock();
         map<Thread*, Internal::JoinContext>::iterator jit = busInternal->joinThreads.begin();
@@ -664,6 +668,9 @@ void BusAttachment::WaitStopInternal()
          */
         if (isStarted) {
             busInternal->transportList.Join();
+            if (!busInternal->GetRouter().IsDaemon()) {
+                static_cast<ClientRouter&>(busInternal->GetRouter()).JoinDirectRoutes();
+            }
 
             /* Clear peer state */
             busInternal->peerStateTable.Clear();
@@ -744,6 +751,23 @@ void BusAttachment::ClearKeyStore()
     busInternal->keyStore.Clear();
 }
 
+QStatus BusAttachment::EnableIntrospectionCache(const char* fileName)
+{
+    qcc::String path;
+    if (fileName) {
+        path = GetHomeDir() + "/" + fileName;
+    } else {
+        path = GetHomeDir() + "/.alljoyn_introspection/" + busInternal->application;
+    }
+    QStatus status = busInternal->introspectionCache.Load(path);
+    if (status == ER_OK) {
+        busInternal->introspectionCacheEnabled = true;
+    } else {
+        QCC_LogError(status, ("Failed to load introspection cache from %s", path.c_str()));
+    }
+    return status;
+}
+
 const qcc::String BusAttachment::GetUniqueName() const
 {
     /*
@@ -1637,6 +1661,9 @@ QStatus BusAttachment::LeaveSession(const SessionId& sessionId)
     Message reply(*this);
     MsgArg arg("u", sessionId);
     const ProxyBusObject& alljoynObj = this->GetAllJoynProxyObj();
+    if (!busInternal->GetRouter().IsDaemon()) {
+        static_cast<ClientRouter&>(busInternal->GetRouter()).RemoveDirectRoute(sessionId);
+    }
     QStatus status = alljoynObj.MethodCall(org::alljoyn::Bus::InterfaceName, "LeaveSession", &arg, 1, reply);
     if (ER_OK == status) {
         uint32_t disposition;
@@ -1715,6 +1742,42 @@ QStatus BusAttachment::GetSessionFd(SessionId sessionId, SocketFd& sockFd)
     return status;
 }
 
+QStatus BusAttachment::EnableDirectSession(SessionId sessionId)
+{
+    QCC_DbgTrace(("BusAttachment::EnableDirectSession sessionId:%d", sessionId));
+    if (!IsConnected()) {
+        return ER_BUS_NOT_CONNECTED;
+    }
+    Router& router = busInternal->GetRouter();
+    if (router.IsDaemon()) {
+        return ER_NOT_IMPLEMENTED;
+    }
+
+    Message reply(*this);
+    MsgArg arg("u", sessionId);
+    const ProxyBusObject& alljoynObj = this->GetAllJoynProxyObj();
+    QStatus status = alljoynObj.MethodCall(org::alljoyn::Bus::InterfaceName, "GetSessionChannel", &arg, 1, reply);
+    if (ER_OK == status) {
+        SocketFd sockFd;
+        const char* peerName;
+        status = reply->GetArgs("hs", &sockFd, &peerName);
+        if (status == ER_OK) {
+            status = qcc::SocketDup(sockFd, sockFd);
+            if (status == ER_OK) {
+                status = qcc::SetBlocking(sockFd, false);
+                if (status == ER_OK) {
+                    status = static_cast<ClientRouter&>(router).AddDirectRoute(sessionId, peerName, sockFd);
+                } else {
+                    qcc::Close(sockFd);
+                }
+            }
+        }
+    } else {
+        QCC_LogError(status, ("%s.GetSessionChannel returned ERROR_MESSAGE (error=%s)", org::alljoyn::Bus::InterfaceName, reply->GetErrorDescription().c_str()));
+    }
+    return status;
+}
+
 QStatus BusAttachment::SetLinkTimeoutAsync(SessionId sessionid, uint32_t linkTimeout, BusAttachment::SetLinkTimeoutAsyncCB* callback, void* context)
 {
     if (!IsConnected()) {
@@ -1866,8 +1929,11 @@ void BusAttachment::Internal::AllJoynSignalHandler(const InterfaceDescription::M
             }
             listenersLock.Unlock(MUTEX_CONTEXT);
         } else if (0 == strcmp("SessionLost", msg->GetMemberName())) {
-            sessionListenersLock.Lock(MUTEX_CONTEXT);
             SessionId id = static_cast<SessionId>(args[0].v_uint32);
+            if (!router->IsDaemon()) {
+                static_cast<ClientRouter*>(router)->RemoveDirectRoute(id);
+            }
+            sessionListenersLock.Lock(MUTEX_CONTEXT);
             SessionListenerMap::iterator slit = sessionListeners.find(id);
             if (slit != sessionListeners.end()) {
                 ProtectedSessionListener pl = slit->second;
@@ -1959,16 +2025,9 @@ QStatus BusAttachment::SetSessionListener(SessionId id, SessionListener* listene
 
 QStatus BusAttachment::CreateInterfacesFromXml(const char* xml)
 {
-    StringSource source(xml);
-
-    /* Parse the XML to update this ProxyBusObject instance (plus any new children and interfaces) */
-    XmlParseContext pc(source);
-    QStatus status = XmlElement::Parse(pc);
-    if (status == ER_OK) {
-        XmlHelper xmlHelper(this, "BusAttachment");
-        status = xmlHelper.AddInterfaceDefinitions(pc.GetRoot());
-    }
-    return status;
+    /* Parse the XML adding any new interfaces to this bus attachment */
+    XmlHelper xmlHelper(this, "BusAttachment");
+    return xmlHelper.AddInterfaceDefinitions(xml);
 }
 
 bool BusAttachment::Internal::CallAcceptListeners(SessionPort sessionPort, const char* joiner, const SessionOpts& opts)
@@ -2033,8 +2092,9 @@ QStatus BusAttachment::GetPeerGUID(const char* name, qcc::String& guid)
     } else {
         peerName = GetUniqueName();
     }
-    if (peerTable->IsKnownPeer(peerName)) {
-        guid = peerTable->GetPeerState(peerName)->GetGuid().ToString();
+    PeerState peerState;
+    if (peerTable->FindPeerState(peerName, peerState)) {
+        guid = peerState->GetGuid().ToString();
         return ER_OK;
     } else {
         return ER_BUS_NO_PEER_GUID;
@@ -43,6 +43,7 @@
 #include "Transport.h"
 #include "TransportList.h"
 #include "CompressionRules.h"
+#include "IntrospectionCache.h"
 
 #include <alljoyn/Status.h>
 
@@ -60,6 +61,13 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
      */
     KeyStore& GetKeyStore() { return keyStore; }
 
+    /**
+     * Get the introspection cache for this bus attachment.
+     *
+     * @return The introspection cache or NULL if introspection caching is not enabled.
+     */
+    IntrospectionCache* GetIntrospectionCache() { return introspectionCacheEnabled ? &introspectionCache : NULL; }
+
     /**
      * Return the next available serial number. Note 0 is an invalid serial number.
      *
@@ -279,6 +287,8 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
     qcc::IODispatch m_ioDispatch;         /* iodispatch for this bus */
     TransportList transportList;          /* List of active transports */
     KeyStore keyStore;                    /* The key store for the bus attachment */
+    IntrospectionCache introspectionCache; /* Cache of introspection data of remote objects */
+    bool introspectionCacheEnabled;       /* true if the introspection cache is in use */
     AuthManager authManager;              /* The authentication manager for the bus attachment */
     qcc::GUID128 globalGuid;              /* Global GUID for this BusAttachment */
     int32_t msgSerial;                    /* Serial number is updated for every message sent by this bus */
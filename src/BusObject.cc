@@ -42,6 +42,7 @@
 #include "AllJoynPeerObj.h"
 #include "MethodTable.h"
 #include "BusInternal.h"
+#include "IntrospectionCache.h"
 
 
 #define QCC_MODULE "ALLJOYN"
@@ -73,6 +74,14 @@ struct BusObject::Components {
     int32_t inUseCounter;
 };
 
+/*
+ * Check if a method call is a request for the digest of the introspection data.
+ */
+static bool IsIntrospectDigestCall(const Message& msg)
+{
+    return (strcmp(msg->GetMemberName(), "IntrospectDigest") == 0) && (strcmp(msg->GetInterface(), org::alljoyn::Bus::Introspectable::InterfaceName) == 0);
+}
+
 /*
  * Helper function to lookup an interface. Because we don't expect objects to implement more than a
  * small number of interfaces we just use a simple linear search.
@@ -139,29 +148,64 @@ qcc::String BusObject::GenerateIntrospection(bool deep, size_t indent) const
     return xml;
 }
 
-void BusObject::GetProp(const InterfaceDescription::Member* member, Message& msg)
+QStatus BusObject::ReadProp(const char* ifcName, const char* propName, bool encrypted, MsgArg& val)
 {
     QStatus status;
-    const MsgArg* iface = msg->GetArg(0);
-    const MsgArg* property = msg->GetArg(1);
-    MsgArg val = MsgArg();
 
     /* Check property exists on this interface and is readable */
-    const InterfaceDescription* ifc = LookupInterface(components->ifaces, iface->v_string.str);
+    const InterfaceDescription* ifc = LookupInterface(components->ifaces, ifcName);
     if (ifc) {
         /*
          * If the interface is secure the message must be encrypted
          */
-        if (ifc->IsSecure() && !msg->IsEncrypted()) {
+        if (ifc->IsSecure() && !encrypted) {
             status = ER_BUS_MESSAGE_NOT_ENCRYPTED;
             QCC_LogError(status, ("Attempt to get a property from a secure interface"));
         } else {
-            const InterfaceDescription::Property* prop = ifc->GetProperty(property->v_string.str);
+            const InterfaceDescription::Property* prop = ifc->GetProperty(propName);
             if (prop) {
                 if (prop->access & PROP_ACCESS_READ) {
-                    status = Get(iface->v_string.str, property->v_string.str, val);
+                    status = Get(ifcName, propName, val);
+                } else {
+                    QCC_DbgPrintf(("No read access on property %s", propName));
+                    status = ER_BUS_PROPERTY_ACCESS_DENIED;
+                }
+            } else {
+                status = ER_BUS_NO_SUCH_PROPERTY;
+            }
+        }
+    } else {
+        status = ER_BUS_UNKNOWN_INTERFACE;
+    }
+    return status;
+}
+
+QStatus BusObject::WriteProp(const char* ifcName, const char* propName, MsgArg& val, bool encrypted, SessionId id)
+{
+    QStatus status;
+
+    /* Check property exists on this interface has correct signature and is writeable */
+    const InterfaceDescription* ifc = LookupInterface(components->ifaces, ifcName);
+    if (ifc) {
+        /*
+         * If the interface is secure the message must be encrypted
+         */
+        if (ifc->IsSecure() && !encrypted) {
+            status = ER_BUS_MESSAGE_NOT_ENCRYPTED;
+            QCC_LogError(status, ("Attempt to set a property on a secure interface"));
+        } else {
+            const InterfaceDescription::Property* prop = ifc->GetProperty(propName);
+            if (prop) {
+                if (!val.HasSignature(prop->signature.c_str())) {
+                    QCC_DbgPrintf(("Property value for %s has wrong type %s", propName, prop->signature.c_str()));
+                    status = ER_BUS_SET_WRONG_SIGNATURE;
+                } else if (prop->access & PROP_ACCESS_WRITE) {
+                    // set the value, then inform bus listeners via Signal
+                    status = Set(ifcName, propName, val);
+                    // notify all session members that this property has changed
+                    EmitPropChanged(ifcName, propName, val, id);
                 } else {
-                    QCC_DbgPrintf(("No read access on property %s", property->v_string.str));
+                    QCC_DbgPrintf(("No write access on property %s", propName));
                     status = ER_BUS_PROPERTY_ACCESS_DENIED;
                 }
             } else {
@@ -171,6 +215,16 @@ void BusObject::GetProp(const InterfaceDescription::Member* member, Message& msg
     } else {
         status = ER_BUS_UNKNOWN_INTERFACE;
     }
+    return status;
+}
+
+void BusObject::GetProp(const InterfaceDescription::Member* member, Message& msg)
+{
+    const MsgArg* iface = msg->GetArg(0);
+    const MsgArg* property = msg->GetArg(1);
+    MsgArg val = MsgArg();
+
+    QStatus status = ReadProp(iface->v_string.str, property->v_string.str, msg->IsEncrypted(), val);
     QCC_DbgPrintf(("Properties.Get %s", QCC_StatusText(status)));
     if (status == ER_OK) {
         /* Properties are returned as variants */
@@ -222,45 +276,100 @@ void BusObject::EmitPropChanged(const char* ifcName, const char* propName, MsgAr
 
 void BusObject::SetProp(const InterfaceDescription::Member* member, Message& msg)
 {
-    QStatus status = ER_BUS_NO_SUCH_PROPERTY;
     const MsgArg* iface = msg->GetArg(0);
     const MsgArg* property = msg->GetArg(1);
     const MsgArg* val = msg->GetArg(2);
+    const SessionId id = msg->hdrFields.field[ALLJOYN_HDR_FIELD_SESSION_ID].v_uint32;
 
-    /* Check property exists on this interface has correct signature and is writeable */
-    const InterfaceDescription* ifc = LookupInterface(components->ifaces, iface->v_string.str);
-    if (ifc) {
-        /*
-         * If the interface is secure the message must be encrypted
-         */
-        if (ifc->IsSecure() && !msg->IsEncrypted()) {
-            status = ER_BUS_MESSAGE_NOT_ENCRYPTED;
-            QCC_LogError(status, ("Attempt to set a property on a secure interface"));
-        } else {
-            const InterfaceDescription::Property* prop = ifc->GetProperty(property->v_string.str);
-            if (prop) {
-                if (!val->v_variant.val->HasSignature(prop->signature.c_str())) {
-                    QCC_DbgPrintf(("Property value for %s has wrong type %s", property->v_string.str, prop->signature.c_str()));
-                    status = ER_BUS_SET_WRONG_SIGNATURE;
-                } else if (prop->access & PROP_ACCESS_WRITE) {
-                    // set the value, then inform bus listeners via Signal
-                    status = Set(iface->v_string.str, property->v_string.str, *(val->v_variant.val));
-                    // notify all session members that this property has changed
-                    const SessionId id = msg->hdrFields.field[ALLJOYN_HDR_FIELD_SESSION_ID].v_uint32;
-                    EmitPropChanged(iface->v_string.str, property->v_string.str, *(val->v_variant.val), id);
-                } else {
-                    QCC_DbgPrintf(("No write access on property %s", property->v_string.str));
-                    status = ER_BUS_PROPERTY_ACCESS_DENIED;
-                }
+    QStatus status = WriteProp(iface->v_string.str, property->v_string.str, *(val->v_variant.val), msg->IsEncrypted(), id);
+    QCC_DbgPrintf(("Properties.Set %s", QCC_StatusText(status)));
+    MethodReply(msg, status);
+}
+
+BusObject* BusObject::AcquireLocalObject(const char* objectPath)
+{
+    LocalEndpoint localEndpoint = bus->GetInternal().GetLocalEndpoint();
+    localEndpoint->objectsLock.Lock(MUTEX_CONTEXT);
+    BusObject* obj = localEndpoint->FindLocalObject(objectPath);
+    if (obj) {
+        obj->InUseIncrement();
+    }
+    localEndpoint->objectsLock.Unlock(MUTEX_CONTEXT);
+    return obj;
+}
+
+void BusObject::GetMultipleProps(const InterfaceDescription::Member* member, Message& msg)
+{
+    const MsgArg* requests;
+    size_t numRequests;
+    QStatus status = msg->GetArg(0)->Get("a(oss)", &numRequests, &requests);
+    if (status != ER_OK) {
+        MethodReply(msg, status);
+        return;
+    }
+    MsgArg* results = new MsgArg[numRequests];
+    for (size_t i = 0; i < numRequests; ++i) {
+        const char* objPath;
+        const char* ifcName;
+        const char* propName;
+        MsgArg* val = new MsgArg();
+        status = requests[i].Get("(oss)", &objPath, &ifcName, &propName);
+        if (status == ER_OK) {
+            BusObject* obj = AcquireLocalObject(objPath);
+            if (obj) {
+                status = obj->ReadProp(ifcName, propName, msg->IsEncrypted(), *val);
+                obj->InUseDecrement();
             } else {
-                status = ER_BUS_NO_SUCH_PROPERTY;
+                status = ER_BUS_NO_SUCH_OBJECT;
             }
         }
-    } else {
-        status = ER_BUS_UNKNOWN_INTERFACE;
+        if (status != ER_OK) {
+            /* A variant cannot be empty so failed entries carry an empty string */
+            val->Set("s", "");
+        }
+        results[i].Set("(qv)", static_cast<uint16_t>(status), val);
     }
-    QCC_DbgPrintf(("Properties.Set %s", QCC_StatusText(status)));
-    MethodReply(msg, status);
+    MsgArg arg("a(qv)", numRequests, results);
+    /*
+     * Set ownership of the MsgArgs so they will be automatically freed.
+     */
+    arg.SetOwnershipFlags(MsgArg::OwnsArgs, true /*deep*/);
+    QCC_DbgPrintf(("GetMultiple %u properties", numRequests));
+    MethodReply(msg, &arg, 1);
+}
+
+void BusObject::SetMultipleProps(const InterfaceDescription::Member* member, Message& msg)
+{
+    const MsgArg* requests;
+    size_t numRequests;
+    QStatus status = msg->GetArg(0)->Get("a(ossv)", &numRequests, &requests);
+    if (status != ER_OK) {
+        MethodReply(msg, status);
+        return;
+    }
+    const SessionId id = msg->hdrFields.field[ALLJOYN_HDR_FIELD_SESSION_ID].v_uint32;
+    uint16_t* results = new uint16_t[numRequests];
+    for (size_t i = 0; i < numRequests; ++i) {
+        const char* objPath;
+        const char* ifcName;
+        const char* propName;
+        MsgArg* val;
+        status = requests[i].Get("(ossv)", &objPath, &ifcName, &propName, &val);
+        if (status == ER_OK) {
+            BusObject* obj = AcquireLocalObject(objPath);
+            if (obj) {
+                status = obj->WriteProp(ifcName, propName, *val, msg->IsEncrypted(), id);
+                obj->InUseDecrement();
+            } else {
+                status = ER_BUS_NO_SUCH_OBJECT;
+            }
+        }
+        results[i] = static_cast<uint16_t>(status);
+    }
+    MsgArg arg("aq", numRequests, results);
+    QCC_DbgPrintf(("SetMultiple %u properties", numRequests));
+    MethodReply(msg, &arg, 1);
+    delete [] results;
 }
 
 void BusObject::GetAllProps(const InterfaceDescription::Member* member, Message& msg)
@@ -334,6 +443,16 @@ void BusObject::Introspect(const InterfaceDescription::Member* member, Message&
     }
 }
 
+void BusObject::IntrospectDigest(const InterfaceDescription::Member* member, Message& msg)
+{
+    /*
+     * Introspect() may be overridden so the digest is taken from whatever it replies with,
+     * MethodReply() turns the XML reply to an IntrospectDigest request into its digest.
+     */
+    const InterfaceDescription* introspectable = bus->GetInterface(org::freedesktop::DBus::Introspectable::InterfaceName);
+    Introspect(introspectable->GetMember("Introspect"), msg);
+}
+
 QStatus BusObject::AddMethodHandler(const InterfaceDescription::Member* member, MessageReceiver::MethodHandler handler, void* handlerContext)
 {
     if (!member) {
@@ -460,6 +579,23 @@ QStatus BusObject::DoRegistration(BusAttachment& busAttachment)
         }
     }
     status = AddMethodHandlers(methodEntries, ArraySize(methodEntries));
+
+    /*
+     * The introspection digest and batched property handlers are installed without adding their
+     * interfaces to the object so the introspection data is the same as for peers that do not know
+     * about them.
+     */
+    if (ER_OK == status) {
+        const InterfaceDescription* digestIntf = bus->GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+        const InterfaceDescription* batchIntf = bus->GetInterface(org::alljoyn::Bus::Properties::InterfaceName);
+        assert(digestIntf && batchIntf);
+        const MethodContext hidden[] = {
+            { digestIntf->GetMember("IntrospectDigest"), static_cast<MessageReceiver::MethodHandler>(&BusObject::IntrospectDigest), NULL },
+            { batchIntf->GetMember("GetMultiple"),       static_cast<MessageReceiver::MethodHandler>(&BusObject::GetMultipleProps), NULL },
+            { batchIntf->GetMember("SetMultiple"),       static_cast<MessageReceiver::MethodHandler>(&BusObject::SetMultipleProps), NULL }
+        };
+        components->methodContexts.insert(components->methodContexts.end(), hidden, hidden + ArraySize(hidden));
+    }
     return status;
 }
 
@@ -561,6 +697,14 @@ QStatus BusObject::MethodReply(const Message& msg, const MsgArg* args, size_t nu
         status = ER_BUS_NO_CALL_FOR_REPLY;
     } else {
         Message reply(*bus);
+        qcc::String digest;
+        MsgArg digestArg;
+        if ((numArgs == 1) && (args[0].typeId == ALLJOYN_STRING) && IsIntrospectDigestCall(msg)) {
+            /* Introspect() answering an IntrospectDigest request, reply with the digest of the XML */
+            digest = IntrospectionCache::Digest(qcc::String(args[0].v_string.str, args[0].v_string.len));
+            digestArg.Set("ay", digest.size(), (const uint8_t*)digest.data());
+            args = &digestArg;
+        }
         status = reply->ReplyMsg(msg, args, numArgs);
         if (status == ER_OK) {
             BusEndpoint bep = BusEndpoint::cast(bus->GetInternal().GetLocalEndpoint());
@@ -23,6 +23,7 @@
 #include <qcc/platform.h>
 
 #include <qcc/Debug.h>
+#include <qcc/SocketStream.h>
 #include <qcc/Util.h>
 #include <qcc/String.h>
 
@@ -33,6 +34,7 @@
 #include "LocalTransport.h"
 #include "ClientRouter.h"
 #include "BusInternal.h"
+#include "RemoteEndpoint.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -41,6 +43,34 @@ using namespace qcc;
 
 namespace ajn {
 
+class _DirectEndpoint;
+typedef qcc::ManagedObj<_DirectEndpoint> DirectEndpoint;
+
+/*
+ * Endpoint for a channel the daemon handed to the two members of a session on the same device
+ */
+class _DirectEndpoint : public _RemoteEndpoint {
+  public:
+    _DirectEndpoint(BusAttachment& bus, SocketFd sock) :
+        _RemoteEndpoint(bus, false, "direct", &stream, "direct"),
+        stream(sock)
+    {
+    }
+
+    virtual ~_DirectEndpoint() { }
+
+  private:
+    SocketStream stream;
+};
+
+/*
+ * A signal sent to all members of a session. On a point-to-point session that is only the peer.
+ */
+static inline bool IsSessionCast(Message& msg)
+{
+    return msg->IsBroadcastSignal() && (msg->GetSessionId() != 0) && !msg->IsGlobalBroadcast() && !msg->IsSessionless();
+}
+
 QStatus ClientRouter::PushMessage(Message& msg, BusEndpoint& sender)
 {
     QStatus status = ER_OK;
@@ -50,9 +80,24 @@ QStatus ClientRouter::PushMessage(Message& msg, BusEndpoint& sender)
     } else {
         if (sender == BusEndpoint::cast(localEndpoint)) {
             localEndpoint->UpdateSerialNumber(msg);
-            status = nonLocalEndpoint->PushMessage(msg);
-        } else {
+            status = msg->EncryptGroupMessage();
+            if (status == ER_OK) {
+                BusEndpoint directEp = FindDirectRoute(msg);
+                status = directEp->IsValid() ? PushDirectMessage(msg, directEp) : ER_BUS_ENDPOINT_CLOSING;
+                if (status == ER_BUS_ENDPOINT_CLOSING) {
+                    status = nonLocalEndpoint->PushMessage(msg);
+                }
+            } else if (status == ER_BUS_AUTHENTICATION_PENDING) {
+                /* Delivery is retried when the authentication completes */
+                status = ER_OK;
+            }
+        } else if (sender->GetEndpointType() == ENDPOINT_TYPE_NULL) {
+            /* Passed by reference from the bundled daemon */
+            status = localEndpoint->PushInProcessMessage(msg);
+        } else if ((sender == nonLocalEndpoint) || IsDirectMessageAllowed(msg, sender)) {
             status = localEndpoint->PushMessage(msg);
+        } else {
+            QCC_DbgHLPrintf(("Discarding %s received on direct route to %s", msg->Description().c_str(), sender->GetUniqueName().c_str()));
         }
     }
 
@@ -69,6 +114,16 @@ QStatus ClientRouter::RegisterEndpoint(BusEndpoint& endpoint)
 
     QCC_DbgHLPrintf(("ClientRouter::RegisterEndpoint"));
 
+    /* Direct routes are registered by AddDirectRoute() before they are started */
+    directLock.Lock(MUTEX_CONTEXT);
+    for (map<SessionId, BusEndpoint>::iterator it = directRoutes.begin(); it != directRoutes.end(); ++it) {
+        if (it->second == endpoint) {
+            directLock.Unlock(MUTEX_CONTEXT);
+            return ER_OK;
+        }
+    }
+    directLock.Unlock(MUTEX_CONTEXT);
+
     /* Keep track of local and (at least one) non-local endpoint */
     if (isLocal) {
         localEndpoint = LocalEndpoint::cast(endpoint);
@@ -100,8 +155,48 @@ void ClientRouter::UnregisterEndpoint(const String& epName, EndpointType epType)
         localEndpoint->GetBus().GetInternal().NonLocalEndpointDisconnected();
         nonLocalEndpoint->Invalidate();
         nonLocalEndpoint = BusEndpoint();
+
+        /* Sessions end when the daemon goes away so close the direct routes too */
+        directLock.Lock(MUTEX_CONTEXT);
+        vector<BusEndpoint> closing;
+        for (map<SessionId, BusEndpoint>::iterator it = directRoutes.begin(); it != directRoutes.end(); ++it) {
+            closing.push_back(it->second);
+        }
+        directLock.Unlock(MUTEX_CONTEXT);
+        for (size_t i = 0; i < closing.size(); ++i) {
+            RemoteEndpoint::cast(closing[i])->Stop();
+        }
+        return;
     }
 
+    /* Drop a direct route whose channel has closed */
+    if (epType == ENDPOINT_TYPE_REMOTE) {
+        set<uint32_t> calls;
+        directLock.Lock(MUTEX_CONTEXT);
+        for (map<SessionId, BusEndpoint>::iterator it = directRoutes.begin(); it != directRoutes.end(); ++it) {
+            if (it->second->GetUniqueName() == epName) {
+                QCC_DbgPrintf(("Direct route for session %u to %s closed", it->first, epName.c_str()));
+                exitedRoutes.push_back(it->second);
+                directRoutes.erase(it);
+                break;
+            }
+        }
+        map<qcc::String, set<uint32_t> >::iterator cit = directCalls.find(epName);
+        if (cit != directCalls.end()) {
+            calls.swap(cit->second);
+            directCalls.erase(cit);
+        }
+        directLock.Unlock(MUTEX_CONTEXT);
+
+        /* The replies to calls sent on the channel can no longer arrive so fail the calls now */
+        if (localEndpoint->IsValid()) {
+            for (set<uint32_t>::iterator it = calls.begin(); it != calls.end(); ++it) {
+                Message reply(localEndpoint->GetBus());
+                reply->ErrorMsg(ER_BUS_ENDPOINT_CLOSING, *it);
+                localEndpoint->PushMessage(reply);
+            }
+        }
+    }
 }
 
 BusEndpoint ClientRouter::FindEndpoint(const qcc::String& busname)
@@ -109,9 +204,171 @@ BusEndpoint ClientRouter::FindEndpoint(const qcc::String& busname)
     return nonLocalEndpoint;
 }
 
+QStatus ClientRouter::AddDirectRoute(SessionId sessionId, const qcc::String& peerName, qcc::SocketFd sockFd)
+{
+    QCC_DbgHLPrintf(("ClientRouter::AddDirectRoute(%u, %s)", sessionId, peerName.c_str()));
+
+    if (!localEndpoint->IsValid()) {
+        qcc::Close(sockFd);
+        return ER_BUS_NO_ENDPOINT;
+    }
+    ReapDirectRoutes();
+
+    DirectEndpoint dep(localEndpoint->GetBus(), sockFd);
+    RemoteEndpoint rep = RemoteEndpoint::cast(dep);
+    rep->EstablishDirect(peerName);
+    BusEndpoint bep = BusEndpoint::cast(rep);
+
+    /*
+     * Direct endpoints are unregistered by name so there can only be one per peer.
+     */
+    directLock.Lock(MUTEX_CONTEXT);
+    bool exists = directRoutes.find(sessionId) != directRoutes.end();
+    for (map<SessionId, BusEndpoint>::iterator it = directRoutes.begin(); !exists && (it != directRoutes.end()); ++it) {
+        exists = (it->second->GetUniqueName() == peerName);
+    }
+    if (!exists) {
+        directRoutes[sessionId] = bep;
+    }
+    directLock.Unlock(MUTEX_CONTEXT);
+    if (exists) {
+        return ER_BUS_NOT_ALLOWED;
+    }
+
+    /* Start() unregisters the endpoint, removing the route, if it fails */
+    QStatus status = rep->Start();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to start direct route to %s", peerName.c_str()));
+    }
+    return status;
+}
+
+void ClientRouter::RemoveDirectRoute(SessionId sessionId)
+{
+    BusEndpoint ep;
+    directLock.Lock(MUTEX_CONTEXT);
+    map<SessionId, BusEndpoint>::iterator it = directRoutes.find(sessionId);
+    if (it != directRoutes.end()) {
+        ep = it->second;
+    }
+    directLock.Unlock(MUTEX_CONTEXT);
+
+    /* The route is dropped when the endpoint exits */
+    if (ep->IsValid()) {
+        QCC_DbgHLPrintf(("ClientRouter::RemoveDirectRoute(%u)", sessionId));
+        RemoteEndpoint::cast(ep)->Stop();
+    }
+}
+
+BusEndpoint ClientRouter::FindDirectRoute(Message& msg)
+{
+    BusEndpoint ep;
+    SessionId sessionId = msg->GetSessionId();
+    if (sessionId != 0) {
+        directLock.Lock(MUTEX_CONTEXT);
+        map<SessionId, BusEndpoint>::iterator it = directRoutes.find(sessionId);
+        if ((it != directRoutes.end()) && ((it->second->GetUniqueName() == msg->GetDestination()) || IsSessionCast(msg))) {
+            ep = it->second;
+        }
+        directLock.Unlock(MUTEX_CONTEXT);
+    }
+    return ep;
+}
+
+bool ClientRouter::IsDirectMessageAllowed(Message& msg, BusEndpoint& sender)
+{
+    /* Only messages from a current direct route that belong on it are allowed */
+    bool allowed = false;
+    directLock.Lock(MUTEX_CONTEXT);
+    for (map<SessionId, BusEndpoint>::iterator it = directRoutes.begin(); it != directRoutes.end(); ++it) {
+        if (it->second == sender) {
+            allowed = (it->first == msg->GetSessionId()) && ((localEndpoint->GetUniqueName() == msg->GetDestination()) || IsSessionCast(msg));
+            if (allowed && ((msg->GetType() == MESSAGE_METHOD_RET) || (msg->GetType() == MESSAGE_ERROR))) {
+                directCalls[sender->GetUniqueName()].erase(msg->GetReplySerial());
+            }
+            break;
+        }
+    }
+    directLock.Unlock(MUTEX_CONTEXT);
+    return allowed;
+}
+
+QStatus ClientRouter::PushDirectMessage(Message& msg, BusEndpoint& directEp)
+{
+    bool expectsReply = (msg->GetType() == MESSAGE_METHOD_CALL) && !(msg->GetFlags() & ALLJOYN_FLAG_NO_REPLY_EXPECTED);
+    uint32_t serial = msg->GetCallSerial();
+    /*
+     * Record the call before sending it so the reply cannot overtake it. Calls that have been
+     * outstanding for a long time have almost certainly timed out so only the latest are kept.
+     */
+    if (expectsReply) {
+        directLock.Lock(MUTEX_CONTEXT);
+        set<uint32_t>& calls = directCalls[directEp->GetUniqueName()];
+        calls.insert(serial);
+        if (calls.size() > MAX_DIRECT_CALLS) {
+            calls.erase(calls.begin());
+        }
+        directLock.Unlock(MUTEX_CONTEXT);
+    }
+    QStatus status = directEp->PushMessage(msg);
+    if (expectsReply && (status != ER_OK)) {
+        /* The reply will not come over the channel */
+        directLock.Lock(MUTEX_CONTEXT);
+        map<qcc::String, set<uint32_t> >::iterator cit = directCalls.find(directEp->GetUniqueName());
+        if (cit != directCalls.end()) {
+            cit->second.erase(serial);
+        }
+        directLock.Unlock(MUTEX_CONTEXT);
+    }
+    return status;
+}
+
+void ClientRouter::ReapDirectRoutes()
+{
+    vector<BusEndpoint> exited;
+    directLock.Lock(MUTEX_CONTEXT);
+    exited.swap(exitedRoutes);
+    directLock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < exited.size(); ++i) {
+        RemoteEndpoint::cast(exited[i])->Join();
+    }
+}
+
+void ClientRouter::StopDirectRoutes()
+{
+    vector<BusEndpoint> routes;
+    directLock.Lock(MUTEX_CONTEXT);
+    for (map<SessionId, BusEndpoint>::iterator it = directRoutes.begin(); it != directRoutes.end(); ++it) {
+        routes.push_back(it->second);
+    }
+    directLock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < routes.size(); ++i) {
+        RemoteEndpoint::cast(routes[i])->Stop();
+    }
+}
+
+void ClientRouter::JoinDirectRoutes()
+{
+    vector<BusEndpoint> routes;
+    directLock.Lock(MUTEX_CONTEXT);
+    for (map<SessionId, BusEndpoint>::iterator it = directRoutes.begin(); it != directRoutes.end(); ++it) {
+        routes.push_back(it->second);
+    }
+    directLock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < routes.size(); ++i) {
+        RemoteEndpoint::cast(routes[i])->Stop();
+    }
+    /* Each endpoint moves itself to exitedRoutes as it exits */
+    for (size_t i = 0; i < routes.size(); ++i) {
+        RemoteEndpoint::cast(routes[i])->Join();
+    }
+    ReapDirectRoutes();
+}
+
 ClientRouter::~ClientRouter()
 {
     QCC_DbgHLPrintf(("ClientRouter::~ClientRouter()"));
+    JoinDirectRoutes();
 }
 
 
@@ -24,9 +24,17 @@
 
 #include <qcc/platform.h>
 
+#include <map>
+#include <set>
+#include <vector>
+
+#include <qcc/Mutex.h>
+#include <qcc/Socket.h>
 #include <qcc/Thread.h>
 #include <qcc/String.h>
 
+#include <alljoyn/Session.h>
+
 #include "Router.h"
 #include "LocalTransport.h"
 
@@ -117,15 +125,98 @@ class ClientRouter : public Router {
      */
     void SetGlobalGUID(const qcc::GUID128& guid) { }
 
+    /**
+     * Add a direct route to the other member of a point-to-point session on the same device.
+     * Messages on the session that are addressed to the peer's unique name and signals sent to
+     * the whole session are sent over the channel instead of through the daemon.
+     *
+     * @param sessionId  The session the channel belongs to.
+     * @param peerName   Unique name of the other member of the session.
+     * @param sockFd     This member's end of the channel. The router takes ownership.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - ER_BUS_NOT_ALLOWED if there is already a direct route for the session or the peer
+     *      - An error status otherwise
+     */
+    QStatus AddDirectRoute(SessionId sessionId, const qcc::String& peerName, qcc::SocketFd sockFd);
+
+    /**
+     * Close the direct route for a session if there is one. Messages for the session go through
+     * the daemon again.
+     *
+     * @param sessionId  The session that was left or lost.
+     */
+    void RemoveDirectRoute(SessionId sessionId);
+
+    /**
+     * Stop all direct routes without waiting for them to exit.
+     */
+    void StopDirectRoutes();
+
+    /**
+     * Stop all direct routes and wait for their endpoints to exit.
+     */
+    void JoinDirectRoutes();
+
     /**
      * Destructor
      */
     ~ClientRouter();
 
   private:
+
+    /**
+     * Get the direct route for a message sent by the local endpoint.
+     *
+     * @param msg  The message.
+     *
+     * @return  The endpoint to send the message on or an invalid endpoint if the message goes
+     *          through the daemon.
+     */
+    BusEndpoint FindDirectRoute(Message& msg);
+
+    /**
+     * Send a message on a direct route. Method calls that expect a reply are recorded so they
+     * can be failed if the channel closes before the reply arrives.
+     *
+     * @param msg       The message.
+     * @param directEp  The direct endpoint to send the message on.
+     *
+     * @return  The status from pushing the message on the direct endpoint.
+     */
+    QStatus PushDirectMessage(Message& msg, BusEndpoint& directEp);
+
+    /**
+     * Check a message received on a direct route. Only the peer can send on the channel and it
+     * may only send messages for its session that are addressed to this bus attachment or
+     * signals sent to the whole session.
+     *
+     * @param msg     The message.
+     * @param sender  Endpoint that received the message.
+     *
+     * @return  true if sender is a direct route and the message belongs on it.
+     */
+    bool IsDirectMessageAllowed(Message& msg, BusEndpoint& sender);
+
+    /**
+     * Join and release direct endpoints that have exited.
+     */
+    void ReapDirectRoutes();
+
     LocalEndpoint localEndpoint;   /**< Local endpoint */
     BusEndpoint nonLocalEndpoint;  /**< Last non-local enpoint to register */
 
+    std::map<SessionId, BusEndpoint> directRoutes;  /**< Direct channels to same-device session peers */
+    std::vector<BusEndpoint> exitedRoutes;          /**< Direct endpoints waiting to be joined */
+    std::map<qcc::String, std::set<uint32_t> > directCalls;  /**< Serials of calls awaiting a reply on each direct route */
+    qcc::Mutex directLock;                          /**< Protects directRoutes, exitedRoutes and directCalls */
+
+    /**
+     * Maximum number of calls awaiting a reply that are tracked for each direct route
+     */
+    static const size_t MAX_DIRECT_CALLS = 1024;
+
 };
 
 }
@@ -24,6 +24,8 @@
 #include <qcc/String.h>
 #include <qcc/StringMapKey.h>
 #include <map>
+#include <vector>
+#include <string.h>
 #include <alljoyn/AllJoynStd.h>
 #include <alljoyn/Status.h>
 
@@ -198,6 +200,84 @@ bool InterfaceDescription::Property::operator==(const Property& o) const {
 }
 
 
+/*
+ * Flat open-addressed hash index over the members or properties of an activated interface. The
+ * index is built once when the interface is activated, after which the definitions are immutable,
+ * so lookups are a hash and usually a single string compare rather than a walk down a tree.
+ */
+template <typename T>
+class FrozenIndex {
+  public:
+
+    FrozenIndex() : mask(0) { }
+
+    void Build(const std::map<qcc::StringMapKey, T>& defs)
+    {
+        slots.clear();
+        mask = 0;
+        if (defs.empty()) {
+            return;
+        }
+        /* Table size is a power of two at least twice the number of entries to keep probe sequences short */
+        size_t size = 4;
+        while (size < (2 * defs.size())) {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+        typename std::map<qcc::StringMapKey, T>::const_iterator it = defs.begin();
+        for (; it != defs.end(); ++it) {
+            uint32_t hash = Hash(it->second.name.c_str());
+            size_t i = hash & mask;
+            while (slots[i].value) {
+                i = (i + 1) & mask;
+            }
+            slots[i].hash = hash;
+            slots[i].value = &it->second;
+        }
+    }
+
+    void Clear()
+    {
+        slots.clear();
+        mask = 0;
+    }
+
+    bool IsBuilt() const { return !slots.empty(); }
+
+    const T* Find(const char* name) const
+    {
+        uint32_t hash = Hash(name);
+        for (size_t i = hash & mask; slots[i].value; i = (i + 1) & mask) {
+            if ((slots[i].hash == hash) && (strcmp(slots[i].value->name.c_str(), name) == 0)) {
+                return slots[i].value;
+            }
+        }
+        return NULL;
+    }
+
+  private:
+
+    struct Slot {
+        uint32_t hash;
+        const T* value;
+        Slot() : hash(0), value(NULL) { }
+    };
+
+    /* FNV-1a */
+    static uint32_t Hash(const char* name)
+    {
+        uint32_t hash = 2166136261u;
+        while (*name) {
+            hash = (hash ^ (uint8_t)*name++) * 16777619u;
+        }
+        return hash;
+    }
+
+    std::vector<Slot> slots;
+    size_t mask;
+};
+
 struct InterfaceDescription::Definitions {
     typedef std::map<qcc::StringMapKey, Member> MemberMap;
     typedef std::map<qcc::StringMapKey, Property> PropertyMap;
@@ -206,9 +286,18 @@ struct InterfaceDescription::Definitions {
     PropertyMap properties;         /**< Interface properties */
     AnnotationsMap annotations;     /**< Interface Annotations */
 
+    FrozenIndex<Member> memberIndex;     /**< Index of members, built when the interface is activated */
+    FrozenIndex<Property> propertyIndex; /**< Index of properties, built when the interface is activated */
+
     Definitions() { }
     Definitions(const MemberMap& m, const PropertyMap& p, const AnnotationsMap& a) :
         members(m), properties(p), annotations(a) { }
+
+    void BuildIndex()
+    {
+        memberIndex.Build(members);
+        propertyIndex.Build(properties);
+    }
 };
 
 bool InterfaceDescription::Member::GetAnnotation(const qcc::String& name, qcc::String& value) const
@@ -263,10 +352,25 @@ InterfaceDescription& InterfaceDescription::operator=(const InterfaceDescription
         while (mit != defs->members.end()) {
             mit++->second.iface = this;
         }
+        /* The index points into the maps that were just replaced */
+        if (isActivated) {
+            defs->BuildIndex();
+        } else {
+            defs->memberIndex.Clear();
+            defs->propertyIndex.Clear();
+        }
     }
     return *this;
 }
 
+void InterfaceDescription::Activate()
+{
+    if (!isActivated) {
+        defs->BuildIndex();
+        isActivated = true;
+    }
+}
+
 bool InterfaceDescription::IsSecure() const
 {
     AnnotationsMap::const_iterator it = defs->annotations.find(org::alljoyn::Bus::Secure);
@@ -493,6 +597,9 @@ size_t InterfaceDescription::GetProperties(const Property** props, size_t numPro
 
 const InterfaceDescription::Property* InterfaceDescription::GetProperty(const char* name) const
 {
+    if (defs->propertyIndex.IsBuilt()) {
+        return defs->propertyIndex.Find(name);
+    }
     Definitions::PropertyMap::const_iterator pit = defs->properties.find(qcc::StringMapKey(name));
     return (pit == defs->properties.end()) ? NULL : &(pit->second);
 }
@@ -512,6 +619,9 @@ size_t InterfaceDescription::GetMembers(const Member** members, size_t numMember
 
 const InterfaceDescription::Member* InterfaceDescription::GetMember(const char* name) const
 {
+    if (defs->memberIndex.IsBuilt()) {
+        return defs->memberIndex.Find(name);
+    }
     Definitions::MemberMap::const_iterator mit = defs->members.find(qcc::StringMapKey(name));
     return (mit == defs->members.end()) ? NULL : &(mit->second);
 }
@@ -0,0 +1,264 @@
+/**
+ * @file
+ * Implementation of IntrospectionCache methods.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/Crypto.h>
+#include <qcc/FileStream.h>
+#include <qcc/Mutex.h>
+
+#include "IntrospectionCache.h"
+
+#include <alljoyn/Status.h>
+
+#include <vector>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+
+namespace ajn {
+
+/*
+ * Version number of the cache file format. The version is followed by entries up to the end of the
+ * file, each entry is a digest, a length and the XML. Entries are in least to most recently used
+ * order so later entries for a digest replace earlier ones.
+ */
+static const uint16_t IntrospectionCacheVersion = 0x0002;
+
+/*
+ * Upper bounds on the number of cached documents and the size of a cached document
+ */
+static const size_t MaxEntries = 256;
+static const uint32_t MaxXmlLen = 1024 * 1024;
+
+/*
+ * The cache file is rewritten when it holds this many entries, most of them are evicted ones
+ */
+static const uint32_t MaxFileRecords = 2 * MaxEntries;
+
+qcc::String IntrospectionCache::Digest(const qcc::String& xml)
+{
+    Crypto_SHA1 sha1;
+    uint8_t digest[Crypto_SHA1::DIGEST_SIZE];
+    sha1.Init();
+    sha1.Update(xml);
+    sha1.GetDigest(digest);
+    return qcc::String((const char*)digest, sizeof(digest));
+}
+
+void IntrospectionCache::Insert(const qcc::String& digest, const qcc::String& xml)
+{
+    std::map<qcc::String, Entry>::iterator it = entries.find(digest);
+    if (it != entries.end()) {
+        lru.splice(lru.begin(), lru, it->second.lruPos);
+    } else {
+        if (entries.size() >= MaxEntries) {
+            entries.erase(lru.back());
+            lru.pop_back();
+        }
+        lru.push_front(digest);
+        it = entries.insert(std::pair<qcc::String, Entry>(digest, Entry())).first;
+        it->second.lruPos = lru.begin();
+    }
+    it->second.xml = xml;
+}
+
+QStatus IntrospectionCache::Load(const qcc::String& fileName)
+{
+    QStatus status = ER_OK;
+    uint32_t dropped = 0;
+
+    fileLock.Lock(MUTEX_CONTEXT);
+    lock.Lock(MUTEX_CONTEXT);
+    this->fileName = fileName;
+    entries.clear();
+    lru.clear();
+    /* The next store rewrites the file */
+    delete sink;
+    sink = NULL;
+    records = 0;
+
+    FileSource source(fileName);
+    if (source.IsValid()) {
+        uint16_t version;
+        size_t pulled;
+        source.Lock(true);
+        status = source.PullBytes(&version, sizeof(version), pulled);
+        if ((status == ER_OK) && (version != IntrospectionCacheVersion)) {
+            /* Treat a cache from an incompatible version as empty, it will be overwritten */
+            status = ER_NONE;
+        }
+        while (status == ER_OK) {
+            char digest[DIGEST_SIZE];
+            uint32_t len = 0;
+            status = source.PullBytes(digest, sizeof(digest), pulled);
+            if ((status == ER_OK) && (pulled != sizeof(digest))) {
+                status = ER_BUS_READ_ERROR;
+            }
+            if (status == ER_OK) {
+                status = source.PullBytes(&len, sizeof(len), pulled);
+                if ((status == ER_OK) && (pulled != sizeof(len))) {
+                    status = ER_BUS_READ_ERROR;
+                }
+            }
+            if ((status == ER_OK) && (len > MaxXmlLen)) {
+                status = ER_BUS_READ_ERROR;
+            }
+            if (status == ER_OK) {
+                char* xml = new char[len];
+                status = source.PullBytes(xml, len, pulled);
+                if ((status == ER_OK) && (pulled == len)) {
+                    /* The file could have been altered, only trust entries that match their digest */
+                    qcc::String entryXml(xml, len);
+                    qcc::String entryDigest(digest, sizeof(digest));
+                    if (Digest(entryXml) == entryDigest) {
+                        Insert(entryDigest, entryXml);
+                    } else {
+                        ++dropped;
+                    }
+                } else {
+                    status = ER_BUS_READ_ERROR;
+                }
+                delete [] xml;
+            }
+        }
+        source.Unlock();
+        /*
+         * A partially written entry is expected if we stopped while appending to the file. We keep
+         * the entries we could read and rewrite the file on the next store.
+         */
+        if ((status != ER_NONE) && (status != ER_OK)) {
+            QCC_LogError(status, ("Introspection cache %s is corrupt after %u entries", fileName.c_str(), (uint32_t)entries.size()));
+        }
+        if (dropped) {
+            QCC_LogError(ER_BUS_READ_ERROR, ("Dropped %u introspection cache entries from %s that do not match their digest", dropped, fileName.c_str()));
+        }
+        status = ER_OK;
+        QCC_DbgHLPrintf(("Loaded %u introspection cache entries from %s", (uint32_t)entries.size(), fileName.c_str()));
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    fileLock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+bool IntrospectionCache::Find(const qcc::String& digest, qcc::String& xml)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    std::map<qcc::String, Entry>::iterator it = entries.find(digest);
+    bool found = (it != entries.end());
+    if (found) {
+        lru.splice(lru.begin(), lru, it->second.lruPos);
+        xml = it->second.xml;
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return found;
+}
+
+QStatus IntrospectionCache::Add(const qcc::String& xml)
+{
+    QStatus status = ER_OK;
+    if (xml.size() > MaxXmlLen) {
+        return ER_BUS_BAD_LENGTH;
+    }
+    qcc::String digest = Digest(xml);
+
+    lock.Lock(MUTEX_CONTEXT);
+    bool added = (entries.find(digest) == entries.end());
+    Insert(digest, xml);
+    lock.Unlock(MUTEX_CONTEXT);
+
+    /* The file is written without holding the lock so lookups are not held up */
+    if (added) {
+        fileLock.Lock(MUTEX_CONTEXT);
+        status = Store(digest, xml);
+        fileLock.Unlock(MUTEX_CONTEXT);
+    }
+    return status;
+}
+
+QStatus IntrospectionCache::Store(const qcc::String& digest, const qcc::String& xml)
+{
+    QStatus status = ER_OK;
+    if (fileName.empty()) {
+        return status;
+    }
+    size_t pushed;
+    if (!sink || (records >= MaxFileRecords)) {
+        /*
+         * Rewrite the file with the current entries, least recently used first. The new entry is
+         * already one of them.
+         */
+        std::vector<std::pair<qcc::String, qcc::String> > snapshot;
+        lock.Lock(MUTEX_CONTEXT);
+        snapshot.reserve(entries.size());
+        for (std::list<qcc::String>::reverse_iterator it = lru.rbegin(); it != lru.rend(); ++it) {
+            snapshot.push_back(std::pair<qcc::String, qcc::String>(*it, entries[*it].xml));
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+
+        delete sink;
+        sink = new FileSink(fileName, FileSink::PRIVATE);
+        records = 0;
+        if (sink->IsValid()) {
+            sink->Lock(true);
+            status = sink->PushBytes(&IntrospectionCacheVersion, sizeof(IntrospectionCacheVersion), pushed);
+            for (size_t i = 0; (status == ER_OK) && (i < snapshot.size()); ++i) {
+                uint32_t len = snapshot[i].second.size();
+                status = sink->PushBytes(snapshot[i].first.data(), snapshot[i].first.size(), pushed);
+                if (status == ER_OK) {
+                    status = sink->PushBytes(&len, sizeof(len), pushed);
+                }
+                if (status == ER_OK) {
+                    status = sink->PushBytes(snapshot[i].second.data(), len, pushed);
+                }
+                ++records;
+            }
+            sink->Unlock();
+        } else {
+            status = ER_BUS_WRITE_ERROR;
+        }
+    } else {
+        uint32_t len = xml.size();
+        sink->Lock(true);
+        status = sink->PushBytes(digest.data(), digest.size(), pushed);
+        if (status == ER_OK) {
+            status = sink->PushBytes(&len, sizeof(len), pushed);
+        }
+        if (status == ER_OK) {
+            status = sink->PushBytes(xml.data(), len, pushed);
+        }
+        sink->Unlock();
+        ++records;
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Cannot write introspection cache to %s", fileName.c_str()));
+        /* Rewrite the file on the next store */
+        delete sink;
+        sink = NULL;
+    }
+    return status;
+}
+
+}
@@ -0,0 +1,143 @@
+/**
+ * @file
+ * Class for caching introspection data of remote objects across application restarts
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_INTROSPECTION_CACHE_H
+#define _ALLJOYN_INTROSPECTION_CACHE_H
+
+#ifndef __cplusplus
+#error Only include IntrospectionCache.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+#include <qcc/String.h>
+#include <qcc/Mutex.h>
+#include <qcc/FileStream.h>
+
+#include <alljoyn/Status.h>
+
+#include <map>
+#include <list>
+
+namespace ajn {
+
+/**
+ * The introspection cache holds introspection XML indexed by a digest of the XML. A remote object
+ * can be asked for the digest of its introspection data, which is much smaller than the data itself,
+ * so a client that has seen an identical object before, from this or any other peer, can skip
+ * transferring the XML. The cache is kept in a file so it survives application restarts.
+ *
+ * New entries are appended to the file, the file is only rewritten when it has accumulated
+ * too many entries that have since been evicted.
+ */
+class IntrospectionCache {
+
+  public:
+
+    /**
+     * Size of an introspection digest
+     */
+    static const size_t DIGEST_SIZE = 20;
+
+    /**
+     * Compute the digest of introspection XML.
+     *
+     * @param xml  The introspection XML.
+     *
+     * @return The digest as a string of DIGEST_SIZE bytes.
+     */
+    static qcc::String Digest(const qcc::String& xml);
+
+    /**
+     * Constructor
+     */
+    IntrospectionCache() : sink(NULL), records(0) { }
+
+    /**
+     * Destructor
+     */
+    ~IntrospectionCache() { delete sink; }
+
+    /**
+     * Load the cache from a file. Any entries already in the cache are discarded.
+     *
+     * @param fileName  The file to load the cache from and store it to.
+     *
+     * @return ER_OK if the cache was loaded or the file does not exist yet.
+     */
+    QStatus Load(const qcc::String& fileName);
+
+    /**
+     * Look up the introspection XML for a digest. A hit makes the entry the most recently used.
+     *
+     * @param digest    The digest of the introspection XML.
+     * @param[out] xml  Returns the introspection XML.
+     *
+     * @return true if the cache has XML for the digest.
+     */
+    bool Find(const qcc::String& digest, qcc::String& xml);
+
+    /**
+     * Add introspection XML to the cache and append it to the cache file. If the cache is full the
+     * least recently used entry is evicted.
+     *
+     * @param xml  The introspection XML.
+     *
+     * @return ER_OK if the XML was added and the cache stored.
+     */
+    QStatus Add(const qcc::String& xml);
+
+  private:
+
+    /**
+     * Copy constructor and assignment are private
+     */
+    IntrospectionCache(const IntrospectionCache& other);
+    IntrospectionCache& operator=(const IntrospectionCache& other);
+
+    /** A cached document and its position in the lru list */
+    struct Entry {
+        qcc::String xml;
+        std::list<qcc::String>::iterator lruPos;
+    };
+
+    /**
+     * Add an entry evicting the least recently used entry if the cache is full. Must be called
+     * with the lock held.
+     */
+    void Insert(const qcc::String& digest, const qcc::String& xml);
+
+    /**
+     * Append an entry to the cache file, or rewrite the file if it has not been opened yet or holds
+     * too many evicted entries. Must be called with the fileLock held.
+     */
+    QStatus Store(const qcc::String& digest, const qcc::String& xml);
+
+    qcc::Mutex lock;                       /**< Protects entries and lru */
+    qcc::Mutex fileLock;                   /**< Serializes writes to the cache file */
+    qcc::String fileName;
+    std::map<qcc::String, Entry> entries;  /**< Entries indexed by digest */
+    std::list<qcc::String> lru;            /**< Digests, most recently used first */
+    qcc::FileSink* sink;                   /**< The cache file being appended to or NULL */
+    uint32_t records;                      /**< Number of entries in the cache file */
+};
+
+}
+
+#endif
@@ -20,6 +20,7 @@
  *    limitations under the License.
  ******************************************************************************/
 
+#include <algorithm>
 #include <map>
 
 #include <qcc/platform.h>
@@ -59,6 +60,50 @@ static const uint16_t LowStoreVersion = 0x0102;
  */
 static const uint16_t KeyStoreVersion = 0x0103;
 
+/*
+ * Current key store journal version
+ */
+static const uint16_t JournalVersion = 0x0001;
+
+/*
+ * Journal record types
+ */
+static const uint8_t JournalAddKey = 1;
+static const uint8_t JournalDelKey = 2;
+
+/*
+ * Size of the header that is authenticated for each journal record: type, revision and GUID
+ */
+static const size_t JournalHdrLen = 1 + sizeof(uint32_t) + qcc::GUID128::SIZE;
+
+/*
+ * Length of the random nonce used to encrypt a journal record
+ */
+static const size_t JournalNonceLen = 8;
+
+/*
+ * Length of the MAC on encrypted key store data
+ */
+static const uint8_t KeyStoreMACLen = 16;
+
+/*
+ * Sanity checks on the length of the encrypted keys and of a journal record
+ */
+static const size_t MaxKeyStoreLen = 16 * 1024 * 1024;
+static const size_t MaxJournalRecordLen = 64000;
+
+/*
+ * The journal is compacted when it has more than this many records or more than a quarter as
+ * many records as there are keys, whichever is larger. This bounds the time to load the journal
+ * and keeps the amortized cost of compaction constant as the number of keys grows.
+ */
+static const size_t MinJournalRecords = 64;
+
+/*
+ * How long to coalesce changes before a scheduled store happens
+ */
+static const uint32_t StoreDelay = 100;
+
 
 QStatus KeyStoreListener::PutKeys(KeyStore& keyStore, const qcc::String& source, const qcc::String& password)
 {
@@ -80,12 +125,18 @@ class DefaultKeyStoreListener : public KeyStoreListener {
 
   public:
 
-    DefaultKeyStoreListener(const qcc::String& application, const char* fname) {
+    DefaultKeyStoreListener(const qcc::String& application, const char* fname) : journalSink(NULL), lockSink(NULL) {
         if (fname) {
             fileName = GetHomeDir() + "/" + fname;
         } else {
             fileName = GetHomeDir() + "/.alljoyn_keystore/" + application;
         }
+        journalName = fileName + ".journal";
+    }
+
+    ~DefaultKeyStoreListener() {
+        delete journalSink;
+        delete lockSink;
     }
 
     QStatus LoadRequest(KeyStore& keyStore) {
@@ -100,6 +151,9 @@ class DefaultKeyStoreListener : public KeyStoreListener {
                     QCC_DbgHLPrintf(("Read key store from %s", fileName.c_str()));
                 }
                 source.Unlock();
+                if (status == ER_OK) {
+                    status = LoadJournal(keyStore);
+                }
                 return status;
             }
         }
@@ -133,12 +187,89 @@ class DefaultKeyStoreListener : public KeyStoreListener {
 
     QStatus StoreRequest(KeyStore& keyStore) {
         QStatus status;
+        /*
+         * Stores can come from the key store's timer as well as from the application.
+         */
+        storeLock.Lock(MUTEX_CONTEXT);
+        /*
+         * Write all the keys if it is time to compact the journal, otherwise append the changes
+         */
+        if (keyStore.NeedsCompaction()) {
+            status = StoreAll(keyStore);
+        } else {
+            status = StoreJournal(keyStore);
+        }
+        storeLock.Unlock(MUTEX_CONTEXT);
+        return status;
+    }
+
+    /*
+     * Hold off stores from other threads and from other applications sharing the key store. The
+     * key store file itself is locked by each load and store so a separate lock file is used.
+     */
+    void LockStore() {
+        reloadLock.Lock(MUTEX_CONTEXT);
+        lockSink = new FileSink(fileName + ".lock", FileSink::PRIVATE);
+        if (lockSink->IsValid()) {
+            lockSink->Lock(true);
+        } else {
+            QCC_LogError(ER_BUS_WRITE_ERROR, ("Cannot lock key store %s", fileName.c_str()));
+        }
+    }
+
+    void UnlockStore() {
+        if (lockSink->IsValid()) {
+            lockSink->Unlock();
+        }
+        delete lockSink;
+        lockSink = NULL;
+        reloadLock.Unlock(MUTEX_CONTEXT);
+    }
+
+    /*
+     * Merge the changes other applications sharing the key store have appended to the journal
+     */
+    QStatus ReloadJournal(KeyStore& keyStore) {
+        QStatus status = ER_BUS_KEYSTORE_NOT_LOADED;
+        FileSource source(journalName);
+        if (source.IsValid()) {
+            source.Lock(true);
+            status = keyStore.PullJournalChanges(source);
+            source.Unlock();
+        }
+        return status;
+    }
+
+  private:
+
+    QStatus StoreAll(KeyStore& keyStore) {
+        QStatus status;
+        /*
+         * The journal is now stale, the next journal store starts a new one.
+         */
+        delete journalSink;
+        journalSink = NULL;
         FileSink sink(fileName, FileSink::PRIVATE);
         if (sink.IsValid()) {
             sink.Lock(true);
             status = keyStore.Push(sink);
             if (status == ER_OK) {
                 QCC_DbgHLPrintf(("Wrote key store to %s", fileName.c_str()));
+                /*
+                 * Start a new journal, the changes the old journal held are now in the key store.
+                 * Writing the journal header lets applications sharing the key store tell that
+                 * the key store has not changed since.
+                 */
+                journalSink = new FileSink(journalName, FileSink::PRIVATE);
+                if (journalSink->IsValid()) {
+                    journalSink->Lock(true);
+                    keyStore.PushJournal(*journalSink, false);
+                    journalSink->Unlock();
+                }
+                if (!journalSink->IsValid() || keyStore.IsShared()) {
+                    delete journalSink;
+                    journalSink = NULL;
+                }
             }
             sink.Unlock();
         } else {
@@ -148,28 +279,94 @@ class DefaultKeyStoreListener : public KeyStoreListener {
         return status;
     }
 
-  private:
+    QStatus LoadJournal(KeyStore& keyStore) {
+        QStatus status = ER_OK;
+        FileSource source(journalName);
+        if (source.IsValid()) {
+            source.Lock(true);
+            status = keyStore.PullJournal(source);
+            if (status == ER_OK) {
+                QCC_DbgHLPrintf(("Read key store journal from %s", journalName.c_str()));
+            }
+            source.Unlock();
+        }
+        return status;
+    }
+
+    QStatus StoreJournal(KeyStore& keyStore) {
+        QStatus status;
+        /*
+         * We keep the journal open and append to it. A shared key store may have been
+         * written by another application so in that case we rewrite the whole journal.
+         */
+        bool append = (journalSink != NULL) && !keyStore.IsShared();
+        if (!append) {
+            delete journalSink;
+            journalSink = new FileSink(journalName, FileSink::PRIVATE);
+        }
+        if (journalSink->IsValid()) {
+            journalSink->Lock(true);
+            status = keyStore.PushJournal(*journalSink, append);
+            if (status == ER_OK) {
+                QCC_DbgHLPrintf(("%s key store journal %s", append ? "Appended to" : "Wrote", journalName.c_str()));
+            }
+            journalSink->Unlock();
+        } else {
+            status = ER_BUS_WRITE_ERROR;
+            QCC_LogError(status, ("Cannot write key store journal to %s", journalName.c_str()));
+        }
+        if ((status != ER_OK) || keyStore.IsShared()) {
+            delete journalSink;
+            journalSink = NULL;
+        }
+        return status;
+    }
 
     qcc::String fileName;
 
+    qcc::String journalName;
+
+    /**
+     * The open journal, NULL if the journal must be rewritten before it can be appended to.
+     */
+    FileSink* journalSink;
+
+    /**
+     * The lock file held while a shared key store is reloaded and written.
+     */
+    FileSink* lockSink;
+
+    qcc::Mutex storeLock;
+
+    /**
+     * Held with the lock file, taken before storeLock.
+     */
+    qcc::Mutex reloadLock;
+
 };
 
 KeyStore::KeyStore(const qcc::String& application) :
     application(application),
     storeState(UNAVAILABLE),
     keys(new KeyMap),
+    journalBase(0),
+    compact(true),
     defaultListener(NULL),
     listener(NULL),
     thisGuid(),
     keyStoreKey(NULL),
+    revision(0),
     shared(false),
     stored(NULL),
-    loaded(NULL)
+    loaded(NULL),
+    storeTimer(NULL),
+    storePending(false)
 {
 }
 
 KeyStore::~KeyStore()
 {
+    StopStoreTimer();
     /* Unblock thread that might be waiting for a store to complete */
     lock.Lock(MUTEX_CONTEXT);
     if (stored) {
@@ -215,6 +412,7 @@ QStatus KeyStore::SetDefaultListener()
 QStatus KeyStore::Reset()
 {
     if (storeState != UNAVAILABLE) {
+        StopStoreTimer();
         QStatus status = Clear();
         storeState = UNAVAILABLE;
         delete listener;
@@ -252,6 +450,14 @@ QStatus KeyStore::Store()
     }
     /* Don't store if not modified */
     if (storeState == MODIFIED) {
+        /*
+         * Applications sharing the key store must not interleave their reload and write or one
+         * could overwrite the records the other has just written.
+         */
+        DefaultKeyStoreListener* storeListener = (shared && defaultListener) ? static_cast<DefaultKeyStoreListener*>(defaultListener) : NULL;
+        if (storeListener) {
+            storeListener->LockStore();
+        }
 
         lock.Lock(MUTEX_CONTEXT);
         EraseExpiredKeys();
@@ -276,10 +482,70 @@ QStatus KeyStore::Store()
             deletions.clear();
         }
         lock.Unlock(MUTEX_CONTEXT);
+        if (storeListener) {
+            storeListener->UnlockStore();
+        }
+    }
+    return status;
+}
+
+QStatus KeyStore::ScheduleStore()
+{
+    /* Cannot store if never loaded */
+    if (storeState == UNAVAILABLE) {
+        return ER_BUS_KEYSTORE_NOT_LOADED;
+    }
+    QStatus status = ER_OK;
+    lock.Lock(MUTEX_CONTEXT);
+    if (!storePending) {
+        if (!storeTimer) {
+            storeTimer = new Timer("keyStore", true);
+            status = storeTimer->Start();
+            if (status != ER_OK) {
+                delete storeTimer;
+                storeTimer = NULL;
+            }
+        }
+        if (status == ER_OK) {
+            uint32_t delay = StoreDelay;
+            Alarm alarm(delay, this);
+            status = storeTimer->AddAlarm(alarm);
+        }
+        storePending = (status == ER_OK);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    /* Store now if the store could not be scheduled */
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to schedule storing the key store"));
+        status = Store();
     }
     return status;
 }
 
+void KeyStore::AlarmTriggered(const Alarm& alarm, QStatus reason)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    storePending = false;
+    lock.Unlock(MUTEX_CONTEXT);
+    QStatus status = Store();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to store the key store"));
+    }
+}
+
+void KeyStore::StopStoreTimer()
+{
+    /*
+     * The timer expires any pending alarm when it is stopped so a scheduled store is not lost.
+     */
+    if (storeTimer) {
+        storeTimer->Stop();
+        storeTimer->Join();
+        delete storeTimer;
+        storeTimer = NULL;
+    }
+}
+
 QStatus KeyStore::Load()
 {
     QStatus status;
@@ -370,7 +636,7 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
         goto ExitPull;
     }
     /* Sanity check on the length */
-    if (len > 64000) {
+    if (len > MaxKeyStoreLen) {
         status = ER_BUS_CORRUPT_KEYSTORE;
         goto ExitPull;
     }
@@ -390,7 +656,7 @@ QStatus KeyStore::Pull(Source& source, const qcc::String& password)
              */
             KeyBlob nonce((uint8_t*)&revision, sizeof(revision), KeyBlob::GENERIC);
             Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
-            status = aes.Decrypt_CCM(data, data, len, nonce, NULL, 0, 16);
+            status = aes.Decrypt_CCM(data, data, len, nonce, NULL, 0, KeyStoreMACLen);
             /*
              * Unpack the guid/key pairs from an intermediate string source.
              */
@@ -443,6 +709,13 @@ ExitPull:
         keys->clear();
         storeState = MODIFIED;
     }
+    /*
+     * Any journal we pull next must belong to this revision. An empty or unreadable key store
+     * has to be stored in full before we can start a journal.
+     */
+    journal.clear();
+    journalBase = revision;
+    compact = (status != ER_OK) || (revision == 0);
     if (loaded) {
         loaded->SetEvent();
     }
@@ -458,8 +731,9 @@ QStatus KeyStore::Clear()
     lock.Lock(MUTEX_CONTEXT);
     keys->clear();
     storeState = MODIFIED;
-    revision = 0;
     deletions.clear();
+    additions.clear();
+    compact = true;
     lock.Unlock(MUTEX_CONTEXT);
     listener->StoreRequest(*this);
     return ER_OK;
@@ -481,12 +755,24 @@ QStatus KeyStore::Reload()
     if (!shared) {
         return ER_OK;
     }
+    /*
+     * The default listener can catch up on the changes other applications have appended to the
+     * journal. We only need to reload all the keys if the journal was compacted or rewritten.
+     */
+    if (defaultListener && (static_cast<DefaultKeyStoreListener*>(defaultListener)->ReloadJournal(*this) == ER_OK)) {
+        return ER_OK;
+    }
 
     lock.Lock(MUTEX_CONTEXT);
     QStatus status;
     uint32_t currentRevision = revision;
     KeyMap* currentKeys = keys;
     keys = new KeyMap();
+    /* Load() starts a new journal so keep ours in case there is nothing to merge */
+    std::vector<qcc::String> currentJournal;
+    currentJournal.swap(journal);
+    uint32_t currentJournalBase = journalBase;
+    bool currentCompact = compact;
 
     /*
      * Load the keys so we can check for changes and merge if needed
@@ -539,6 +825,9 @@ QStatus KeyStore::Reload()
         keys = currentKeys;
         delete goner;
         revision = currentRevision;
+        journal.swap(currentJournal);
+        journalBase = currentJournalBase;
+        compact = currentCompact;
     }
 
     lock.Unlock(MUTEX_CONTEXT);
@@ -596,9 +885,9 @@ QStatus KeyStore::Push(Sink& sink)
          * Encrypt keys.
          */
         KeyBlob nonce((uint8_t*)&revision, sizeof(revision), KeyBlob::GENERIC);
-        uint8_t* keysData = new uint8_t[keysLen + 16];
+        uint8_t* keysData = new uint8_t[keysLen + KeyStoreMACLen];
         Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
-        status = aes.Encrypt_CCM(strSink.GetString().data(), keysData, keysLen, nonce, NULL, 0, 16);
+        status = aes.Encrypt_CCM(strSink.GetString().data(), keysData, keysLen, nonce, NULL, 0, KeyStoreMACLen);
         /* Store the length of the encrypted keys */
         if (status == ER_OK) {
             status = sink.PushBytes(&keysLen, sizeof(keysLen), pushed);
@@ -615,6 +904,15 @@ QStatus KeyStore::Push(Sink& sink)
         goto ExitPush;
     }
     storeState = LOADED;
+    /*
+     * All the keys have been pushed so start a new journal. The deleted keys are not in the keys
+     * that were pushed so there is nothing left to record for them either.
+     */
+    journal.clear();
+    journalBase = revision;
+    additions.clear();
+    deletions.clear();
+    compact = false;
 
 ExitPush:
 
@@ -625,6 +923,310 @@ ExitPush:
     return status;
 }
 
+bool KeyStore::NeedsCompaction()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    size_t records = journal.size() + additions.size() + deletions.size();
+    bool needed = compact || (records > max(MinJournalRecords, keys->size() / 4));
+    lock.Unlock(MUTEX_CONTEXT);
+    return needed;
+}
+
+QStatus KeyStore::EncodeJournalRecord(Crypto_AES& aes, const qcc::GUID128& guid, KeyRecord* keyRec, qcc::String& record)
+{
+    size_t pushed;
+    uint8_t type = keyRec ? JournalAddKey : JournalDelKey;
+    uint32_t rev = keyRec ? keyRec->revision : revision;
+    /*
+     * The record header is authenticated but not encrypted.
+     */
+    StringSink hdr;
+    hdr.PushBytes(&type, sizeof(type), pushed);
+    hdr.PushBytes(&rev, sizeof(rev), pushed);
+    hdr.PushBytes(guid.GetBytes(), qcc::GUID128::SIZE, pushed);
+    /*
+     * The body of a deletion is just the GUID.
+     */
+    StringSink body;
+    if (keyRec) {
+        keyRec->key.Store(body);
+        body.PushBytes(&keyRec->accessRights, sizeof(keyRec->accessRights), pushed);
+    } else {
+        body.PushBytes(guid.GetBytes(), qcc::GUID128::SIZE, pushed);
+    }
+    /*
+     * Records are encrypted independently so each one gets a random nonce.
+     */
+    KeyBlob nonce;
+    nonce.Rand(JournalNonceLen, KeyBlob::GENERIC);
+    size_t len = body.GetString().size();
+    uint8_t* data = new uint8_t[len + KeyStoreMACLen];
+    QStatus status = aes.Encrypt_CCM(body.GetString().data(), data, len, nonce, hdr.GetString().data(), JournalHdrLen, KeyStoreMACLen);
+    if (status == ER_OK) {
+        uint32_t recLen = (uint32_t)len;
+        record = hdr.GetString();
+        record.append((const char*)nonce.GetData(), JournalNonceLen);
+        record.append((const char*)&recLen, sizeof(recLen));
+        record.append((const char*)data, len);
+    }
+    delete [] data;
+    return status;
+}
+
+QStatus KeyStore::ReadJournalRecord(Source& source, qcc::String& record)
+{
+    uint8_t hdr[JournalHdrLen + JournalNonceLen];
+    uint32_t len;
+    size_t pulled;
+
+    /*
+     * The end of the journal is the only place we expect to run out of data.
+     */
+    QStatus status = source.PullBytes(hdr, sizeof(hdr), pulled);
+    if (status != ER_OK) {
+        return status;
+    }
+    if (pulled == sizeof(hdr)) {
+        status = source.PullBytes(&len, sizeof(len), pulled);
+    }
+    if ((status != ER_OK) || (pulled != sizeof(len)) || (len < KeyStoreMACLen) || (len > MaxJournalRecordLen)) {
+        return ER_BUS_CORRUPT_KEYSTORE;
+    }
+    uint8_t* data = new uint8_t[len];
+    status = source.PullBytes(data, len, pulled);
+    if ((status != ER_OK) || (pulled != len)) {
+        status = ER_BUS_CORRUPT_KEYSTORE;
+    } else {
+        record.assign((const char*)hdr, sizeof(hdr));
+        record.append((const char*)&len, sizeof(len));
+        record.append((const char*)data, len);
+    }
+    delete [] data;
+    return status;
+}
+
+QStatus KeyStore::ApplyJournalRecord(Crypto_AES& aes, const qcc::String& record, bool merge)
+{
+    const uint8_t* hdr = (const uint8_t*)record.data();
+    const size_t dataOffset = JournalHdrLen + JournalNonceLen + sizeof(uint32_t);
+    size_t len = record.size() - dataOffset;
+    size_t pulled;
+
+    KeyBlob nonce(hdr + JournalHdrLen, JournalNonceLen, KeyBlob::GENERIC);
+    uint8_t* data = new uint8_t[len];
+    memcpy(data, hdr + dataOffset, len);
+    QStatus status = aes.Decrypt_CCM(data, data, len, nonce, hdr, JournalHdrLen, KeyStoreMACLen);
+    if (status == ER_OK) {
+        uint8_t type = hdr[0];
+        uint32_t rev;
+        memcpy(&rev, &hdr[1], sizeof(rev));
+        qcc::GUID128 guid;
+        guid.SetBytes(&hdr[1 + sizeof(rev)]);
+        if (type == JournalAddKey) {
+            StringSource strSource(data, len);
+            KeyRecord keyRec;
+            keyRec.revision = rev;
+            status = keyRec.key.Load(strSource);
+            if (status == ER_OK) {
+                status = strSource.PullBytes(&keyRec.accessRights, sizeof(keyRec.accessRights), pulled);
+            }
+            /*
+             * When merging another application's change the stored key wins over a change we
+             * have not stored yet, this is the same rule Reload() applies.
+             */
+            if (status == ER_OK) {
+                (*keys)[guid] = keyRec;
+                if (merge) {
+                    additions.erase(guid);
+                    deletions.erase(guid);
+                }
+            }
+        } else if (type == JournalDelKey) {
+            /*
+             * A key we have added or changed but not stored yet is not deleted.
+             */
+            if (!merge || (additions.count(guid) == 0)) {
+                keys->erase(guid);
+            }
+        } else {
+            status = ER_BUS_CORRUPT_KEYSTORE;
+        }
+        if (rev > revision) {
+            revision = rev;
+        }
+        QCC_DbgPrintf(("KeyStore::ApplyJournalRecord %s rev:%d GUID %s %s", (type == JournalAddKey) ? "add" : "del", rev, QCC_StatusText(status), guid.ToString().c_str()));
+    }
+    delete [] data;
+    return status;
+}
+
+QStatus KeyStore::PullJournalHeader(Source& source)
+{
+    uint8_t guidBuf[qcc::GUID128::SIZE];
+    uint16_t version = 0;
+    uint32_t base = 0;
+    size_t pulled;
+
+    QStatus status = source.PullBytes(&version, sizeof(version), pulled);
+    if (status == ER_OK) {
+        status = source.PullBytes(&base, sizeof(base), pulled);
+    }
+    if (status == ER_OK) {
+        status = source.PullBytes(guidBuf, qcc::GUID128::SIZE, pulled);
+    }
+    /*
+     * An empty journal or a journal for a different revision of the keys has nothing for us.
+     */
+    if ((status == ER_OK) && ((version != JournalVersion) || (base != journalBase) || (memcmp(guidBuf, thisGuid.GetBytes(), qcc::GUID128::SIZE) != 0))) {
+        status = ER_BUS_KEYSTORE_VERSION_MISMATCH;
+    }
+    if (status != ER_OK) {
+        QCC_DbgHLPrintf(("KeyStore journal for revision %d does not apply to revision %d", base, journalBase));
+    }
+    return status;
+}
+
+QStatus KeyStore::PullJournalRecords(Source& source, bool merge)
+{
+    QStatus status = ER_OK;
+    Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
+    size_t count = 0;
+    while (status == ER_OK) {
+        qcc::String record;
+        status = ReadJournalRecord(source, record);
+        if (status == ER_OK) {
+            status = ApplyJournalRecord(aes, record, merge);
+        }
+        if (status == ER_OK) {
+            journal.push_back(record);
+            ++count;
+        }
+    }
+    /*
+     * A partially written record is expected if we stopped while appending to the journal. We keep
+     * the records we could read and compact the journal on the next store.
+     */
+    if (status != ER_NONE) {
+        QCC_LogError(status, ("Key store journal is corrupt after %u records", (uint32_t)journal.size()));
+        compact = true;
+    }
+    QCC_DbgHLPrintf(("KeyStore pulled %u journal records (revision %d)", (uint32_t)count, revision));
+    if (EraseExpiredKeys()) {
+        storeState = MODIFIED;
+    }
+    return ER_OK;
+}
+
+QStatus KeyStore::PullJournal(Source& source)
+{
+    QCC_DbgPrintf(("KeyStore::PullJournal"));
+
+    if (storeState == UNAVAILABLE) {
+        return ER_BUS_KEYSTORE_NOT_LOADED;
+    }
+    lock.Lock(MUTEX_CONTEXT);
+    if (PullJournalHeader(source) == ER_OK) {
+        PullJournalRecords(source, false);
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return ER_OK;
+}
+
+QStatus KeyStore::PullJournalChanges(Source& source)
+{
+    QCC_DbgPrintf(("KeyStore::PullJournalChanges"));
+
+    if (storeState == UNAVAILABLE) {
+        return ER_BUS_KEYSTORE_NOT_LOADED;
+    }
+    lock.Lock(MUTEX_CONTEXT);
+    QStatus status = PullJournalHeader(source);
+    /*
+     * The journal must start with the records we already have. These are compared as they are
+     * stored so we don't need to decrypt them again.
+     */
+    for (size_t i = 0; (status == ER_OK) && (i < journal.size()); ++i) {
+        qcc::String record;
+        status = ReadJournalRecord(source, record);
+        if ((status == ER_OK) && (record != journal[i])) {
+            status = ER_BUS_KEYSTORE_VERSION_MISMATCH;
+        }
+    }
+    if (status == ER_OK) {
+        status = PullJournalRecords(source, true);
+    } else {
+        QCC_DbgHLPrintf(("KeyStore::PullJournalChanges journal has been rewritten %s", QCC_StatusText(status)));
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
+QStatus KeyStore::PushJournal(Sink& sink, bool append)
+{
+    size_t pushed;
+    QStatus status = ER_OK;
+    std::vector<qcc::String> records;
+
+    lock.Lock(MUTEX_CONTEXT);
+    QCC_DbgHLPrintf(("KeyStore::PushJournal (revision %d)", revision + 1));
+
+    /*
+     * Each push of changes to the journal is a new revision so applications sharing the key store
+     * can tell that the keys have changed.
+     */
+    if (!deletions.empty() || !additions.empty()) {
+        ++revision;
+    }
+    Crypto_AES aes(*keyStoreKey, Crypto_AES::CCM);
+    std::set<qcc::GUID128>::iterator itGuid;
+    for (itGuid = deletions.begin(); (status == ER_OK) && (itGuid != deletions.end()); ++itGuid) {
+        qcc::String record;
+        status = EncodeJournalRecord(aes, *itGuid, NULL, record);
+        records.push_back(record);
+    }
+    for (itGuid = additions.begin(); (status == ER_OK) && (itGuid != additions.end()); ++itGuid) {
+        KeyMap::iterator it = keys->find(*itGuid);
+        if (it != keys->end()) {
+            qcc::String record;
+            it->second.revision = revision;
+            status = EncodeJournalRecord(aes, *itGuid, &it->second, record);
+            records.push_back(record);
+        }
+    }
+    /*
+     * Unless we are appending to the journal write the header and the records we already have.
+     */
+    if ((status == ER_OK) && !append) {
+        status = sink.PushBytes(&JournalVersion, sizeof(JournalVersion), pushed);
+        if (status == ER_OK) {
+            status = sink.PushBytes(&journalBase, sizeof(journalBase), pushed);
+        }
+        if (status == ER_OK) {
+            status = sink.PushBytes(thisGuid.GetBytes(), qcc::GUID128::SIZE, pushed);
+        }
+        for (size_t i = 0; (status == ER_OK) && (i < journal.size()); ++i) {
+            status = sink.PushBytes(journal[i].data(), journal[i].size(), pushed);
+        }
+    }
+    for (size_t i = 0; (status == ER_OK) && (i < records.size()); ++i) {
+        status = sink.PushBytes(records[i].data(), records[i].size(), pushed);
+    }
+    if (status == ER_OK) {
+        journal.insert(journal.end(), records.begin(), records.end());
+        additions.clear();
+        deletions.clear();
+        storeState = LOADED;
+    } else {
+        QCC_LogError(status, ("Failed to push key store journal"));
+        compact = true;
+    }
+    if (stored) {
+        stored->SetEvent();
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
 QStatus KeyStore::GetKey(const qcc::GUID128& guid, KeyBlob& key, uint8_t accessRights[4])
 {
     if (storeState == UNAVAILABLE) {
@@ -672,6 +1274,7 @@ QStatus KeyStore::AddKey(const qcc::GUID128& guid, const KeyBlob& key, const uin
     memcpy(&keyRec.accessRights, accessRights, sizeof(uint8_t) * 4);
     storeState = MODIFIED;
     deletions.erase(guid);
+    additions.insert(guid);
     lock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
@@ -686,6 +1289,7 @@ QStatus KeyStore::DelKey(const qcc::GUID128& guid)
     keys->erase(guid);
     storeState = MODIFIED;
     deletions.insert(guid);
+    additions.erase(guid);
     lock.Unlock(MUTEX_CONTEXT);
     listener->StoreRequest(*this);
     return ER_OK;
@@ -702,6 +1306,7 @@ QStatus KeyStore::SetKeyExpiration(const qcc::GUID128& guid, const Timespec& exp
     if (keys->count(guid) != 0) {
         (*keys)[guid].key.SetExpiration(expiration);
         storeState = MODIFIED;
+        additions.insert(guid);
     } else {
         status = ER_BUS_KEY_UNAVAILABLE;
     }
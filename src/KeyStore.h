@@ -27,15 +27,18 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include <qcc/platform.h>
 
 #include <qcc/GUID.h>
 #include <qcc/String.h>
 #include <qcc/KeyBlob.h>
+#include <qcc/Crypto.h>
 #include <qcc/Mutex.h>
 #include <qcc/Stream.h>
 #include <qcc/Event.h>
+#include <qcc/Timer.h>
 #include <qcc/time.h>
 
 #include <alljoyn/KeyStoreListener.h>
@@ -50,7 +53,7 @@ namespace ajn {
  * The %KeyStore class manages the storing and loading of key blobs from
  * external storage.
  */
-class KeyStore {
+class KeyStore : public qcc::AlarmListener {
   public:
 
     /**
@@ -78,6 +81,16 @@ class KeyStore {
      */
     QStatus Store();
 
+    /**
+     * Requests the key store listener to store the contents of the key store after a short delay.
+     * Changes made before the store happens are coalesced into a single store request.
+     *
+     * @return
+     *      - ER_OK if the store was scheduled
+     *      - An error status otherwise
+     */
+    QStatus ScheduleStore();
+
     /**
      * Re-read keys from the key store. This is a no-op unless the key store is shared.
      * If the key store is shared the key store is reloaded merging any changes made by
@@ -256,6 +269,55 @@ class KeyStore {
      */
     QStatus Push(qcc::Sink& sink);
 
+    /**
+     * Pull the journal of changes made since the keys were last pushed in full. This must be
+     * called after Pull() with the journal that was written by PushJournal(). A journal that
+     * doesn't belong to the keys that were pulled is ignored.
+     *
+     * @param source    The source to read the journal from.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus PullJournal(qcc::Source& source);
+
+    /**
+     * Pull only the journal records that other applications sharing the key store have added
+     * since we last pulled or pushed the journal and merge them with our keys. The records we
+     * already have are compared but not decrypted again.
+     *
+     * @param source    The source to read the journal from.
+     *
+     * @return
+     *      - ER_OK if the changes were merged
+     *      - An error status if the journal has been rewritten or compacted, in which case all the
+     *        keys must be reloaded.
+     */
+    QStatus PullJournalChanges(qcc::Source& source);
+
+    /**
+     * Push the keys that have been added, changed or deleted since the last push into a journal
+     * sink. Each journal record is encrypted separately so only the changed keys are encrypted.
+     *
+     * @param sink    The sink to write the journal to.
+     * @param append  If true the sink already holds the journal and only the new records are
+     *                written, otherwise the complete journal is written.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus PushJournal(qcc::Sink& sink, bool append);
+
+    /**
+     * Indicates if the journal should be compacted by pushing all the keys rather than pushing
+     * the journal.
+     *
+     * @return  Returns true if the next store should push all the keys.
+     */
+    bool NeedsCompaction();
+
     /**
      * Indicates if this is a shared key store.
      *
@@ -290,6 +352,16 @@ class KeyStore {
      */
     QStatus Load();
 
+    /**
+     * Stop the timer for scheduled stores, any scheduled store happens now.
+     */
+    void StopStoreTimer();
+
+    /**
+     * Timer callback for scheduled stores
+     */
+    void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
+
     /**
      * The application that owns this key store. If the key store is shared this will be the name
      * of a suite of applications.
@@ -321,6 +393,32 @@ class KeyStore {
      */
     typedef std::map<qcc::GUID128, KeyRecord> KeyMap;
 
+    /**
+     * Internal function to encode and encrypt a journal record. A NULL key record encodes a deletion.
+     */
+    QStatus EncodeJournalRecord(qcc::Crypto_AES& aes, const qcc::GUID128& guid, KeyRecord* keyRec, qcc::String& record);
+
+    /**
+     * Internal function to read an encrypted journal record.
+     */
+    QStatus ReadJournalRecord(qcc::Source& source, qcc::String& record);
+
+    /**
+     * Internal function to decrypt and apply a journal record. If merge is true the record is
+     * another application's change and is merged with the changes we have not stored yet.
+     */
+    QStatus ApplyJournalRecord(qcc::Crypto_AES& aes, const qcc::String& record, bool merge);
+
+    /**
+     * Internal function to pull the journal header and check the journal applies to our keys.
+     */
+    QStatus PullJournalHeader(qcc::Source& source);
+
+    /**
+     * Internal function to pull and apply journal records up to the end of the journal.
+     */
+    QStatus PullJournalRecords(qcc::Source& source, bool merge);
+
     /**
      * In memory copy of the key store
      */
@@ -331,6 +429,26 @@ class KeyStore {
      */
     std::set<qcc::GUID128> deletions;
 
+    /**
+     * GUID for keys that have been added or changed since the keys were last pushed
+     */
+    std::set<qcc::GUID128> additions;
+
+    /**
+     * Encrypted journal records pushed since the keys were last pushed in full
+     */
+    std::vector<qcc::String> journal;
+
+    /**
+     * Revision of the full key store that the journal applies to
+     */
+    uint32_t journalBase;
+
+    /**
+     * Indicates that the next store must push all the keys
+     */
+    bool compact;
+
     /**
      * Default listener for handling load/store requests
      */
@@ -375,6 +493,16 @@ class KeyStore {
      * Event for synchronizing load requests
      */
     qcc::Event* loaded;
+
+    /**
+     * Timer for scheduled stores
+     */
+    qcc::Timer* storeTimer;
+
+    /**
+     * Indicates a store has been scheduled but has not happened yet
+     */
+    bool storePending;
 };
 
 }
@@ -117,14 +117,16 @@ class _LocalEndpoint::ReplyContext {
                  const InterfaceDescription::Member* method,
                  Message& methodCall,
                  void* context,
-                 uint32_t timeout) :
+                 uint32_t timeout,
+                 bool isSync) :
         ep(ep),
         receiver(receiver),
         handler(handler),
         method(method),
         callFlags(methodCall->GetFlags()),
         serial(methodCall->msgHeader.serialNum),
-        context(context)
+        context(context),
+        isSync(isSync)
     {
         uint32_t zero = 0;
         void* tempContext = (void*)this;
@@ -143,6 +145,7 @@ class _LocalEndpoint::ReplyContext {
     uint8_t callFlags;                           /* Flags from the method call */
     uint32_t serial;                             /* Serial number for the method reply */
     void* context;                               /* The calling object's context */
+    bool isSync;                                 /* The handler only wakes a synchronous caller */
     qcc::Alarm alarm;                            /* Alarm object for handling method call timeouts */
 
   private:
@@ -454,6 +457,24 @@ QStatus _LocalEndpoint::PushMessage(Message& message)
     return ret;
 }
 
+QStatus _LocalEndpoint::PushInProcessMessage(Message& message)
+{
+    if (running && !message->IsEncrypted() &&
+        ((message->GetType() == MESSAGE_METHOD_RET) || (message->GetType() == MESSAGE_ERROR))) {
+        bool isSync = false;
+        replyMapLock.Lock(MUTEX_CONTEXT);
+        map<uint32_t, ReplyContext*>::iterator iter = replyMap.find(message->GetReplySerial());
+        if (iter != replyMap.end()) {
+            isSync = iter->second->isSync && !(iter->second->callFlags & ALLJOYN_FLAG_ENCRYPTED);
+        }
+        replyMapLock.Unlock(MUTEX_CONTEXT);
+        if (isSync) {
+            return DoPushMessage(message);
+        }
+    }
+    return PushMessage(message);
+}
+
 QStatus _LocalEndpoint::DoPushMessage(Message& message)
 {
     QStatus status = ER_OK;
@@ -656,14 +677,15 @@ QStatus _LocalEndpoint::RegisterReplyHandler(MessageReceiver* receiver,
                                              const InterfaceDescription::Member& method,
                                              Message& methodCallMsg,
                                              void* context,
-                                             uint32_t timeout)
+                                             uint32_t timeout,
+                                             bool isSync)
 {
     QStatus status = ER_OK;
     if (!running) {
         status = ER_BUS_STOPPING;
         QCC_LogError(status, ("Local transport not running"));
     } else {
-        ReplyContext* rc =  new ReplyContext(LocalEndpoint::wrap(this), receiver, replyHandler, &method, methodCallMsg, context, timeout);
+        ReplyContext* rc =  new ReplyContext(LocalEndpoint::wrap(this), receiver, replyHandler, &method, methodCallMsg, context, timeout, isSync);
         QCC_DbgPrintf(("LocalEndpoint::RegisterReplyHandler"));
         /*
          * Add reply context.
@@ -132,6 +132,8 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
      * @param context        Opaque context pointer passed from method call to it's reply handler.
      * @param timeout        Timeout specified in milliseconds to wait for a reply to a method call.
      *                       The value 0 means use the implementation dependent default timeout.
+     * @param isSync         true if the reply handler only wakes a thread blocked in a synchronous
+     *                       method call and so is safe to call from any thread.
      * @return
      *      - ER_OK if successful
      *      - An error status otherwise
@@ -141,7 +143,8 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
                                  const InterfaceDescription::Member& method,
                                  Message& methodCallMsg,
                                  void* context = NULL,
-                                 uint32_t timeout = 0);
+                                 uint32_t timeout = 0,
+                                 bool isSync = false);
 
     /**
      * Un-register the handler for a specified method call.
@@ -345,6 +348,19 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
      */
     QStatus PushMessage(Message& msg);
 
+    /**
+     * Send a message that was passed by reference from a daemon bundled in the same process.
+     * Unencrypted replies to synchronous method calls are handled on the calling thread because
+     * all that does is wake the blocked caller. Everything else is dispatched as by PushMessage().
+     *
+     * @param msg        Message to deliver to this endpoint.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - An error status otherwise
+     */
+    QStatus PushInProcessMessage(Message& msg);
+
     /**
      * Indicate whether this endpoint is allowed to receive messages from remote devices.
      * LocalEndpoints always allow remote messages.
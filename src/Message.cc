@@ -312,9 +312,7 @@ _Message::_Message(BusAttachment& bus) :
     numHandles(0),
     encrypt(false),
     readState(MESSAGE_NEW),
-    countRead(0),
-    writeState(MESSAGE_NEW),
-    countWrite(0)
+    countRead(0)
 {
     msgHeader.msgType = MESSAGE_INVALID;
     msgHeader.endian = myEndian;
@@ -345,8 +343,6 @@ _Message::_Message(const _Message& other) :
     encrypt(other.encrypt),
     readState(other.readState),
     countRead(other.countRead),
-    writeState(other.writeState),
-    countWrite(other.countWrite),
     hdrFields(other.hdrFields)
 {
     if (bufSize > 0) {
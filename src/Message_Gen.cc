@@ -517,19 +517,17 @@ QStatus _Message::Deliver(RemoteEndpoint& endpoint)
     return status;
 }
 
-QStatus _Message::DeliverNonBlocking(RemoteEndpoint& endpoint)
+QStatus _Message::DeliverNonBlocking(RemoteEndpoint& endpoint, WriteCursor& cursor)
 {
     size_t pushed;
     QStatus status = ER_OK;
     Sink& sink = endpoint->GetSink();
 
-    switch (writeState) {
+    switch (cursor.state) {
     case MESSAGE_NEW:
-        writePtr = reinterpret_cast<uint8_t*>(msgBuf);
-        countWrite = bufEOD - writePtr;
         pushed = 0;
 
-        if (countWrite == 0) {
+        if (bufEOD == reinterpret_cast<uint8_t*>(msgBuf)) {
             status = ER_BUS_EMPTY_MESSAGE;
             QCC_LogError(status, ("Message is empty"));
             return status;
@@ -561,32 +559,34 @@ QStatus _Message::DeliverNonBlocking(RemoteEndpoint& endpoint)
                 return ER_OK;
             }
         }
-        writeState = MESSAGE_HEADERFIELDS;
+        /*
+         * The remaining count is computed after encryption since encrypting adds the MAC
+         */
+        cursor.countWrite = bufEOD - reinterpret_cast<uint8_t*>(msgBuf);
+        cursor.state = MESSAGE_HEADERFIELDS;
 
     case MESSAGE_HEADERFIELDS:
         if (handles) {
-            status = sink.PushBytesAndFds(writePtr, countWrite, pushed, handles, numHandles, endpoint->GetProcessId());
+            status = sink.PushBytesAndFds(bufEOD - cursor.countWrite, cursor.countWrite, pushed, handles, numHandles, endpoint->GetProcessId());
         } else {
-            status = sink.PushBytes(writePtr, countWrite, pushed, (msgHeader.flags & ALLJOYN_FLAG_SESSIONLESS) ? (ttl * 1000) : ttl);
+            status = sink.PushBytes(bufEOD - cursor.countWrite, cursor.countWrite, pushed, (msgHeader.flags & ALLJOYN_FLAG_SESSIONLESS) ? (ttl * 1000) : ttl);
         }
 
         if (status == ER_OK) {
-            countWrite -= pushed;
-            writePtr += pushed;
-            writeState = MESSAGE_HEADER_BODY;
+            cursor.countWrite -= pushed;
+            cursor.state = MESSAGE_HEADER_BODY;
         } else break;
 
     case MESSAGE_HEADER_BODY:
         status = ER_OK;
-        while (status == ER_OK && countWrite > 0) {
-            status = sink.PushBytes(writePtr, countWrite, pushed);
+        while (status == ER_OK && cursor.countWrite > 0) {
+            status = sink.PushBytes(bufEOD - cursor.countWrite, cursor.countWrite, pushed);
             if (status == ER_OK) {
-                countWrite -= pushed;
-                writePtr += pushed;
+                cursor.countWrite -= pushed;
             }
         }
-        if (countWrite == 0) {
-            writeState = MESSAGE_COMPLETE;
+        if (cursor.countWrite == 0) {
+            cursor.state = MESSAGE_COMPLETE;
         }
         break;
 
@@ -732,11 +732,23 @@ size_t _Message::ComputeHeaderLen()
     return ROUNDUP8(sizeof(msgHeader) + hdrLen);
 }
 
+QStatus _Message::EncryptGroupMessage()
+{
+    QStatus status = ER_OK;
+    if (encrypt && (GetDestination()[0] == '\0')) {
+        status = EncryptMessage();
+    }
+    return status;
+}
+
 QStatus _Message::EncryptMessage()
 {
-    KeyBlob key;
-    PeerState peerState = bus->GetInternal().GetPeerStateTable()->GetPeerState(GetDestination());
-    QStatus status = peerState->GetKey(key, PEER_SESSION_KEY);
+    MessageCipher cipher;
+    PeerState peerState;
+    QStatus status = ER_BUS_KEY_UNAVAILABLE;
+    if (bus->GetInternal().GetPeerStateTable()->FindPeerState(GetDestination(), peerState)) {
+        status = peerState->GetCipher(cipher, PEER_SESSION_KEY);
+    }
 
     if (status == ER_OK) {
         /*
@@ -750,13 +762,13 @@ QStatus _Message::EncryptMessage()
     if (status == ER_OK) {
         size_t argsLen = msgHeader.bodyLen - ajn::Crypto::MACLength;
         size_t hdrLen = ROUNDUP8(sizeof(msgHeader) + msgHeader.headerLen);
-        status = ajn::Crypto::Encrypt(*this, key, (uint8_t*)msgBuf, hdrLen, argsLen);
+        status = ajn::Crypto::Encrypt(*this, cipher, (uint8_t*)msgBuf, hdrLen, argsLen);
         if (status == ER_OK) {
             QCC_DbgHLPrintf(("EncryptMessage: %s", Description().c_str()));
             /*
              * Save the authentication mechanism that was used.
              */
-            authMechanism = key.GetTag();
+            authMechanism = cipher->GetKey().GetTag();
             encrypt = false;
             assert(msgHeader.bodyLen == argsLen);
         }
@@ -588,9 +588,13 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
     if (msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED) {
         bool broadcast = (hdrFields.field[ALLJOYN_HDR_FIELD_DESTINATION].typeId == ALLJOYN_INVALID);
         size_t hdrLen = bodyPtr - (uint8_t*)msgBuf;
-        PeerState peerState = bus->GetInternal().GetPeerStateTable()->GetPeerState(GetSender());
-        KeyBlob key;
-        status = peerState->GetKey(key, broadcast ? PEER_GROUP_KEY : PEER_SESSION_KEY);
+        PeerState peerState;
+        MessageCipher cipher;
+        if (bus->GetInternal().GetPeerStateTable()->FindPeerState(GetSender(), peerState)) {
+            status = peerState->GetCipher(cipher, broadcast ? PEER_GROUP_KEY : PEER_SESSION_KEY);
+        } else {
+            status = ER_BUS_KEY_UNAVAILABLE;
+        }
         if (status != ER_OK) {
             QCC_LogError(status, ("Unable to decrypt message"));
             /*
@@ -612,12 +616,12 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
          * algorithm adds appends a MAC block to the end of the encrypted data.
          */
         size_t bodyLen = msgHeader.bodyLen;
-        status = ajn::Crypto::Decrypt(*this, key, (uint8_t*)msgBuf, hdrLen, bodyLen);
+        status = ajn::Crypto::Decrypt(*this, cipher, (uint8_t*)msgBuf, hdrLen, bodyLen);
         if (status != ER_OK) {
             goto ExitUnmarshalArgs;
         }
         msgHeader.bodyLen = static_cast<uint32_t>(bodyLen);
-        authMechanism = key.GetTag();
+        authMechanism = cipher->GetKey().GetTag();
     }
     /*
      * Calculate how many arguments there are
@@ -1033,7 +1037,44 @@ QStatus _Message::Read(RemoteEndpoint& endpoint, bool checkSender, bool pedantic
     return status;
 }
 
-QStatus _Message::Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool pedantic, uint32_t timeout)
+QStatus _Message::ReadFromBuffer(RemoteEndpoint& endpoint, const uint8_t* buf, size_t len, size_t& used, bool pedantic)
+{
+    QStatus status;
+    /*
+     * Clear out any stale message state
+     */
+    msgBuf = NULL;
+    delete [] _msgBuf;
+    _msgBuf = NULL;
+    ClearHeader();
+    readState = MESSAGE_NEW;
+    used = 0;
+
+    if (len < sizeof(msgHeader)) {
+        return ER_BUS_BAD_LENGTH;
+    }
+    memcpy(&msgHeader, buf, sizeof(msgHeader));
+    status = InterpretHeader();
+    if (status != ER_OK) {
+        return status;
+    }
+    /*
+     * InterpretHeader has allocated the buffer and set countRead to the size of the rest of the message
+     */
+    if (countRead > (len - sizeof(msgHeader))) {
+        return ER_BUS_BAD_LENGTH;
+    }
+    memcpy(bufPos, buf + sizeof(msgHeader), countRead);
+    used = sizeof(msgHeader) + countRead;
+    countRead = 0;
+    readState = MESSAGE_COMPLETE;
+    bufPos = (uint8_t*)msgBuf + sizeof(msgHeader);
+
+    /* Not on the endpoint's receive path so its peer state cache cannot be used */
+    return Unmarshal(endpoint, false, pedantic, 0, false);
+}
+
+QStatus _Message::Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool pedantic, uint32_t timeout, bool receivePath)
 {
     QStatus status;
 
@@ -1180,7 +1221,8 @@ QStatus _Message::Unmarshal(RemoteEndpoint& endpoint, bool checkSender, bool ped
      * session.
      */
     if (senderField->typeId != ALLJOYN_INVALID) {
-        PeerState peerState = bus->GetInternal().GetPeerStateTable()->GetPeerState(senderField->v_string.str);
+        PeerStateTable* peerStateTable = bus->GetInternal().GetPeerStateTable();
+        PeerState peerState = receivePath ? endpoint->GetPeerState(*peerStateTable, senderField->v_string.str) : peerStateTable->GetPeerState(senderField->v_string.str);
         bool unreliable = hdrFields.field[ALLJOYN_HDR_FIELD_TIME_TO_LIVE].typeId != ALLJOYN_INVALID;
         bool secure = (msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED) != 0;
         if ((msgHeader.flags & ALLJOYN_FLAG_SESSIONLESS) == 0) {
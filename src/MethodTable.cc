@@ -23,6 +23,9 @@
 
 #include <qcc/platform.h>
 
+#include <string.h>
+#include <map>
+
 #include "MethodTable.h"
 
 /** @internal */
@@ -33,15 +36,66 @@ using namespace std;
 
 namespace ajn {
 
+/*
+ * FNV-1a hash of a NUL terminated string
+ */
+static inline uint32_t Hash(const char* str)
+{
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash = (hash ^ (uint8_t)*str++) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Number of slots for a table with n entries, a power of two with at least half the slots empty.
+ */
+static size_t SlotCount(size_t n)
+{
+    size_t size = 4;
+    while (size < (2 * n)) {
+        size <<= 1;
+    }
+    return size;
+}
+
+/*
+ * Returns the index of the slot for name, either the slot holding name or the empty slot where
+ * it would be inserted.
+ */
+template <typename T>
+static size_t Probe(const std::vector<T>& slots, const char* T::* key, const char* name, uint32_t hash)
+{
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].*key && ((slots[i].hash != hash) || (strcmp(slots[i].*key, name) != 0))) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+MethodTable::MethodTable() : current(NULL), epoch(0), publications(0), waiting(0)
+{
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
 MethodTable::~MethodTable()
 {
     lock.Lock(MUTEX_CONTEXT);
-    MapType::iterator iter = hashTable.begin();
-    while (iter != hashTable.end()) {
-        delete iter->second;
+    delete current;
+    current = NULL;
+    for (std::map<BusObject*, Object*>::iterator it = tables.begin(); it != tables.end(); ++it) {
+        delete it->second;
     }
-
-    hashTable.clear();
+    tables.clear();
+    for (std::map<BusObject*, std::vector<Entry*> >::iterator it = entries.begin(); it != entries.end(); ++it) {
+        for (size_t i = 0; i < it->second.size(); ++i) {
+            delete it->second[i];
+        }
+    }
+    entries.clear();
     lock.Unlock(MUTEX_CONTEXT);
 }
 
@@ -52,12 +106,7 @@ void MethodTable::Add(BusObject* object,
 {
     Entry* entry = new Entry(object, func, member, context);
     lock.Lock(MUTEX_CONTEXT);
-    hashTable[Key(object->GetPath(), entry->ifaceStr.empty() ? NULL : entry->ifaceStr.c_str(), member->name.c_str())] = entry;
-
-    /* Method calls don't require an interface so we need to add an entry with a NULL interface */
-    if (!entry->ifaceStr.empty()) {
-        hashTable[Key(object->GetPath(), NULL, member->name.c_str())] = new Entry(*entry);
-    }
+    entries[object].push_back(entry);
     lock.Unlock(MUTEX_CONTEXT);
 }
 
@@ -65,43 +114,179 @@ MethodTable::SafeEntry* MethodTable::Find(const char* objectPath,
                                           const char* iface,
                                           const char* methodName)
 {
-    SafeEntry* entry = NULL;
-    Key key(objectPath, iface, methodName);
-    lock.Lock(MUTEX_CONTEXT);
-    MapType::iterator iter = hashTable.find(key);
-    if (iter != hashTable.end()) {
-        entry = new SafeEntry();
-        entry->Set(iter->second);
+    SafeEntry* safeEntry = NULL;
+    int32_t index = epoch & 1;
+    IncrementAndFetch(&readers[index]);
+    const Dispatch* dispatch = current;
+    if (dispatch) {
+        uint32_t hash = Hash(objectPath);
+        const Object* obj = dispatch->objects[Probe(dispatch->objects, &Slot::path, objectPath, hash)].object;
+        const std::vector<Member>* members = NULL;
+        if (!obj) {
+            /* No such object */
+        } else if (iface && *iface) {
+            hash = Hash(iface);
+            const Interface& ifc = obj->ifaces[Probe(obj->ifaces, &Interface::name, iface, hash)];
+            if (ifc.name) {
+                members = &ifc.members;
+            }
+        } else {
+            /* Method calls don't require an interface */
+            members = &obj->anyIface;
+        }
+        if (members) {
+            hash = Hash(methodName);
+            const Member& member = (*members)[Probe(*members, &Member::name, methodName, hash)];
+            if (member.name) {
+                safeEntry = new SafeEntry();
+                safeEntry->Set(member.entry);
+            }
+        }
     }
-    lock.Unlock(MUTEX_CONTEXT);
-    return entry;
+    /* Full barrier before checking for a waiting writer, pairs with the one in WaitForReaders() */
+    if ((DecrementAndFetch(&readers[index]) == 0) && waiting) {
+        drained.SetEvent();
+    }
+    return safeEntry;
 }
 
 void MethodTable::RemoveAll(BusObject* object)
 {
-    MapType::iterator iter;
+    std::vector<Entry*> removed;
     /*
-     * Iterate over all entries deleting all entries that reference the object
+     * Publish a dispatch table without the object's entries before deleting them
      */
     lock.Lock(MUTEX_CONTEXT);
-    iter = hashTable.begin();
-    while (iter != hashTable.end()) {
-        if (iter->second->object == object) {
-            Entry* deleteMe = iter->second;
-            hashTable.erase(iter);
-            delete deleteMe;
-            iter = hashTable.begin();
-        } else {
-            ++iter;
-        }
+    std::map<BusObject*, std::vector<Entry*> >::iterator iter = entries.find(object);
+    if (iter != entries.end()) {
+        removed.swap(iter->second);
+        entries.erase(iter);
+        Publish(object);
     }
     lock.Unlock(MUTEX_CONTEXT);
+    /* Entry destructor waits for method calls that are still using the entry */
+    for (size_t i = 0; i < removed.size(); ++i) {
+        delete removed[i];
+    }
 }
 
 void MethodTable::AddAll(BusObject* object)
 {
     object->InstallMethods(*this);
+    lock.Lock(MUTEX_CONTEXT);
+    Publish(object);
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+MethodTable::Object* MethodTable::BuildObject(const std::vector<Entry*>& objEntries) const
+{
+    /*
+     * Group the entries by interface
+     */
+    typedef std::map<qcc::String, std::vector<Entry*> > IfaceMap;
+    IfaceMap ifaces;
+    for (size_t i = 0; i < objEntries.size(); ++i) {
+        ifaces[objEntries[i]->ifaceStr].push_back(objEntries[i]);
+    }
+
+    Object* obj = new Object();
+    obj->path = objEntries.front()->object->GetPath();
+    obj->hash = Hash(obj->path);
+    obj->ifaces.resize(SlotCount(ifaces.size()));
+    for (IfaceMap::iterator iit = ifaces.begin(); iit != ifaces.end(); ++iit) {
+        if (iit->first.empty()) {
+            continue;
+        }
+        const char* name = iit->second.front()->ifaceStr.c_str();
+        uint32_t hash = Hash(name);
+        Interface& ifc = obj->ifaces[Probe(obj->ifaces, &Interface::name, name, hash)];
+        ifc.name = name;
+        ifc.hash = hash;
+        ifc.members.resize(SlotCount(iit->second.size()));
+        for (size_t i = 0; i < iit->second.size(); ++i) {
+            Entry* entry = iit->second[i];
+            hash = Hash(entry->methodStr.c_str());
+            Member& member = ifc.members[Probe(ifc.members, &Member::name, entry->methodStr.c_str(), hash)];
+            member.name = entry->methodStr.c_str();
+            member.hash = hash;
+            member.entry = entry;
+        }
+    }
+    /*
+     * Members without an interface are filled in the order the entries were added so if a member
+     * name is on more than one interface the last one added is used.
+     */
+    obj->anyIface.resize(SlotCount(objEntries.size()));
+    for (size_t i = 0; i < objEntries.size(); ++i) {
+        Entry* entry = objEntries[i];
+        uint32_t hash = Hash(entry->methodStr.c_str());
+        Member& member = obj->anyIface[Probe(obj->anyIface, &Member::name, entry->methodStr.c_str(), hash)];
+        member.name = entry->methodStr.c_str();
+        member.hash = hash;
+        member.entry = entry;
+    }
+    return obj;
+}
+
+void MethodTable::Publish(BusObject* object)
+{
+    /*
+     * Only the object's own sub-table is rebuilt, the top level only holds pointers to the
+     * sub-tables so it is cheap to regenerate.
+     */
+    Object* stale = NULL;
+    std::map<BusObject*, Object*>::iterator tit = tables.find(object);
+    if (tit != tables.end()) {
+        stale = tit->second;
+        tables.erase(tit);
+    }
+    std::map<BusObject*, std::vector<Entry*> >::iterator eit = entries.find(object);
+    if ((eit != entries.end()) && !eit->second.empty()) {
+        tables[object] = BuildObject(eit->second);
+    }
+    Dispatch* dispatch = new Dispatch();
+    dispatch->objects.resize(SlotCount(tables.size()));
+    for (tit = tables.begin(); tit != tables.end(); ++tit) {
+        Object* obj = tit->second;
+        Slot& slot = dispatch->objects[Probe(dispatch->objects, &Slot::path, obj->path, obj->hash)];
+        slot.path = obj->path;
+        slot.hash = obj->hash;
+        slot.object = obj;
+    }
+
+    Dispatch* old = current;
+    current = dispatch;
+    /* Full barrier so the new table is visible before the reader counts are sampled */
+    IncrementAndFetch(&publications);
+    /*
+     * Lookups that started before the swap may be holding the old table or the stale sub-table.
+     * Readers are counted against one of two indices so new lookups never delay the wait for
+     * earlier ones.
+     */
+    int32_t prev = epoch & 1;
+    WaitForReaders(prev ^ 1);
+    IncrementAndFetch(&epoch);
+    WaitForReaders(prev);
+    delete old;
+    delete stale;
 }
 
+void MethodTable::WaitForReaders(int32_t index)
+{
+    if (readers[index] == 0) {
+        return;
+    }
+    /*
+     * Full barrier after announcing the wait so a lookup that drops the count to zero either
+     * sees the announcement and sets the event or its decrement is seen here.
+     */
+    drained.ResetEvent();
+    IncrementAndFetch(&waiting);
+    while (readers[index] != 0) {
+        Event::Wait(drained);
+        drained.ResetEvent();
+    }
+    DecrementAndFetch(&waiting);
 }
 
+}
@@ -23,9 +23,11 @@
 
 #include <qcc/platform.h>
 
+#include <map>
 #include <vector>
 
 #include <qcc/String.h>
+#include <qcc/Event.h>
 #include <qcc/Mutex.h>
 #include <qcc/Thread.h>
 #include <qcc/atomic.h>
@@ -36,12 +38,14 @@
 
 #include <alljoyn/Status.h>
 
-#include <qcc/STLContainer.h>
-
 namespace ajn {
 
 /**
  * %MethodTable is a hash table that maps object paths to BusObject instances.
+ *
+ * Lookups go through an immutable dispatch table (object -> interface -> member) that is republished
+ * when objects are registered or unregistered without blocking concurrent lookups. Only the
+ * sub-table of the object being registered or unregistered is rebuilt, the others are reused.
  */
 class MethodTable {
 
@@ -101,13 +105,19 @@ class MethodTable {
         const Entry* entry;
     };
 
+    /**
+     * Constructor
+     */
+    MethodTable();
+
     /**
      * Destructor
      */
     ~MethodTable();
 
     /**
-     * Add an entry to the method hash table.
+     * Add an entry to the method hash table. The entry is not visible to Find() until the
+     * dispatch table is republished by AddAll().
      *
      * @param object     Object instance.
      * @param func       Handler for method.
@@ -119,7 +129,7 @@ class MethodTable {
              void* context = NULL);
 
     /**
-     * Find an Entry based on set of criteria.
+     * Find an Entry based on set of criteria. This does not take any locks.
      *
      * @param objectPath   The object path.
      * @param iface        The interface.
@@ -138,7 +148,7 @@ class MethodTable {
     void RemoveAll(BusObject* object);
 
     /**
-     * Register handlers for an object's methods.
+     * Register handlers for an object's methods and publish the updated dispatch table.
      *
      * @param object  Object whose methods are to be registered.
      */
@@ -146,60 +156,72 @@ class MethodTable {
 
   private:
 
-    qcc::Mutex lock; /**< Lock protecting the method table */
-
     /**
-     * Type definition for method hash table key
+     * Dispatch table slots. Each level is an open addressed hash table with at least twice as
+     * many slots as entries so every probe sequence ends at an empty slot (NULL name).
      */
-    class Key {
-      public:
-        const char* objPath;
-        const char* iface;
-        const char* methodName;
-        Key(const char* obj, const char* ifc, const char* method) : objPath(obj), iface((ifc && *ifc) ? ifc : NULL), methodName(method) { }
+    struct Member {
+        const char* name;
+        uint32_t hash;
+        Entry* entry;
+        Member() : name(NULL), hash(0), entry(NULL) { }
+    };
+
+    struct Interface {
+        const char* name;
+        uint32_t hash;
+        std::vector<Member> members;
+        Interface() : name(NULL), hash(0) { }
+    };
+
+    struct Object {
+        const char* path;
+        uint32_t hash;
+        std::vector<Interface> ifaces;
+        std::vector<Member> anyIface;   /**< Members by name for method calls with no interface */
+        Object() : path(NULL), hash(0) { }
     };
 
     /**
-     * Hash functor
+     * Top level slot. Sub-tables are owned by the method table and shared between successive
+     * dispatch tables so publishing does not copy them.
      */
-    struct Hash {
-        /** Calculate hash for Key k  */
-        size_t operator()(const Key& k) const {
-            size_t hash = 37;
-            for (const char* p = k.methodName; *p; ++p) {
-                hash = *p + hash * 11;
-            }
-            for (const char* p = k.objPath; *p; ++p) {
-                hash = *p + hash * 5;
-            }
-            if (k.iface) {
-                for (const char* p = k.iface; *p; ++p) {
-                    hash += *p * 7;
-                }
-            }
-            return hash;
-        }
+    struct Slot {
+        const char* path;
+        uint32_t hash;
+        Object* object;
+        Slot() : path(NULL), hash(0), object(NULL) { }
+    };
+
+    struct Dispatch {
+        std::vector<Slot> objects;
     };
 
     /**
-     * Functor for testing 2 keys for equality
+     * Build the sub-table for an object from its entries.
      */
-    struct Equal {
-        /**
-         * Return true two keys are equal
-         */
-        bool operator()(const Key& k1, const Key& k2) const {
-            if ((k1.iface == NULL) || (k2.iface == NULL)) {
-                return (k1.iface == k2.iface) && (strcmp(k1.methodName, k2.methodName) == 0) && (strcmp(k1.objPath, k2.objPath) == 0);
-            } else {
-                return (strcmp(k1.methodName, k2.methodName) == 0) && (strcmp(k1.iface, k2.iface) == 0) && (strcmp(k1.objPath, k2.objPath) == 0);
-            }
-        }
-    };
+    Object* BuildObject(const std::vector<Entry*>& objEntries) const;
+
+    /**
+     * Rebuild the sub-table for an object, publish a new dispatch table and free the old one
+     * once no lookups are using it. Must be called with the lock held.
+     */
+    void Publish(BusObject* object);
 
-    /** The hash table */
-    typedef std::unordered_map<Key, Entry*, Hash, Equal> MapType;
-    MapType hashTable;
+    /**
+     * Wait until there are no lookups counted against a reader index.
+     */
+    void WaitForReaders(int32_t index);
+
+    qcc::Mutex lock;                  /**< Lock serializing changes to the method table */
+    std::map<BusObject*, std::vector<Entry*> > entries;  /**< Entries for each object in the order they were added */
+    std::map<BusObject*, Object*> tables;              /**< Published sub-table for each object */
+    Dispatch* volatile current;       /**< The published dispatch table */
+    volatile int32_t epoch;           /**< Selects the reader count new lookups are counted against */
+    volatile int32_t readers[2];      /**< Lookups in progress */
+    volatile int32_t publications;    /**< Number of times a dispatch table has been published */
+    volatile int32_t waiting;         /**< Non-zero while a writer is waiting for lookups to drain */
+    qcc::Event drained;               /**< Set by the last lookup to leave while a writer is waiting */
 };
 
 }
@@ -86,46 +86,104 @@ bool _PeerState::IsValidSerial(uint32_t serial, bool secure, bool unreliable)
 
 }
 
-PeerStateTable::PeerStateTable()
+PeerStateTable::PeerStateTable() : generation(0)
 {
     Clear();
 }
 
 PeerState PeerStateTable::GetPeerState(const qcc::String& busName)
 {
-    lock.Lock(MUTEX_CONTEXT);
-    QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() %s state for %s", peerMap.count(busName) ? "got" : "no", busName.c_str()));
-    PeerState result = peerMap[busName];
-    lock.Unlock(MUTEX_CONTEXT);
+    Bucket& bucket = buckets[BucketIndex(busName)];
+    bucket.lock.Lock(MUTEX_CONTEXT);
+    PeerMap::iterator iter = bucket.peerMap.find(busName);
+    if (iter == bucket.peerMap.end()) {
+        QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() no state for %s", busName.c_str()));
+        iter = bucket.peerMap.insert(PeerMap::value_type(busName, PeerState())).first;
+    } else {
+        QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() got state for %s", busName.c_str()));
+    }
+    PeerState result = iter->second;
+    bucket.lock.Unlock(MUTEX_CONTEXT);
 
     return result;
 }
 
+PeerState PeerStateTable::GetPeerState(const qcc::String& busName, PeerStateCache& cache)
+{
+    /*
+     * The generation is read before the lookup so a mapping that is removed while the lookup is in
+     * progress invalidates the entry we are about to cache.
+     */
+    int32_t gen = generation;
+    if ((cache.generation != gen) || (cache.busName != busName)) {
+        cache.peerState = GetPeerState(busName);
+        cache.busName = busName;
+        cache.generation = gen;
+    }
+    return cache.peerState;
+}
+
+bool PeerStateTable::FindPeerState(const qcc::String& busName, PeerState& peerState)
+{
+    Bucket& bucket = buckets[BucketIndex(busName)];
+    bucket.lock.Lock(MUTEX_CONTEXT);
+    PeerMap::const_iterator iter = bucket.peerMap.find(busName);
+    bool found = (iter != bucket.peerMap.end());
+    if (found) {
+        peerState = iter->second;
+    }
+    bucket.lock.Unlock(MUTEX_CONTEXT);
+    return found;
+}
+
 PeerState PeerStateTable::GetPeerState(const qcc::String& uniqueName, const qcc::String& aliasName)
 {
     assert(uniqueName[0] == ':');
     PeerState result;
-    lock.Lock(MUTEX_CONTEXT);
-    std::map<const qcc::String, PeerState>::iterator iter = peerMap.find(uniqueName);
-    if (iter == peerMap.end()) {
+    /*
+     * Both buckets are held so the two names are linked atomically. Buckets are always locked in
+     * index order to avoid deadlock.
+     */
+    size_t uniqueIdx = BucketIndex(uniqueName);
+    size_t aliasIdx = BucketIndex(aliasName);
+    Bucket& uniqueBucket = buckets[uniqueIdx];
+    Bucket& aliasBucket = buckets[aliasIdx];
+    buckets[(std::min)(uniqueIdx, aliasIdx)].lock.Lock(MUTEX_CONTEXT);
+    if (uniqueIdx != aliasIdx) {
+        buckets[(std::max)(uniqueIdx, aliasIdx)].lock.Lock(MUTEX_CONTEXT);
+    }
+    PeerMap::iterator iter = uniqueBucket.peerMap.find(uniqueName);
+    if (iter == uniqueBucket.peerMap.end()) {
         QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() no state stored for %s aka %s", uniqueName.c_str(), aliasName.c_str()));
-        result = peerMap[aliasName];
-        peerMap[uniqueName] = result;
+        result = aliasBucket.peerMap[aliasName];
+        uniqueBucket.peerMap[uniqueName] = result;
     } else {
         QCC_DbgHLPrintf(("PeerStateTable::GetPeerState() got state for %s aka %s", uniqueName.c_str(), aliasName.c_str()));
         result = iter->second;
-        peerMap[aliasName] = result;
+        PeerMap::iterator aliasIter = aliasBucket.peerMap.find(aliasName);
+        if (aliasIter == aliasBucket.peerMap.end()) {
+            aliasBucket.peerMap.insert(PeerMap::value_type(aliasName, result));
+        } else if (!aliasIter->second.iden(result)) {
+            aliasIter->second = result;
+            IncrementAndFetch(&generation);
+        }
+    }
+    if (uniqueIdx != aliasIdx) {
+        buckets[(std::max)(uniqueIdx, aliasIdx)].lock.Unlock(MUTEX_CONTEXT);
     }
-    lock.Unlock(MUTEX_CONTEXT);
+    buckets[(std::min)(uniqueIdx, aliasIdx)].lock.Unlock(MUTEX_CONTEXT);
     return result;
 }
 
 void PeerStateTable::DelPeerState(const qcc::String& busName)
 {
-    lock.Lock(MUTEX_CONTEXT);
-    QCC_DbgHLPrintf(("PeerStateTable::DelPeerState() %s for %s", peerMap.count(busName) ? "remove state" : "no state to remove", busName.c_str()));
-    peerMap.erase(busName);
-    lock.Unlock(MUTEX_CONTEXT);
+    Bucket& bucket = buckets[BucketIndex(busName)];
+    bucket.lock.Lock(MUTEX_CONTEXT);
+    QCC_DbgHLPrintf(("PeerStateTable::DelPeerState() %s for %s", bucket.peerMap.count(busName) ? "remove state" : "no state to remove", busName.c_str()));
+    if (bucket.peerMap.erase(busName)) {
+        IncrementAndFetch(&generation);
+    }
+    bucket.lock.Unlock(MUTEX_CONTEXT);
 }
 
 void PeerStateTable::GetGroupKey(qcc::KeyBlob& key)
@@ -144,22 +202,31 @@ void PeerStateTable::GetGroupKey(qcc::KeyBlob& key)
 void PeerStateTable::Clear()
 {
     qcc::KeyBlob key;
-    lock.Lock(MUTEX_CONTEXT);
-    peerMap.clear();
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        buckets[i].lock.Lock(MUTEX_CONTEXT);
+    }
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        buckets[i].peerMap.clear();
+    }
+    IncrementAndFetch(&generation);
     PeerState nullPeer;
     QCC_DbgHLPrintf(("Allocating group key"));
     key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
     key.SetTag("GroupKey", KeyBlob::NO_ROLE);
     nullPeer->SetKey(key, PEER_SESSION_KEY);
-    peerMap[""] = nullPeer;
-    lock.Unlock(MUTEX_CONTEXT);
+    buckets[BucketIndex("")].peerMap[""] = nullPeer;
+    for (size_t i = NUM_BUCKETS; i > 0; --i) {
+        buckets[i - 1].lock.Unlock(MUTEX_CONTEXT);
+    }
 }
 
 PeerStateTable::~PeerStateTable()
 {
-    lock.Lock(MUTEX_CONTEXT);
-    peerMap.clear();
-    lock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        buckets[i].lock.Lock(MUTEX_CONTEXT);
+        buckets[i].peerMap.clear();
+        buckets[i].lock.Unlock(MUTEX_CONTEXT);
+    }
 }
 
 }
@@ -27,7 +27,6 @@
 
 #include <qcc/platform.h>
 
-#include <map>
 #include <limits>
 #include <assert.h>
 
@@ -40,9 +39,14 @@
 #include <qcc/Mutex.h>
 #include <qcc/Event.h>
 #include <qcc/time.h>
+#include <qcc/atomic.h>
 
 #include <alljoyn/Status.h>
 
+#include "AllJoynCrypto.h"
+
+#include <qcc/STLContainer.h>
+
 namespace ajn {
 
 /* Forward declaration */
@@ -142,6 +146,7 @@ class _PeerState {
      */
     void SetKey(const qcc::KeyBlob& key, PeerKeyType keyType) {
         keys[keyType] = key;
+        ciphers[keyType] = MessageCipher(key);
         isSecure = key.IsValid();
     }
 
@@ -168,12 +173,39 @@ class _PeerState {
         }
     }
 
+    /**
+     * Gets the cipher for a session key for this peer. The cipher holds the expanded key schedule
+     * for the key so it can be used for any number of messages.
+     *
+     * @param cipher    [out]Returns the cipher.
+     * @param keyType   Indicate if this is the unicast or broadcast key.
+     *
+     * @return  - ER_OK if there is a session key set for this peer.
+     *          - ER_BUS_KEY_UNAVAILABLE if no session key has been set for this peer.
+     *          - ER_BUS_KEY_EXPIRED if there was a session key but the key has expired.
+     */
+    QStatus GetCipher(MessageCipher& cipher, PeerKeyType keyType) {
+        if (isSecure) {
+            if (keys[keyType].HasExpired()) {
+                ClearKeys();
+                return ER_BUS_KEY_EXPIRED;
+            } else {
+                cipher = ciphers[keyType];
+                return ER_OK;
+            }
+        } else {
+            return ER_BUS_KEY_UNAVAILABLE;
+        }
+    }
+
     /**
      * Clear the keys for this peer.
      */
     void ClearKeys() {
         keys[PEER_SESSION_KEY].Erase();
         keys[PEER_GROUP_KEY].Erase();
+        ciphers[PEER_SESSION_KEY] = MessageCipher();
+        ciphers[PEER_GROUP_KEY] = MessageCipher();
         isSecure = false;
     }
 
@@ -315,6 +347,11 @@ class _PeerState {
      */
     qcc::KeyBlob keys[2];
 
+    /**
+     * Ciphers for the session keys, created when the keys are set.
+     */
+    MessageCipher ciphers[2];
+
     /**
      * Serial number window. Used by IsValidSerial() to detect replay attacks. The size of the
      * window defines that largest tolerable gap between consecutive serial numbers.
@@ -325,7 +362,21 @@ class _PeerState {
 
 
 /**
- * This class is a container for managing state information about remote peers.
+ * A single entry cache of a peer state lookup. A receive path that sees a run of messages from the
+ * same sender holds one of these so the peer state table is only consulted when the sender changes
+ * or the table has been modified since the entry was filled in.
+ */
+struct PeerStateCache {
+    PeerStateCache() : generation(-1) { }
+
+    qcc::String busName;   /**< The bus name the cached peer state belongs to */
+    PeerState peerState;   /**< The cached peer state */
+    int32_t generation;    /**< Generation of the peer state table when the entry was filled in */
+};
+
+/**
+ * This class is a container for managing state information about remote peers. The table is split
+ * into independently locked buckets so lookups for different peers do not contend on a single lock.
  */
 class PeerStateTable {
 
@@ -337,7 +388,7 @@ class PeerStateTable {
     PeerStateTable();
 
     /**
-     * Get the peer state for given a bus name.
+     * Get the peer state for given a bus name, creating a new peer state if there is none.
      *
      * @param busName   The bus name for a remote connection
      *
@@ -345,6 +396,27 @@ class PeerStateTable {
      */
     PeerState GetPeerState(const qcc::String& busName);
 
+    /**
+     * Get the peer state for a given bus name using a single entry cache. The cache must only be
+     * used by one thread at a time, typically the receive thread of an endpoint.
+     *
+     * @param busName   The bus name for a remote connection
+     * @param cache     The cache to check and update.
+     *
+     * @return  The peer state.
+     */
+    PeerState GetPeerState(const qcc::String& busName, PeerStateCache& cache);
+
+    /**
+     * Find the peer state for a given bus name without creating one.
+     *
+     * @param busName     The bus name for a remote connection
+     * @param peerState   [out]Returns the peer state if the peer is known.
+     *
+     * @return  Returns true if the peer is known.
+     */
+    bool FindPeerState(const qcc::String& busName, PeerState& peerState);
+
     /**
      * Fnd out if the bus name is for a known peer.
      *
@@ -353,10 +425,8 @@ class PeerStateTable {
      * @return  Returns true if the peer is known.
      */
     bool IsKnownPeer(const qcc::String& busName) {
-        lock.Lock(MUTEX_CONTEXT);
-        bool known = peerMap.count(busName) > 0;
-        lock.Unlock(MUTEX_CONTEXT);
-        return known;
+        PeerState peerState;
+        return FindPeerState(busName, peerState);
     }
 
     /**
@@ -378,7 +448,9 @@ class PeerStateTable {
      * @return  Returns true if the two bus names are known to refer to the same peer.
      */
     bool IsAlias(const qcc::String& name1, const qcc::String& name2) {
-        return (name1 == name2) || (GetPeerState(name1).iden(GetPeerState(name2)));
+        PeerState peer1;
+        PeerState peer2;
+        return (name1 == name2) || (FindPeerState(name1, peer1) && FindPeerState(name2, peer2) && peer1.iden(peer2));
     }
 
     /**
@@ -409,14 +481,52 @@ class PeerStateTable {
   private:
 
     /**
-     * Mapping table from bus names to peer state.
+     * Hash functor
+     */
+    struct Hash {
+        inline size_t operator()(const qcc::String& s) const {
+            return qcc::hash_string(s.c_str());
+        }
+    };
+
+    struct Equal {
+        inline bool operator()(const qcc::String& s1, const qcc::String& s2) const {
+            return s1 == s2;
+        }
+    };
+
+    typedef std::unordered_map<qcc::String, PeerState, Hash, Equal> PeerMap;
+
+    /**
+     * A bucket of the peer table.
+     */
+    struct Bucket {
+        qcc::Mutex lock;   /**< Mutex to protect this bucket */
+        PeerMap peerMap;   /**< Mapping from bus names to peer state for names that hash to this bucket */
+    };
+
+    /**
+     * Number of buckets the table is split into.
+     */
+    static const size_t NUM_BUCKETS = 16;
+
+    /**
+     * Get the bucket index for a bus name.
+     */
+    static size_t BucketIndex(const qcc::String& busName) {
+        return (qcc::hash_string(busName.c_str()) >> 4) % NUM_BUCKETS;
+    }
+
+    /**
+     * The buckets of the peer table.
      */
-    std::map<const qcc::String, PeerState> peerMap;
+    Bucket buckets[NUM_BUCKETS];
 
     /**
-     * Mutex to protect the peer table
+     * Incremented whenever an existing mapping is removed or replaced so cached lookups can be
+     * validated without taking a lock.
      */
-    qcc::Mutex lock;
+    volatile int32_t generation;
 
 };
 
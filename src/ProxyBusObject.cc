@@ -28,8 +28,6 @@
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
-#include <qcc/StringSource.h>
-#include <qcc/XmlElement.h>
 #include <qcc/Util.h>
 #include <qcc/Event.h>
 #include <qcc/Mutex.h>
@@ -47,6 +45,7 @@
 #include "AllJoynPeerObj.h"
 #include "BusInternal.h"
 #include "XmlHelper.h"
+#include "IntrospectionCache.h"
 
 #include <alljoyn/Status.h>
 
@@ -60,8 +59,42 @@ using namespace std;
 
 namespace ajn {
 
+/*
+ * Property values cached for the interfaces that property caching has been enabled for. The values
+ * are stored as the variants returned by Properties.Get. The generation for an interface is bumped by
+ * every PropertiesChanged signal so a value fetched from the remote object is only cached if no change
+ * was signalled while the fetch was in flight. A generation of zero means the interface is not cached.
+ *
+ * The cache only holds values while it is subscribed to the PropertiesChanged signals of the unique
+ * name that owned the service name when caching was enabled. It is detached, and its values dropped,
+ * if that owner goes away or the session to it is lost.
+ */
+struct PropertyCache {
+
+    struct Values {
+        Values() : generation(1) { }
+        map<qcc::String, MsgArg> props;
+        uint32_t generation;
+    };
+
+    PropertyCache() : hits(0), misses(0), active(false), detached(false) { }
+
+    /** True if values can be cached and read from the cache */
+    bool IsUsable() const { return active && !detached; }
+
+    map<qcc::String, Values> ifaces;
+    qcc::String sender;       /**< Unique name of the remote object's bus attachment */
+    qcc::String matchRule;    /**< Match rule for the remote object's PropertiesChanged signals */
+    uint32_t hits;
+    uint32_t misses;
+    bool active;              /**< True once the cache is subscribed to PropertiesChanged */
+    bool detached;            /**< True if the owner of the remote object changed or the session was lost */
+};
+
 struct ProxyBusObject::Components {
 
+    Components() : propCache(NULL) { }
+
     /** The interfaces this object implements */
     map<qcc::StringMapKey, const InterfaceDescription*> ifaces;
 
@@ -70,8 +103,21 @@ struct ProxyBusObject::Components {
 
     /** List of threads that are waiting in sync method calls */
     vector<Thread*> waitingThreads;
+
+    /** Cached property values, NULL unless property caching is enabled. Not shared by copies. */
+    PropertyCache* propCache;
 };
 
+/*
+ * Only properties that the remote object will tell us about when they change can be cached
+ */
+static bool IsCacheable(const InterfaceDescription* ifc, const char* property)
+{
+    qcc::String emitsChanged;
+    return ifc && ifc->GetPropertyAnnotation(property, org::freedesktop::DBus::AnnotateEmitsChanged, emitsChanged) &&
+           ((emitsChanged == "true") || (emitsChanged == "invalidates"));
+}
+
 template <typename _cbType> struct CBContext {
     CBContext(ProxyBusObject* obj, ProxyBusObject::Listener* listener, _cbType callback, void* context)
         : obj(obj), listener(listener), callback(callback), context(context) { }
@@ -85,9 +131,12 @@ template <typename _cbType> struct CBContext {
 QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value, uint32_t timeout) const
 {
     QStatus status;
+    uint32_t generation = 0;
     const InterfaceDescription* valueIface = bus->GetInterface(iface);
     if (!valueIface) {
         status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    } else if (GetCachedProperties(iface, value, generation)) {
+        status = ER_OK;
     } else {
         uint8_t flags = 0;
         if (valueIface->IsSecure()) {
@@ -102,6 +151,7 @@ QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value, uint3
             status = MethodCall(*(propIface->GetMember("GetAll")), &arg, 1, reply, timeout, flags);
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
+                CacheProperties(iface, value, generation);
             }
         }
     }
@@ -170,9 +220,12 @@ QStatus ProxyBusObject::GetAllPropertiesAsync(const char* iface,
 QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, MsgArg& value, uint32_t timeout) const
 {
     QStatus status;
+    uint32_t generation = 0;
     const InterfaceDescription* valueIface = bus->GetInterface(iface);
     if (!valueIface) {
         status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    } else if (GetCachedProperty(iface, property, value, generation)) {
+        status = ER_OK;
     } else {
         uint8_t flags = 0;
         if (valueIface->IsSecure()) {
@@ -189,6 +242,7 @@ QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, Msg
             status = MethodCall(*(propIface->GetMember("Get")), inArgs, numArgs, reply, timeout, flags);
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
+                CacheProperty(iface, property, value, generation);
             }
         }
     }
@@ -282,6 +336,9 @@ QStatus ProxyBusObject::SetProperty(const char* iface, const char* property, Msg
                                 reply,
                                 timeout,
                                 flags);
+            if (ER_OK == status) {
+                InvalidateCachedProperty(iface, property);
+            }
         }
     }
     return status;
@@ -348,6 +405,609 @@ QStatus ProxyBusObject::SetPropertyAsync(const char* iface,
     return status;
 }
 
+/*
+ * Maximum number of properties sent in one GetMultiple or SetMultiple call. Larger batches are
+ * split and the calls are pipelined.
+ */
+static const size_t MaxPropertiesPerCall = 64;
+
+/*
+ * How much longer than the call timeout BatchProperties() waits for the replies before it gives
+ * up on them. The reply timeouts normally fire first.
+ */
+static const uint32_t BatchWaitMargin = 1000;
+
+/*
+ * Collects the replies to the GetMultiple or SetMultiple calls made for one batch of properties.
+ * The batch is reference counted by the caller and each outstanding call so it outlives a caller
+ * that gives up waiting. Once the caller has given up the replies no longer touch its properties.
+ */
+class PropertyBatch : public MessageReceiver {
+  public:
+
+    struct Chunk {
+        ProxyBusObject::BatchProperty* props;
+        size_t numProps;
+    };
+
+    PropertyBatch(bool get) : get(get), refs(1), status(ER_OK), abandoned(false) { }
+
+    void Add()
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        ++refs;
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    /*
+     * Called once for each call, may delete the batch
+     */
+    void Done(QStatus result)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        if ((result != ER_OK) && (status == ER_OK)) {
+            status = result;
+        }
+        size_t remaining = --refs;
+        if (remaining == 1) {
+            /* Only the caller is left */
+            done.SetEvent();
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        if (remaining == 0) {
+            delete this;
+        }
+    }
+
+    /*
+     * Called once by the caller, may delete the batch
+     */
+    QStatus Wait(uint32_t timeout)
+    {
+        Event::Wait(done, timeout);
+        lock.Lock(MUTEX_CONTEXT);
+        QStatus result = status;
+        if (refs > 1) {
+            abandoned = true;
+            result = ER_TIMEOUT;
+        }
+        size_t remaining = --refs;
+        lock.Unlock(MUTEX_CONTEXT);
+        if (remaining == 0) {
+            delete this;
+        }
+        return result;
+    }
+
+    void BatchReplyHandler(Message& msg, void* context)
+    {
+        Chunk* chunk = reinterpret_cast<Chunk*>(context);
+        QStatus result = ER_OK;
+        lock.Lock(MUTEX_CONTEXT);
+        if (abandoned) {
+            /* The caller has returned so its properties must not be touched */
+            result = ER_TIMEOUT;
+        } else if (msg->GetType() == MESSAGE_METHOD_RET) {
+            size_t num;
+            if (get) {
+                const MsgArg* values;
+                result = msg->GetArg(0)->Get("a(qv)", &num, &values);
+                if ((result == ER_OK) && (num != chunk->numProps)) {
+                    result = ER_BUS_BAD_VALUE;
+                }
+                for (size_t i = 0; (result == ER_OK) && (i < num); ++i) {
+                    uint16_t rawStatus;
+                    MsgArg* val;
+                    result = values[i].Get("(qv)", &rawStatus, &val);
+                    if (result == ER_OK) {
+                        chunk->props[i].status = static_cast<QStatus>(rawStatus);
+                        if (rawStatus == ER_OK) {
+                            chunk->props[i].value = *val;
+                        }
+                    }
+                }
+            } else {
+                uint16_t* results;
+                result = msg->GetArg(0)->Get("aq", &num, &results);
+                if ((result == ER_OK) && (num != chunk->numProps)) {
+                    result = ER_BUS_BAD_VALUE;
+                }
+                for (size_t i = 0; (result == ER_OK) && (i < num); ++i) {
+                    chunk->props[i].status = static_cast<QStatus>(results[i]);
+                }
+            }
+        } else {
+            result = ER_BUS_REPLY_IS_ERROR_MESSAGE;
+            if (::strcmp(msg->GetErrorName(), org::alljoyn::Bus::ErrorName) == 0) {
+                const char* err;
+                uint16_t rawStatus;
+                if (msg->GetArgs("sq", &err, &rawStatus) == ER_OK) {
+                    result = static_cast<QStatus>(rawStatus);
+                }
+            }
+        }
+        if ((result != ER_OK) && !abandoned) {
+            for (size_t i = 0; i < chunk->numProps; ++i) {
+                chunk->props[i].status = result;
+            }
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        delete chunk;
+        Done(result);
+    }
+
+  private:
+
+    bool get;
+    qcc::Mutex lock;
+    qcc::Event done;
+    size_t refs;          /* The caller plus one for each outstanding call */
+    QStatus status;
+    bool abandoned;       /* The caller stopped waiting for the replies */
+};
+
+QStatus ProxyBusObject::GetProperties(BatchProperty* props, size_t numProps, uint32_t timeout) const
+{
+    return BatchProperties(props, numProps, true, timeout);
+}
+
+QStatus ProxyBusObject::SetProperties(BatchProperty* props, size_t numProps, uint32_t timeout) const
+{
+    return BatchProperties(props, numProps, false, timeout);
+}
+
+QStatus ProxyBusObject::BatchProperties(BatchProperty* props, size_t numProps, bool get, uint32_t timeout) const
+{
+    if (!props && numProps) {
+        return ER_BAD_ARG_1;
+    }
+    LocalEndpoint localEndpoint = bus->GetInternal().GetLocalEndpoint();
+    if (!localEndpoint->IsValid()) {
+        return ER_BUS_ENDPOINT_CLOSING;
+    }
+    /*
+     * if we're being called from the LocalEndpoint (callback) thread, do not allow
+     * blocking calls unless BusAttachment::EnableConcurrentCallbacks has been called first
+     */
+    if (localEndpoint->IsReentrantCall()) {
+        return ER_BUS_BLOCKING_CALL_NOT_ALLOWED;
+    }
+    const InterfaceDescription* batchIface = bus->GetInterface(org::alljoyn::Bus::Properties::InterfaceName);
+    if (!batchIface) {
+        return ER_BUS_NO_SUCH_INTERFACE;
+    }
+    const InterfaceDescription::Member* member = batchIface->GetMember(get ? "GetMultiple" : "SetMultiple");
+    assert(member);
+
+    /* If any of the interfaces is secure the whole batch must be encrypted */
+    uint8_t flags = 0;
+    for (size_t i = 0; i < numProps; ++i) {
+        const InterfaceDescription* valueIface = bus->GetInterface(props[i].iface);
+        if (valueIface && valueIface->IsSecure()) {
+            flags |= ALLJOYN_FLAG_ENCRYPTED;
+        }
+        props[i].status = ER_OK;
+    }
+
+    /*
+     * The batch interface is not part of the introspection data of remote objects so the calls
+     * are made through a proxy object that implements it.
+     */
+    ProxyBusObject batchProxy(*bus, serviceName.c_str(), path.c_str(), sessionId);
+    batchProxy.b2bEp = b2bEp;
+    batchProxy.AddInterface(*batchIface);
+
+    /* Issue all the calls before waiting for any of the replies */
+    PropertyBatch* batch = new PropertyBatch(get);
+    QStatus status = ER_OK;
+    for (size_t offset = 0; (status == ER_OK) && (offset < numProps); offset += MaxPropertiesPerCall) {
+        PropertyBatch::Chunk* chunk = new PropertyBatch::Chunk;
+        chunk->props = props + offset;
+        chunk->numProps = min(MaxPropertiesPerCall, numProps - offset);
+        MsgArg* entries = new MsgArg[chunk->numProps];
+        for (size_t i = 0; i < chunk->numProps; ++i) {
+            BatchProperty& prop = chunk->props[i];
+            const char* objPath = prop.path ? prop.path : path.c_str();
+            if (get) {
+                entries[i].Set("(oss)", objPath, prop.iface, prop.property);
+            } else {
+                entries[i].Set("(ossv)", objPath, prop.iface, prop.property, &prop.value);
+            }
+        }
+        MsgArg arg(get ? "a(oss)" : "a(ossv)", chunk->numProps, entries);
+        batch->Add();
+        status = batchProxy.MethodCallAsync(*member,
+                                            batch,
+                                            static_cast<MessageReceiver::ReplyHandler>(&PropertyBatch::BatchReplyHandler),
+                                            &arg,
+                                            1,
+                                            reinterpret_cast<void*>(chunk),
+                                            timeout,
+                                            flags);
+        if (status != ER_OK) {
+            /* This and any later properties are never sent */
+            for (size_t i = offset; i < numProps; ++i) {
+                props[i].status = status;
+            }
+            delete chunk;
+            batch->Done(status);
+        }
+        delete [] entries;
+    }
+    uint32_t waitTime = timeout ? timeout : DefaultCallTimeout;
+    waitTime = (waitTime > (Event::WAIT_FOREVER - BatchWaitMargin)) ? Event::WAIT_FOREVER : (waitTime + BatchWaitMargin);
+    QStatus result = batch->Wait(waitTime);
+    return (status == ER_OK) ? result : status;
+}
+
+QStatus ProxyBusObject::EnablePropertyCaching(const char* iface, uint32_t timeout)
+{
+    QStatus status = ER_OK;
+    if (!bus->GetInterface(iface)) {
+        return ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    }
+    if (!bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName)) {
+        return ER_BUS_NO_SUCH_INTERFACE;
+    }
+
+    /*
+     * The first caller installs the cache and subscribes it. The cache doesn't hold values until the
+     * subscription is complete so concurrent callers can add their interface straight away. A cache
+     * that was detached from the remote object is replaced.
+     */
+    PropertyCache* cache = NULL;
+    PropertyCache* stale = NULL;
+    lock->Lock(MUTEX_CONTEXT);
+    if (components->propCache && components->propCache->active && components->propCache->detached) {
+        stale = components->propCache;
+        components->propCache = NULL;
+    }
+    if (!components->propCache) {
+        cache = new PropertyCache();
+        components->propCache = cache;
+    }
+    components->propCache->ifaces[iface];
+    lock->Unlock(MUTEX_CONTEXT);
+
+    if (stale) {
+        UnsubscribePropertyCache(stale->matchRule);
+        delete stale;
+    }
+
+    if (cache) {
+        /* The signals are sent from the unique name so resolve the service name if it is a well-known name */
+        qcc::String sender = serviceName;
+        qcc::String matchRule;
+        if (serviceName[0] != ':') {
+            Message reply(*bus);
+            MsgArg arg("s", serviceName.c_str());
+            status = bus->GetDBusProxyObj().MethodCall(org::freedesktop::DBus::InterfaceName, "GetNameOwner", &arg, 1, reply);
+            if (ER_OK == status) {
+                sender = reply->GetArg(0)->v_string.str;
+            }
+        }
+        if (ER_OK == status) {
+            matchRule = "type='signal',sender='" + sender + "',path='" + path + "',interface='" +
+                        org::freedesktop::DBus::Properties::InterfaceName + "',member='PropertiesChanged'";
+            status = SubscribePropertyCache(matchRule);
+        }
+        bool installed = false;
+        lock->Lock(MUTEX_CONTEXT);
+        if (components && (components->propCache == cache)) {
+            if (ER_OK == status) {
+                cache->sender = sender;
+                cache->matchRule = matchRule;
+                cache->active = true;
+                installed = true;
+            } else {
+                components->propCache = NULL;
+                delete cache;
+            }
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+        if (ER_OK != status) {
+            QCC_LogError(status, ("Failed to subscribe to PropertiesChanged for %s", path.c_str()));
+        } else if (!installed) {
+            /* Caching was disabled while we were subscribing */
+            UnsubscribePropertyCache(matchRule);
+        }
+    }
+
+    /* Populate the cache for the interface */
+    if (ER_OK == status) {
+        MsgArg values;
+        status = GetAllProperties(iface, values, timeout);
+    }
+    return status;
+}
+
+void ProxyBusObject::DisablePropertyCaching()
+{
+    if (!lock) {
+        return;
+    }
+    lock->Lock(MUTEX_CONTEXT);
+    PropertyCache* cache = NULL;
+    if (components) {
+        cache = components->propCache;
+        components->propCache = NULL;
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+
+    if (cache) {
+        UnsubscribePropertyCache(cache->matchRule);
+        delete cache;
+    }
+}
+
+QStatus ProxyBusObject::SubscribePropertyCache(const qcc::String& matchRule)
+{
+    const InterfaceDescription* propIface = bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+    const InterfaceDescription* dbusIface = bus->GetInterface(org::freedesktop::DBus::InterfaceName);
+    const InterfaceDescription* ajIface = bus->GetInterface(org::alljoyn::Bus::InterfaceName);
+    if (!propIface || !dbusIface || !ajIface) {
+        return ER_BUS_NO_SUCH_INTERFACE;
+    }
+    QStatus status = bus->RegisterSignalHandler(this,
+                                                static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertiesChangedHandler),
+                                                propIface->GetMember("PropertiesChanged"),
+                                                path.c_str());
+    /*
+     * The bus attachment already receives all org.freedesktop.DBus signals and the SessionLost
+     * signals for its sessions so these handlers don't need match rules of their own.
+     */
+    if (ER_OK == status) {
+        status = bus->RegisterSignalHandler(this,
+                                            static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertyCacheOwnerHandler),
+                                            dbusIface->GetMember("NameOwnerChanged"),
+                                            NULL);
+    }
+    if ((ER_OK == status) && (sessionId != 0)) {
+        status = bus->RegisterSignalHandler(this,
+                                            static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertyCacheOwnerHandler),
+                                            ajIface->GetMember("SessionLost"),
+                                            NULL);
+    }
+    if (ER_OK == status) {
+        status = bus->AddMatch(matchRule.c_str());
+    }
+    if (ER_OK != status) {
+        UnsubscribePropertyCache(qcc::String());
+    }
+    return status;
+}
+
+void ProxyBusObject::UnsubscribePropertyCache(const qcc::String& matchRule)
+{
+    const InterfaceDescription* propIface = bus->GetInterface(org::freedesktop::DBus::Properties::InterfaceName);
+    if (propIface) {
+        bus->UnregisterSignalHandler(this,
+                                     static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertiesChangedHandler),
+                                     propIface->GetMember("PropertiesChanged"),
+                                     path.c_str());
+    }
+    const InterfaceDescription* dbusIface = bus->GetInterface(org::freedesktop::DBus::InterfaceName);
+    if (dbusIface) {
+        bus->UnregisterSignalHandler(this,
+                                     static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertyCacheOwnerHandler),
+                                     dbusIface->GetMember("NameOwnerChanged"),
+                                     NULL);
+    }
+    const InterfaceDescription* ajIface = bus->GetInterface(org::alljoyn::Bus::InterfaceName);
+    if (ajIface && (sessionId != 0)) {
+        bus->UnregisterSignalHandler(this,
+                                     static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertyCacheOwnerHandler),
+                                     ajIface->GetMember("SessionLost"),
+                                     NULL);
+    }
+    if (!matchRule.empty()) {
+        bus->RemoveMatch(matchRule.c_str());
+    }
+}
+
+void ProxyBusObject::PropertyCacheOwnerHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    if (numArgs < 1) {
+        return;
+    }
+    bool lost;
+    if (member->name == "SessionLost") {
+        lost = (args[0].typeId == ALLJOYN_UINT32) && (args[0].v_uint32 == sessionId);
+    } else {
+        /* Any change of owner of the service name means the cached values may be for another object */
+        lost = (args[0].typeId == ALLJOYN_STRING) && (serviceName == args[0].v_string.str);
+    }
+    if (lost) {
+        lock->Lock(MUTEX_CONTEXT);
+        if (components && components->propCache && !components->propCache->detached) {
+            QCC_DbgPrintf(("Discarding cached properties of %s %s", serviceName.c_str(), path.c_str()));
+            map<qcc::String, PropertyCache::Values>::iterator it;
+            for (it = components->propCache->ifaces.begin(); it != components->propCache->ifaces.end(); ++it) {
+                it->second.props.clear();
+                ++it->second.generation;
+            }
+            components->propCache->detached = true;
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+    }
+}
+
+void ProxyBusObject::GetPropertyCacheStats(uint32_t& hits, uint32_t& misses) const
+{
+    hits = 0;
+    misses = 0;
+    if (lock) {
+        lock->Lock(MUTEX_CONTEXT);
+        if (components && components->propCache) {
+            hits = components->propCache->hits;
+            misses = components->propCache->misses;
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+    }
+}
+
+bool ProxyBusObject::GetCachedProperty(const char* iface, const char* property, MsgArg& value, uint32_t& generation) const
+{
+    bool hit = false;
+    generation = 0;
+    lock->Lock(MUTEX_CONTEXT);
+    PropertyCache* propCache = components->propCache;
+    if (propCache && propCache->IsUsable()) {
+        map<qcc::String, PropertyCache::Values>::iterator it = propCache->ifaces.find(iface);
+        if (it != propCache->ifaces.end()) {
+            map<qcc::String, MsgArg>::const_iterator pit = it->second.props.find(property);
+            if (pit != it->second.props.end()) {
+                value = pit->second;
+                ++propCache->hits;
+                hit = true;
+            } else {
+                generation = it->second.generation;
+                ++propCache->misses;
+            }
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+    return hit;
+}
+
+bool ProxyBusObject::GetCachedProperties(const char* iface, MsgArg& values, uint32_t& generation) const
+{
+    bool hit = false;
+    generation = 0;
+    const InterfaceDescription* ifc = bus->GetInterface(iface);
+    size_t numProps = ifc ? ifc->GetProperties() : 0;
+    const InterfaceDescription::Property** props = new const InterfaceDescription::Property *[numProps];
+    if (ifc) {
+        ifc->GetProperties(props, numProps);
+    }
+    lock->Lock(MUTEX_CONTEXT);
+    PropertyCache* propCache = components->propCache;
+    if (propCache && propCache->IsUsable()) {
+        map<qcc::String, PropertyCache::Values>::iterator it = propCache->ifaces.find(iface);
+        if (it != propCache->ifaces.end()) {
+            /* All readable properties must be in the cache to answer locally */
+            vector<const MsgArg*> cached;
+            vector<const char*> names;
+            size_t readable = 0;
+            for (size_t i = 0; i < numProps; ++i) {
+                if (props[i]->access & PROP_ACCESS_READ) {
+                    ++readable;
+                    map<qcc::String, MsgArg>::const_iterator pit = it->second.props.find(props[i]->name);
+                    if (pit != it->second.props.end()) {
+                        cached.push_back(&pit->second);
+                        names.push_back(props[i]->name.c_str());
+                    }
+                }
+            }
+            if (cached.size() == readable) {
+                MsgArg* dict = new MsgArg[readable];
+                for (size_t i = 0; i < readable; ++i) {
+                    dict[i].Set("{sv}", names[i], cached[i]->v_variant.val);
+                    /* Copy the name and value out of the cache */
+                    dict[i].Stabilize();
+                }
+                values.Set("a{sv}", readable, dict);
+                values.SetOwnershipFlags(MsgArg::OwnsArgs);
+                ++propCache->hits;
+                hit = true;
+            } else {
+                generation = it->second.generation;
+                ++propCache->misses;
+            }
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+    delete [] props;
+    return hit;
+}
+
+void ProxyBusObject::CacheProperty(const char* iface, const char* property, const MsgArg& value, uint32_t generation) const
+{
+    if (generation && IsCacheable(bus->GetInterface(iface), property)) {
+        lock->Lock(MUTEX_CONTEXT);
+        PropertyCache* propCache = components->propCache;
+        if (propCache && propCache->IsUsable()) {
+            map<qcc::String, PropertyCache::Values>::iterator it = propCache->ifaces.find(iface);
+            if ((it != propCache->ifaces.end()) && (it->second.generation == generation)) {
+                it->second.props[property] = value;
+            }
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+    }
+}
+
+void ProxyBusObject::CacheProperties(const char* iface, const MsgArg& values, uint32_t generation) const
+{
+    MsgArg* entries;
+    size_t num;
+    if (generation && (values.Get("a{sv}", &num, &entries) == ER_OK)) {
+        const InterfaceDescription* ifc = bus->GetInterface(iface);
+        lock->Lock(MUTEX_CONTEXT);
+        PropertyCache* propCache = components->propCache;
+        if (propCache && propCache->IsUsable()) {
+            map<qcc::String, PropertyCache::Values>::iterator it = propCache->ifaces.find(iface);
+            if ((it != propCache->ifaces.end()) && (it->second.generation == generation)) {
+                for (size_t i = 0; i < num; ++i) {
+                    const char* property = entries[i].v_dictEntry.key->v_string.str;
+                    if (IsCacheable(ifc, property)) {
+                        it->second.props[property] = *entries[i].v_dictEntry.val;
+                    }
+                }
+            }
+        }
+        lock->Unlock(MUTEX_CONTEXT);
+    }
+}
+
+void ProxyBusObject::InvalidateCachedProperty(const char* iface, const char* property) const
+{
+    lock->Lock(MUTEX_CONTEXT);
+    PropertyCache* propCache = components->propCache;
+    if (propCache && propCache->IsUsable()) {
+        map<qcc::String, PropertyCache::Values>::iterator it = propCache->ifaces.find(iface);
+        if (it != propCache->ifaces.end()) {
+            it->second.props.erase(property);
+            ++it->second.generation;
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+{
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+    if (numArgs < 3) {
+        return;
+    }
+    MsgArg* changed;
+    size_t numChanged;
+    MsgArg* invalidated;
+    size_t numInvalidated;
+    if ((args[1].Get("a{sv}", &numChanged, &changed) != ER_OK) || (args[2].Get("as", &numInvalidated, &invalidated) != ER_OK)) {
+        return;
+    }
+    lock->Lock(MUTEX_CONTEXT);
+    PropertyCache* propCache = components->propCache;
+    if (propCache && propCache->IsUsable() && (propCache->sender == msg->GetSender())) {
+        map<qcc::String, PropertyCache::Values>::iterator it = propCache->ifaces.find(args[0].v_string.str);
+        if (it != propCache->ifaces.end()) {
+            ++it->second.generation;
+            for (size_t i = 0; i < numChanged; ++i) {
+                it->second.props[changed[i].v_dictEntry.key->v_string.str] = *changed[i].v_dictEntry.val;
+            }
+            for (size_t i = 0; i < numInvalidated; ++i) {
+                it->second.props.erase(invalidated[i].v_string.str);
+            }
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
 size_t ProxyBusObject::GetInterfaces(const InterfaceDescription** ifaces, size_t numIfaces) const
 {
     lock->Lock(MUTEX_CONTEXT);
@@ -708,6 +1368,168 @@ QStatus ProxyBusObject::MethodCallAsync(const char* ifaceName,
     return MethodCallAsync(*member, receiver, replyHandler, args, numArgs, context, timeout, flags);
 }
 
+/*
+ * Collects the replies to a pipelined batch of method calls and delivers them in one callback.
+ */
+class PipelinedReplies : public MessageReceiver {
+  public:
+
+    PipelinedReplies(BusAttachment& bus, size_t numCalls, MessageReceiver* receiver, MessageReceiver::BatchReplyHandler replyFunc, void* context) :
+        receiver(receiver), replyFunc(replyFunc), context(context), outstanding(numCalls + 1)
+    {
+        replies.reserve(numCalls);
+        for (size_t i = 0; i < numCalls; ++i) {
+            replies.push_back(Message(bus));
+        }
+    }
+
+    void PipelinedReplyHandler(Message& msg, void* context)
+    {
+        SetReply(reinterpret_cast<size_t>(context), msg);
+    }
+
+    void SetReply(size_t index, Message& msg)
+    {
+        replies[index] = msg;
+        Done();
+    }
+
+    /*
+     * Called once for each reply and once by the caller after all of the calls have been sent.
+     * The batch reply handler is called by whichever comes last.
+     */
+    void Done()
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        bool last = (--outstanding == 0);
+        lock.Unlock(MUTEX_CONTEXT);
+        if (last) {
+            (receiver->*replyFunc)(&replies[0], replies.size(), context);
+            delete this;
+        }
+    }
+
+  private:
+
+    MessageReceiver* receiver;
+    MessageReceiver::BatchReplyHandler replyFunc;
+    void* context;
+    std::vector<Message> replies;
+    qcc::Mutex lock;
+    size_t outstanding;
+};
+
+QStatus ProxyBusObject::MethodCallPipelined(const PipelinedCall* calls,
+                                            size_t numCalls,
+                                            MessageReceiver* receiver,
+                                            MessageReceiver::BatchReplyHandler replyFunc,
+                                            void* context,
+                                            uint32_t timeout,
+                                            uint8_t flags) const
+{
+    if (!calls || !numCalls) {
+        return ER_BAD_ARG_1;
+    }
+    if (!receiver || !replyFunc) {
+        return ER_BAD_ARG_3;
+    }
+    LocalEndpoint localEndpoint = bus->GetInternal().GetLocalEndpoint();
+    if (!localEndpoint->IsValid()) {
+        return ER_BUS_ENDPOINT_CLOSING;
+    }
+
+    /* Marshal all of the calls first so nothing is sent if any of them is invalid */
+    QStatus status = ER_OK;
+    std::vector<Message> msgs;
+    msgs.reserve(numCalls);
+    for (size_t i = 0; (status == ER_OK) && (i < numCalls); ++i) {
+        const InterfaceDescription::Member* method = calls[i].method;
+        if (!method) {
+            status = ER_BAD_ARG_1;
+            break;
+        }
+        /*
+         * This object must implement the interface for this method
+         */
+        if (!ImplementsInterface(method->iface->GetName())) {
+            status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+            QCC_LogError(status, ("Object %s does not implement %s", path.c_str(), method->iface->GetName()));
+            break;
+        }
+        uint8_t callFlags = flags & ~ALLJOYN_FLAG_NO_REPLY_EXPECTED;
+        if (method->iface->IsSecure()) {
+            callFlags |= ALLJOYN_FLAG_ENCRYPTED;
+        }
+        if ((callFlags & ALLJOYN_FLAG_ENCRYPTED) && !bus->IsPeerSecurityEnabled()) {
+            status = ER_BUS_SECURITY_NOT_ENABLED;
+            break;
+        }
+        Message msg(*bus);
+        status = msg->CallMsg(method->signature, serviceName, sessionId, path, method->iface->GetName(), method->name, calls[i].args, calls[i].numArgs, callFlags);
+        msgs.push_back(msg);
+    }
+    if (status != ER_OK) {
+        return status;
+    }
+
+    PipelinedReplies* replies = new PipelinedReplies(*bus, numCalls, receiver, replyFunc, context);
+    for (size_t i = 0; i < numCalls; ++i) {
+        status = localEndpoint->RegisterReplyHandler(replies,
+                                                     static_cast<MessageReceiver::ReplyHandler>(&PipelinedReplies::PipelinedReplyHandler),
+                                                     *calls[i].method,
+                                                     msgs[i],
+                                                     reinterpret_cast<void*>(i),
+                                                     timeout);
+        if (status != ER_OK) {
+            /* None of the calls have been sent yet so the batch can be abandoned */
+            for (size_t j = 0; j < i; ++j) {
+                localEndpoint->UnregisterReplyHandler(msgs[j]);
+            }
+            delete replies;
+            return status;
+        }
+    }
+
+    /*
+     * Queue the calls back to back. Once the first call is queued the transmit side drains the
+     * rest in the same write callback.
+     */
+    size_t sent = 0;
+    for (; (status == ER_OK) && (sent < numCalls); ++sent) {
+        if (b2bEp->IsValid()) {
+            status = b2bEp->PushMessage(msgs[sent]);
+        } else {
+            BusEndpoint busEndpoint = BusEndpoint::cast(localEndpoint);
+            status = bus->GetInternal().GetRouter().PushMessage(msgs[sent], busEndpoint);
+        }
+        if (status != ER_OK) {
+            break;
+        }
+    }
+    if (status != ER_OK) {
+        /* Calls that were not sent and are still waiting for a reply get an error reply */
+        std::vector<size_t> unsent;
+        for (size_t i = sent; i < numCalls; ++i) {
+            if (localEndpoint->UnregisterReplyHandler(msgs[i])) {
+                unsent.push_back(i);
+            }
+        }
+        if (unsent.size() == numCalls) {
+            /* Nothing was sent so report the error instead of calling the reply handler */
+            delete replies;
+            return status;
+        }
+        QCC_LogError(status, ("Pipelined method call failed after %u of %u calls were sent", (unsigned int)sent, (unsigned int)numCalls));
+        for (size_t i = 0; i < unsent.size(); ++i) {
+            Message error(*bus);
+            error->ErrorMsg(status, msgs[unsent[i]]->GetCallSerial());
+            replies->SetReply(unsent[i], error);
+        }
+    }
+    replies->Done();
+    return ER_OK;
+}
+
 /**
  * Internal context structure used between synchronous method_call and method_return
  */
@@ -784,7 +1606,8 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
                                                      method,
                                                      msg,
                                                      heapCtx,
-                                                     timeout);
+                                                     timeout,
+                                                     true);
         if (status == ER_OK) {
             if (b2bEp->IsValid()) {
                 status = b2bEp->PushMessage(msg);
@@ -935,6 +1758,37 @@ QStatus ProxyBusObject::IntrospectRemoteObject(uint32_t timeout)
         AddInterface(*introIntf);
     }
 
+    /*
+     * If the introspection cache is enabled ask the remote object for the digest of its
+     * introspection data first. Peers that don't support the digest return an error in which case
+     * we simply fall back to a full introspection.
+     */
+    IntrospectionCache* cache = bus->GetInternal().GetIntrospectionCache();
+    if (cache) {
+        ProxyBusObject digestProxy(*bus, serviceName.c_str(), path.c_str(), sessionId);
+        digestProxy.b2bEp = b2bEp;
+        const InterfaceDescription* digestIntf = bus->GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+        assert(digestIntf);
+        digestProxy.AddInterface(*digestIntf);
+        Message reply(*bus);
+        QStatus status = digestProxy.MethodCall(*digestIntf->GetMember("IntrospectDigest"), NULL, 0, reply, timeout);
+        if (ER_OK == status) {
+            uint8_t* digest;
+            size_t len;
+            qcc::String xml;
+            status = reply->GetArg(0)->Get("ay", &len, &digest);
+            if ((ER_OK == status) && (len == IntrospectionCache::DIGEST_SIZE) && cache->Find(qcc::String((const char*)digest, len), xml)) {
+                qcc::String ident = reply->GetSender();
+                ident += " : ";
+                ident += reply->GetObjectPath();
+                status = ParseXml(xml.c_str(), ident.c_str());
+                if (ER_OK == status) {
+                    return status;
+                }
+            }
+        }
+    }
+
     /* Attempt to retrieve introspection from the remote object using sync call */
     Message reply(*bus);
     const InterfaceDescription::Member* introMember = introIntf->GetMember("Introspect");
@@ -949,6 +1803,10 @@ QStatus ProxyBusObject::IntrospectRemoteObject(uint32_t timeout)
         ident += reply->GetObjectPath();
         status = ParseXml(reply->GetArg(0)->v_string.str, ident.c_str());
     }
+    /* Only cache introspection data that parsed correctly */
+    if ((ER_OK == status) && cache) {
+        cache->Add(reply->GetArg(0)->v_string.str);
+    }
     return status;
 }
 
@@ -1009,16 +1867,9 @@ void ProxyBusObject::IntrospectMethodCB(Message& msg, void* context)
 
 QStatus ProxyBusObject::ParseXml(const char* xml, const char* ident)
 {
-    StringSource source(xml);
-
     /* Parse the XML to update this ProxyBusObject instance (plus any new children and interfaces) */
-    XmlParseContext pc(source);
-    QStatus status = XmlElement::Parse(pc);
-    if (status == ER_OK) {
-        XmlHelper xmlHelper(bus, ident ? ident : path.c_str());
-        status = xmlHelper.AddProxyObjects(*this, pc.GetRoot());
-    }
-    return status;
+    XmlHelper xmlHelper(bus, ident ? ident : path.c_str());
+    return xmlHelper.AddProxyObjects(*this, xml);
 }
 
 ProxyBusObject::~ProxyBusObject()
@@ -1032,6 +1883,7 @@ ProxyBusObject::~ProxyBusObject()
 
 void ProxyBusObject::DestructComponents()
 {
+    DisablePropertyCaching();
     if (lock && components) {
         lock->Lock(MUTEX_CONTEXT);
         isExiting = true;
@@ -1092,6 +1944,7 @@ ProxyBusObject::ProxyBusObject(const ProxyBusObject& other) :
     isExiting(false)
 {
     *components = *other.components;
+    components->propCache = NULL;
 }
 
 ProxyBusObject& ProxyBusObject::operator=(const ProxyBusObject& other)
@@ -1101,6 +1954,7 @@ ProxyBusObject& ProxyBusObject::operator=(const ProxyBusObject& other)
         if (other.components) {
             components = new Components();
             *components = *other.components;
+            components->propCache = NULL;
             if (!lock) {
                 lock = new Mutex();
             }
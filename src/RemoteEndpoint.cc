@@ -82,6 +82,8 @@ class _RemoteEndpoint::Internal {
         hasRxSessionMsg(false),
         getNextMsg(true),
         currentWriteMsg(bus),
+        txShared(0),
+        txCopied(0),
         stopping(false),
         sessionId(0)
     {
@@ -125,7 +127,11 @@ class _RemoteEndpoint::Internal {
     bool validateSender;                     /**< If true, the sender field on incomming messages will be overwritten with actual endpoint name */
     bool hasRxSessionMsg;                    /**< true iff this endpoint has previously processed a non-control message */
     bool getNextMsg;                         /**< If true, read the next message from the txQueue */
-    Message currentWriteMsg;                 /**< The message currently being read for this endpoint */
+    Message currentWriteMsg;                 /**< The message currently being written for this endpoint */
+    PeerStateCache peerStateCache;           /**< Peer state of the last sender seen by the rx path */
+    _Message::WriteCursor writeCursor;       /**< Write progress of currentWriteMsg on this endpoint */
+    uint32_t txShared;                       /**< Number of messages written from a buffer shared with other endpoints */
+    uint32_t txCopied;                       /**< Number of messages that were copied before being written */
     bool stopping;                           /**< Is this EP stopping? */
     uint32_t sessionId;                      /**< SessionId for BusToBus endpoint. (not used for non-B2B endpoints) */
 };
@@ -187,6 +193,25 @@ const qcc::String&  _RemoteEndpoint::GetConnectSpec() const
     }
 }
 
+uint32_t _RemoteEndpoint::GetTxSharedCount() const
+{
+    return internal ? internal->txShared : 0;
+}
+
+uint32_t _RemoteEndpoint::GetTxCopiedCount() const
+{
+    return internal ? internal->txCopied : 0;
+}
+
+PeerState _RemoteEndpoint::GetPeerState(PeerStateTable& peerStateTable, const qcc::String& sender)
+{
+    if (internal) {
+        return peerStateTable.GetPeerState(sender, internal->peerStateCache);
+    } else {
+        return peerStateTable.GetPeerState(sender);
+    }
+}
+
 bool _RemoteEndpoint::IsIncomingConnection() const
 {
     if (internal) {
@@ -239,6 +264,20 @@ QStatus _RemoteEndpoint::Establish(const qcc::String& authMechanisms, qcc::Strin
     return status;
 }
 
+QStatus _RemoteEndpoint::EstablishDirect(const qcc::String& peerName)
+{
+    if (!internal) {
+        return ER_BUS_NO_ENDPOINT;
+    }
+    internal->uniqueName = peerName;
+    internal->remoteName = peerName;
+    internal->validateSender = true;
+    internal->features.handlePassing = true;
+    internal->features.protocolVersion = ALLJOYN_PROTOCOL_VERSION;
+    internal->features.trusted = true;
+    return ER_OK;
+}
+
 QStatus _RemoteEndpoint::SetLinkTimeout(uint32_t& idleTimeout)
 {
     if (internal) {
@@ -466,6 +505,7 @@ void _RemoteEndpoint::ExitCallback() {
     }
 
     internal->lock.Unlock(MUTEX_CONTEXT);
+    QCC_DbgPrintf(("Endpoint %s wrote %u shared and %u copied messages", GetUniqueName().c_str(), internal->txShared, internal->txCopied));
     RemoteEndpoint rep = RemoteEndpoint::wrap(this);
     /* Un-register this remote endpoint from the router */
     internal->bus.GetInternal().GetRouter().UnregisterEndpoint(this->GetUniqueName(), this->GetEndpointType());
@@ -691,10 +731,18 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
         if (internal->getNextMsg) {
             internal->lock.Lock(MUTEX_CONTEXT);
             if (!internal->txQueue.empty()) {
-                /* Make a deep copy of the message since there is state information inside the message.
-                 * Each copy of the message could be in different write state.
+                /* The write state is kept in the endpoint so the same marshaled message can be
+                 * written to any number of endpoints without copying it. A deep copy is only needed
+                 * if delivery rewrites the message buffer (i.e. the message is encrypted in place).
                  */
-                internal->currentWriteMsg = Message(internal->txQueue.back(), true);
+                if (internal->txQueue.back()->IsModifiedOnDelivery()) {
+                    internal->currentWriteMsg = Message(internal->txQueue.back(), true);
+                    ++internal->txCopied;
+                } else {
+                    internal->currentWriteMsg = internal->txQueue.back();
+                    ++internal->txShared;
+                }
+                internal->writeCursor = _Message::WriteCursor();
 
                 /* Alert next thread on wait queue */
                 if (0 < internal->txWaitQueue.size()) {
@@ -716,7 +764,7 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
         }
         /* Deliver message */
         RemoteEndpoint rep = RemoteEndpoint::wrap(this);
-        status = internal->currentWriteMsg->DeliverNonBlocking(rep);
+        status = internal->currentWriteMsg->DeliverNonBlocking(rep, internal->writeCursor);
         /* Report authorization failure as a security violation */
         if (status == ER_BUS_NOT_AUTHORIZED) {
             internal->bus.GetInternal().GetLocalEndpoint()->GetPeerObj()->HandleSecurityViolation(internal->currentWriteMsg, status);
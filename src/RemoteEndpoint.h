@@ -34,6 +34,7 @@
 
 #include "BusEndpoint.h"
 #include "EndpointAuth.h"
+#include "PeerState.h"
 
 #include <alljoyn/Status.h>
 
@@ -62,7 +63,8 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
 
       public:
 
-        Features() : isBusToBus(false), allowRemote(false), handlePassing(false), ajVersion(0), protocolVersion(0), processId(0), trusted(false)
+        Features() : isBusToBus(false), allowRemote(false), handlePassing(false), ajVersion(0), protocolVersion(0), processId(0), trusted(false),
+            nameChanges(false)
         { }
 
         bool isBusToBus;       /**< When initiating connection this is an input value indicating if this is a bus-to-bus connection.
@@ -82,6 +84,8 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
         uint32_t processId;        /**< Process id optionally obtained from the remote peer */
 
         bool trusted;              /**< Indicated if the remote client was trusted */
+
+        bool nameChanges;          /**< Indicates if the remote daemon has announced that it accepts batched NameChanges signals */
     };
 
     /**
@@ -270,6 +274,20 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     QStatus Establish(const qcc::String& authMechanisms, qcc::String& authUsed, qcc::String& redirection, AuthListener* listener = NULL);
 
+    /**
+     * Establish an endpoint on a channel the daemon handed to the two members of a point-to-point
+     * session on the same device. There is no authentication handshake; the daemon only gives the
+     * channel to the two members. The sender field of every message received is checked against
+     * the peer's unique name.
+     *
+     * @param peerName   Unique name of the other member of the session.
+     *
+     * @return
+     *      - ER_OK if successful.
+     *      - ER_BUS_NO_ENDPOINT if the endpoint is not initialized.
+     */
+    QStatus EstablishDirect(const qcc::String& peerName);
+
     /**
      * Get the GUID of the remote side of a bus-to-bus endpoint.
      *
@@ -284,6 +302,34 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     const qcc::String& GetConnectSpec() const;
 
+    /**
+     * Get the number of messages written by this endpoint directly from a marshaled message
+     * buffer that may be shared with other endpoints.
+     *
+     * @return The number of shared (zero-copy) message writes.
+     */
+    uint32_t GetTxSharedCount() const;
+
+    /**
+     * Get the number of messages this endpoint had to copy before writing them because
+     * delivery modifies the message buffer.
+     *
+     * @return The number of copied message writes.
+     */
+    uint32_t GetTxCopiedCount() const;
+
+    /**
+     * Get the peer state for the sender of a message received on this endpoint. The peer state of
+     * the last sender is cached so a run of messages from the same sender skips the table lookup.
+     * Must only be called from the receive path of this endpoint.
+     *
+     * @param peerStateTable  The peer state table to look the sender up in on a cache miss.
+     * @param sender          The sender of the received message.
+     *
+     * @return The peer state for the sender.
+     */
+    PeerState GetPeerState(PeerStateTable& peerStateTable, const qcc::String& sender);
+
     /**
      * Indicate whether this endpoint can receive messages from other devices.
      *
@@ -0,0 +1,244 @@
+/**
+ * @file
+ * SharedMemoryStream is a socket stream that moves message bytes through shared memory rings
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef _ALLJOYN_SHAREDMEMORYSTREAM_H
+#define _ALLJOYN_SHAREDMEMORYSTREAM_H
+
+#ifndef __cplusplus
+#error Only include SharedMemoryStream.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <deque>
+
+#include <qcc/Event.h>
+#include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
+
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * %SharedMemoryStream starts out as a plain socket stream. Once Attach() is called all bytes are
+ * exchanged through a pair of single producer, single consumer rings in memory shared by the two
+ * ends of the connection. The socket is only used to wake up a reader that is waiting for data
+ * and to pass file descriptors. A second socket carries wake-ups for a writer that is waiting for
+ * space in its ring.
+ */
+class SharedMemoryStream : public qcc::SocketStream {
+  public:
+
+    /**
+     * Default size of each of the two rings
+     */
+    static const uint32_t DefaultRingSize = 256 * 1024;
+
+    /**
+     * Value of the credentials byte sent by a client that is offering shared memory.
+     */
+    static const uint8_t Offer = 'S';
+
+    /**
+     * Reply sent by the daemon when it has attached to the shared memory offered by the client.
+     */
+    static const uint8_t Accept = 'A';
+
+    /**
+     * Reply sent by the daemon when it declines the shared memory offered by the client.
+     */
+    static const uint8_t Decline = 'D';
+
+    /**
+     * Create a shared memory stream on a connected socket.
+     *
+     * @param sock  The connected socket.
+     */
+    SharedMemoryStream(qcc::SocketFd sock);
+
+    /**
+     * Destructor
+     */
+    virtual ~SharedMemoryStream();
+
+    /**
+     * Create the shared memory and the socket pair used for space available wake-ups. Called by
+     * the connecting side, which passes shmFd and spaceFds[1] to the other end. The shared memory
+     * is sealed so its size cannot change once it has been created.
+     *
+     * @param ringSize  Size of each ring, must be a power of two.
+     * @param shmFd     [OUT] File descriptor for the shared memory.
+     * @param spaceFds  [OUT] Socket pair for space available wake-ups.
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - ER_NOT_IMPLEMENTED if shared memory is not supported on this platform
+     *      - An error status otherwise
+     */
+    static QStatus Create(uint32_t ringSize, qcc::SocketFd& shmFd, qcc::SocketFd (&spaceFds)[2]);
+
+    /**
+     * Switch this stream over to the shared memory rings. This stream takes ownership of both
+     * file descriptors even if the call fails.
+     *
+     * @param shmFd      File descriptor for the shared memory created by Create().
+     * @param spaceFd    This end's socket for space available wake-ups.
+     * @param connector  true on the side that called Create().
+     *
+     * @return
+     *      - ER_OK if successful
+     *      - ER_BUS_BAD_TRANSPORT_ARGS if the shared memory is not valid, is not sealed against
+     *        resizing or spaceFd is not a UNIX domain socket
+     *      - An error status otherwise
+     */
+    QStatus Attach(qcc::SocketFd shmFd, qcc::SocketFd spaceFd, bool connector);
+
+    /**
+     * Indicates if this stream is using shared memory.
+     *
+     * @return  true if Attach() was successful.
+     */
+    bool IsAttached() const { return shared != NULL; }
+
+    /**
+     * Allow file descriptors to be received once handle passing has been negotiated. Until then
+     * descriptors sent by the other end fail the stream.
+     *
+     * @param enable  true if handle passing was negotiated.
+     */
+    void EnableHandlePassing(bool enable) { handlePassing = enable; }
+
+    /** Close the stream */
+    void Close();
+
+    /**
+     * Pull bytes from the stream.
+     *
+     * @param buf          Buffer to store pulled bytes
+     * @param reqBytes     Number of bytes requested to be pulled from source.
+     * @param actualBytes  [OUT] Actual number of bytes retrieved from source.
+     * @param timeout      Timeout in milliseconds.
+     * @return   ER_OK if successful. ER_SOCK_OTHER_END_CLOSED if the other end closed. Otherwise an error.
+     */
+    QStatus PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout = qcc::Event::WAIT_FOREVER);
+
+    /**
+     * Pull bytes and any accompanying file/socket descriptors from the stream.
+     *
+     * @param buf          Buffer to store pulled bytes
+     * @param reqBytes     Number of bytes requested to be pulled from source.
+     * @param actualBytes  [OUT] Actual number of bytes retrieved from source.
+     * @param fdList       Array to receive file descriptors.
+     * @param numFds       [IN,OUT] On IN the size of fdList on OUT number of files descriptors pulled.
+     * @param timeout      Timeout in milliseconds.
+     * @return   ER_OK if successful. ER_SOCK_OTHER_END_CLOSED if the other end closed. Otherwise an error.
+     */
+    QStatus PullBytesAndFds(void* buf, size_t reqBytes, size_t& actualBytes, qcc::SocketFd* fdList, size_t& numFds, uint32_t timeout = qcc::Event::WAIT_FOREVER);
+
+    /**
+     * Push bytes into the stream.
+     *
+     * @param buf          Buffer containing bytes to push
+     * @param numBytes     Number of bytes from buf to send to sink.
+     * @param numSent      [OUT] Number of bytes actually consumed by sink.
+     * @return   ER_OK if successful.
+     */
+    QStatus PushBytes(const void* buf, size_t numBytes, size_t& numSent);
+
+    /**
+     * Push bytes into the stream. The time-to-live is ignored.
+     *
+     * @param buf          Buffer containing bytes to push
+     * @param numBytes     Number of bytes from buf to send to sink.
+     * @param numSent      [OUT] Number of bytes actually consumed by sink.
+     * @param ttl          Time-to-live in milliseconds.
+     * @return   ER_OK if successful.
+     */
+    QStatus PushBytes(const void* buf, size_t numBytes, size_t& numSent, uint32_t ttl) { return PushBytes(buf, numBytes, numSent); }
+
+    /**
+     * Push bytes accompanied by one or more file/socket descriptors to the stream.
+     *
+     * @param buf       Buffer containing bytes to push
+     * @param numBytes  Number of bytes from buf to send to sink, must be at least 1.
+     * @param numSent   [OUT] Number of bytes actually consumed by sink.
+     * @param fdList    Array of file descriptors to push.
+     * @param numFds    Number of files descriptors, must be at least 1.
+     * @param pid       Process id required on some platforms.
+     *
+     * @return  ER_OK or an error.
+     */
+    QStatus PushBytesAndFds(const void* buf, size_t numBytes, size_t& numSent, qcc::SocketFd* fdList, size_t numFds, uint32_t pid = -1);
+
+    /**
+     * Get the Event indicating that the stream can accept data.
+     *
+     * @return Event set when the stream can accept more data via PushBytes
+     */
+    qcc::Event& GetSinkEvent() { return spaceEvent ? *spaceEvent : SocketStream::GetSinkEvent(); }
+
+    /**
+     * Set the send timeout for this stream.
+     *
+     * @param sendTimeout   Send timeout in ms.
+     */
+    void SetSendTimeout(uint32_t sendTimeout);
+
+  private:
+
+    struct Header;
+    struct Ring;
+
+    /** Private copy constructor, SharedMemoryStream cannot be copied */
+    SharedMemoryStream(const SharedMemoryStream& other);
+
+    /** Private assignment operator, SharedMemoryStream cannot be assigned */
+    SharedMemoryStream& operator=(const SharedMemoryStream& other);
+
+    QStatus Pull(void* buf, size_t reqBytes, size_t& actualBytes, qcc::SocketFd* fdList, size_t* numFds, uint32_t timeout);
+    QStatus Push(const void* buf, size_t numBytes, size_t& numSent, qcc::SocketFd* fdList, size_t numFds);
+    QStatus DrainWakeUps();
+    QStatus DrainSpaceWakeUps();
+    void Detach();
+
+    Header* shared;                 /**< The mapped shared memory or NULL if not attached */
+    size_t mapSize;                 /**< Size of the mapping */
+    uint32_t ringSize;              /**< Size of each ring as validated by Attach() */
+    Ring* tx;                       /**< Control block for the ring this end writes */
+    Ring* rx;                       /**< Control block for the ring this end reads */
+    uint8_t* txData;                /**< Data for the ring this end writes */
+    uint8_t* rxData;                /**< Data for the ring this end reads */
+    uint32_t txHead;                /**< Private copy of the tx ring head */
+    uint32_t rxTail;                /**< Private copy of the rx ring tail */
+    uint32_t rxRemaining;           /**< Bytes left to read from the current rx record */
+    bool peerClosed;                /**< The other end closed the socket */
+    qcc::SocketFd spaceFd;          /**< Socket for space available wake-ups */
+    qcc::Event* spaceEvent;         /**< Event set when there is a space available wake-up */
+    uint32_t sendTimeout;           /**< Send timeout in ms */
+    std::deque<qcc::SocketFd> rxFds; /**< Descriptors received ahead of the record they belong to */
+    bool handlePassing;             /**< Descriptors may be received */
+    uint32_t txFdMark;              /**< Tx ring position the reader must pass before more descriptors are sent */
+};
+
+}
+
+#endif
@@ -23,10 +23,13 @@
 #include <qcc/platform.h>
 
 #include <assert.h>
+#include <string.h>
+#include <map>
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
-#include <qcc/XmlElement.h>
+#include <qcc/StringUtil.h>
 
 #include <alljoyn/AllJoynStd.h>
 #include <alljoyn/BusAttachment.h>
@@ -48,40 +51,343 @@ using namespace std;
 
 namespace ajn {
 
-QStatus XmlHelper::ParseInterface(const XmlElement* elem, ProxyBusObject* obj)
+static inline bool IsXmlWhite(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+static inline bool IsXmlNameChar(char c)
+{
+    return c && !IsXmlWhite(c) && (c != '/') && (c != '>') && (c != '=') && (c != '<');
+}
+
+/*
+ * Minimal pull scanner for introspection XML. Each call to Next() advances to the next start or end
+ * tag, skipping character data, comments, processing instructions and declarations. Self closing
+ * tags are reported as a start tag followed by an end tag. Only the attributes of the current tag are
+ * kept so memory use does not depend on the size of the document.
+ */
+class XmlHelper::Scanner {
+  public:
+
+    typedef enum {
+        START_TAG,
+        END_TAG,
+        END_OF_DOC
+    } Token;
+
+    Scanner(const char* xml) : pos(xml), token(END_OF_DOC), selfClosed(false), sawRoot(false) { }
+
+    /**
+     * Advance to the next tag.
+     *
+     * @return ER_OK or ER_BUS_BAD_XML if the XML is not well formed.
+     */
+    QStatus Next();
+
+    /**
+     * Skip over the remainder of the element whose start tag is the current tag.
+     */
+    QStatus SkipElement();
+
+    Token GetToken() const { return token; }
+
+    const qcc::String& GetName() const { return name; }
+
+    const qcc::String& GetAttribute(const char* attr) const
+    {
+        for (size_t i = 0; i < attributes.size(); ++i) {
+            if (attributes[i].first == attr) {
+                return attributes[i].second;
+            }
+        }
+        return noAttribute;
+    }
+
+  private:
+
+    const char* Skip(const char* terminator)
+    {
+        const char* end = strstr(pos, terminator);
+        return end ? end + strlen(terminator) : NULL;
+    }
+
+    QStatus ScanName(qcc::String& str);
+    QStatus ScanValue(qcc::String& str);
+
+    const char* pos;
+    Token token;
+    qcc::String name;
+    std::vector<std::pair<qcc::String, qcc::String> > attributes;
+    std::vector<qcc::String> openTags;
+    bool selfClosed;
+    bool sawRoot;
+    const qcc::String noAttribute;
+};
+
+QStatus XmlHelper::Scanner::ScanName(qcc::String& str)
+{
+    const char* start = pos;
+    while (IsXmlNameChar(*pos)) {
+        ++pos;
+    }
+    if (pos == start) {
+        return ER_BUS_BAD_XML;
+    }
+    str.assign(start, pos - start);
+    return ER_OK;
+}
+
+QStatus XmlHelper::Scanner::ScanValue(qcc::String& str)
+{
+    char quote = *pos++;
+    if ((quote != '"') && (quote != '\'')) {
+        return ER_BUS_BAD_XML;
+    }
+    str.clear();
+    while (*pos != quote) {
+        const char* start = pos;
+        while (*pos && (*pos != quote) && (*pos != '&') && (*pos != '<')) {
+            ++pos;
+        }
+        str.append(start, pos - start);
+        if (*pos == '&') {
+            const char* end = strchr(pos, ';');
+            if (!end) {
+                return ER_BUS_BAD_XML;
+            }
+            qcc::String ref(pos + 1, end - pos - 1);
+            if (ref == "lt") {
+                str += '<';
+            } else if (ref == "gt") {
+                str += '>';
+            } else if (ref == "amp") {
+                str += '&';
+            } else if (ref == "quot") {
+                str += '"';
+            } else if (ref == "apos") {
+                str += '\'';
+            } else if ((ref.size() > 1) && (ref[0] == '#')) {
+                uint32_t c = (ref[1] == 'x') ? qcc::StringToU32(ref.substr(2), 16, 0) : qcc::StringToU32(ref.substr(1), 10, 0);
+                if (c == 0) {
+                    return ER_BUS_BAD_XML;
+                }
+                /* Encode the character reference as UTF-8 */
+                if (c < 0x80) {
+                    str += (char)c;
+                } else if (c < 0x800) {
+                    str += (char)(0xC0 | (c >> 6));
+                    str += (char)(0x80 | (c & 0x3F));
+                } else if (c < 0x10000) {
+                    str += (char)(0xE0 | (c >> 12));
+                    str += (char)(0x80 | ((c >> 6) & 0x3F));
+                    str += (char)(0x80 | (c & 0x3F));
+                } else {
+                    str += (char)(0xF0 | (c >> 18));
+                    str += (char)(0x80 | ((c >> 12) & 0x3F));
+                    str += (char)(0x80 | ((c >> 6) & 0x3F));
+                    str += (char)(0x80 | (c & 0x3F));
+                }
+            } else {
+                return ER_BUS_BAD_XML;
+            }
+            pos = end + 1;
+        } else if (*pos != quote) {
+            /* Reached the end of the document or a '<' in an attribute value */
+            return ER_BUS_BAD_XML;
+        }
+    }
+    ++pos;
+    return ER_OK;
+}
+
+QStatus XmlHelper::Scanner::Next()
 {
     QStatus status = ER_OK;
 
-    assert(elem->GetName() == "interface");
+    attributes.clear();
+    if (selfClosed) {
+        /* Report the end tag for a self closing tag, the name is unchanged */
+        selfClosed = false;
+        openTags.pop_back();
+        token = END_TAG;
+        return ER_OK;
+    }
+    while (true) {
+        /* Skip character data, introspection elements don't have any content we care about */
+        while (*pos && (*pos != '<')) {
+            if (openTags.empty() && !IsXmlWhite(*pos)) {
+                return ER_BUS_BAD_XML;
+            }
+            ++pos;
+        }
+        if (!*pos) {
+            if (!openTags.empty() || !sawRoot) {
+                return ER_BUS_BAD_XML;
+            }
+            token = END_OF_DOC;
+            return ER_OK;
+        }
+        if (strncmp(pos, "<!--", 4) == 0) {
+            pos = Skip("-->");
+        } else if (strncmp(pos, "<![CDATA[", 9) == 0) {
+            pos = openTags.empty() ? NULL : Skip("]]>");
+        } else if (pos[1] == '?') {
+            pos = Skip("?>");
+        } else if (pos[1] == '!') {
+            /* A declaration such as <!DOCTYPE ...> possibly with an internal subset in brackets */
+            int depth = 0;
+            char quote = 0;
+            for (++pos; *pos; ++pos) {
+                if (quote) {
+                    quote = (*pos == quote) ? 0 : quote;
+                } else if ((*pos == '"') || (*pos == '\'')) {
+                    quote = *pos;
+                } else if (*pos == '[') {
+                    ++depth;
+                } else if (*pos == ']') {
+                    --depth;
+                } else if ((*pos == '>') && (depth == 0)) {
+                    break;
+                }
+            }
+            pos = *pos ? pos + 1 : NULL;
+        } else {
+            break;
+        }
+        if (!pos) {
+            return ER_BUS_BAD_XML;
+        }
+    }
 
-    qcc::String ifName = elem->GetAttribute("name");
-    if (!IsLegalInterfaceName(ifName.c_str())) {
-        status = ER_BUS_BAD_INTERFACE_NAME;
-        QCC_LogError(status, ("Invalid interface name \"%s\" in XML introspection data for %s", ifName.c_str(), ident));
-        return status;
+    if (pos[1] == '/') {
+        pos += 2;
+        status = ScanName(name);
+        while ((status == ER_OK) && IsXmlWhite(*pos)) {
+            ++pos;
+        }
+        if ((status != ER_OK) || (*pos != '>') || openTags.empty() || (openTags.back() != name)) {
+            return ER_BUS_BAD_XML;
+        }
+        ++pos;
+        openTags.pop_back();
+        token = END_TAG;
+        return ER_OK;
     }
 
-    /* Get "secure" annotation */
-    bool secure = false;
-    vector<XmlElement*>::const_iterator ifIt = elem->GetChildren().begin();
-    while (ifIt != elem->GetChildren().end()) {
-        const XmlElement* ifChildElem = *ifIt++;
-        qcc::String ifChildName = ifChildElem->GetName();
-        if ((ifChildName == "annotation") && (ifChildElem->GetAttribute("name") == org::alljoyn::Bus::Secure)) {
-            secure = (ifChildElem->GetAttribute("value") == "true");
+    /* A document has exactly one root element */
+    if (openTags.empty() && sawRoot) {
+        return ER_BUS_BAD_XML;
+    }
+    ++pos;
+    status = ScanName(name);
+    while (status == ER_OK) {
+        while (IsXmlWhite(*pos)) {
+            ++pos;
+        }
+        if (*pos == '>') {
+            ++pos;
+            break;
+        }
+        if ((pos[0] == '/') && (pos[1] == '>')) {
+            pos += 2;
+            selfClosed = true;
             break;
         }
+        attributes.push_back(std::pair<qcc::String, qcc::String>());
+        status = ScanName(attributes.back().first);
+        while ((status == ER_OK) && IsXmlWhite(*pos)) {
+            ++pos;
+        }
+        if ((status == ER_OK) && (*pos++ != '=')) {
+            status = ER_BUS_BAD_XML;
+        }
+        while ((status == ER_OK) && IsXmlWhite(*pos)) {
+            ++pos;
+        }
+        if (status == ER_OK) {
+            status = ScanValue(attributes.back().second);
+        }
+    }
+    if (status == ER_OK) {
+        openTags.push_back(name);
+        sawRoot = true;
+        token = START_TAG;
+    }
+    return status;
+}
+
+QStatus XmlHelper::Scanner::SkipElement()
+{
+    QStatus status = ER_OK;
+    size_t depth = 1;
+    while ((status == ER_OK) && depth) {
+        status = Next();
+        if (status == ER_OK) {
+            depth = (token == START_TAG) ? depth + 1 : depth - 1;
+        }
     }
+    return status;
+}
 
-    /* Create a new interface */
-    InterfaceDescription intf(ifName.c_str(), secure);
+QStatus XmlHelper::AddInterfaceDefinitions(const char* xml)
+{
+    Scanner scanner(xml);
+    return ParseRoot(scanner, NULL, false);
+}
+
+QStatus XmlHelper::AddProxyObjects(ProxyBusObject& parent, const char* xml)
+{
+    Scanner scanner(xml);
+    return ParseRoot(scanner, &parent, true);
+}
+
+QStatus XmlHelper::ParseRoot(Scanner& scanner, ProxyBusObject* obj, bool nodeOnly)
+{
+    QStatus status = scanner.Next();
+    if (status == ER_OK) {
+        if (scanner.GetName() == "node") {
+            status = ParseNode(scanner, obj);
+        } else if (!nodeOnly && (scanner.GetName() == "interface")) {
+            status = ParseInterface(scanner, obj);
+        } else {
+            status = ER_BUS_BAD_XML;
+        }
+    }
+    /* Check there is nothing but white space and comments after the root element */
+    if (status == ER_OK) {
+        status = scanner.Next();
+    }
+    if (status == ER_BUS_BAD_XML) {
+        QCC_LogError(status, ("Malformed introspection data for %s", ident));
+    }
+    return status;
+}
+
+QStatus XmlHelper::ParseInterface(Scanner& scanner, ProxyBusObject* obj)
+{
+    QStatus status = ER_OK;
+
+    assert(scanner.GetName() == "interface");
+
+    qcc::String ifName = scanner.GetAttribute("name");
+    if (!IsLegalInterfaceName(ifName.c_str())) {
+        status = ER_BUS_BAD_INTERFACE_NAME;
+        QCC_LogError(status, ("Invalid interface name \"%s\" in XML introspection data for %s", ifName.c_str(), ident));
+        return status;
+    }
+
+    /* Create a new interface, the "secure" annotation is added along with the other annotations */
+    InterfaceDescription intf(ifName.c_str(), false);
 
     /* Iterate over <method>, <signal> and <property> elements */
-    ifIt = elem->GetChildren().begin();
-    while ((ER_OK == status) && (ifIt != elem->GetChildren().end())) {
-        const XmlElement* ifChildElem = *ifIt++;
-        const qcc::String& ifChildName = ifChildElem->GetName();
-        const qcc::String& memberName = ifChildElem->GetAttribute("name");
+    while (ER_OK == status) {
+        status = scanner.Next();
+        if ((ER_OK != status) || (scanner.GetToken() == Scanner::END_TAG)) {
+            break;
+        }
+        const qcc::String ifChildName = scanner.GetName();
+        const qcc::String memberName = scanner.GetAttribute("name");
         if ((ifChildName == "method") || (ifChildName == "signal")) {
             if (IsLegalMemberName(memberName.c_str())) {
 
@@ -95,16 +401,17 @@ QStatus XmlHelper::ParseInterface(const XmlElement* elem, ProxyBusObject* obj)
                 std::map<String, String> annotations;
 
                 /* Iterate over member children */
-                const vector<XmlElement*>& argChildren = ifChildElem->GetChildren();
-                vector<XmlElement*>::const_iterator argIt = argChildren.begin();
-                while ((ER_OK == status) && (argIt != argChildren.end())) {
-                    const XmlElement* argElem = *argIt++;
-                    if (argElem->GetName() == "arg") {
+                while (ER_OK == status) {
+                    status = scanner.Next();
+                    if ((ER_OK != status) || (scanner.GetToken() == Scanner::END_TAG)) {
+                        break;
+                    }
+                    if (scanner.GetName() == "arg") {
                         if (!isFirstArg) {
                             argNames += ',';
                         }
                         isFirstArg = false;
-                        const qcc::String& typeAtt = argElem->GetAttribute("type");
+                        const qcc::String& typeAtt = scanner.GetAttribute("type");
 
                         if (typeAtt.empty()) {
                             status = ER_BUS_BAD_XML;
@@ -112,22 +419,21 @@ QStatus XmlHelper::ParseInterface(const XmlElement* elem, ProxyBusObject* obj)
                             break;
                         }
 
-                        const qcc::String& nameAtt = argElem->GetAttribute("name");
+                        const qcc::String& nameAtt = scanner.GetAttribute("name");
                         if (!nameAtt.empty()) {
                             isArgNamesEmpty = false;
                             argNames += nameAtt;
                         }
 
-                        if (isSignal || (argElem->GetAttribute("direction") == "in")) {
+                        if (isSignal || (scanner.GetAttribute("direction") == "in")) {
                             inSig += typeAtt;
                         } else {
                             outSig += typeAtt;
                         }
-                    } else if (argElem->GetName() == "annotation") {
-                        const qcc::String& nameAtt = argElem->GetAttribute("name");
-                        const qcc::String& valueAtt = argElem->GetAttribute("value");
-                        annotations[nameAtt] = valueAtt;
+                    } else if (scanner.GetName() == "annotation") {
+                        annotations[scanner.GetAttribute("name")] = scanner.GetAttribute("value");
                     }
+                    status = scanner.SkipElement();
                 }
 
                 /* Add the member */
@@ -147,8 +453,8 @@ QStatus XmlHelper::ParseInterface(const XmlElement* elem, ProxyBusObject* obj)
                 QCC_LogError(status, ("Illegal member name \"%s\" introspection data for %s", memberName.c_str(), ident));
             }
         } else if (ifChildName == "property") {
-            const qcc::String& sig = ifChildElem->GetAttribute("type");
-            const qcc::String& accessStr = ifChildElem->GetAttribute("access");
+            const qcc::String sig = scanner.GetAttribute("type");
+            const qcc::String& accessStr = scanner.GetAttribute("access");
             if (!SignatureUtils::IsCompleteType(sig.c_str())) {
                 status = ER_BUS_BAD_SIGNATURE;
                 QCC_LogError(status, ("Invalid signature for property %s in introspection data from %s", memberName.c_str(), ident));
@@ -163,15 +469,22 @@ QStatus XmlHelper::ParseInterface(const XmlElement* elem, ProxyBusObject* obj)
                 status = intf.AddProperty(memberName.c_str(), sig.c_str(), access);
 
                 // add Property annotations
-                const vector<XmlElement*>& argChildren = ifChildElem->GetChildren();
-                vector<XmlElement*>::const_iterator argIt = argChildren.begin();
-                while ((ER_OK == status) && (argIt != argChildren.end())) {
-                    const XmlElement* argElem = *argIt++;
-                    status = intf.AddPropertyAnnotation(memberName, argElem->GetAttribute("name"), argElem->GetAttribute("value"));
+                while (ER_OK == status) {
+                    status = scanner.Next();
+                    if ((ER_OK != status) || (scanner.GetToken() == Scanner::END_TAG)) {
+                        break;
+                    }
+                    status = intf.AddPropertyAnnotation(memberName, scanner.GetAttribute("name"), scanner.GetAttribute("value"));
+                    if (ER_OK == status) {
+                        status = scanner.SkipElement();
+                    }
                 }
             }
         } else if (ifChildName == "annotation") {
-            status = intf.AddAnnotation(ifChildElem->GetAttribute("name"), ifChildElem->GetAttribute("value"));
+            status = intf.AddAnnotation(scanner.GetAttribute("name"), scanner.GetAttribute("value"));
+            if (ER_OK == status) {
+                status = scanner.SkipElement();
+            }
         } else {
             status = ER_FAIL;
             QCC_LogError(status, ("Unknown element \"%s\" found in introspection data from %s", ifChildName.c_str(), ident));
@@ -213,23 +526,24 @@ QStatus XmlHelper::ParseInterface(const XmlElement* elem, ProxyBusObject* obj)
     return status;
 }
 
-QStatus XmlHelper::ParseNode(const XmlElement* root, ProxyBusObject* obj)
+QStatus XmlHelper::ParseNode(Scanner& scanner, ProxyBusObject* obj)
 {
     QStatus status = ER_OK;
 
-    assert(root->GetName() == "node");
+    assert(scanner.GetName() == "node");
 
     /* Iterate over <interface> and <node> elements */
-    const vector<XmlElement*>& rootChildren = root->GetChildren();
-    vector<XmlElement*>::const_iterator it = rootChildren.begin();
-    while ((ER_OK == status) && (it != rootChildren.end())) {
-        const XmlElement* elem = *it++;
-        const qcc::String& elemName = elem->GetName();
+    while (ER_OK == status) {
+        status = scanner.Next();
+        if ((ER_OK != status) || (scanner.GetToken() == Scanner::END_TAG)) {
+            break;
+        }
+        const qcc::String& elemName = scanner.GetName();
         if (elemName == "interface") {
-            status = ParseInterface(elem, obj);
+            status = ParseInterface(scanner, obj);
         } else if (elemName == "node") {
             if (obj) {
-                const qcc::String& relativePath = elem->GetAttribute("name");
+                const qcc::String relativePath = scanner.GetAttribute("name");
                 qcc::String childObjPath = obj->GetPath();
                 if (0 || childObjPath.size() > 1) {
                     childObjPath += '/';
@@ -239,10 +553,10 @@ QStatus XmlHelper::ParseNode(const XmlElement* root, ProxyBusObject* obj)
                     /* Check for existing child with the same name. Use this child if found, otherwise create a new one */
                     ProxyBusObject* childObj = obj->GetChild(relativePath.c_str());
                     if (childObj) {
-                        status = ParseNode(elem, childObj);
+                        status = ParseNode(scanner, childObj);
                     } else {
                         ProxyBusObject newChild(*bus, obj->GetServiceName().c_str(), childObjPath.c_str(), obj->sessionId);
-                        status = ParseNode(elem, &newChild);
+                        status = ParseNode(scanner, &newChild);
                         if (ER_OK == status) {
                             obj->AddChild(newChild);
                         }
@@ -255,8 +569,10 @@ QStatus XmlHelper::ParseNode(const XmlElement* root, ProxyBusObject* obj)
                     QCC_LogError(status, ("Illegal child object name \"%s\" specified in introspection for %s", relativePath.c_str(), ident));
                 }
             } else {
-                status = ParseNode(elem, NULL);
+                status = ParseNode(scanner, NULL);
             }
+        } else {
+            status = scanner.SkipElement();
         }
     }
     return status;
@@ -29,7 +29,6 @@
 
 #include <qcc/platform.h>
 #include <qcc/String.h>
-#include <qcc/XmlElement.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/ProxyBusObject.h>
@@ -41,6 +40,10 @@ namespace ajn {
 
 /**
  * XmlHelper is a utility class for traversing introspection XML.
+ *
+ * The XML is scanned in a single pass and interfaces and child proxy objects are created as their
+ * elements are encountered, no document tree is built. Because of this, interfaces and children that
+ * precede a malformed part of the XML will already have been added when an error is returned.
  */
 class XmlHelper {
   public:
@@ -48,47 +51,35 @@ class XmlHelper {
     XmlHelper(BusAttachment* bus, const char* ident) : bus(bus), ident(ident) { }
 
     /**
-     * Traverse the XML tree adding all interfaces to the bus. Nodes are ignored.
+     * Traverse the XML adding all interfaces to the bus. Nodes are ignored.
      *
-     * @param root  The root can be an <interface> or <node> element.
+     * @param xml  The root element can be an <interface> or <node> element.
      *
      * @return #ER_OK if the XML was well formed and the interfaces were added.
      *         #ER_BUS_BAD_XML if the XML was not as expected.
      *         #Other errors indicating the interfaces were not succesfully added.
      */
-    QStatus AddInterfaceDefinitions(const qcc::XmlElement* root) {
-        if (root) {
-            if (root->GetName() == "interface") {
-                return ParseInterface(root, NULL);
-            } else if (root->GetName() == "node") {
-                return ParseNode(root, NULL);
-            }
-        }
-        return ER_BUS_BAD_XML;
-    }
+    QStatus AddInterfaceDefinitions(const char* xml);
 
     /**
-     * Traverse the XML tree recursively adding all nodes as children of a parent proxy object.
+     * Traverse the XML recursively adding all nodes as children of a parent proxy object.
      *
      * @param parent  The parent proxy object to add the children too.
-     * @param root    The root must be a <node> element.
+     * @param xml     The root element must be a <node> element.
      *
      * @return #ER_OK if the XML was well formed and the children were added.
      *         #ER_BUS_BAD_XML if the XML was not as expected.
      *         #Other errors indicating the children were not succesfully added.
      */
-    QStatus AddProxyObjects(ProxyBusObject& parent, const qcc::XmlElement* root) {
-        if (root && (root->GetName() == "node")) {
-            return ParseNode(root, &parent);
-        } else {
-            return ER_BUS_BAD_XML;
-        }
-    }
+    QStatus AddProxyObjects(ProxyBusObject& parent, const char* xml);
 
   private:
 
-    QStatus ParseNode(const qcc::XmlElement* elem, ProxyBusObject* obj);
-    QStatus ParseInterface(const qcc::XmlElement* elem, ProxyBusObject* obj);
+    class Scanner;
+
+    QStatus ParseRoot(Scanner& scanner, ProxyBusObject* obj, bool nodeOnly);
+    QStatus ParseNode(Scanner& scanner, ProxyBusObject* obj);
+    QStatus ParseInterface(Scanner& scanner, ProxyBusObject* obj);
 
     BusAttachment* bus;
     const char* ident;
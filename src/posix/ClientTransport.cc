@@ -41,6 +41,7 @@
 #include "RemoteEndpoint.h"
 #include "Router.h"
 #include "ClientTransport.h"
+#include "SharedMemoryStream.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -119,14 +120,30 @@ class _ClientEndpoint : public _RemoteEndpoint {
      */
     bool SupportsUnixIDs() const { return true; }
 
+    /**
+     * Switch the endpoint over to shared memory once the daemon has accepted it.
+     *
+     * @param shmFd    The shared memory offered to the daemon.
+     * @param spaceFd  This end of the space available wake-up socket pair.
+     *
+     * @return  ER_OK if successful.
+     */
+    QStatus AttachSharedMemory(SocketFd shmFd, SocketFd spaceFd) { return stream.Attach(shmFd, spaceFd, true); }
+
+    /**
+     * Let the shared memory stream accept file descriptors once handle passing has been negotiated.
+     */
+    void EnableHandlePassing() { stream.EnableHandlePassing(GetFeatures().handlePassing); }
 
   private:
     uint32_t userId;
     uint32_t groupId;
     uint32_t processId;
-    SocketStream stream;
+    SharedMemoryStream stream;
 };
 
+static const int SHM_REPLY_TIMEOUT = 5000;  /**< How long to wait for the daemon to answer a shared memory offer */
+
 QStatus ClientTransport::NormalizeTransportSpec(const char* inSpec, qcc::String& outSpec, map<qcc::String, qcc::String>& argMap) const
 {
     /*
@@ -160,7 +177,7 @@ QStatus ClientTransport::NormalizeTransportSpec(const char* inSpec, qcc::String&
     return status;
 }
 
-static QStatus SendSocketCreds(SocketFd sockFd, uid_t uid, gid_t gid, pid_t pid)
+static QStatus SendSocketCreds(SocketFd sockFd, uid_t uid, gid_t gid, pid_t pid, char credByte = 0, SocketFd* fds = NULL, size_t numFds = 0)
 {
     int enableCred = 1;
     int rc = setsockopt(sockFd, SOL_SOCKET, SO_PASSCRED, &enableCred, sizeof(enableCred));
@@ -171,14 +188,15 @@ static QStatus SendSocketCreds(SocketFd sockFd, uid_t uid, gid_t gid, pid_t pid)
     }
 
     /*
-     * Compose a header that includes the local user credentials and a single NUL byte.
+     * Compose a header that includes the local user credentials and a single byte. The byte is NUL
+     * unless the header is also carrying the descriptors for a shared memory offer.
      */
     ssize_t ret;
-    char nulbuf = 0;
+    char nulbuf = credByte;
     struct cmsghdr* cmsg;
     struct ucred* cred;
     struct iovec iov[] = { { &nulbuf, sizeof(nulbuf) } };
-    char cbuf[CMSG_SPACE(sizeof(struct ucred))];
+    char cbuf[CMSG_SPACE(sizeof(struct ucred)) + CMSG_SPACE(2 * sizeof(int))];
     ::memset(cbuf, 0, sizeof(cbuf));
     struct msghdr msg;
     msg.msg_name = NULL;
@@ -186,7 +204,7 @@ static QStatus SendSocketCreds(SocketFd sockFd, uid_t uid, gid_t gid, pid_t pid)
     msg.msg_iov = iov;
     msg.msg_iovlen = ArraySize(iov);
     msg.msg_control = cbuf;
-    msg.msg_controllen = ArraySize(cbuf);
+    msg.msg_controllen = CMSG_SPACE(sizeof(struct ucred)) + (numFds ? CMSG_SPACE(numFds * sizeof(int)) : 0);
     msg.msg_flags = 0;
 
     cmsg = CMSG_FIRSTHDR(&msg);
@@ -198,6 +216,17 @@ static QStatus SendSocketCreds(SocketFd sockFd, uid_t uid, gid_t gid, pid_t pid)
     cred->gid = gid;
     cred->pid = pid;
 
+    if (numFds) {
+        cmsg = CMSG_NXTHDR(&msg, cmsg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(numFds * sizeof(int));
+        int* fdList = reinterpret_cast<int*>(CMSG_DATA(cmsg));
+        for (size_t i = 0; i < numFds; ++i) {
+            fdList[i] = fds[i];
+        }
+    }
+
     QCC_DbgHLPrintf(("Sending UID: %u  GID: %u  PID %u", cred->uid, cred->gid, cred->pid));
 
     ret = sendmsg(sockFd, &msg, 0);
@@ -218,6 +247,28 @@ static QStatus SendSocketCreds(SocketFd sockFd, uid_t uid, gid_t gid, pid_t pid)
     return ER_OK;
 }
 
+/*
+ * Wait for the daemon to accept or decline a shared memory offer.
+ */
+static QStatus RecvSharedMemoryReply(SocketFd sockFd, bool& accepted)
+{
+    uint8_t reply = 0;
+    size_t recvd = 0;
+    QStatus status = qcc::Recv(sockFd, &reply, 1, recvd);
+    if (status == ER_WOULDBLOCK) {
+        qcc::Event event(sockFd, qcc::Event::IO_READ, false);
+        status = Event::Wait(event, SHM_REPLY_TIMEOUT);
+        if (status == ER_OK) {
+            status = qcc::Recv(sockFd, &reply, 1, recvd);
+        }
+    }
+    if ((status == ER_OK) && (recvd != 1)) {
+        status = ER_SOCK_OTHER_END_CLOSED;
+    }
+    accepted = (status == ER_OK) && (reply == SharedMemoryStream::Accept);
+    return status;
+}
+
 QStatus ClientTransport::Connect(const char* connectArgs, const SessionOpts& opts, BusEndpoint& newep)
 {
     if (!m_running) {
@@ -260,10 +311,49 @@ QStatus ClientTransport::Connect(const char* connectArgs, const SessionOpts& opt
         return status;
     }
 
-    status = SendSocketCreds(sockFd, GetUid(), GetGid(), GetPid());
+    /*
+     * If requested in the connect spec offer the daemon shared memory with the credentials. With
+     * shm=required the connection fails rather than falling back to the socket.
+     */
+    SocketFd shmFd = -1;
+    SocketFd spaceFds[2] = { -1, -1 };
+    bool requireShm = (argMap["shm"] == "required");
+    bool offerShm = ((argMap["shm"] == "true") || requireShm) && (SharedMemoryStream::Create(SharedMemoryStream::DefaultRingSize, shmFd, spaceFds) == ER_OK);
+    if (requireShm && !offerShm) {
+        QCC_LogError(ER_BUS_CONNECT_FAILED, ("ClientTransport::Connect(): Shared memory required but not available"));
+        qcc::Close(sockFd);
+        return ER_BUS_CONNECT_FAILED;
+    }
+    if (offerShm) {
+        SocketFd fds[2] = { shmFd, spaceFds[1] };
+        status = SendSocketCreds(sockFd, GetUid(), GetGid(), GetPid(), SharedMemoryStream::Offer, fds, ArraySize(fds));
+        qcc::Close(spaceFds[1]);
+    } else {
+        status = SendSocketCreds(sockFd, GetUid(), GetGid(), GetPid());
+    }
     static const bool falsiness = false;
     ClientEndpoint ep = ClientEndpoint(m_bus, falsiness, normSpec, sockFd);
 
+    if (offerShm) {
+        bool accepted = false;
+        if (status == ER_OK) {
+            /* A daemon that does not support shared memory does not reply, carry on with the socket */
+            QStatus replyStatus = RecvSharedMemoryReply(sockFd, accepted);
+            if (accepted) {
+                status = ep->AttachSharedMemory(shmFd, spaceFds[0]);
+            } else if (requireShm) {
+                QCC_LogError(ER_BUS_CONNECT_FAILED, ("ClientTransport::Connect(): Daemon did not accept shared memory (%s)", QCC_StatusText(replyStatus)));
+                status = ER_BUS_CONNECT_FAILED;
+            } else {
+                QCC_DbgHLPrintf(("Daemon did not accept shared memory (%s)", QCC_StatusText(replyStatus)));
+            }
+        }
+        if (!accepted) {
+            qcc::Close(shmFd);
+            qcc::Close(spaceFds[0]);
+        }
+    }
+
     /* Initialized the features for this endpoint */
     ep->GetFeatures().isBusToBus = false;
     ep->GetFeatures().allowRemote = m_bus.GetInternal().AllowRemoteMessages();
@@ -271,8 +361,11 @@ QStatus ClientTransport::Connect(const char* connectArgs, const SessionOpts& opt
 
     qcc::String authName;
     qcc::String redirection;
-    status = ep->Establish("EXTERNAL", authName, redirection);
     if (status == ER_OK) {
+        status = ep->Establish("EXTERNAL", authName, redirection);
+    }
+    if (status == ER_OK) {
+        ep->EnableHandlePassing();
         ep->SetListener(this);
         status = ep->Start();
         if (status != ER_OK) {
@@ -0,0 +1,642 @@
+/**
+ * @file
+ * SharedMemoryStream moves message bytes between a client and the daemon through shared
+ * memory rings, using the connection's socket only for wake-ups and file descriptors.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include <qcc/Debug.h>
+#include <qcc/Event.h>
+#include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
+#include <qcc/Util.h>
+
+#include "SharedMemoryStream.h"
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/*
+ * Identifies a valid shared memory header
+ */
+static const uint32_t SharedMemoryMagic = 0x414A5348;
+static const uint32_t SharedMemoryVersion = 1;
+
+/*
+ * Limits on the ring size accepted from the other end
+ */
+static const uint32_t MinRingSize = 4096;
+static const uint32_t MaxRingSize = 16 * 1024 * 1024;
+
+/*
+ * Maximum number of file descriptors that can accompany a record
+ */
+static const size_t MaxRecordFds = 16;
+
+#if defined(QCC_OS_LINUX) && !defined(QCC_OS_ANDROID)
+/*
+ * Seals the shared memory must carry before it is mapped. Without them the other end could shrink
+ * the memory and fault the process mapping it.
+ */
+static const int RequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+#endif
+
+/*
+ * Control block for one ring. The fields written by the producer and the consumer are on separate
+ * cache lines. Positions are free running byte counts, the offset into the ring is the position
+ * modulo the ring size.
+ */
+struct SharedMemoryStream::Ring {
+    volatile uint32_t head;           /* Written by the producer */
+    volatile int32_t readerWaiting;   /* Set by the consumer before it waits for a wake-up */
+    uint8_t pad0[56];
+    volatile uint32_t tail;           /* Written by the consumer */
+    volatile int32_t writerWaiting;   /* Set by the producer before it waits for a wake-up */
+    uint8_t pad1[56];
+};
+
+/*
+ * Layout of the start of the shared memory, the data for ring 0 and then ring 1 follows.
+ */
+struct SharedMemoryStream::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t ringSize;
+    uint8_t pad[52];
+    Ring rings[2];    /* rings[0] carries bytes from the connector, rings[1] bytes to the connector */
+};
+
+/*
+ * Each push is written to the ring as a record so descriptors passed on the socket can be matched
+ * to the bytes they were sent with.
+ */
+struct RecordHeader {
+    uint32_t len;
+    uint32_t numFds;
+};
+
+static inline void FullBarrier()
+{
+    __sync_synchronize();
+}
+
+static void CopyIn(uint8_t* ring, uint32_t ringSize, uint32_t pos, const void* buf, size_t len)
+{
+    uint32_t offset = pos & (ringSize - 1);
+    size_t first = (std::min)(len, (size_t)(ringSize - offset));
+    memcpy(ring + offset, buf, first);
+    memcpy(ring, (const uint8_t*)buf + first, len - first);
+}
+
+static void CopyOut(void* buf, const uint8_t* ring, uint32_t ringSize, uint32_t pos, size_t len)
+{
+    uint32_t offset = pos & (ringSize - 1);
+    size_t first = (std::min)(len, (size_t)(ringSize - offset));
+    memcpy(buf, ring + offset, first);
+    memcpy((uint8_t*)buf + first, ring, len - first);
+}
+
+/*
+ * Send a single wake-up byte, optionally with file descriptors. A wake-up that cannot be sent
+ * because the socket buffer is full is not needed since there are wake-ups already pending.
+ */
+static QStatus SendWakeUp(SocketFd sock, SocketFd* fdList = NULL, size_t numFds = 0)
+{
+    char wake = 0;
+    struct iovec iov[] = { { &wake, sizeof(wake) } };
+    char cbuf[CMSG_SPACE(MaxRecordFds * sizeof(int))];
+    struct msghdr msg;
+    ::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = ArraySize(iov);
+    if (numFds) {
+        ::memset(cbuf, 0, sizeof(cbuf));
+        msg.msg_control = cbuf;
+        msg.msg_controllen = CMSG_SPACE(numFds * sizeof(int));
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(numFds * sizeof(int));
+        int* fds = reinterpret_cast<int*>(CMSG_DATA(cmsg));
+        for (size_t i = 0; i < numFds; ++i) {
+            fds[i] = fdList[i];
+        }
+    }
+    ssize_t ret = sendmsg(sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (ret == 1) {
+        return ER_OK;
+    }
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        /* Descriptors must be sent, a plain wake-up can be dropped */
+        return numFds ? ER_WOULDBLOCK : ER_OK;
+    }
+    return (errno == EPIPE) ? ER_SOCK_OTHER_END_CLOSED : ER_OS_ERROR;
+}
+
+/*
+ * Check that a descriptor from the other end is a memory file that cannot change size. The size
+ * returned in st is only stable once the seals have been checked.
+ */
+static bool IsSealedMemory(int fd, struct stat& st)
+{
+#if defined(QCC_OS_LINUX) && !defined(QCC_OS_ANDROID)
+    int seals = fcntl(fd, F_GET_SEALS);
+    if ((seals < 0) || ((seals & RequiredSeals) != RequiredSeals)) {
+        QCC_DbgHLPrintf(("Shared memory is not sealed"));
+        return false;
+    }
+    return (fstat(fd, &st) == 0) && S_ISREG(st.st_mode);
+#else
+    return false;
+#endif
+}
+
+/*
+ * Check that a descriptor from the other end is a UNIX domain socket.
+ */
+static bool IsUnixSocket(int fd)
+{
+    struct sockaddr_storage addr;
+    socklen_t addrLen = sizeof(addr);
+    if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen) != 0) {
+        return false;
+    }
+    return addr.ss_family == AF_UNIX;
+}
+
+SharedMemoryStream::SharedMemoryStream(SocketFd sock) :
+    SocketStream(sock),
+    shared(NULL),
+    mapSize(0),
+    ringSize(0),
+    tx(NULL),
+    rx(NULL),
+    txData(NULL),
+    rxData(NULL),
+    txHead(0),
+    rxTail(0),
+    rxRemaining(0),
+    peerClosed(false),
+    spaceFd(-1),
+    spaceEvent(NULL),
+    sendTimeout(Event::WAIT_FOREVER),
+    handlePassing(false),
+    txFdMark(0)
+{
+}
+
+SharedMemoryStream::~SharedMemoryStream()
+{
+    Detach();
+}
+
+QStatus SharedMemoryStream::Create(uint32_t ringSize, SocketFd& shmFd, SocketFd (&spaceFds)[2])
+{
+#if defined(QCC_OS_LINUX) && !defined(QCC_OS_ANDROID)
+    if ((ringSize < MinRingSize) || (ringSize > MaxRingSize) || (ringSize & (ringSize - 1))) {
+        return ER_BAD_ARG_1;
+    }
+    /*
+     * The shared memory is an anonymous memory file, it is only reachable through the descriptor
+     * passed to the daemon. It is sealed against resizing so the daemon can map it without the
+     * client being able to truncate it from under the daemon.
+     */
+    int fd = memfd_create("alljoyn", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        QCC_LogError(ER_OS_ERROR, ("memfd_create failed: %s", strerror(errno)));
+        return ER_OS_ERROR;
+    }
+
+    size_t size = sizeof(Header) + 2 * (size_t)ringSize;
+    void* mem = MAP_FAILED;
+    if ((ftruncate(fd, size) == 0) && (fcntl(fd, F_ADD_SEALS, RequiredSeals) == 0)) {
+        mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mem == MAP_FAILED) {
+        QCC_LogError(ER_OS_ERROR, ("Failed to size shared memory: %s", strerror(errno)));
+        close(fd);
+        return ER_OS_ERROR;
+    }
+    Header* header = reinterpret_cast<Header*>(mem);
+    header->magic = SharedMemoryMagic;
+    header->version = SharedMemoryVersion;
+    header->ringSize = ringSize;
+    munmap(mem, size);
+
+    QStatus status = SocketPair(spaceFds);
+    if (status == ER_OK) {
+        status = qcc::SetBlocking(spaceFds[0], false);
+        if (status == ER_OK) {
+            status = qcc::SetBlocking(spaceFds[1], false);
+        }
+        if (status != ER_OK) {
+            qcc::Close(spaceFds[0]);
+            qcc::Close(spaceFds[1]);
+        }
+    }
+    if (status == ER_OK) {
+        shmFd = fd;
+    } else {
+        QCC_LogError(status, ("Failed to create wake-up socket pair"));
+        close(fd);
+    }
+    return status;
+#else
+    return ER_NOT_IMPLEMENTED;
+#endif
+}
+
+QStatus SharedMemoryStream::Attach(SocketFd shmFd, SocketFd spaceFd, bool connector)
+{
+    QStatus status = ER_OK;
+    void* mem = MAP_FAILED;
+    struct stat st;
+    size_t size = 0;
+    uint32_t validSize = 0;
+
+    if (shared) {
+        status = ER_BUS_ALREADY_CONNECTED;
+    } else if (!IsSealedMemory(shmFd, st) || !IsUnixSocket(spaceFd) || (st.st_size < (off_t)sizeof(Header))) {
+        status = ER_BUS_BAD_TRANSPORT_ARGS;
+    } else {
+        /*
+         * The other end is not trusted so the ring size is read from a mapping of just the header
+         * and validated once. Only the validated copy is used and only the memory it accounts for
+         * is mapped, however large the memory offered is.
+         */
+        const Header* header = reinterpret_cast<const Header*>(mmap(NULL, sizeof(Header), PROT_READ, MAP_SHARED, shmFd, 0));
+        if (header == MAP_FAILED) {
+            status = ER_OS_ERROR;
+        } else {
+            validSize = header->ringSize;
+            if ((header->magic != SharedMemoryMagic) || (header->version != SharedMemoryVersion) ||
+                (validSize < MinRingSize) || (validSize > MaxRingSize) || (validSize & (validSize - 1))) {
+                status = ER_BUS_BAD_TRANSPORT_ARGS;
+            }
+            munmap(const_cast<Header*>(header), sizeof(Header));
+        }
+        if (status == ER_OK) {
+            size = sizeof(Header) + 2 * (size_t)validSize;
+            if ((off_t)size > st.st_size) {
+                status = ER_BUS_BAD_TRANSPORT_ARGS;
+            }
+        }
+        if (status == ER_OK) {
+            mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+            if (mem == MAP_FAILED) {
+                status = ER_OS_ERROR;
+            }
+        }
+    }
+    close(shmFd);
+
+    if (status == ER_OK) {
+        Header* header = reinterpret_cast<Header*>(mem);
+        shared = header;
+        mapSize = size;
+        ringSize = validSize;
+        uint8_t* data = reinterpret_cast<uint8_t*>(mem) + sizeof(Header);
+        tx = &header->rings[connector ? 0 : 1];
+        rx = &header->rings[connector ? 1 : 0];
+        txData = data + (connector ? 0 : ringSize);
+        rxData = data + (connector ? ringSize : 0);
+        txHead = tx->head;
+        txFdMark = txHead;
+        rxTail = rx->tail;
+        rxRemaining = 0;
+        this->spaceFd = spaceFd;
+        spaceEvent = new Event(spaceFd, Event::IO_READ, false);
+        QCC_DbgHLPrintf(("Attached to shared memory with %u byte rings", ringSize));
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Cannot attach to shared memory"));
+        qcc::Close(spaceFd);
+    }
+    return status;
+}
+
+void SharedMemoryStream::Detach()
+{
+    if (shared) {
+        munmap(shared, mapSize);
+        shared = NULL;
+        tx = rx = NULL;
+        txData = rxData = NULL;
+    }
+    delete spaceEvent;
+    spaceEvent = NULL;
+    if (spaceFd != -1) {
+        qcc::Close(spaceFd);
+        spaceFd = -1;
+    }
+    while (!rxFds.empty()) {
+        qcc::Close(rxFds.front());
+        rxFds.pop_front();
+    }
+}
+
+void SharedMemoryStream::Close()
+{
+    Detach();
+    SocketStream::Close();
+}
+
+void SharedMemoryStream::SetSendTimeout(uint32_t sendTimeout)
+{
+    this->sendTimeout = sendTimeout;
+    SocketStream::SetSendTimeout(sendTimeout);
+}
+
+QStatus SharedMemoryStream::DrainWakeUps()
+{
+    char buf[64];
+    char cbuf[CMSG_SPACE(MaxRecordFds * sizeof(int))];
+    while (true) {
+        struct iovec iov[] = { { buf, sizeof(buf) } };
+        struct msghdr msg;
+        ::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = ArraySize(iov);
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+        ssize_t ret = recvmsg(GetSocketFd(), &msg, MSG_DONTWAIT);
+        if (ret < 0) {
+            return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? ER_OK : ER_OS_ERROR;
+        }
+        if (ret == 0) {
+            peerClosed = true;
+            return ER_OK;
+        }
+        /*
+         * The writer does not send descriptors for a record until the reader has claimed the
+         * descriptors for the previous one, so there are never more than MaxRecordFds waiting.
+         * Anything beyond that, or any descriptor before handle passing was negotiated, is a
+         * misbehaving peer.
+         */
+        QStatus status = (msg.msg_flags & MSG_CTRUNC) ? ER_READ_ERROR : ER_OK;
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS)) {
+                size_t num = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                int* fds = reinterpret_cast<int*>(CMSG_DATA(cmsg));
+                for (size_t i = 0; i < num; ++i) {
+                    if (handlePassing && (status == ER_OK) && (rxFds.size() < MaxRecordFds)) {
+                        rxFds.push_back(fds[i]);
+                    } else {
+                        qcc::Close(fds[i]);
+                        status = ER_READ_ERROR;
+                    }
+                }
+            }
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Unexpected file descriptors on shared memory stream"));
+            return status;
+        }
+    }
+}
+
+QStatus SharedMemoryStream::DrainSpaceWakeUps()
+{
+    char buf[64];
+    while (true) {
+        ssize_t ret = recv(spaceFd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (ret < 0) {
+            return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? ER_OK : ER_OS_ERROR;
+        }
+        if (ret == 0) {
+            return ER_SOCK_OTHER_END_CLOSED;
+        }
+    }
+}
+
+QStatus SharedMemoryStream::Pull(void* buf, size_t reqBytes, size_t& actualBytes, SocketFd* fdList, size_t* numFds, uint32_t timeout)
+{
+    size_t maxFds = numFds ? *numFds : 0;
+    if (numFds) {
+        *numFds = 0;
+    }
+    actualBytes = 0;
+    /*
+     * The socket is only read when this end is about to block or a record is waiting for its
+     * descriptors so a reader that keeps up with the writer makes no system calls.
+     */
+    QStatus status = ER_OK;
+    while (rxRemaining == 0) {
+        uint32_t avail = rx->head - rxTail;
+        FullBarrier();
+        if (avail > ringSize) {
+            return ER_READ_ERROR;
+        }
+        if (avail >= sizeof(RecordHeader)) {
+            RecordHeader record;
+            CopyOut(&record, rxData, ringSize, rxTail, sizeof(record));
+            if ((record.len > (avail - sizeof(record))) || (record.numFds > MaxRecordFds) || (record.numFds && !handlePassing)) {
+                return ER_READ_ERROR;
+            }
+            rxTail += sizeof(record);
+            rxRemaining = record.len;
+            if (record.numFds) {
+                /* The descriptors were sent before the record was written */
+                while (rxFds.size() < record.numFds) {
+                    status = DrainWakeUps();
+                    if ((status == ER_OK) && (rxFds.size() < record.numFds)) {
+                        status = peerClosed ? ER_SOCK_OTHER_END_CLOSED : Event::Wait(GetSourceEvent(), 1000);
+                    }
+                    if (status != ER_OK) {
+                        QCC_LogError(status, ("Missing file descriptors for shared memory record"));
+                        return status;
+                    }
+                }
+                for (size_t i = 0; i < record.numFds; ++i) {
+                    if (numFds && (*numFds < maxFds)) {
+                        fdList[(*numFds)++] = rxFds.front();
+                    } else {
+                        qcc::Close(rxFds.front());
+                    }
+                    rxFds.pop_front();
+                }
+                /* Let the writer know the descriptors have been claimed so it can send more */
+                FullBarrier();
+                rx->tail = rxTail;
+                FullBarrier();
+                if (__sync_bool_compare_and_swap(&rx->writerWaiting, 1, 0)) {
+                    SendWakeUp(spaceFd);
+                }
+            }
+        } else if (avail != 0) {
+            /* Records are published whole so a partial record header is never visible */
+            return ER_READ_ERROR;
+        } else if (peerClosed) {
+            return ER_SOCK_OTHER_END_CLOSED;
+        } else {
+            rx->readerWaiting = 1;
+            FullBarrier();
+            if (rx->head != rxTail) {
+                continue;
+            }
+            /*
+             * About to block here or in the caller, consume stale wake-ups so the source event
+             * only fires for new data or the other end closing.
+             */
+            status = DrainWakeUps();
+            if (status != ER_OK) {
+                return status;
+            }
+            if (peerClosed || (rx->head != rxTail)) {
+                continue;
+            }
+            if (timeout == 0) {
+                return ER_TIMEOUT;
+            }
+            status = Event::Wait(GetSourceEvent(), timeout);
+            if (status != ER_OK) {
+                return status;
+            }
+        }
+    }
+    size_t len = (std::min)(reqBytes, (size_t)rxRemaining);
+    CopyOut(buf, rxData, ringSize, rxTail, len);
+    rxTail += len;
+    rxRemaining -= len;
+    FullBarrier();
+    rx->tail = rxTail;
+    FullBarrier();
+    if (__sync_bool_compare_and_swap(&rx->writerWaiting, 1, 0)) {
+        SendWakeUp(spaceFd);
+    }
+    actualBytes = len;
+    return ER_OK;
+}
+
+QStatus SharedMemoryStream::Push(const void* buf, size_t numBytes, size_t& numSent, SocketFd* fdList, size_t numFds)
+{
+    numSent = 0;
+    if (numFds > MaxRecordFds) {
+        return ER_BAD_ARG_5;
+    }
+    if ((numBytes == 0) && (numFds == 0)) {
+        return ER_OK;
+    }
+    /* Space available wake-ups are only read when this end has to wait for space */
+    QStatus status = ER_OK;
+    uint32_t space = 0;
+    while (status == ER_OK) {
+        uint32_t used = txHead - tx->tail;
+        if (used > ringSize) {
+            return ER_WRITE_ERROR;
+        }
+        space = ringSize - used;
+        /* Descriptors wait until the reader has claimed the ones sent with the previous record */
+        bool fdsClaimed = (numFds == 0) || ((int32_t)(tx->tail - txFdMark) >= 0);
+        if ((space > sizeof(RecordHeader)) && fdsClaimed) {
+            break;
+        }
+        tx->writerWaiting = 1;
+        FullBarrier();
+        if ((txHead - tx->tail) != used) {
+            continue;
+        }
+        /* About to block, consume stale wake-ups so the event only fires for new space */
+        status = DrainSpaceWakeUps();
+        if ((status != ER_OK) || ((txHead - tx->tail) != used)) {
+            continue;
+        }
+        if (sendTimeout == 0) {
+            return ER_TIMEOUT;
+        }
+        status = Event::Wait(*spaceEvent, sendTimeout);
+    }
+    if ((status == ER_OK) && numFds) {
+        /* Descriptors go first so they are waiting when the reader gets to the record */
+        status = SendWakeUp(GetSocketFd(), fdList, numFds);
+        if (status == ER_WOULDBLOCK) {
+            status = ER_TIMEOUT;
+        }
+    }
+    if (status != ER_OK) {
+        return status;
+    }
+    RecordHeader record;
+    record.len = (std::min)(numBytes, (size_t)(space - sizeof(record)));
+    record.numFds = numFds;
+    CopyIn(txData, ringSize, txHead, &record, sizeof(record));
+    CopyIn(txData, ringSize, txHead + sizeof(record), buf, record.len);
+    if (numFds) {
+        txFdMark = txHead + sizeof(record);
+    }
+    txHead += sizeof(record) + record.len;
+    FullBarrier();
+    tx->head = txHead;
+    FullBarrier();
+    if (__sync_bool_compare_and_swap(&tx->readerWaiting, 1, 0)) {
+        status = SendWakeUp(GetSocketFd());
+    }
+    numSent = record.len;
+    return status;
+}
+
+QStatus SharedMemoryStream::PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout)
+{
+    if (!shared) {
+        return SocketStream::PullBytes(buf, reqBytes, actualBytes, timeout);
+    }
+    return Pull(buf, reqBytes, actualBytes, NULL, NULL, timeout);
+}
+
+QStatus SharedMemoryStream::PullBytesAndFds(void* buf, size_t reqBytes, size_t& actualBytes, SocketFd* fdList, size_t& numFds, uint32_t timeout)
+{
+    if (!shared) {
+        return SocketStream::PullBytesAndFds(buf, reqBytes, actualBytes, fdList, numFds, timeout);
+    }
+    return Pull(buf, reqBytes, actualBytes, fdList, &numFds, timeout);
+}
+
+QStatus SharedMemoryStream::PushBytes(const void* buf, size_t numBytes, size_t& numSent)
+{
+    if (!shared) {
+        return SocketStream::PushBytes(buf, numBytes, numSent);
+    }
+    return Push(buf, numBytes, numSent, NULL, 0);
+}
+
+QStatus SharedMemoryStream::PushBytesAndFds(const void* buf, size_t numBytes, size_t& numSent, SocketFd* fdList, size_t numFds, uint32_t pid)
+{
+    if (!shared) {
+        return SocketStream::PushBytesAndFds(buf, numBytes, numSent, fdList, numFds, pid);
+    }
+    return Push(buf, numBytes, numSent, fdList, numFds);
+}
+
+}
@@ -1,7 +1,8 @@
 /**
  * @file
  *
- * This file tests AES-CCM against the RFC 3610 test vectors and some or our own tests
+ * This file tests AES-CCM against the RFC 3610 test vectors and some or our own tests and
+ * optionally measures AES-CCM message encryption throughput.
  */
 
 /******************************************************************************
@@ -22,12 +23,17 @@
 
 #include <qcc/platform.h>
 
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
 #include <qcc/Crypto.h>
 #include <qcc/Debug.h>
 #include <qcc/KeyBlob.h>
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/Util.h>
+#include <qcc/time.h>
 
 #include <alljoyn/version.h>
 
@@ -322,14 +328,79 @@ static TEST_CASE testVector[] = {
 };
 
 
+/*
+ * Encrypt iterations messages of a given body size with an 8 byte MAC and a 32 byte header as
+ * associated data, either reusing one cipher for all messages or creating a new cipher (and so
+ * expanding the key schedule) for each message. Returns the elapsed time in milliseconds.
+ */
+static uint64_t EncryptMessages(const KeyBlob& kb, size_t bodySize, uint32_t iterations, bool reuseCipher)
+{
+    const size_t hdrLen = 32;
+    const size_t macLen = 8;
+    std::vector<uint8_t> msg(hdrLen + bodySize + macLen, 0xA5);
+    uint8_t* body = &msg[hdrLen];
+    Crypto_AES cipher(kb, Crypto_AES::CCM);
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        uint8_t nd[5];
+        nd[0] = 0;
+        nd[1] = (uint8_t)(i >> 24);
+        nd[2] = (uint8_t)(i >> 16);
+        nd[3] = (uint8_t)(i >> 8);
+        nd[4] = (uint8_t)(i);
+        KeyBlob nonce(nd, sizeof(nd), KeyBlob::GENERIC);
+        size_t len = bodySize;
+        if (reuseCipher) {
+            cipher.Encrypt_CCM(body, body, len, nonce, &msg[0], hdrLen, macLen);
+        } else {
+            Crypto_AES aes(kb, Crypto_AES::CCM);
+            aes.Encrypt_CCM(body, body, len, nonce, &msg[0], hdrLen, macLen);
+        }
+    }
+    return GetTimestamp64() - start;
+}
+
+static void Benchmark(uint32_t iterations)
+{
+    static const size_t sizes[] = { 16, 64, 256, 1024, 4096, 16384 };
+    KeyBlob kb;
+    kb.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+
+    printf("AES CCM throughput, %u messages per size\n", iterations);
+    printf("%8s %16s %16s %12s\n", "bytes", "new cipher/s", "cached cipher/s", "cached MB/s");
+    for (size_t i = 0; i < ArraySize(sizes); ++i) {
+        uint64_t fresh = EncryptMessages(kb, sizes[i], iterations, false);
+        uint64_t cached = EncryptMessages(kb, sizes[i], iterations, true);
+        fresh = fresh ? fresh : 1;
+        cached = cached ? cached : 1;
+        printf("%8u %16llu %16llu %12llu\n", (unsigned int)sizes[i],
+               (unsigned long long)((iterations * 1000ULL) / fresh),
+               (unsigned long long)((iterations * 1000ULL) / cached),
+               (unsigned long long)((sizes[i] * iterations * 1000ULL) / (cached * 1024 * 1024)));
+    }
+}
 
 int main(int argc, char** argv)
 {
     QStatus status = ER_OK;
+    uint32_t benchIterations = 0;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
     printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
 
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-p", argv[i])) && ((i + 1) < argc)) {
+            benchIterations = StringToU32(argv[++i], 0, 0);
+        } else if (0 == strcmp("-p", argv[i])) {
+            benchIterations = 10000;
+        } else {
+            printf("Usage: aes_ccm [-p [<iterations>]]\n");
+            printf("   -p   = Measure encryption throughput after running the test vectors\n");
+            return -1;
+        }
+    }
+
     for (size_t i = 0; i < ArraySize(testVector); i++) {
         uint8_t key[16];
         uint8_t msg[64];
@@ -387,6 +458,10 @@ int main(int argc, char** argv)
         printf("Crypto_PseudorandomFunctionCCM test PASSED\n");
     }
 
+    if (benchIterations) {
+        Benchmark(benchIterations);
+    }
+
     return 0;
 
 ErrorExit:
@@ -0,0 +1,215 @@
+/* authresume - compare the latency of full and resumed peer authentication. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/AllJoynStd.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* AUTHRESUME_NAME = "org.alljoyn.test.authresume";
+static const char* AUTHRESUME_PATH = "/org/alljoyn/test/authresume";
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+class AuthResumeListener : public AuthListener {
+    bool RequestCredentials(const char* authMechanism, const char* authPeer, uint16_t authCount, const char* userId, uint16_t credMask, Credentials& creds)
+    {
+        if (credMask & AuthListener::CRED_PASSWORD) {
+            creds.SetPassword("123456");
+        }
+        return true;
+    }
+
+    void AuthenticationComplete(const char* authMechanism, const char* authPeer, bool success)
+    {
+        if (!success) {
+            printf("Authentication %s with %s failed\n", authMechanism, authPeer);
+        }
+    }
+};
+
+static void usage(void)
+{
+    printf("Usage: authresume [-n <rounds>] [-m <mechanism>]\n\n");
+    printf("Options:\n");
+    printf("   -h             = Print this help message\n");
+    printf("   -n <rounds>    = Number of full and resumed authentications to time (default 20)\n");
+    printf("   -m <mechanism> = Authentication mechanism (default ALLJOYN_SRP_KEYX)\n");
+    printf("\n");
+    printf("The service reconnects to the bus before every round to simulate a peer that has\n");
+    printf("roamed. Full rounds clear the client's key store first, resumed rounds keep it.\n");
+    printf("\n");
+}
+
+/*
+ * Reconnect the service so it gets a new unique name and wait until the client has
+ * dropped the peer state it had for the old one.
+ */
+static QStatus Reconnect(BusAttachment& service, BusAttachment& client, const qcc::String& connectArgs)
+{
+    QStatus status = connectArgs.empty() ? service.Disconnect() : service.Disconnect(connectArgs.c_str());
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? service.Connect() : service.Connect(connectArgs.c_str());
+    }
+    if (status == ER_OK) {
+        status = service.RequestName(AUTHRESUME_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    }
+    qcc::String guid;
+    for (uint32_t msecs = 0; (status == ER_OK) && (msecs < 5000); msecs += 5) {
+        if (client.GetPeerGUID(AUTHRESUME_NAME, guid) != ER_OK) {
+            break;
+        }
+        qcc::Sleep(5);
+    }
+    return status;
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t rounds = 20;
+    const char* mechanism = "ALLJOYN_SRP_KEYX";
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            rounds = qcc::StringToU32(argv[++i], 0, rounds);
+        } else if ((0 == strcmp("-m", argv[i])) && ((i + 1) < argc)) {
+            mechanism = argv[++i];
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectArgs = env->Find("BUS_ADDRESS");
+
+    BusAttachment service("authresume-service", true);
+    BusAttachment client("authresume-client", true);
+    AuthResumeListener serviceListener;
+    AuthResumeListener clientListener;
+
+    status = service.Start();
+    if (status == ER_OK) {
+        status = client.Start();
+    }
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? service.Connect() : service.Connect(connectArgs.c_str());
+    }
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? client.Connect() : client.Connect(connectArgs.c_str());
+    }
+    if (status == ER_OK) {
+        status = service.EnablePeerSecurity(mechanism, &serviceListener);
+    }
+    if (status == ER_OK) {
+        status = client.EnablePeerSecurity(mechanism, &clientListener);
+    }
+    if (status == ER_OK) {
+        status = service.RequestName(AUTHRESUME_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set up service and client"));
+    }
+
+    uint64_t fullTotal = 0;
+    uint64_t resumedTotal = 0;
+    uint32_t fullCount = 0;
+    uint32_t resumedCount = 0;
+    for (uint32_t i = 0; (status == ER_OK) && (i < rounds) && !g_interrupt; ++i) {
+        /* Full authentication, the client has no master secret for the service */
+        status = Reconnect(service, client, connectArgs);
+        if (status == ER_OK) {
+            client.ClearKeyStore();
+            ProxyBusObject proxy(client, AUTHRESUME_NAME, AUTHRESUME_PATH, 0);
+            uint64_t start = GetTimestamp64();
+            status = proxy.SecureConnection();
+            if (status == ER_OK) {
+                fullTotal += GetTimestamp64() - start;
+                ++fullCount;
+            } else {
+                QCC_LogError(status, ("Full authentication failed"));
+            }
+        }
+        /* Resumed authentication, the client still has the master secret from the previous round */
+        if (status == ER_OK) {
+            status = Reconnect(service, client, connectArgs);
+        }
+        if (status == ER_OK) {
+            ProxyBusObject proxy(client, AUTHRESUME_NAME, AUTHRESUME_PATH, 0);
+            uint64_t start = GetTimestamp64();
+            status = proxy.SecureConnection();
+            if (status == ER_OK) {
+                resumedTotal += GetTimestamp64() - start;
+                ++resumedCount;
+            } else {
+                QCC_LogError(status, ("Resumed authentication failed"));
+            }
+        }
+    }
+
+    if (fullCount && resumedCount) {
+        printf("%-10s %8s %12s\n", "handshake", "rounds", "avg (ms)");
+        printf("%-10s %8u %12.2f\n", "full", fullCount, (double)fullTotal / fullCount);
+        printf("%-10s %8u %12.2f\n", "resumed", resumedCount, (double)resumedTotal / resumedCount);
+    }
+
+    client.Stop();
+    service.Stop();
+    client.Join();
+    service.Join();
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
@@ -0,0 +1,222 @@
+/* bundledbench - compare round trip latency and throughput through a standalone daemon and a bundled daemon. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* BUNDLEDBENCH_NAME = "org.alljoyn.test.bundledbench";
+static const char* BUNDLEDBENCH_PATH = "/org/alljoyn/test/bundledbench";
+static const char* BUNDLEDBENCH_IFACE = "org.alljoyn.test.bundledbench";
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+class BundledBenchObject : public BusObject {
+  public:
+    BundledBenchObject(BusAttachment& bus, const InterfaceDescription& iface) : BusObject(BUNDLEDBENCH_PATH)
+    {
+        AddInterface(iface);
+        AddMethodHandler(iface.GetMember("Ping"), static_cast<MessageReceiver::MethodHandler>(&BundledBenchObject::Echo));
+        AddMethodHandler(iface.GetMember("Echo"), static_cast<MessageReceiver::MethodHandler>(&BundledBenchObject::Echo));
+    }
+
+    void Echo(const InterfaceDescription::Member* member, Message& msg)
+    {
+        MethodReply(msg, msg->GetArg(0), 1);
+    }
+};
+
+static void usage(void)
+{
+    printf("Usage: bundledbench [-n <calls>] [-s <size>]\n\n");
+    printf("Options:\n");
+    printf("   -h          = Print this help message\n");
+    printf("   -n <calls>  = Number of round trips to time for latency (default 2000)\n");
+    printf("   -s <size>   = Payload size in bytes for the throughput test (default 65536)\n");
+    printf("\n");
+    printf("The service and the client first connect to the standalone daemon at BUS_ADDRESS\n");
+    printf("(default unix:abstract=alljoyn) and then to the daemon bundled in this process over null:.\n");
+    printf("The bundled run needs a build with the bundled daemon linked in (BD=on).\n");
+    printf("\n");
+}
+
+/*
+ * Connect a service and a client to the daemon and time method calls between them.
+ */
+static QStatus RunBenchmark(const qcc::String& connectSpec, uint32_t calls, uint32_t size, double& latency, double& throughput)
+{
+    BusAttachment service("bundledbench-service", true);
+    BusAttachment client("bundledbench-client", true);
+    BundledBenchObject* object = NULL;
+
+    InterfaceDescription* iface = NULL;
+    QStatus status = service.CreateInterface(BUNDLEDBENCH_IFACE, iface);
+    if (status == ER_OK) {
+        iface->AddMethod("Ping", "u", "u", "in,out");
+        iface->AddMethod("Echo", "ay", "ay", "in,out");
+        iface->Activate();
+        object = new BundledBenchObject(service, *iface);
+        status = service.Start();
+    }
+    if (status == ER_OK) {
+        status = service.Connect(connectSpec.c_str());
+    }
+    if (status == ER_OK) {
+        status = service.RegisterBusObject(*object);
+    }
+    if (status == ER_OK) {
+        status = service.RequestName(BUNDLEDBENCH_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    }
+    if (status == ER_OK) {
+        status = client.Start();
+    }
+    if (status == ER_OK) {
+        status = client.Connect(connectSpec.c_str());
+    }
+
+    /* A failed connect silently falls back to the bundled daemon so make sure we got what was asked for */
+    if ((status == ER_OK) && (client.GetConnectSpec() != connectSpec)) {
+        status = ER_BUS_TRANSPORT_NOT_AVAILABLE;
+        QCC_LogError(status, ("Connected to %s instead of %s", client.GetConnectSpec().c_str(), connectSpec.c_str()));
+    }
+
+    ProxyBusObject proxy(client, BUNDLEDBENCH_NAME, BUNDLEDBENCH_PATH, 0);
+    if (status == ER_OK) {
+        status = proxy.IntrospectRemoteObject();
+    }
+
+    /* Latency: small round trips one at a time */
+    if (status == ER_OK) {
+        Message reply(client);
+        uint64_t start = GetTimestamp64();
+        uint32_t i;
+        for (i = 0; (status == ER_OK) && (i < calls) && !g_interrupt; ++i) {
+            MsgArg arg("u", i);
+            status = proxy.MethodCall(BUNDLEDBENCH_IFACE, "Ping", &arg, 1, reply);
+        }
+        if (i) {
+            latency = (double)(GetTimestamp64() - start) * 1000.0 / i;
+        }
+    }
+
+    /* Throughput: large payloads echoed back to the client */
+    if (status == ER_OK) {
+        std::vector<uint8_t> payload(size, 0xA5);
+        Message reply(client);
+        uint32_t rounds = (calls / 10) ? (calls / 10) : 1;
+        uint64_t start = GetTimestamp64();
+        uint32_t i;
+        for (i = 0; (status == ER_OK) && (i < rounds) && !g_interrupt; ++i) {
+            MsgArg arg("ay", payload.size(), &payload[0]);
+            status = proxy.MethodCall(BUNDLEDBENCH_IFACE, "Echo", &arg, 1, reply);
+        }
+        uint64_t elapsed = GetTimestamp64() - start;
+        if (i && elapsed) {
+            throughput = (2.0 * size * i) / (elapsed * 1000.0);
+        }
+    }
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Benchmark over %s failed", connectSpec.c_str()));
+    }
+
+    client.Stop();
+    client.Join();
+    if (object) {
+        service.UnregisterBusObject(*object);
+    }
+    service.Stop();
+    service.Join();
+    delete object;
+    return status;
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t calls = 2000;
+    uint32_t size = 65536;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            calls = qcc::StringToU32(argv[++i], 0, calls);
+        } else if ((0 == strcmp("-s", argv[i])) && ((i + 1) < argc)) {
+            size = qcc::StringToU32(argv[++i], 0, size);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectSpec = env->Find("BUS_ADDRESS", "unix:abstract=alljoyn");
+
+    double latency[2] = { 0.0, 0.0 };
+    double throughput[2] = { 0.0, 0.0 };
+    status = RunBenchmark(connectSpec, calls, size, latency[0], throughput[0]);
+    if ((status == ER_OK) && !g_interrupt) {
+        status = RunBenchmark("null:", calls, size, latency[1], throughput[1]);
+    }
+
+    if (status == ER_OK) {
+        printf("%-10s %16s %18s\n", "daemon", "latency (us)", "throughput (MB/s)");
+        printf("%-10s %16.1f %18.1f\n", "standalone", latency[0], throughput[0]);
+        printf("%-10s %16.1f %18.1f\n", "bundled", latency[1], throughput[1]);
+    }
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
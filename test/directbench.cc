@@ -0,0 +1,284 @@
+/* directbench - compare round trip latency of session method calls through the daemon and over a direct channel. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* DIRECTBENCH_NAME = "org.alljoyn.test.directbench";
+static const char* DIRECTBENCH_PATH = "/org/alljoyn/test/directbench";
+static const char* DIRECTBENCH_IFACE = "org.alljoyn.test.directbench";
+static const SessionPort DIRECTBENCH_PORT = 42;
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+class DirectBenchObject : public BusObject {
+  public:
+    DirectBenchObject(BusAttachment& bus, const InterfaceDescription& iface) : BusObject(DIRECTBENCH_PATH)
+    {
+        AddInterface(iface);
+        AddMethodHandler(iface.GetMember("Ping"), static_cast<MessageReceiver::MethodHandler>(&DirectBenchObject::Echo));
+        AddMethodHandler(iface.GetMember("Echo"), static_cast<MessageReceiver::MethodHandler>(&DirectBenchObject::Echo));
+    }
+
+    void Echo(const InterfaceDescription::Member* member, Message& msg)
+    {
+        MethodReply(msg, msg->GetArg(0), 1);
+    }
+};
+
+class DirectBenchListener : public SessionPortListener {
+  public:
+    DirectBenchListener() : sessionId(0) { }
+
+    bool AcceptSessionJoiner(SessionPort sessionPort, const char* joiner, const SessionOpts& opts)
+    {
+        return sessionPort == DIRECTBENCH_PORT;
+    }
+
+    void SessionJoined(SessionPort sessionPort, SessionId id, const char* joiner)
+    {
+        sessionId = id;
+    }
+
+    volatile SessionId sessionId;
+};
+
+/*
+ * Both members of the session have to ask for the direct channel. The service side asks from
+ * this thread while the client asks from the main thread.
+ */
+class EnableDirectThread : public Thread {
+  public:
+    EnableDirectThread(BusAttachment& bus, DirectBenchListener& listener) :
+        Thread("EnableDirect"), bus(bus), listener(listener), status(ER_OK) { }
+
+    qcc::ThreadReturn STDCALL Run(void* arg)
+    {
+        uint64_t start = GetTimestamp64();
+        while ((listener.sessionId == 0) && ((GetTimestamp64() - start) < 5000)) {
+            qcc::Sleep(5);
+        }
+        status = bus.EnableDirectSession(listener.sessionId);
+        return 0;
+    }
+
+    BusAttachment& bus;
+    DirectBenchListener& listener;
+    QStatus status;
+};
+
+static void usage(void)
+{
+    printf("Usage: directbench [-n <calls>] [-s <size>]\n\n");
+    printf("Options:\n");
+    printf("   -h          = Print this help message\n");
+    printf("   -n <calls>  = Number of round trips to time for latency (default 2000)\n");
+    printf("   -s <size>   = Payload size in bytes for the throughput test (default 65536)\n");
+    printf("\n");
+    printf("The service and the client connect to the daemon at BUS_ADDRESS (default unix:abstract=alljoyn),\n");
+    printf("join a session and time method calls first through the daemon and then over a direct channel.\n");
+    printf("\n");
+}
+
+/*
+ * Time method calls on a session.
+ */
+static QStatus TimeCalls(ProxyBusObject& proxy, BusAttachment& client, uint32_t calls, uint32_t size, double& latency, double& throughput)
+{
+    QStatus status = ER_OK;
+
+    /* Latency: small round trips one at a time */
+    Message reply(client);
+    uint64_t start = GetTimestamp64();
+    uint32_t i;
+    for (i = 0; (status == ER_OK) && (i < calls) && !g_interrupt; ++i) {
+        MsgArg arg("u", i);
+        status = proxy.MethodCall(DIRECTBENCH_IFACE, "Ping", &arg, 1, reply);
+    }
+    if (i) {
+        latency = (double)(GetTimestamp64() - start) * 1000.0 / i;
+    }
+
+    /* Throughput: large payloads echoed back to the client */
+    if (status == ER_OK) {
+        std::vector<uint8_t> payload(size, 0xA5);
+        uint32_t rounds = (calls / 10) ? (calls / 10) : 1;
+        start = GetTimestamp64();
+        for (i = 0; (status == ER_OK) && (i < rounds) && !g_interrupt; ++i) {
+            MsgArg arg("ay", payload.size(), &payload[0]);
+            status = proxy.MethodCall(DIRECTBENCH_IFACE, "Echo", &arg, 1, reply);
+        }
+        uint64_t elapsed = GetTimestamp64() - start;
+        if (i && elapsed) {
+            throughput = (2.0 * size * i) / (elapsed * 1000.0);
+        }
+    }
+    return status;
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t calls = 2000;
+    uint32_t size = 65536;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            calls = qcc::StringToU32(argv[++i], 0, calls);
+        } else if ((0 == strcmp("-s", argv[i])) && ((i + 1) < argc)) {
+            size = qcc::StringToU32(argv[++i], 0, size);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectSpec = env->Find("BUS_ADDRESS", "unix:abstract=alljoyn");
+
+    BusAttachment service("directbench-service", true);
+    BusAttachment client("directbench-client", true);
+    DirectBenchObject* object = NULL;
+    DirectBenchListener listener;
+
+    InterfaceDescription* iface = NULL;
+    status = service.CreateInterface(DIRECTBENCH_IFACE, iface);
+    if (status == ER_OK) {
+        iface->AddMethod("Ping", "u", "u", "in,out");
+        iface->AddMethod("Echo", "ay", "ay", "in,out");
+        iface->Activate();
+        object = new DirectBenchObject(service, *iface);
+        status = service.Start();
+    }
+    if (status == ER_OK) {
+        status = service.Connect(connectSpec.c_str());
+    }
+    if (status == ER_OK) {
+        status = service.RegisterBusObject(*object);
+    }
+    if (status == ER_OK) {
+        status = service.RequestName(DIRECTBENCH_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    }
+    SessionOpts opts(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_LOCAL);
+    if (status == ER_OK) {
+        SessionPort port = DIRECTBENCH_PORT;
+        status = service.BindSessionPort(port, opts, listener);
+    }
+    if (status == ER_OK) {
+        status = client.Start();
+    }
+    if (status == ER_OK) {
+        status = client.Connect(connectSpec.c_str());
+    }
+    SessionId sessionId = 0;
+    if (status == ER_OK) {
+        status = client.JoinSession(DIRECTBENCH_NAME, DIRECTBENCH_PORT, NULL, sessionId, opts);
+    }
+
+    /* Direct messages must be addressed to the unique name */
+    ProxyBusObject proxy(client, service.GetUniqueName().c_str(), DIRECTBENCH_PATH, sessionId);
+    if (status == ER_OK) {
+        status = proxy.IntrospectRemoteObject();
+    }
+
+    double latency[2] = { 0.0, 0.0 };
+    double throughput[2] = { 0.0, 0.0 };
+    if (status == ER_OK) {
+        status = TimeCalls(proxy, client, calls, size, latency[0], throughput[0]);
+    }
+
+    if ((status == ER_OK) && !g_interrupt) {
+        EnableDirectThread thread(service, listener);
+        status = thread.Start();
+        if (status == ER_OK) {
+            status = client.EnableDirectSession(sessionId);
+            thread.Join();
+            if (status == ER_OK) {
+                status = thread.status;
+            }
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("EnableDirectSession failed"));
+        }
+    }
+
+    if ((status == ER_OK) && !g_interrupt) {
+        status = TimeCalls(proxy, client, calls, size, latency[1], throughput[1]);
+    }
+
+    if (status == ER_OK) {
+        printf("%-8s %16s %18s\n", "path", "latency (us)", "throughput (MB/s)");
+        printf("%-8s %16.1f %18.1f\n", "daemon", latency[0], throughput[0]);
+        printf("%-8s %16.1f %18.1f\n", "direct", latency[1], throughput[1]);
+    }
+
+    if (sessionId) {
+        client.LeaveSession(sessionId);
+    }
+    client.Stop();
+    client.Join();
+    if (object) {
+        service.UnregisterBusObject(*object);
+    }
+    service.Stop();
+    service.Join();
+    delete object;
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
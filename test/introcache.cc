@@ -0,0 +1,210 @@
+/* introcache - compare connection to first method call latency with and without the introspection cache. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* INTROCACHE_NAME = "org.alljoyn.test.introcache";
+static const char* INTROCACHE_PATH = "/org/alljoyn/test/introcache";
+static const char* INTROCACHE_IFACE = "org.alljoyn.test.introcache";
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+class IntroCacheObject : public BusObject {
+  public:
+    IntroCacheObject(BusAttachment& bus, const InterfaceDescription& iface) : BusObject(INTROCACHE_PATH)
+    {
+        AddInterface(iface);
+        AddMethodHandler(iface.GetMember("Ping"), static_cast<MessageReceiver::MethodHandler>(&IntroCacheObject::Ping));
+    }
+
+    void Ping(const InterfaceDescription::Member* member, Message& msg)
+    {
+        MethodReply(msg, msg->GetArg(0), 1);
+    }
+};
+
+static void usage(void)
+{
+    printf("Usage: introcache [-n <rounds>] [-m <members>]\n\n");
+    printf("Options:\n");
+    printf("   -h            = Print this help message\n");
+    printf("   -n <rounds>   = Number of connections to time with and without the cache (default 20)\n");
+    printf("   -m <members>  = Number of methods, signals and properties on the test interface (default 32)\n");
+    printf("\n");
+    printf("Each round connects a new client, introspects the service and makes one method call.\n");
+    printf("\n");
+}
+
+/*
+ * Time connecting a new client to the bus, introspecting the service and calling a method on it.
+ */
+static QStatus ConnectAndCall(const qcc::String& connectArgs, bool useCache, uint64_t& elapsed)
+{
+    BusAttachment client("introcache-client", true);
+    QStatus status = client.Start();
+    uint64_t start = GetTimestamp64();
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? client.Connect() : client.Connect(connectArgs.c_str());
+    }
+    if ((status == ER_OK) && useCache) {
+        status = client.EnableIntrospectionCache();
+    }
+    if (status == ER_OK) {
+        ProxyBusObject proxy(client, INTROCACHE_NAME, INTROCACHE_PATH, 0);
+        status = proxy.IntrospectRemoteObject();
+        if (status == ER_OK) {
+            Message reply(client);
+            MsgArg arg("s", "ping");
+            status = proxy.MethodCall(INTROCACHE_IFACE, "Ping", &arg, 1, reply);
+        }
+    }
+    elapsed = GetTimestamp64() - start;
+    client.Stop();
+    client.Join();
+    return status;
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t rounds = 20;
+    uint32_t members = 32;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            rounds = qcc::StringToU32(argv[++i], 0, rounds);
+        } else if ((0 == strcmp("-m", argv[i])) && ((i + 1) < argc)) {
+            members = qcc::StringToU32(argv[++i], 0, members);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectArgs = env->Find("BUS_ADDRESS");
+
+    BusAttachment service("introcache-service", true);
+    InterfaceDescription* iface = NULL;
+    status = service.CreateInterface(INTROCACHE_IFACE, iface);
+    if (status == ER_OK) {
+        iface->AddMethod("Ping", "s", "s", "in,out");
+        for (uint32_t m = 0; m < members; ++m) {
+            qcc::String n = U32ToString(m);
+            iface->AddMethod(("Method" + n).c_str(), "a{sv}", "(usay)", "in,out");
+            iface->AddSignal(("Signal" + n).c_str(), "s", "value");
+            iface->AddProperty(("Property" + n).c_str(), "u", PROP_ACCESS_RW);
+        }
+        iface->Activate();
+    }
+    IntroCacheObject* object = (status == ER_OK) ? new IntroCacheObject(service, *iface) : NULL;
+
+    if (status == ER_OK) {
+        status = service.Start();
+    }
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? service.Connect() : service.Connect(connectArgs.c_str());
+    }
+    if (status == ER_OK) {
+        status = service.RegisterBusObject(*object);
+    }
+    if (status == ER_OK) {
+        status = service.RequestName(INTROCACHE_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set up service"));
+    }
+
+    /* Prime the cache so every cached round is a reconnecting client */
+    uint64_t elapsed;
+    if (status == ER_OK) {
+        status = ConnectAndCall(connectArgs, true, elapsed);
+    }
+
+    uint64_t uncachedTotal = 0;
+    uint64_t cachedTotal = 0;
+    uint32_t count = 0;
+    for (uint32_t i = 0; (status == ER_OK) && (i < rounds) && !g_interrupt; ++i) {
+        status = ConnectAndCall(connectArgs, false, elapsed);
+        if (status == ER_OK) {
+            uncachedTotal += elapsed;
+            status = ConnectAndCall(connectArgs, true, elapsed);
+        }
+        if (status == ER_OK) {
+            cachedTotal += elapsed;
+            ++count;
+        } else {
+            QCC_LogError(status, ("Round %u failed", i));
+        }
+    }
+
+    if (count) {
+        printf("%-10s %8s %12s\n", "cache", "rounds", "avg (ms)");
+        printf("%-10s %8u %12.2f\n", "off", count, (double)uncachedTotal / count);
+        printf("%-10s %8u %12.2f\n", "on", count, (double)cachedTotal / count);
+    }
+
+    if (object) {
+        service.UnregisterBusObject(*object);
+    }
+    service.Stop();
+    service.Join();
+    delete object;
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
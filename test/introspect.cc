@@ -0,0 +1,149 @@
+/* introspect - measure how long it takes to parse introspection XML into proxy objects. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringSource.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+#include <qcc/XmlElement.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* INTROSPECT_PATH = "/org/alljoyn/test/introspect";
+
+/*
+ * Build an introspection document for an object with the requested number of children, each
+ * child implements its own interface with the requested number of methods, signals and properties.
+ */
+static qcc::String BuildXml(uint32_t numChildren, uint32_t numMembers)
+{
+    qcc::String xml = "<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\"\n"
+                      "\"http://standards.freedesktop.org/dbus/introspect-1.0.dtd\">\n";
+    xml += qcc::String("<node name=\"") + INTROSPECT_PATH + "\">\n";
+    for (uint32_t c = 0; c < numChildren; ++c) {
+        qcc::String child = "c" + U32ToString(c);
+        xml += "  <node name=\"" + child + "\">\n";
+        xml += "    <interface name=\"org.alljoyn.test.introspect.n" + U32ToString(numChildren) + "m" + U32ToString(numMembers) + "." + child + "\">\n";
+        for (uint32_t m = 0; m < numMembers; ++m) {
+            qcc::String n = U32ToString(m);
+            xml += "      <method name=\"Method" + n + "\">\n";
+            xml += "        <arg name=\"in\" type=\"a{sv}\" direction=\"in\"/>\n";
+            xml += "        <arg name=\"out\" type=\"(usay)\" direction=\"out\"/>\n";
+            xml += "      </method>\n";
+            xml += "      <signal name=\"Signal" + n + "\">\n";
+            xml += "        <arg name=\"value\" type=\"s\" direction=\"out\"/>\n";
+            xml += "        <annotation name=\"org.freedesktop.DBus.Deprecated\" value=\"false\"/>\n";
+            xml += "      </signal>\n";
+            xml += "      <property name=\"Property" + n + "\" type=\"u\" access=\"readwrite\"/>\n";
+        }
+        xml += "    </interface>\n";
+        xml += "  </node>\n";
+    }
+    xml += "</node>\n";
+    return xml;
+}
+
+static void usage(void)
+{
+    printf("Usage: introspect [-n <iterations>]\n\n");
+    printf("Options:\n");
+    printf("   -h              = Print this help message\n");
+    printf("   -n <iterations> = Number of times each document is parsed (default 20)\n");
+    printf("\n");
+    printf("Reports the time to build only a DOM of each document with qcc::XmlElement and the\n");
+    printf("time ProxyBusObject::ParseXml takes to create the proxy objects and interfaces.\n");
+    printf("\n");
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    static const uint32_t numChildren[] = { 1, 10, 100, 500 };
+    static const uint32_t numMembers[] = { 4, 16, 64 };
+    QStatus status = ER_OK;
+    uint32_t iterations = 20;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            iterations = qcc::StringToU32(argv[++i], 0, iterations);
+            iterations = iterations ? iterations : 1;
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    BusAttachment bus("introspect");
+
+    printf("%8s %8s %10s %12s %14s\n", "children", "members", "KB", "DOM (us)", "ParseXml (us)");
+    for (size_t c = 0; (status == ER_OK) && (c < ArraySize(numChildren)); ++c) {
+        for (size_t m = 0; (status == ER_OK) && (m < ArraySize(numMembers)); ++m) {
+            qcc::String xml = BuildXml(numChildren[c], numMembers[m]);
+
+            uint64_t start = GetTimestamp64();
+            for (uint32_t i = 0; (status == ER_OK) && (i < iterations); ++i) {
+                StringSource source(xml);
+                XmlParseContext pc(source);
+                status = XmlElement::Parse(pc);
+            }
+            uint64_t dom = GetTimestamp64() - start;
+
+            /* The first parse creates the interfaces, later ones check them against the existing ones */
+            start = GetTimestamp64();
+            for (uint32_t i = 0; (status == ER_OK) && (i < iterations); ++i) {
+                ProxyBusObject proxy(bus, "org.alljoyn.test.introspect", INTROSPECT_PATH, 0);
+                status = proxy.ParseXml(xml.c_str(), "introspect");
+            }
+            uint64_t stream = GetTimestamp64() - start;
+
+            if (status == ER_OK) {
+                printf("%8u %8u %10u %12llu %14llu\n", numChildren[c], numMembers[m], (uint32_t)(xml.size() / 1024),
+                       (unsigned long long)((dom * 1000) / iterations),
+                       (unsigned long long)((stream * 1000) / iterations));
+            } else {
+                QCC_LogError(status, ("Failed to parse %u children with %u members", numChildren[c], numMembers[m]));
+            }
+        }
+    }
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
@@ -0,0 +1,273 @@
+/* joinstorm - measure daemon JoinSession latency when many joins are issued at once. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <algorithm>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/AllJoynStd.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const SessionPort JOINSTORM_PORT = 27;
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+/*
+ * Service side: one bus attachment per advertised name so that every join is a
+ * distinct session hosted behind the same remote daemon.
+ */
+class StormService : public SessionPortListener {
+  public:
+    bool AcceptSessionJoiner(SessionPort sessionPort, const char* joiner, const SessionOpts& opts)
+    {
+        return sessionPort == JOINSTORM_PORT;
+    }
+};
+
+/*
+ * Client side: collect discovered names, then fire a JoinSessionAsync for each of
+ * them back-to-back and record the per-join latency.
+ */
+class StormClient : public BusListener, public BusAttachment::JoinSessionAsyncCB {
+  public:
+    StormClient(BusAttachment& bus, size_t expected) : bus(bus), expected(expected), numDone(0), numFailed(0) { }
+
+    void FoundAdvertisedName(const char* name, TransportMask transport, const char* namePrefix)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        if (names.size() < expected) {
+            names.push_back(name);
+            if (names.size() == expected) {
+                foundAll.SetEvent();
+            }
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    void JoinAll(const SessionOpts& opts)
+    {
+        startTimes.resize(names.size());
+        latencies.reserve(names.size());
+        for (size_t i = 0; i < names.size(); ++i) {
+            startTimes[i] = GetTimestamp64();
+            QStatus status = bus.JoinSessionAsync(names[i].c_str(), JOINSTORM_PORT, NULL, opts, this, reinterpret_cast<void*>(i));
+            if (status != ER_OK) {
+                QCC_LogError(status, ("JoinSessionAsync(%s) failed", names[i].c_str()));
+                lock.Lock(MUTEX_CONTEXT);
+                ++numFailed;
+                ++numDone;
+                lock.Unlock(MUTEX_CONTEXT);
+            }
+        }
+    }
+
+    void JoinSessionCB(QStatus status, SessionId sessionId, const SessionOpts& opts, void* context)
+    {
+        size_t i = reinterpret_cast<size_t>(context);
+        uint64_t elapsed = GetTimestamp64() - startTimes[i];
+        lock.Lock(MUTEX_CONTEXT);
+        if (status == ER_OK) {
+            latencies.push_back(elapsed);
+        } else {
+            QCC_SyncPrintf("JoinSession(%s) failed with %s\n", names[i].c_str(), QCC_StatusText(status));
+            ++numFailed;
+        }
+        if (++numDone == names.size()) {
+            joinedAll.SetEvent();
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    void Report(uint64_t totalMs)
+    {
+        sort(latencies.begin(), latencies.end());
+        printf("joins: %u ok, %u failed, %llu ms total\n", (unsigned int)latencies.size(), (unsigned int)numFailed, (unsigned long long)totalMs);
+        if (!latencies.empty()) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < latencies.size(); ++i) {
+                sum += latencies[i];
+            }
+            printf("latency (ms): min %llu  avg %llu  p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+                   (unsigned long long)latencies.front(),
+                   (unsigned long long)(sum / latencies.size()),
+                   (unsigned long long)latencies[latencies.size() / 2],
+                   (unsigned long long)latencies[(latencies.size() * 90) / 100],
+                   (unsigned long long)latencies[(latencies.size() * 99) / 100],
+                   (unsigned long long)latencies.back());
+        }
+    }
+
+    BusAttachment& bus;
+    size_t expected;
+    size_t numDone;
+    size_t numFailed;
+    Mutex lock;
+    Event foundAll;
+    Event joinedAll;
+    vector<String> names;
+    vector<uint64_t> startTimes;
+    vector<uint64_t> latencies;
+};
+
+static void usage(void)
+{
+    printf("Usage: joinstorm [-s | -c] [-n <count>] [-p <prefix>] [-t]\n\n");
+    printf("Options:\n");
+    printf("   -h           = Print this help message\n");
+    printf("   -s           = Run as service (advertise <count> names)\n");
+    printf("   -c           = Run as client (join <count> sessions concurrently)\n");
+    printf("   -n <count>   = Number of names/sessions (default 100)\n");
+    printf("   -p <prefix>  = Well-known name prefix (default org.alljoyn.joinstorm)\n");
+    printf("   -t           = Restrict to TCP transport\n");
+    printf("\n");
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    bool isService = false;
+    bool isClient = false;
+    size_t count = 100;
+    String prefix = "org.alljoyn.joinstorm";
+    TransportMask transports = TRANSPORT_ANY;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if (0 == strcmp("-s", argv[i])) {
+            isService = true;
+        } else if (0 == strcmp("-c", argv[i])) {
+            isClient = true;
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            count = qcc::StringToU32(argv[++i], 0, 100);
+        } else if ((0 == strcmp("-p", argv[i])) && ((i + 1) < argc)) {
+            prefix = argv[++i];
+        } else if (0 == strcmp("-t", argv[i])) {
+            transports = TRANSPORT_TCP;
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+    if (isService == isClient) {
+        usage();
+        exit(1);
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectArgs = env->Find("BUS_ADDRESS");
+    SessionOpts opts(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, transports);
+
+    if (isService) {
+        StormService listener;
+        vector<BusAttachment*> buses;
+        for (size_t i = 0; (status == ER_OK) && (i < count); ++i) {
+            String name = prefix + ".n" + U32ToString(i);
+            BusAttachment* bus = new BusAttachment("joinstorm", true);
+            buses.push_back(bus);
+            status = bus->Start();
+            if (status == ER_OK) {
+                status = connectArgs.empty() ? bus->Connect() : bus->Connect(connectArgs.c_str());
+            }
+            if (status == ER_OK) {
+                SessionPort port = JOINSTORM_PORT;
+                status = bus->BindSessionPort(port, opts, listener);
+            }
+            if (status == ER_OK) {
+                status = bus->RequestName(name.c_str(), DBUS_NAME_FLAG_DO_NOT_QUEUE);
+            }
+            if (status == ER_OK) {
+                status = bus->AdvertiseName(name.c_str(), transports);
+            }
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Failed to set up service %s", name.c_str()));
+            }
+        }
+        if (status == ER_OK) {
+            printf("Advertising %u names with prefix %s\n", (unsigned int)count, prefix.c_str());
+        }
+        while ((status == ER_OK) && !g_interrupt) {
+            qcc::Sleep(100);
+        }
+        for (size_t i = 0; i < buses.size(); ++i) {
+            delete buses[i];
+        }
+    } else {
+        BusAttachment bus("joinstorm", true);
+        StormClient client(bus, count);
+        status = bus.Start();
+        if (status == ER_OK) {
+            status = connectArgs.empty() ? bus.Connect() : bus.Connect(connectArgs.c_str());
+        }
+        if (status == ER_OK) {
+            bus.RegisterBusListener(client);
+            status = bus.FindAdvertisedName(prefix.c_str());
+        }
+        if (status == ER_OK) {
+            status = Event::Wait(client.foundAll, 60000);
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Only found %u of %u names", (unsigned int)client.names.size(), (unsigned int)count));
+            }
+        }
+        if (status == ER_OK) {
+            uint64_t start = GetTimestamp64();
+            client.JoinAll(opts);
+            status = Event::Wait(client.joinedAll, 120000);
+            client.Report(GetTimestamp64() - start);
+        }
+        bus.UnregisterBusListener(client);
+    }
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
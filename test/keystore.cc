@@ -25,6 +25,9 @@
 
 #include <qcc/platform.h>
 
+#include <stdio.h>
+#include <string.h>
+
 #include <qcc/Crypto.h>
 #include <qcc/Debug.h>
 #include <qcc/FileStream.h>
@@ -46,6 +49,54 @@ using namespace ajn;
 
 static const char testData[] = "This is the message that we are going to encrypt and then decrypt and verify";
 
+/*
+ * Add keys one at a time storing the key store after each one, this is what happens when a
+ * device pairs with new peers. The store time should not grow with the number of keys.
+ */
+static QStatus Benchmark(uint32_t numKeys)
+{
+    static const uint32_t BATCH = 1000;
+    QStatus status = ER_OK;
+    KeyBlob key;
+
+    printf("Key store store time, storing after each of %u keys\n", numKeys);
+    printf("%8s %16s\n", "keys", "usecs/store");
+    {
+        KeyStore keyStore("keystore_bench");
+        keyStore.Init(NULL, false);
+        keyStore.Clear();
+
+        uint64_t start = GetTimestamp64();
+        for (uint32_t i = 0; (status == ER_OK) && (i < numKeys); ++i) {
+            qcc::GUID128 guid;
+            key.Rand(48, KeyBlob::GENERIC);
+            key.SetTag("ALLJOYN_SRP_KEYX", KeyBlob::NO_ROLE);
+            keyStore.AddKey(guid, key);
+            status = keyStore.Store();
+            if ((((i + 1) % BATCH) == 0) || ((i + 1) == numKeys)) {
+                uint64_t now = GetTimestamp64();
+                uint32_t batch = ((i + 1) % BATCH) ? ((i + 1) % BATCH) : BATCH;
+                printf("%8u %16llu\n", i + 1, (unsigned long long)(((now - start) * 1000) / batch));
+                start = now;
+            }
+        }
+        if (status != ER_OK) {
+            printf("Failed to store keystore %s\n", QCC_StatusText(status));
+            return status;
+        }
+    }
+    {
+        uint64_t start = GetTimestamp64();
+        KeyStore keyStore("keystore_bench");
+        status = keyStore.Init(NULL, false);
+        printf("Loaded %u keys in %llu ms\n", numKeys, (unsigned long long)(GetTimestamp64() - start));
+        keyStore.Clear();
+    }
+    DeleteFile(GetHomeDir() + "/.alljoyn_keystore/keystore_bench");
+    DeleteFile(GetHomeDir() + "/.alljoyn_keystore/keystore_bench.journal");
+    return status;
+}
+
 int main(int argc, char** argv)
 {
     qcc::GUID128 guid1;
@@ -54,10 +105,23 @@ int main(int argc, char** argv)
     qcc::GUID128 guid4;
     QStatus status = ER_OK;
     KeyBlob key;
+    uint32_t benchKeys = 0;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
     printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
 
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-p", argv[i])) && ((i + 1) < argc)) {
+            benchKeys = StringToU32(argv[++i], 0, 0);
+        } else if (0 == strcmp("-p", argv[i])) {
+            benchKeys = 10000;
+        } else {
+            printf("Usage: keystore [-p [<keys>]]\n");
+            printf("   -p   = Measure key store store and load times after running the tests\n");
+            return -1;
+        }
+    }
+
     Crypto_AES::Block* encrypted = new Crypto_AES::Block[Crypto_AES::NumBlocks(sizeof(testData))];
 
     printf("Testing basic key encryption/decryption\n");
@@ -270,6 +334,13 @@ int main(int argc, char** argv)
     }
 
     printf("keystore unit test PASSED\n");
+
+    if (benchKeys) {
+        status = Benchmark(benchKeys);
+        if (status != ER_OK) {
+            goto ErrorExit;
+        }
+    }
     return 0;
 
 ErrorExit:
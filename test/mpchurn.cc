@@ -0,0 +1,185 @@
+/* mpchurn - measure daemon cost of multipoint session member churn. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/AllJoynStd.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const SessionPort MPCHURN_PORT = 28;
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+class ChurnHost : public SessionPortListener {
+  public:
+    bool AcceptSessionJoiner(SessionPort sessionPort, const char* joiner, const SessionOpts& opts)
+    {
+        return sessionPort == MPCHURN_PORT;
+    }
+};
+
+static QStatus ConnectBus(BusAttachment& bus, const qcc::String& connectArgs)
+{
+    QStatus status = bus.Start();
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? bus.Connect() : bus.Connect(connectArgs.c_str());
+    }
+    return status;
+}
+
+static void usage(void)
+{
+    printf("Usage: mpchurn [-m <members>] [-i <iterations>] [-s <sessions>]\n\n");
+    printf("Options:\n");
+    printf("   -h              = Print this help message\n");
+    printf("   -m <members>    = Number of members in each multipoint session (default 50)\n");
+    printf("   -s <sessions>   = Number of concurrent multipoint sessions (default 4)\n");
+    printf("   -i <iterations> = Number of leave/join rounds (default 10)\n");
+    printf("\n");
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t numMembers = 50;
+    uint32_t numSessions = 4;
+    uint32_t iterations = 10;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-m", argv[i])) && ((i + 1) < argc)) {
+            numMembers = qcc::StringToU32(argv[++i], 0, numMembers);
+        } else if ((0 == strcmp("-s", argv[i])) && ((i + 1) < argc)) {
+            numSessions = qcc::StringToU32(argv[++i], 0, numSessions);
+        } else if ((0 == strcmp("-i", argv[i])) && ((i + 1) < argc)) {
+            iterations = qcc::StringToU32(argv[++i], 0, iterations);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectArgs = env->Find("BUS_ADDRESS");
+    SessionOpts opts(SessionOpts::TRAFFIC_MESSAGES, true, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY);
+
+    /* One host per session, each with numMembers joiners */
+    ChurnHost hostListener;
+    vector<BusAttachment*> hosts;
+    vector<BusAttachment*> members;
+    vector<SessionId> memberSessions(numSessions * numMembers, 0);
+
+    for (uint32_t s = 0; (status == ER_OK) && (s < numSessions); ++s) {
+        BusAttachment* host = new BusAttachment("mpchurn", true);
+        hosts.push_back(host);
+        status = ConnectBus(*host, connectArgs);
+        if (status == ER_OK) {
+            SessionPort port = MPCHURN_PORT;
+            status = host->BindSessionPort(port, opts, hostListener);
+        }
+        for (uint32_t m = 0; (status == ER_OK) && (m < numMembers); ++m) {
+            BusAttachment* member = new BusAttachment("mpchurn", true);
+            members.push_back(member);
+            status = ConnectBus(*member, connectArgs);
+        }
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set up bus attachments"));
+    }
+
+    uint64_t joinTime = 0;
+    uint64_t leaveTime = 0;
+    uint32_t numJoins = 0;
+    uint32_t numLeaves = 0;
+
+    for (uint32_t iter = 0; (status == ER_OK) && (iter < iterations) && !g_interrupt; ++iter) {
+        /* Every member joins its host's session */
+        uint64_t start = GetTimestamp64();
+        for (size_t i = 0; (status == ER_OK) && (i < members.size()); ++i) {
+            SessionOpts optsOut = opts;
+            status = members[i]->JoinSession(hosts[i / numMembers]->GetUniqueName().c_str(), MPCHURN_PORT, NULL, memberSessions[i], optsOut);
+            if (status != ER_OK) {
+                QCC_LogError(status, ("JoinSession failed for member %u", (unsigned int)i));
+            }
+            ++numJoins;
+        }
+        joinTime += GetTimestamp64() - start;
+
+        /* Then every member leaves again */
+        start = GetTimestamp64();
+        for (size_t i = 0; (status == ER_OK) && (i < members.size()); ++i) {
+            status = members[i]->LeaveSession(memberSessions[i]);
+            if (status != ER_OK) {
+                QCC_LogError(status, ("LeaveSession failed for member %u", (unsigned int)i));
+            }
+            ++numLeaves;
+        }
+        leaveTime += GetTimestamp64() - start;
+        printf("iteration %u: %u sessions x %u members\n", iter, numSessions, numMembers);
+    }
+
+    if (numJoins && numLeaves) {
+        printf("join:  %u calls, %llu ms total, %llu us/call\n", numJoins, (unsigned long long)joinTime, (unsigned long long)((joinTime * 1000) / numJoins));
+        printf("leave: %u calls, %llu ms total, %llu us/call\n", numLeaves, (unsigned long long)leaveTime, (unsigned long long)((leaveTime * 1000) / numLeaves));
+    }
+
+    for (size_t i = 0; i < members.size(); ++i) {
+        delete members[i];
+    }
+    for (size_t i = 0; i < hosts.size(); ++i) {
+        delete hosts[i];
+    }
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
@@ -0,0 +1,230 @@
+/* mpfanout - measure session multicast throughput for a large multipoint session. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/atomic.h>
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/AllJoynStd.h>
+#include <alljoyn/MsgArg.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* MPFANOUT_INTERFACE = "org.alljoyn.test.mpfanout";
+static const char* MPFANOUT_PATH = "/org/alljoyn/test/mpfanout";
+static const SessionPort MPFANOUT_PORT = 29;
+
+static volatile int32_t g_received = 0;
+
+static QStatus CreateInterface(BusAttachment& bus)
+{
+    InterfaceDescription* intf = NULL;
+    QStatus status = bus.CreateInterface(MPFANOUT_INTERFACE, intf);
+    if (status == ER_OK) {
+        intf->AddSignal("Tick", "uay", "seq,payload", 0);
+        intf->Activate();
+    } else if (status == ER_BUS_IFACE_ALREADY_EXISTS) {
+        status = ER_OK;
+    }
+    return status;
+}
+
+class FanoutSender : public BusObject {
+  public:
+    FanoutSender(BusAttachment& bus) : BusObject(MPFANOUT_PATH), tick(NULL)
+    {
+        const InterfaceDescription* intf = bus.GetInterface(MPFANOUT_INTERFACE);
+        AddInterface(*intf);
+        tick = intf->GetMember("Tick");
+    }
+
+    QStatus SendTick(SessionId id, uint32_t seq, const vector<uint8_t>& payload)
+    {
+        MsgArg args[2];
+        args[0].Set("u", seq);
+        args[1].Set("ay", payload.size(), payload.empty() ? NULL : &payload[0]);
+        return Signal(NULL, id, *tick, args, ArraySize(args));
+    }
+
+  private:
+    const InterfaceDescription::Member* tick;
+};
+
+class FanoutReceiver : public MessageReceiver {
+  public:
+    void TickHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+    {
+        IncrementAndFetch(&g_received);
+    }
+};
+
+class FanoutHost : public SessionPortListener {
+  public:
+    bool AcceptSessionJoiner(SessionPort sessionPort, const char* joiner, const SessionOpts& opts)
+    {
+        return sessionPort == MPFANOUT_PORT;
+    }
+};
+
+static QStatus ConnectBus(BusAttachment& bus, const qcc::String& connectArgs)
+{
+    QStatus status = bus.Start();
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? bus.Connect() : bus.Connect(connectArgs.c_str());
+    }
+    if (status == ER_OK) {
+        status = CreateInterface(bus);
+    }
+    return status;
+}
+
+static void usage(void)
+{
+    printf("Usage: mpfanout [-m <members>] [-n <signals>] [-s <bytes>]\n\n");
+    printf("Options:\n");
+    printf("   -h             = Print this help message\n");
+    printf("   -m <members>   = Number of session members including the host (default 100)\n");
+    printf("   -n <signals>   = Number of session signals to send (default 1000)\n");
+    printf("   -s <bytes>     = Signal payload size (default 64)\n");
+    printf("\n");
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t numMembers = 100;
+    uint32_t numSignals = 1000;
+    uint32_t payloadSize = 64;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-m", argv[i])) && ((i + 1) < argc)) {
+            numMembers = qcc::StringToU32(argv[++i], 0, numMembers);
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            numSignals = qcc::StringToU32(argv[++i], 0, numSignals);
+        } else if ((0 == strcmp("-s", argv[i])) && ((i + 1) < argc)) {
+            payloadSize = qcc::StringToU32(argv[++i], 0, payloadSize);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+    if (numMembers < 2) {
+        numMembers = 2;
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectArgs = env->Find("BUS_ADDRESS");
+    SessionOpts opts(SessionOpts::TRAFFIC_MESSAGES, true, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY);
+
+    /* Host binds the multipoint session port and sends the signals */
+    BusAttachment host("mpfanout", true);
+    FanoutHost hostListener;
+    status = ConnectBus(host, connectArgs);
+    if (status == ER_OK) {
+        SessionPort port = MPFANOUT_PORT;
+        status = host.BindSessionPort(port, opts, hostListener);
+    }
+    FanoutSender* sender = NULL;
+    if (status == ER_OK) {
+        sender = new FanoutSender(host);
+        status = host.RegisterBusObject(*sender);
+    }
+
+    /* Every other member joins the session and listens for the signal */
+    FanoutReceiver receiver;
+    vector<BusAttachment*> members;
+    SessionId sessionId = 0;
+    for (uint32_t i = 1; (status == ER_OK) && (i < numMembers); ++i) {
+        BusAttachment* member = new BusAttachment("mpfanout", true);
+        members.push_back(member);
+        status = ConnectBus(*member, connectArgs);
+        if (status == ER_OK) {
+            status = member->RegisterSignalHandler(&receiver,
+                                                   static_cast<MessageReceiver::SignalHandler>(&FanoutReceiver::TickHandler),
+                                                   member->GetInterface(MPFANOUT_INTERFACE)->GetMember("Tick"),
+                                                   NULL);
+        }
+        if (status == ER_OK) {
+            SessionOpts optsOut = opts;
+            status = member->JoinSession(host.GetUniqueName().c_str(), MPFANOUT_PORT, NULL, sessionId, optsOut);
+        }
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set up %u member session", numMembers));
+    }
+
+    if (status == ER_OK) {
+        vector<uint8_t> payload(payloadSize, 0xA5);
+        uint32_t expected = numSignals * (numMembers - 1);
+        uint64_t start = GetTimestamp64();
+        for (uint32_t seq = 0; (status == ER_OK) && (seq < numSignals); ++seq) {
+            status = sender->SendTick(sessionId, seq, payload);
+        }
+        /* Wait up to 30s for delivery to drain */
+        uint64_t deadline = GetTimestamp64() + 30000;
+        while (((uint32_t)g_received < expected) && (GetTimestamp64() < deadline)) {
+            qcc::Sleep(10);
+        }
+        uint64_t elapsed = GetTimestamp64() - start;
+        if (elapsed == 0) {
+            elapsed = 1;
+        }
+        printf("%u signals x %u receivers: %u of %u delivered in %llu ms (%llu signals/s, %llu deliveries/s)\n",
+               numSignals, numMembers - 1, (uint32_t)g_received, expected, (unsigned long long)elapsed,
+               (unsigned long long)((numSignals * 1000ULL) / elapsed),
+               (unsigned long long)(((uint64_t)g_received * 1000ULL) / elapsed));
+    }
+
+    for (size_t i = 0; i < members.size(); ++i) {
+        delete members[i];
+    }
+    host.Stop();
+    host.Join();
+    delete sender;
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
@@ -120,11 +120,12 @@ static void SigIntHandler(int sig)
 
 static void usage(void)
 {
-    printf("Usage: rawclient [-h] [-n <well-known name>] [-t <transport_mask>]\n\n");
+    printf("Usage: rawclient [-h] [-n <well-known name>] [-t <transport_mask>] [-b]\n\n");
     printf("Options:\n");
     printf("   -h                    = Print this help message\n");
     printf("   -n <well-known name>  = Well-known bus name advertised by bbservice\n");
     printf("   -t <transport_mask>   = Set the transports that will attempt a joinSession\n");
+    printf("   -b                    = Read until the service closes the session and report throughput (use with rawservice -b)\n");
     printf("\n");
 }
 
@@ -133,6 +134,7 @@ int main(int argc, char** argv)
 {
     QStatus status = ER_OK;
     Environ* env;
+    bool bench = false;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
     printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
@@ -167,6 +169,8 @@ int main(int argc, char** argv)
                     g_busListener.SetTransportMask(transportMask);
                 }
             }
+        } else if (0 == strcmp("-b", argv[i])) {
+            bench = true;
         } else if (0 == strcmp("-h", argv[i])) {
             usage();
             exit(0);
@@ -263,7 +267,40 @@ int main(int argc, char** argv)
         /* Get the descriptor */
         SocketFd sockFd;
         QStatus status = g_msgBus->GetSessionFd(ssId, sockFd);
-        if (status == ER_OK) {
+        if ((status == ER_OK) && bench) {
+            /* Read everything the service streams and time it */
+            std::vector<uint8_t> buf(64 * 1024);
+            Event readable(sockFd, Event::IO_READ, false);
+            uint64_t start = 0;
+            uint64_t total = 0;
+            while ((status == ER_OK) && !g_interrupt) {
+                size_t recvd = 0;
+                status = qcc::Recv(sockFd, &buf[0], buf.size(), recvd);
+                if (status == ER_OK) {
+                    if (recvd == 0) {
+                        break;
+                    }
+                    if (total == 0) {
+                        start = GetTimestamp64();
+                    }
+                    total += recvd;
+                } else if (status == ER_WOULDBLOCK) {
+                    status = Event::Wait(readable, 1000);
+                    if (status == ER_TIMEOUT) {
+                        status = ER_OK;
+                    }
+                } else if (status == ER_SOCK_OTHER_END_CLOSED) {
+                    status = ER_OK;
+                    break;
+                }
+            }
+            uint64_t elapsed = total ? (GetTimestamp64() - start) : 0;
+            QCC_SyncPrintf("Read %llu bytes in %llu ms (%.1f MB/s)\n", (unsigned long long)total, (unsigned long long)elapsed,
+                           elapsed ? (total / (elapsed * 1000.0)) : 0.0);
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Read from raw fd failed"));
+            }
+        } else if (status == ER_OK) {
             /* Attempt to read test string from fd */
             char buf[256];
             size_t recvd;
@@ -28,6 +28,7 @@
 
 #include <qcc/Debug.h>
 #include <qcc/Environ.h>
+#include <qcc/Event.h>
 #include <qcc/Mutex.h>
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
@@ -95,11 +96,45 @@ class MySessionPortListener : public SessionPortListener {
 
 static void usage(void)
 {
-    printf("Usage: rawservice [-h] [-n <name>] [-t <transport_mask>]\n\n");
+    printf("Usage: rawservice [-h] [-n <name>] [-t <transport_mask>] [-b <bytes>]\n\n");
     printf("Options:\n");
     printf("   -h                    = Print this help message\n");
     printf("   -n <name>             = Well-known name to advertise\n");
     printf("   -t <transport_mask>   = Set the transports that are used for advertising. (Defaults to TRANSPORT_ANY)\n");
+    printf("   -b <bytes>            = Stream <bytes> bytes to each joiner instead of the test message (use with rawclient -b)\n");
+    printf("\n");
+    printf("To measure the relay of a daemon that bridges raw sessions run rawservice and rawclient against two\n");
+    printf("daemons that can only reach each other through a third one.\n");
+}
+
+/*
+ * Write len bytes to a raw session socket waiting for the socket to become writable as needed.
+ */
+static QStatus StreamBytes(SocketFd sockFd, uint64_t len)
+{
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    std::vector<uint8_t> chunk(CHUNK_SIZE, 0xA5);
+    Event writable(sockFd, Event::IO_WRITE, false);
+    QStatus status = ER_OK;
+    uint64_t start = GetTimestamp64();
+    uint64_t total = 0;
+    while ((status == ER_OK) && (total < len) && !g_interrupt) {
+        size_t sent = 0;
+        size_t toSend = (size_t)((len - total) < CHUNK_SIZE ? (len - total) : CHUNK_SIZE);
+        status = qcc::Send(sockFd, &chunk[0], toSend, sent);
+        if (status == ER_OK) {
+            total += sent;
+        } else if (status == ER_WOULDBLOCK) {
+            status = Event::Wait(writable, 1000);
+            if (status == ER_TIMEOUT) {
+                status = ER_OK;
+            }
+        }
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    printf("Wrote %llu bytes in %llu ms (%.1f MB/s)\n", (unsigned long long)total, (unsigned long long)elapsed,
+           elapsed ? (total / (elapsed * 1000.0)) : 0.0);
+    return status;
 }
 
 /** Main entry point */
@@ -107,6 +142,7 @@ int main(int argc, char** argv)
 {
     QStatus status = ER_OK;
     TransportMask transportMask = TRANSPORT_ANY;
+    uint64_t benchBytes = 0;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
     printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
@@ -142,6 +178,15 @@ int main(int argc, char** argv)
                     exit(1);
                 }
             }
+        } else if (0 == strcmp("-b", argv[i])) {
+            ++i;
+            if (i == argc) {
+                printf("option %s requires a parameter\n", argv[i - 1]);
+                usage();
+                exit(1);
+            } else {
+                benchBytes = StringToU64(argv[i], 10, 0);
+            }
         } else {
             status = ER_FAIL;
             printf("Unknown option %s\n", argv[i]);
@@ -223,6 +268,21 @@ int main(int argc, char** argv)
             QCC_LogError(status, ("Failed to get socket from GetSessionFd args"));
         }
 
+        /* Stream the benchmark bytes on the socket */
+        if ((status == ER_OK) && benchBytes) {
+            status = StreamBytes(sockFd, benchBytes);
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Failed to stream %llu bytes", (unsigned long long)benchBytes));
+            }
+#ifdef WIN32
+            closesocket(sockFd);
+#else
+            ::shutdown(sockFd, SHUT_RDWR);
+            ::close(sockFd);
+#endif
+            continue;
+        }
+
         /* Write test message on socket */
         if (status == ER_OK) {
             const char* testMessage = "abcdefghijklmnopqrstuvwxyz";
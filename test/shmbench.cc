@@ -0,0 +1,233 @@
+/* shmbench - compare round trip latency and throughput through the daemon over unix sockets and shared memory. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* SHMBENCH_NAME = "org.alljoyn.test.shmbench";
+static const char* SHMBENCH_PATH = "/org/alljoyn/test/shmbench";
+static const char* SHMBENCH_IFACE = "org.alljoyn.test.shmbench";
+
+static volatile sig_atomic_t g_interrupt = false;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+class ShmBenchObject : public BusObject {
+  public:
+    ShmBenchObject(BusAttachment& bus, const InterfaceDescription& iface) : BusObject(SHMBENCH_PATH)
+    {
+        AddInterface(iface);
+        AddMethodHandler(iface.GetMember("Ping"), static_cast<MessageReceiver::MethodHandler>(&ShmBenchObject::Echo));
+        AddMethodHandler(iface.GetMember("Echo"), static_cast<MessageReceiver::MethodHandler>(&ShmBenchObject::Echo));
+    }
+
+    void Echo(const InterfaceDescription::Member* member, Message& msg)
+    {
+        MethodReply(msg, msg->GetArg(0), 1);
+    }
+};
+
+static void usage(void)
+{
+    printf("Usage: shmbench [-n <calls>] [-s <size>]\n\n");
+    printf("Options:\n");
+    printf("   -h          = Print this help message\n");
+    printf("   -n <calls>  = Number of round trips to time for latency (default 2000)\n");
+    printf("   -s <size>   = Payload size in bytes for the throughput test (default 65536)\n");
+    printf("\n");
+    printf("The service and the client connect to the daemon at BUS_ADDRESS (default unix:abstract=alljoyn),\n");
+    printf("first over the unix socket and then with shm=required added to the connect spec.\n");
+    printf("\n");
+}
+
+/*
+ * Connect a service and a client to the daemon and time method calls between them.
+ */
+static QStatus RunBenchmark(const qcc::String& connectSpec, uint32_t calls, uint32_t size, double& latency, double& throughput)
+{
+    BusAttachment service("shmbench-service", true);
+    BusAttachment client("shmbench-client", true);
+    ShmBenchObject* object = NULL;
+
+    InterfaceDescription* iface = NULL;
+    QStatus status = service.CreateInterface(SHMBENCH_IFACE, iface);
+    if (status == ER_OK) {
+        iface->AddMethod("Ping", "u", "u", "in,out");
+        iface->AddMethod("Echo", "ay", "ay", "in,out");
+        iface->Activate();
+        object = new ShmBenchObject(service, *iface);
+        status = service.Start();
+    }
+    if (status == ER_OK) {
+        status = service.Connect(connectSpec.c_str());
+    }
+    if (status == ER_OK) {
+        status = service.RegisterBusObject(*object);
+    }
+    if (status == ER_OK) {
+        status = service.RequestName(SHMBENCH_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    }
+    if (status == ER_OK) {
+        status = client.Start();
+    }
+    if (status == ER_OK) {
+        status = client.Connect(connectSpec.c_str());
+    }
+
+    ProxyBusObject proxy(client, SHMBENCH_NAME, SHMBENCH_PATH, 0);
+    if (status == ER_OK) {
+        status = proxy.IntrospectRemoteObject();
+    }
+
+    /* Latency: small round trips one at a time */
+    if (status == ER_OK) {
+        Message reply(client);
+        uint64_t start = GetTimestamp64();
+        uint32_t i;
+        for (i = 0; (status == ER_OK) && (i < calls) && !g_interrupt; ++i) {
+            MsgArg arg("u", i);
+            status = proxy.MethodCall(SHMBENCH_IFACE, "Ping", &arg, 1, reply);
+            uint32_t echoed = 0;
+            if ((status == ER_OK) && ((reply->GetArg(0)->Get("u", &echoed) != ER_OK) || (echoed != i))) {
+                status = ER_BUS_BAD_VALUE;
+            }
+        }
+        if (i) {
+            latency = (double)(GetTimestamp64() - start) * 1000.0 / i;
+        }
+    }
+
+    /* Throughput: large payloads echoed back to the client */
+    if (status == ER_OK) {
+        std::vector<uint8_t> payload(size);
+        for (uint32_t j = 0; j < size; ++j) {
+            payload[j] = (uint8_t)(j * 31 + 7);
+        }
+        Message reply(client);
+        uint32_t rounds = (calls / 10) ? (calls / 10) : 1;
+        uint64_t start = GetTimestamp64();
+        uint32_t i;
+        for (i = 0; (status == ER_OK) && (i < rounds) && !g_interrupt; ++i) {
+            MsgArg arg("ay", payload.size(), &payload[0]);
+            status = proxy.MethodCall(SHMBENCH_IFACE, "Echo", &arg, 1, reply);
+            size_t len = 0;
+            uint8_t* echoed = NULL;
+            if ((status == ER_OK) && ((reply->GetArg(0)->Get("ay", &len, &echoed) != ER_OK) || (len != payload.size()) ||
+                                      (memcmp(echoed, &payload[0], len) != 0))) {
+                status = ER_BUS_BAD_VALUE;
+            }
+        }
+        uint64_t elapsed = GetTimestamp64() - start;
+        if (i && elapsed) {
+            throughput = (2.0 * size * i) / (elapsed * 1000.0);
+        }
+    }
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Benchmark over %s failed", connectSpec.c_str()));
+    }
+
+    client.Stop();
+    client.Join();
+    if (object) {
+        service.UnregisterBusObject(*object);
+    }
+    service.Stop();
+    service.Join();
+    delete object;
+    return status;
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t calls = 2000;
+    uint32_t size = 65536;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            calls = qcc::StringToU32(argv[++i], 0, calls);
+        } else if ((0 == strcmp("-s", argv[i])) && ((i + 1) < argc)) {
+            size = qcc::StringToU32(argv[++i], 0, size);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectSpec = env->Find("BUS_ADDRESS", "unix:abstract=alljoyn");
+    if (connectSpec.compare(0, 5, "unix:") != 0) {
+        printf("BUS_ADDRESS must be a unix transport address\n");
+        exit(1);
+    }
+
+    double latency[2] = { 0.0, 0.0 };
+    double throughput[2] = { 0.0, 0.0 };
+    status = RunBenchmark(connectSpec, calls, size, latency[0], throughput[0]);
+    if ((status == ER_OK) && !g_interrupt) {
+        /* Fail rather than report socket numbers as shared memory if the daemon declines */
+        status = RunBenchmark(connectSpec + ",shm=required", calls, size, latency[1], throughput[1]);
+    }
+
+    if (status == ER_OK) {
+        printf("%-8s %16s %18s\n", "path", "latency (us)", "throughput (MB/s)");
+        printf("%-8s %16.1f %18.1f\n", "socket", latency[0], throughput[0]);
+        printf("%-8s %16.1f %18.1f\n", "shm", latency[1], throughput[1]);
+    }
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
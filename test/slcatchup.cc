@@ -0,0 +1,228 @@
+/* slcatchup - measure how long a new client takes to catch up on retained sessionless signals. */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/atomic.h>
+#include <qcc/Debug.h>
+#include <qcc/Environ.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/AllJoynStd.h>
+#include <alljoyn/MsgArg.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+using namespace ajn;
+
+static const char* SLCATCHUP_INTERFACE = "org.alljoyn.test.slcatchup";
+static const char* SLCATCHUP_PATH = "/org/alljoyn/test/slcatchup/s";
+
+static volatile sig_atomic_t g_interrupt = false;
+static volatile int32_t g_received = 0;
+
+static void SigIntHandler(int sig)
+{
+    g_interrupt = true;
+}
+
+static QStatus CreateInterface(BusAttachment& bus)
+{
+    InterfaceDescription* intf = NULL;
+    QStatus status = bus.CreateInterface(SLCATCHUP_INTERFACE, intf);
+    if (status == ER_OK) {
+        intf->AddSignal("State", "uay", "seq,payload", 0);
+        intf->Activate();
+    } else if (status == ER_BUS_IFACE_ALREADY_EXISTS) {
+        status = ER_OK;
+    }
+    return status;
+}
+
+/*
+ * Sessionless signals are retained per sender, interface, member and object path so
+ * each signal is sent from its own object to keep all of them in the daemon's cache.
+ */
+class StateObject : public BusObject {
+  public:
+    StateObject(BusAttachment& bus, const qcc::String& path) : BusObject(path.c_str()), state(NULL)
+    {
+        const InterfaceDescription* intf = bus.GetInterface(SLCATCHUP_INTERFACE);
+        AddInterface(*intf);
+        state = intf->GetMember("State");
+    }
+
+    QStatus SendState(uint32_t seq, const vector<uint8_t>& payload)
+    {
+        MsgArg args[2];
+        args[0].Set("u", seq);
+        args[1].Set("ay", payload.size(), payload.empty() ? NULL : &payload[0]);
+        return Signal(NULL, 0, *state, args, ArraySize(args), 0, ALLJOYN_FLAG_SESSIONLESS);
+    }
+
+  private:
+    const InterfaceDescription::Member* state;
+};
+
+class StateReceiver : public MessageReceiver {
+  public:
+    void StateHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+    {
+        IncrementAndFetch(&g_received);
+    }
+};
+
+static void usage(void)
+{
+    printf("Usage: slcatchup [-s | -c] [-n <signals>] [-b <bytes>]\n\n");
+    printf("Options:\n");
+    printf("   -h             = Print this help message\n");
+    printf("   -s             = Run as service (send <signals> sessionless signals and wait)\n");
+    printf("   -c             = Run as client (catch up on <signals> sessionless signals)\n");
+    printf("   -n <signals>   = Number of sessionless signals (default 1000)\n");
+    printf("   -b <bytes>     = Signal payload size (default 64)\n");
+    printf("\n");
+    printf("Run the service and client against two different daemons (for example two\n");
+    printf("bundled or standalone daemons on the same host) to measure catch up between them.\n");
+    printf("\n");
+}
+
+/** Main entry point */
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    bool isService = false;
+    bool isClient = false;
+    uint32_t numSignals = 1000;
+    uint32_t payloadSize = 64;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    signal(SIGINT, SigIntHandler);
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-h", argv[i]) || 0 == strcmp("-?", argv[i])) {
+            usage();
+            exit(0);
+        } else if (0 == strcmp("-s", argv[i])) {
+            isService = true;
+        } else if (0 == strcmp("-c", argv[i])) {
+            isClient = true;
+        } else if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            numSignals = qcc::StringToU32(argv[++i], 0, numSignals);
+        } else if ((0 == strcmp("-b", argv[i])) && ((i + 1) < argc)) {
+            payloadSize = qcc::StringToU32(argv[++i], 0, payloadSize);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+    if (isService == isClient) {
+        usage();
+        exit(1);
+    }
+
+    Environ* env = Environ::GetAppEnviron();
+    qcc::String connectArgs = env->Find("BUS_ADDRESS");
+
+    BusAttachment bus("slcatchup", true);
+    status = bus.Start();
+    if (status == ER_OK) {
+        status = connectArgs.empty() ? bus.Connect() : bus.Connect(connectArgs.c_str());
+    }
+    if (status == ER_OK) {
+        status = CreateInterface(bus);
+    }
+
+    if (isService) {
+        vector<StateObject*> objects;
+        for (uint32_t i = 0; (status == ER_OK) && (i < numSignals); ++i) {
+            StateObject* obj = new StateObject(bus, qcc::String(SLCATCHUP_PATH) + U32ToString(i));
+            objects.push_back(obj);
+            status = bus.RegisterBusObject(*obj);
+        }
+        vector<uint8_t> payload(payloadSize, 0x5A);
+        uint64_t start = GetTimestamp64();
+        for (uint32_t i = 0; (status == ER_OK) && (i < numSignals); ++i) {
+            status = objects[i]->SendState(i, payload);
+        }
+        if (status == ER_OK) {
+            printf("Sent %u sessionless signals in %llu ms, waiting for clients\n", numSignals, (unsigned long long)(GetTimestamp64() - start));
+        } else {
+            QCC_LogError(status, ("Failed to send sessionless signals"));
+        }
+        while ((status == ER_OK) && !g_interrupt) {
+            qcc::Sleep(100);
+        }
+        bus.Stop();
+        bus.Join();
+        for (size_t i = 0; i < objects.size(); ++i) {
+            delete objects[i];
+        }
+    } else {
+        StateReceiver receiver;
+        if (status == ER_OK) {
+            status = bus.RegisterSignalHandler(&receiver,
+                                               static_cast<MessageReceiver::SignalHandler>(&StateReceiver::StateHandler),
+                                               bus.GetInterface(SLCATCHUP_INTERFACE)->GetMember("State"),
+                                               NULL);
+        }
+        uint64_t start = GetTimestamp64();
+        if (status == ER_OK) {
+            status = bus.AddMatch("type='signal',sessionless='t',interface='org.alljoyn.test.slcatchup'");
+        }
+        if (status == ER_OK) {
+            /* Wait up to 60s for the catch up to complete */
+            uint64_t firstAt = 0;
+            uint64_t deadline = start + 60000;
+            while (((uint32_t)g_received < numSignals) && (GetTimestamp64() < deadline) && !g_interrupt) {
+                if (!firstAt && g_received) {
+                    firstAt = GetTimestamp64();
+                }
+                qcc::Sleep(5);
+            }
+            uint64_t elapsed = GetTimestamp64() - start;
+            printf("caught up on %u of %u signals in %llu ms (first signal after %llu ms)\n",
+                   (uint32_t)g_received, numSignals, (unsigned long long)elapsed,
+                   (unsigned long long)(firstAt ? (firstAt - start) : 0));
+            if ((uint32_t)g_received < numSignals) {
+                status = ER_TIMEOUT;
+            }
+        }
+    }
+
+    printf("%s exiting with status %d (%s)\n", argv[0], status, QCC_StatusText(status));
+    return (int) status;
+}
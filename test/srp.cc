@@ -22,6 +22,9 @@
 
 #include <qcc/platform.h>
 
+#include <stdio.h>
+#include <string.h>
+
 #include <qcc/Crypto.h>
 #include <qcc/Debug.h>
 #include <qcc/KeyBlob.h>
@@ -30,6 +33,8 @@
 #include <qcc/Util.h>
 #include <qcc/Debug.h>
 #include <qcc/BigNum.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
 
 #include <alljoyn/version.h>
 #include <alljoyn/BusAttachment.h>
@@ -56,6 +61,89 @@ class MyAuthListener : public AuthListener {
     }
 };
 
+/*
+ * Run one SRP handshake, the server side either derives the verifier from the password or
+ * starts from a verifier that was computed earlier.
+ */
+static QStatus Handshake(const String& user, const String& pwd, const String& verifier)
+{
+    Crypto_SRP client;
+    Crypto_SRP server;
+    String toClient;
+    String toServer;
+
+    QStatus status = verifier.empty() ? server.ServerInit(user, pwd, toClient) : server.ServerInit(verifier, toClient);
+    if (status == ER_OK) {
+        status = client.ClientInit(toClient, toServer);
+    }
+    if (status == ER_OK) {
+        status = server.ServerFinish(toServer);
+    }
+    if (status == ER_OK) {
+        status = client.ClientFinish(user, pwd);
+    }
+    return status;
+}
+
+class HandshakeThread : public Thread {
+  public:
+    HandshakeThread(const String& verifier, uint32_t iterations) : Thread("srp"), verifier(verifier), iterations(iterations) { }
+
+  protected:
+    qcc::ThreadReturn STDCALL Run(void* arg)
+    {
+        QStatus status = ER_OK;
+        for (uint32_t i = 0; (status == ER_OK) && (i < iterations); ++i) {
+            status = Handshake("someuser", "a-secret-password", verifier);
+        }
+        return (qcc::ThreadReturn)(uintptr_t)status;
+    }
+
+  private:
+    String verifier;
+    uint32_t iterations;
+};
+
+static uint64_t TimeHandshakes(const String& verifier, uint32_t numThreads, uint32_t iterations)
+{
+    HandshakeThread** threads = new HandshakeThread*[numThreads];
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads[i] = new HandshakeThread(verifier, iterations);
+        threads[i]->Start();
+    }
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads[i]->Join();
+        delete threads[i];
+    }
+    delete [] threads;
+    return GetTimestamp64() - start;
+}
+
+static void Benchmark(uint32_t iterations)
+{
+    static const uint32_t numThreads[] = { 1, 2, 4, 8 };
+    String verifier;
+    {
+        Crypto_SRP server;
+        String toClient;
+        server.ServerInit("someuser", "a-secret-password", toClient);
+        verifier = server.ServerGetVerifier();
+    }
+
+    printf("SRP handshake throughput, %u handshakes per thread\n", iterations);
+    printf("%8s %16s %16s\n", "threads", "password/s", "verifier/s");
+    for (size_t i = 0; i < ArraySize(numThreads); ++i) {
+        uint64_t fromPwd = TimeHandshakes("", numThreads[i], iterations);
+        uint64_t fromVerifier = TimeHandshakes(verifier, numThreads[i], iterations);
+        fromPwd = fromPwd ? fromPwd : 1;
+        fromVerifier = fromVerifier ? fromVerifier : 1;
+        printf("%8u %16llu %16llu\n", numThreads[i],
+               (unsigned long long)((numThreads[i] * iterations * 1000ULL) / fromPwd),
+               (unsigned long long)((numThreads[i] * iterations * 1000ULL) / fromVerifier));
+    }
+}
+
 int main(int argc, char** argv)
 {
     String toClient;
@@ -66,10 +154,23 @@ int main(int argc, char** argv)
     KeyBlob clientPMS;
     String user = "someuser";
     String pwd = "a-secret-password";
+    uint32_t benchIterations = 0;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
     printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
 
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-p", argv[i])) && ((i + 1) < argc)) {
+            benchIterations = StringToU32(argv[++i], 0, 0);
+        } else if (0 == strcmp("-p", argv[i])) {
+            benchIterations = 20;
+        } else {
+            printf("Usage: srp [-p [<handshakes>]]\n");
+            printf("   -p   = Measure SRP handshake throughput after running the tests\n");
+            return -1;
+        }
+    }
+
     /* Test vector as defined in RFC 5246 built in to Crypto_SRP class */
     {
         Crypto_SRP srp;
@@ -226,6 +327,10 @@ int main(int argc, char** argv)
         }
     }
 
+    if (benchIterations) {
+        Benchmark(benchIterations);
+    }
+
     printf("Passed\n");
     return 0;
 
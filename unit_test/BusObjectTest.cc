@@ -22,8 +22,10 @@
 #include <alljoyn/ProxyBusObject.h>
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/DBusStd.h>
+#include <alljoyn/AllJoynStd.h>
 #include <qcc/Debug.h>
 #include <qcc/Thread.h>
+#include "IntrospectionCache.h"
 
 using namespace ajn;
 using namespace qcc;
@@ -83,3 +85,47 @@ TEST_F(BusObjectTest, DISABLED_ObjectRegisteredUnregistered) {
     EXPECT_TRUE(testObj.wasRegistered);
     EXPECT_TRUE(testObj.wasUnregistered);
 }
+
+class CustomIntrospectBusObject : public BusObject {
+  public:
+    CustomIntrospectBusObject(const char* path) : BusObject(path) { }
+
+    static qcc::String CustomXml() {
+        return qcc::String(org::freedesktop::DBus::Introspectable::IntrospectDocType) + "<node>\n  <node name=\"custom\"/>\n</node>\n";
+    }
+
+    void Introspect(const InterfaceDescription::Member* member, Message& msg) {
+        MsgArg arg("s", CustomXml().c_str());
+        MethodReply(msg, &arg, 1);
+    }
+};
+
+TEST_F(BusObjectTest, IntrospectDigest_overridden_Introspect) {
+    CustomIntrospectBusObject testObj(OBJECT_PATH);
+
+    status = bus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = bus.Connect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = bus.RegisterBusObject(testObj);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject proxy(bus, bus.GetUniqueName().c_str(), OBJECT_PATH, 0);
+    const InterfaceDescription* digestIntf = bus.GetInterface(org::alljoyn::Bus::Introspectable::InterfaceName);
+    ASSERT_TRUE(digestIntf != NULL);
+    proxy.AddInterface(*digestIntf);
+    Message reply(bus);
+    status = proxy.MethodCall(*digestIntf->GetMember("IntrospectDigest"), NULL, 0, reply);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    /* The digest must be of the XML the object actually returns, not the default introspection */
+    uint8_t* digest;
+    size_t len;
+    status = reply->GetArg(0)->Get("ay", &len, &digest);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_TRUE(IntrospectionCache::Digest(CustomIntrospectBusObject::CustomXml()) == qcc::String((const char*)digest, len));
+
+    bus.UnregisterBusObject(testObj);
+    bus.Stop();
+    bus.Join();
+}
@@ -15,6 +15,7 @@
  ******************************************************************************/
 #include "ClientSetup.h"
 #include <qcc/Thread.h>
+#include <qcc/StringUtil.h>
 #include <gtest/gtest.h>
 
 namespace cl {
@@ -287,6 +288,67 @@ void ClientSetup::AsyncCallReplyHandler(Message& msg, void* context)
     g_Signal_flag++;
 }
 
+/*
+ * Function to make method calls in pipelined batches of batchSize calls
+ */
+QStatus ClientSetup::PipelinedMethodCall(int noOfCalls, int batchSize)
+{
+    QStatus status = ER_OK;
+
+    assert(clientMsgBus);
+    ProxyBusObject remoteObj(
+        *clientMsgBus,
+        ::cl::org::alljoyn::alljoyn_test::WellKnownName,
+        ::cl::org::alljoyn::alljoyn_test::ObjectPath,
+        0);
+
+    status = remoteObj.IntrospectRemoteObject();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Problem while introspecting remote object";
+    if (status != ER_OK) {
+        return status;
+    }
+    const InterfaceDescription* intf = remoteObj.GetInterface(::cl::org::alljoyn::alljoyn_test::InterfaceName);
+    assert(intf);
+
+    /* Each call carries its position in the batch so the handler can check the reply order */
+    std::vector<qcc::String> pings(batchSize);
+    std::vector<MsgArg> pingStr(batchSize);
+    std::vector<ProxyBusObject::PipelinedCall> calls(batchSize);
+    for (int j = 0; j < batchSize; j++) {
+        pings[j] = "Test Ping " + qcc::I32ToString(j);
+        pingStr[j].Set("s", pings[j].c_str());
+    }
+    for (int i = 0; i < noOfCalls; i += batchSize) {
+        int n = ((noOfCalls - i) < batchSize) ? (noOfCalls - i) : batchSize;
+        for (int j = 0; j < n; j++) {
+            calls[j].method = intf->GetMember("my_ping");
+            calls[j].args = &pingStr[j];
+            calls[j].numArgs = 1;
+        }
+        status = remoteObj.MethodCallPipelined(&calls[0], n, this,
+                                               static_cast<MessageReceiver::BatchReplyHandler>(&ClientSetup::PipelinedCallReplyHandler));
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Problem while calling remote method";
+        if (status != ER_OK) {
+            return status;
+        }
+    }
+    return status;
+}
+
+/*
+ * Function to handle the replies to a batch of pipelined method calls
+ */
+void ClientSetup::PipelinedCallReplyHandler(Message* replies, size_t numReplies, void* context)
+{
+    for (size_t i = 0; i < numReplies; ++i) {
+        const MsgArg* arg = replies[i]->GetArg(0);
+        if ((replies[i]->GetType() == MESSAGE_METHOD_RET) && arg &&
+            (qcc::String("Test Ping ") + qcc::I32ToString(i) == arg->v_string.str)) {
+            g_Signal_flag++;
+        }
+    }
+}
+
 /*
  * Function to test signals
  */
@@ -52,6 +52,8 @@ class ClientSetup : public MessageReceiver {
     QStatus MethodCall(int noOfCalls, int type);
     QStatus AsyncMethodCall(int noOfCalls, int type);
     void AsyncCallReplyHandler(Message& msg, void* context);
+    QStatus PipelinedMethodCall(int noOfCalls, int batchSize);
+    void PipelinedCallReplyHandler(Message* replies, size_t numReplies, void* context);
     QStatus SignalHandler(int noOfCalls, int type);
     void MySignalHandler(const InterfaceDescription::Member*member,
                          const char* sourcePath,
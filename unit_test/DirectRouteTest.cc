@@ -0,0 +1,191 @@
+/**
+ * @file
+ *
+ * This file tests the checks on messages received over a direct session channel
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+#include "ajTestCommon.h"
+
+#include <utility>
+#include <vector>
+
+#include <qcc/Mutex.h>
+#include <qcc/Socket.h>
+#include <qcc/String.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/InterfaceDescription.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MessageReceiver.h>
+
+#include "BusInternal.h"
+#include "ClientRouter.h"
+
+using namespace ajn;
+using namespace qcc;
+using namespace std;
+
+/*constants*/
+static const char* DIRECT_IFACE = "org.alljoyn.test.DirectRoute";
+static const char* DIRECT_PATH = "/org/alljoyn/test/DirectRoute";
+
+/* The name the daemon would have told us the peer has, deliberately not the peer's real name */
+static const char* PEER_ALIAS = ":DirectRouteTest.1";
+
+/* A name that is neither end of the channel */
+static const char* OTHER_NAME = ":DirectRouteTest.2";
+
+static const SessionId SESSION_A = 0x1001;
+static const SessionId SESSION_B = 0x1002;
+
+class DirectRouteSender : public BusObject {
+  public:
+    DirectRouteSender(const InterfaceDescription& iface) : BusObject(DIRECT_PATH), member(iface.GetMember("Ping"))
+    {
+        AddInterface(iface);
+    }
+
+    QStatus Send(const char* destination, SessionId sessionId, uint32_t value)
+    {
+        MsgArg arg("u", value);
+        return Signal(destination, sessionId, *member, &arg, 1);
+    }
+
+    const InterfaceDescription::Member* member;
+};
+
+class DirectRouteTest : public testing::Test, public MessageReceiver {
+  public:
+    DirectRouteTest() : bus("DirectRouteTest", false), peer("DirectRouteTestPeer", false), sender(NULL) { }
+
+    virtual void SetUp() {
+        BusAttachment* buses[] = { &bus, &peer };
+        for (size_t i = 0; i < ArraySize(buses); ++i) {
+            InterfaceDescription* iface = NULL;
+            status = buses[i]->CreateInterface(DIRECT_IFACE, iface);
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+            iface->AddSignal("Ping", "u", "value", 0);
+            iface->Activate();
+            status = buses[i]->Start();
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+            status = buses[i]->Connect(ajn::getConnectArg().c_str());
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        }
+        status = bus.RegisterSignalHandler(this, static_cast<MessageReceiver::SignalHandler>(&DirectRouteTest::Ping),
+                                           bus.GetInterface(DIRECT_IFACE)->GetMember("Ping"), NULL);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        sender = new DirectRouteSender(*peer.GetInterface(DIRECT_IFACE));
+        status = peer.RegisterBusObject(*sender);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+
+    virtual void TearDown() {
+        if (sender) {
+            peer.UnregisterBusObject(*sender);
+        }
+        peer.Stop();
+        peer.Join();
+        bus.Stop();
+        bus.Join();
+        delete sender;
+    }
+
+    /*
+     * Connect the two bus attachments with a channel, telling each end the session and peer name
+     * that the daemon would have given it.
+     */
+    void AddRoutes(SessionId busSession, const char* peerName, SessionId peerSession, const char* busName) {
+        SocketFd fds[2];
+        ASSERT_EQ(ER_OK, SocketPair(fds));
+        ASSERT_EQ(ER_OK, SetBlocking(fds[0], false));
+        ASSERT_EQ(ER_OK, SetBlocking(fds[1], false));
+        status = static_cast<ClientRouter&>(bus.GetInternal().GetRouter()).AddDirectRoute(busSession, peerName, fds[0]);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = static_cast<ClientRouter&>(peer.GetInternal().GetRouter()).AddDirectRoute(peerSession, busName, fds[1]);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+
+    void Ping(const InterfaceDescription::Member* member, const char* srcPath, Message& msg) {
+        lock.Lock(MUTEX_CONTEXT);
+        received.push_back(make_pair(msg->GetArg(0)->v_uint32, qcc::String(msg->GetSender())));
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    size_t WaitForSignals(size_t count, uint32_t timeout) {
+        size_t num = 0;
+        for (uint32_t waited = 0; waited <= timeout; waited += 10) {
+            lock.Lock(MUTEX_CONTEXT);
+            num = received.size();
+            lock.Unlock(MUTEX_CONTEXT);
+            if (num >= count) {
+                break;
+            }
+            qcc::Sleep(10);
+        }
+        return num;
+    }
+
+    QStatus status;
+    BusAttachment bus;
+    BusAttachment peer;
+    DirectRouteSender* sender;
+    qcc::Mutex lock;
+    vector<pair<uint32_t, qcc::String> > received;
+};
+
+TEST_F(DirectRouteTest, sender_is_rewritten) {
+    AddRoutes(SESSION_A, PEER_ALIAS, SESSION_A, bus.GetUniqueName().c_str());
+
+    status = sender->Send(bus.GetUniqueName().c_str(), SESSION_A, 1);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_EQ((size_t)1, WaitForSignals(1, 5000));
+
+    /* Whatever the peer wrote as the sender the message appears to come from the name the daemon gave us */
+    EXPECT_EQ((uint32_t)1, received[0].first);
+    EXPECT_STREQ(PEER_ALIAS, received[0].second.c_str());
+}
+
+TEST_F(DirectRouteTest, other_session_dropped) {
+    AddRoutes(SESSION_A, PEER_ALIAS, SESSION_B, bus.GetUniqueName().c_str());
+
+    /* The peer sends on the channel for a session the channel does not belong to */
+    status = sender->Send(bus.GetUniqueName().c_str(), SESSION_B, 1);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ((size_t)0, WaitForSignals(1, 500));
+}
+
+TEST_F(DirectRouteTest, other_destination_dropped) {
+    AddRoutes(SESSION_A, PEER_ALIAS, SESSION_A, OTHER_NAME);
+
+    /* Addressed to someone else so it must not be delivered here */
+    status = sender->Send(OTHER_NAME, SESSION_A, 1);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    /* A signal to the whole session is allowed, the channel delivers in order so the first was dropped */
+    status = sender->Send(NULL, SESSION_A, 2);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    ASSERT_EQ((size_t)1, WaitForSignals(1, 5000));
+    EXPECT_EQ((uint32_t)2, received[0].first);
+    EXPECT_STREQ(PEER_ALIAS, received[0].second.c_str());
+
+    EXPECT_EQ((size_t)1, WaitForSignals(2, 200));
+}
@@ -18,6 +18,7 @@
 
 #include <gtest/gtest.h>
 
+#include <qcc/StringUtil.h>
 #include <qcc/Thread.h>
 
 const char* SERVICE_OBJECT_PATH = "/org/alljoyn/test_services";
@@ -525,3 +526,45 @@ TEST_F(InterfaceTest, ArgNamesTest) {
     EXPECT_TRUE(member != NULL);
     EXPECT_STREQ(",arg1", member->argNames.c_str());
 }
+
+TEST_F(InterfaceTest, LookupAfterActivation) {
+    QStatus status = ER_OK;
+    InterfaceDescription* testIntf = NULL;
+    const uint32_t numMembers = 100;
+
+    status = g_msgBus->CreateInterface("org.alljoyn.test.lookup", testIntf);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    for (uint32_t i = 0; i < numMembers; ++i) {
+        qcc::String n = qcc::U32ToString(i);
+        EXPECT_EQ(ER_OK, testIntf->AddMethod(("Method" + n).c_str(), "u", "u", "in,out", 0));
+        EXPECT_EQ(ER_OK, testIntf->AddSignal(("Signal" + n).c_str(), "s", "value", 0));
+        EXPECT_EQ(ER_OK, testIntf->AddProperty(("Property" + n).c_str(), "u", PROP_ACCESS_RW));
+    }
+    testIntf->Activate();
+
+    /* Every member and property must be found by name once the interface is activated */
+    for (uint32_t i = 0; i < numMembers; ++i) {
+        qcc::String n = qcc::U32ToString(i);
+        const InterfaceDescription::Member* method = testIntf->GetMember(("Method" + n).c_str());
+        ASSERT_TRUE(method != NULL);
+        EXPECT_STREQ(("Method" + n).c_str(), method->name.c_str());
+        EXPECT_EQ(MESSAGE_METHOD_CALL, method->memberType);
+        EXPECT_EQ(testIntf, method->iface);
+        const InterfaceDescription::Member* signal = testIntf->GetSignal(("Signal" + n).c_str());
+        ASSERT_TRUE(signal != NULL);
+        EXPECT_STREQ(("Signal" + n).c_str(), signal->name.c_str());
+        const InterfaceDescription::Property* prop = testIntf->GetProperty(("Property" + n).c_str());
+        ASSERT_TRUE(prop != NULL);
+        EXPECT_STREQ(("Property" + n).c_str(), prop->name.c_str());
+    }
+    EXPECT_TRUE(testIntf->GetMember("Method") == NULL);
+    EXPECT_TRUE(testIntf->GetMember("Property0") == NULL);
+    EXPECT_TRUE(testIntf->GetProperty("Method0") == NULL);
+    EXPECT_TRUE(testIntf->GetProperty("") == NULL);
+
+    /* Copies of an activated interface must find their own members */
+    InterfaceDescription copy(*testIntf);
+    const InterfaceDescription::Member* member = copy.GetMember("Method42");
+    ASSERT_TRUE(member != NULL);
+    EXPECT_EQ(&copy, member->iface);
+}
@@ -48,6 +48,67 @@ using namespace ajn;
 
 static const char testData[] = "This is the message that we are going to encrypt and then decrypt and verify";
 
+/*
+ * Delete the files written by a key store initialized with the default file name
+ */
+static void DeleteKeyStoreFiles(const char* application)
+{
+    qcc::String fileName = GetHomeDir() + "/.alljoyn_keystore/" + application;
+    DeleteFile(fileName);
+    DeleteFile(fileName + ".journal");
+    DeleteFile(fileName + ".lock");
+}
+
+/*
+ * Name of the journal written by a key store initialized with the default file name
+ */
+static qcc::String JournalFileName(const char* application)
+{
+    return GetHomeDir() + "/.alljoyn_keystore/" + application + ".journal";
+}
+
+static qcc::String ReadFileContents(const qcc::String& fileName)
+{
+    qcc::String contents;
+    FileSource source(fileName);
+    char buf[256];
+    size_t pulled;
+    while ((source.PullBytes(buf, sizeof(buf), pulled) == ER_OK) && (pulled > 0)) {
+        contents.append(buf, pulled);
+    }
+    return contents;
+}
+
+static void WriteFileContents(const qcc::String& fileName, const qcc::String& contents)
+{
+    FileSink sink(fileName, FileSink::PRIVATE);
+    size_t pushed;
+    sink.PushBytes(contents.data(), contents.size(), pushed);
+}
+
+static bool SameKey(const KeyBlob& a, const KeyBlob& b)
+{
+    return (a.GetSize() == b.GetSize()) && (memcmp(a.GetData(), b.GetData(), a.GetSize()) == 0);
+}
+
+/*
+ * Start a non-shared key store with two keys in its journal and return the size of the journal
+ */
+static size_t InitJournalTest(const char* application, const qcc::GUID128& guid1, const qcc::GUID128& guid2)
+{
+    KeyStore keyStore(application);
+    keyStore.Init(NULL, false);
+    keyStore.Clear();
+
+    KeyBlob key;
+    key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+    keyStore.AddKey(guid1, key);
+    key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+    keyStore.AddKey(guid2, key);
+    keyStore.Store();
+    return ReadFileContents(JournalFileName(application)).size();
+}
+
 
 
 TEST(KeyStoreTest, basic_encryption_decryption) {
@@ -229,3 +290,236 @@ TEST(KeyStoreTest, keystore_store_load_merge) {
     DeleteFile("keystore_test");
 }
 
+
+TEST(KeyStoreTest, keystore_shared_reload) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key;
+
+    {
+        KeyStore keyStore1("keystore_shared_test");
+        keyStore1.Init(NULL, true);
+        keyStore1.Clear();
+
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore1.AddKey(guid1, key);
+        status = keyStore1.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        KeyStore keyStore2("keystore_shared_test");
+        keyStore2.Init(NULL, true);
+        ASSERT_TRUE(keyStore2.HasKey(guid1));
+
+        /*
+         * Keys added by one application are merged from the journal when the other reloads
+         */
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore1.AddKey(guid2, key);
+        status = keyStore1.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        ASSERT_FALSE(keyStore2.HasKey(guid2));
+        status = keyStore2.Reload();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to reload keystore";
+        ASSERT_TRUE(keyStore2.HasKey(guid2));
+
+        /*
+         * A deletion is merged without losing a key that has not been stored yet
+         */
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore2.AddKey(guid3, key);
+        keyStore1.DelKey(guid1);
+
+        status = keyStore2.Reload();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to reload keystore";
+        ASSERT_FALSE(keyStore2.HasKey(guid1));
+        ASSERT_TRUE(keyStore2.HasKey(guid3));
+
+        status = keyStore2.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        status = keyStore1.Reload();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to reload keystore";
+        ASSERT_FALSE(keyStore1.HasKey(guid1));
+        ASSERT_TRUE(keyStore1.HasKey(guid2));
+        ASSERT_TRUE(keyStore1.HasKey(guid3));
+
+        keyStore1.Clear();
+    }
+    DeleteKeyStoreFiles("keystore_shared_test");
+}
+
+TEST(KeyStoreTest, journal_replay) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key1;
+    KeyBlob key3;
+    KeyBlob key;
+
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+        keyStore.Clear();
+        size_t baseLen = ReadFileContents(JournalFileName("keystore_journal_test")).size();
+
+        key1.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid1, key1);
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid2, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        key3.Rand(620, KeyBlob::GENERIC);
+        keyStore.AddKey(guid3, key3);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+
+        /* Deleting a key stores straight away */
+        keyStore.DelKey(guid2);
+
+        /* The changes were appended to the journal rather than rewriting the key store */
+        ASSERT_FALSE(keyStore.NeedsCompaction());
+        ASSERT_LT(baseLen, ReadFileContents(JournalFileName("keystore_journal_test")).size());
+    }
+
+    {
+        KeyStore keyStore("keystore_journal_test");
+        status = keyStore.Init(NULL, false);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load keystore";
+
+        status = keyStore.GetKey(guid1, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid1";
+        ASSERT_TRUE(SameKey(key1, key));
+
+        status = keyStore.GetKey(guid2, key);
+        ASSERT_EQ(ER_BUS_KEY_UNAVAILABLE, status) << "  Actual Status: " << QCC_StatusText(status) << " guid2 was not deleted";
+
+        status = keyStore.GetKey(guid3, key);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load guid3";
+        ASSERT_TRUE(SameKey(key3, key));
+    }
+    DeleteKeyStoreFiles("keystore_journal_test");
+}
+
+TEST(KeyStoreTest, journal_torn_record) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    QStatus status = ER_OK;
+    KeyBlob key;
+
+    size_t goodLen = InitJournalTest("keystore_journal_test", guid1, guid2);
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid3, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+    }
+
+    /* Cut the last record short as if we had stopped while appending it */
+    qcc::String journal = ReadFileContents(JournalFileName("keystore_journal_test"));
+    ASSERT_LT(goodLen + 5, journal.size());
+    WriteFileContents(JournalFileName("keystore_journal_test"), journal.substr(0, journal.size() - 5));
+
+    {
+        KeyStore keyStore("keystore_journal_test");
+        status = keyStore.Init(NULL, false);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load keystore";
+        ASSERT_TRUE(keyStore.HasKey(guid1));
+        ASSERT_TRUE(keyStore.HasKey(guid2));
+        ASSERT_FALSE(keyStore.HasKey(guid3));
+        /* The damaged journal is rewritten with the next store */
+        ASSERT_TRUE(keyStore.NeedsCompaction());
+    }
+    DeleteKeyStoreFiles("keystore_journal_test");
+}
+
+TEST(KeyStoreTest, journal_tampered_record) {
+    qcc::GUID128 guid1;
+    qcc::GUID128 guid2;
+    qcc::GUID128 guid3;
+    qcc::GUID128 guid4;
+    QStatus status = ER_OK;
+    KeyBlob key;
+
+    size_t goodLen = InitJournalTest("keystore_journal_test", guid1, guid2);
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid3, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+        key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+        keyStore.AddKey(guid4, key);
+        status = keyStore.Store();
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+    }
+
+    /*
+     * Change the GUID in the header of the record for guid3. The header is not encrypted but it
+     * is authenticated so the record must be rejected.
+     */
+    qcc::String journal = ReadFileContents(JournalFileName("keystore_journal_test"));
+    ASSERT_LT(goodLen + 6, journal.size());
+    journal[goodLen + 5] ^= 0x01;
+    WriteFileContents(JournalFileName("keystore_journal_test"), journal);
+
+    {
+        KeyStore keyStore("keystore_journal_test");
+        status = keyStore.Init(NULL, false);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load keystore";
+        ASSERT_TRUE(keyStore.HasKey(guid1));
+        ASSERT_TRUE(keyStore.HasKey(guid2));
+        ASSERT_FALSE(keyStore.HasKey(guid3));
+        /* Nothing after the bad record is trusted either */
+        ASSERT_FALSE(keyStore.HasKey(guid4));
+        ASSERT_TRUE(keyStore.NeedsCompaction());
+    }
+    DeleteKeyStoreFiles("keystore_journal_test");
+}
+
+TEST(KeyStoreTest, journal_compaction) {
+    static const size_t numKeys = 80;
+    qcc::GUID128 guids[numKeys];
+    QStatus status = ER_OK;
+    KeyBlob key;
+    bool compacted = false;
+
+    {
+        KeyStore keyStore("keystore_journal_test");
+        keyStore.Init(NULL, false);
+        keyStore.Clear();
+
+        /* Store the keys one at a time until the journal grows enough to be compacted */
+        size_t journalLen = ReadFileContents(JournalFileName("keystore_journal_test")).size();
+        for (size_t i = 0; i < numKeys; ++i) {
+            key.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+            keyStore.AddKey(guids[i], key);
+            status = keyStore.Store();
+            ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to store keystore";
+            size_t len = ReadFileContents(JournalFileName("keystore_journal_test")).size();
+            if (len < journalLen) {
+                compacted = true;
+            }
+            journalLen = len;
+        }
+    }
+    ASSERT_TRUE(compacted);
+
+    {
+        KeyStore keyStore("keystore_journal_test");
+        status = keyStore.Init(NULL, false);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status) << " Failed to load keystore";
+        for (size_t i = 0; i < numKeys; ++i) {
+            ASSERT_TRUE(keyStore.HasKey(guids[i])) << " Key " << i << " was lost";
+        }
+    }
+    DeleteKeyStoreFiles("keystore_journal_test");
+}
@@ -0,0 +1,181 @@
+/**
+ * @file
+ *
+ * This file tests method table lookups and times method call dispatch lookups
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/InterfaceDescription.h>
+#include "MethodTable.h"
+
+#include <alljoyn/Status.h>
+
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static const size_t NumObjects = 64;
+static const size_t NumInterfaces = 4;
+static const size_t NumMethods = 16;
+
+class MethodTableTestObject : public BusObject {
+  public:
+    MethodTableTestObject(const char* path, std::vector<const InterfaceDescription*>& ifaces) : BusObject(path)
+    {
+        for (size_t i = 0; i < ifaces.size(); ++i) {
+            AddInterface(*ifaces[i]);
+            for (size_t m = 0; m < NumMethods; ++m) {
+                qcc::String name = "Method" + U32ToString(m);
+                AddMethodHandler(ifaces[i]->GetMember(name.c_str()), static_cast<MessageReceiver::MethodHandler>(&MethodTableTestObject::Handler));
+            }
+        }
+    }
+
+    void Handler(const InterfaceDescription::Member* member, Message& msg) { }
+};
+
+class MethodTableTest : public testing::Test {
+  public:
+    MethodTableTest() : bus("MethodTableTest", false) { }
+
+    virtual void SetUp()
+    {
+        for (size_t i = 0; i < NumInterfaces; ++i) {
+            InterfaceDescription* iface = NULL;
+            qcc::String name = "org.alljoyn.test.MethodTable" + U32ToString(i);
+            ASSERT_EQ(ER_OK, bus.CreateInterface(name.c_str(), iface));
+            for (size_t m = 0; m < NumMethods; ++m) {
+                iface->AddMethod(("Method" + U32ToString(m)).c_str(), "s", "s", "in,out");
+            }
+            iface->Activate();
+            ifaces.push_back(iface);
+            ifaceNames.push_back(name);
+        }
+        for (size_t i = 0; i < NumObjects; ++i) {
+            paths.push_back("/org/alljoyn/test/MethodTable/Object" + U32ToString(i));
+        }
+        for (size_t i = 0; i < NumObjects; ++i) {
+            objects.push_back(new MethodTableTestObject(paths[i].c_str(), ifaces));
+        }
+        for (size_t m = 0; m < NumMethods; ++m) {
+            methodNames.push_back("Method" + U32ToString(m));
+        }
+    }
+
+    virtual void TearDown()
+    {
+        for (size_t i = 0; i < objects.size(); ++i) {
+            delete objects[i];
+        }
+    }
+
+    BusAttachment bus;
+    std::vector<const InterfaceDescription*> ifaces;
+    std::vector<qcc::String> ifaceNames;
+    std::vector<qcc::String> paths;
+    std::vector<qcc::String> methodNames;
+    std::vector<MethodTableTestObject*> objects;
+};
+
+TEST_F(MethodTableTest, Find) {
+    MethodTable table;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        table.AddAll(objects[i]);
+    }
+
+    MethodTable::SafeEntry* safeEntry = table.Find(paths[3].c_str(), ifaceNames[2].c_str(), "Method5");
+    ASSERT_TRUE(safeEntry != NULL);
+    EXPECT_EQ(objects[3], safeEntry->entry->object);
+    EXPECT_STREQ(ifaceNames[2].c_str(), safeEntry->entry->member->iface->GetName());
+    EXPECT_STREQ("Method5", safeEntry->entry->member->name.c_str());
+    delete safeEntry;
+
+    /* Method calls don't require an interface */
+    safeEntry = table.Find(paths[7].c_str(), "", "Method9");
+    ASSERT_TRUE(safeEntry != NULL);
+    EXPECT_EQ(objects[7], safeEntry->entry->object);
+    EXPECT_STREQ("Method9", safeEntry->entry->member->name.c_str());
+    delete safeEntry;
+
+    EXPECT_TRUE(table.Find("/org/alljoyn/test/MethodTable/NoSuchObject", ifaceNames[0].c_str(), "Method0") == NULL);
+    EXPECT_TRUE(table.Find(paths[0].c_str(), "org.alljoyn.test.NoSuchInterface", "Method0") == NULL);
+    EXPECT_TRUE(table.Find(paths[0].c_str(), ifaceNames[0].c_str(), "NoSuchMethod") == NULL);
+
+    table.RemoveAll(objects[3]);
+    EXPECT_TRUE(table.Find(paths[3].c_str(), ifaceNames[2].c_str(), "Method5") == NULL);
+    safeEntry = table.Find(paths[4].c_str(), ifaceNames[2].c_str(), "Method5");
+    ASSERT_TRUE(safeEntry != NULL);
+    EXPECT_EQ(objects[4], safeEntry->entry->object);
+    delete safeEntry;
+}
+
+TEST_F(MethodTableTest, ReRegister) {
+    MethodTable table;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        table.AddAll(objects[i]);
+    }
+
+    /* Unregistering and registering one object must leave the others untouched */
+    table.RemoveAll(objects[5]);
+    EXPECT_TRUE(table.Find(paths[5].c_str(), ifaceNames[1].c_str(), "Method2") == NULL);
+    table.AddAll(objects[5]);
+    for (size_t i = 0; i < objects.size(); ++i) {
+        MethodTable::SafeEntry* safeEntry = table.Find(paths[i].c_str(), ifaceNames[1].c_str(), "Method2");
+        ASSERT_TRUE(safeEntry != NULL);
+        EXPECT_EQ(objects[i], safeEntry->entry->object);
+        delete safeEntry;
+    }
+}
+
+TEST_F(MethodTableTest, DispatchLookupTime) {
+    const size_t lookups = 1000000;
+    MethodTable table;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        table.AddAll(objects[i]);
+    }
+
+    size_t found = 0;
+    uint64_t start = GetTimestamp64();
+    for (size_t i = 0; i < lookups; ++i) {
+        MethodTable::SafeEntry* safeEntry = table.Find(paths[i % NumObjects].c_str(),
+                                                       ifaceNames[i % NumInterfaces].c_str(),
+                                                       methodNames[i % NumMethods].c_str());
+        if (safeEntry) {
+            ++found;
+            delete safeEntry;
+        }
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    EXPECT_EQ(lookups, found);
+    printf("%u lookups over %u methods in %llu ms (%.1f ns per lookup)\n", (unsigned int)lookups,
+           (unsigned int)(NumObjects * NumInterfaces * NumMethods), (unsigned long long)elapsed,
+           (double)elapsed * 1000000.0 / lookups);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file
+ *
+ * This file tests the peer state table
+ */
+
+/******************************************************************************
+ *
+ *
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <qcc/KeyBlob.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+
+#include "PeerState.h"
+
+#include <alljoyn/Status.h>
+
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+TEST(PeerStateTest, find_does_not_insert) {
+    PeerStateTable table;
+    PeerState peerState;
+
+    EXPECT_FALSE(table.FindPeerState(":1.1", peerState));
+    EXPECT_FALSE(table.IsKnownPeer(":1.1"));
+
+    PeerState created = table.GetPeerState(":1.1");
+    EXPECT_TRUE(table.FindPeerState(":1.1", peerState));
+    EXPECT_TRUE(peerState.iden(created));
+
+    /* The group key peer is always present */
+    EXPECT_TRUE(table.IsKnownPeer(""));
+}
+
+TEST(PeerStateTest, alias) {
+    PeerStateTable table;
+
+    PeerState unique = table.GetPeerState(":1.2");
+    PeerState linked = table.GetPeerState(":1.2", "org.alljoyn.test");
+    EXPECT_TRUE(unique.iden(linked));
+    EXPECT_TRUE(table.IsAlias(":1.2", "org.alljoyn.test"));
+    EXPECT_FALSE(table.IsAlias(":1.2", ":1.3"));
+    EXPECT_FALSE(table.IsKnownPeer(":1.3"));
+}
+
+TEST(PeerStateTest, cached_lookup) {
+    PeerStateTable table;
+    PeerStateCache cache;
+
+    PeerState first = table.GetPeerState(":1.4", cache);
+    EXPECT_TRUE(first.iden(table.GetPeerState(":1.4", cache)));
+    EXPECT_TRUE(first.iden(table.GetPeerState(":1.4")));
+
+    /* Deleting the peer must invalidate the cached entry */
+    table.DelPeerState(":1.4");
+    PeerState second = table.GetPeerState(":1.4", cache);
+    EXPECT_FALSE(first.iden(second));
+
+    /* So must clearing the table */
+    table.Clear();
+    EXPECT_FALSE(second.iden(table.GetPeerState(":1.4", cache)));
+}
+
+TEST(PeerStateTest, many_peers) {
+    PeerStateTable table;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        table.GetPeerState(qcc::String(":1.") + U32ToString(i));
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(table.IsKnownPeer(qcc::String(":1.") + U32ToString(i)));
+    }
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        table.DelPeerState(qcc::String(":1.") + U32ToString(i));
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ((i & 1) != 0, table.IsKnownPeer(qcc::String(":1.") + U32ToString(i)));
+    }
+}
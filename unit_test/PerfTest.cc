@@ -436,6 +436,36 @@ TEST_F(PerfTest, AsyncMethodCallTest_SimpleCall) {
 
 }
 
+/* Compare sequential synchronous method calls with pipelined batches */
+TEST_F(PerfTest, PipelinedMethodCallTest_Throughput) {
+    ClientSetup testclient(ajn::getConnectArg().c_str());
+    const int noOfCalls = 2000;
+    const int batchSizes[] = { 1, 16, 64 };
+
+    uint64_t start = qcc::GetTimestamp64();
+    QStatus status = testclient.MethodCall(noOfCalls, 1);
+    uint64_t syncTime = qcc::GetTimestamp64() - start;
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    printf("%-16s %8d calls %8llu ms\n", "sync", noOfCalls, (unsigned long long)syncTime);
+
+    for (size_t b = 0; b < ArraySize(batchSizes); ++b) {
+        testclient.setSignalFlag(0);
+        start = qcc::GetTimestamp64();
+        status = testclient.PipelinedMethodCall(noOfCalls, batchSizes[b]);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        //Wait upto 10 seconds for all of the replies to arrive in order
+        for (int i = 0; i < 10000; ++i) {
+            if (testclient.getSignalFlag() == noOfCalls) {
+                break;
+            }
+            qcc::Sleep(1);
+        }
+        uint64_t pipelinedTime = qcc::GetTimestamp64() - start;
+        EXPECT_EQ(noOfCalls, testclient.getSignalFlag());
+        printf("pipelined x%-6d %8d calls %8llu ms\n", batchSizes[b], noOfCalls, (unsigned long long)pipelinedTime);
+    }
+}
+
 TEST_F(PerfTest, BusObject_ALLJOYN_328_BusObject_destruction)
 {
     ClientSetup testclient(ajn::getConnectArg().c_str());
@@ -21,7 +21,13 @@
 #include <alljoyn/ProxyBusObject.h>
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/DBusStd.h>
+#include <qcc/Mutex.h>
 #include <qcc/Thread.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+
+#include <stdio.h>
 
 using namespace ajn;
 using namespace qcc;
@@ -216,6 +222,65 @@ TEST_F(ProxyBusObjectTest, ParseXml) {
     EXPECT_STREQ(expectedIntrospect, introspect.c_str());
 }
 
+TEST_F(ProxyBusObjectTest, ParseXml_children) {
+    const char* busObjectXML =
+        "<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\"\n"
+        "\"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"
+        "<node name=\"/org/alljoyn/test/ProxyObjectTest\">\n"
+        "  <!-- interfaces and children are added as they are scanned -->\n"
+        "  <interface name=\"org.alljoyn.test.ProxyBusObjectTest.Children\">\n"
+        "    <method name=\"ping\">\n"
+        "      <arg name=\"in\" type=\"s\" direction=\"in\"/>\n"
+        "      <arg name=\"out\" type=\"s\" direction=\"out\"/>\n"
+        "      <annotation name=\"org.alljoyn.test.Note\" value=\"&lt;a &amp; b&gt;\"/>\n"
+        "    </method>\n"
+        "    <property name=\"size\" type=\"u\" access=\"read\"/>\n"
+        "  </interface>\n"
+        "  <node name=\"ChildOne\"/>\n"
+        "  <node name=\"ChildTwo\">\n"
+        "    <node name=\"GrandChild\"></node>\n"
+        "  </node>\n"
+        "</node>\n";
+    QStatus status;
+
+    ProxyBusObject proxyObj(bus, NULL, OBJECT_PATH, 0);
+    status = proxyObj.ParseXml(busObjectXML, NULL);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    const InterfaceDescription* testIntf = proxyObj.GetInterface("org.alljoyn.test.ProxyBusObjectTest.Children");
+    ASSERT_TRUE(testIntf != NULL);
+    const InterfaceDescription::Member* ping = testIntf->GetMember("ping");
+    ASSERT_TRUE(ping != NULL);
+    EXPECT_STREQ("s", ping->signature.c_str());
+    EXPECT_STREQ("s", ping->returnSignature.c_str());
+    qcc::String note;
+    EXPECT_TRUE(ping->GetAnnotation("org.alljoyn.test.Note", note));
+    EXPECT_STREQ("<a & b>", note.c_str());
+    EXPECT_TRUE(testIntf->HasProperty("size"));
+
+    EXPECT_TRUE(proxyObj.GetChild("ChildOne") != NULL);
+    EXPECT_TRUE(proxyObj.GetChild("ChildTwo") != NULL);
+    EXPECT_TRUE(proxyObj.GetChild("ChildTwo/GrandChild") != NULL);
+}
+
+TEST_F(ProxyBusObjectTest, ParseXml_malformed) {
+    const char* malformedXML[] = {
+        "",
+        "<node>",
+        "<node></interface>",
+        "<node><interface name=\"org.alljoyn.test.Bad\"></node></interface>",
+        "<node name=\"/a></node>",
+        "<node></node><node></node>",
+        "<node><node name=\"child\"></node>",
+    };
+    for (size_t i = 0; i < ArraySize(malformedXML); ++i) {
+        ProxyBusObject proxyObj(bus, NULL, OBJECT_PATH, 0);
+        QStatus status = proxyObj.ParseXml(malformedXML[i], NULL);
+        EXPECT_EQ(ER_BUS_BAD_XML, status) << "  Actual Status: " << QCC_StatusText(status) << " for \"" << malformedXML[i] << "\"";
+    }
+}
+
 bool auth_complete_listener1_flag;
 bool auth_complete_listener2_flag;
 class ProxyBusObjectTestAuthListenerOne : public AuthListener {
@@ -440,3 +505,338 @@ TEST_F(ProxyBusObjectTest, AddChild_regressionTest) {
     //if ALLJOYN-1908 were not fixed this would return 1
     EXPECT_EQ((size_t)2, numChildren);
 }
+
+static const char* CACHE_INTERFACE_NAME = "org.alljoyn.test.ProxyBusObjectTest.Cache";
+static const char* CACHE_OBJECT_PATH = "/org/alljoyn/test/ProxyObjectTest/Cache";
+static const uint32_t CACHE_NUM_UPDATES = 500;
+
+static void CreateCacheInterface(BusAttachment& bus)
+{
+    InterfaceDescription* testIntf = NULL;
+    QStatus status = bus.CreateInterface(CACHE_INTERFACE_NAME, testIntf, false);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = testIntf->AddProperty("counter", "u", PROP_ACCESS_READ);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = testIntf->AddPropertyAnnotation("counter", org::freedesktop::DBus::AnnotateEmitsChanged, "true");
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = testIntf->AddProperty("uncached", "u", PROP_ACCESS_READ);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    testIntf->Activate();
+}
+
+class ProxyBusObjectCacheTestObject : public BusObject {
+  public:
+    ProxyBusObjectCacheTestObject(BusAttachment& bus) : BusObject(CACHE_OBJECT_PATH), counter(0), getCount(0)
+    {
+        AddInterface(*bus.GetInterface(CACHE_INTERFACE_NAME));
+    }
+
+    QStatus Get(const char* ifcName, const char* propName, MsgArg& val)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        ++getCount;
+        QStatus status = ER_OK;
+        if (strcmp(propName, "counter") == 0) {
+            val.Set("u", counter);
+        } else if (strcmp(propName, "uncached") == 0) {
+            val.Set("u", getCount);
+        } else {
+            status = ER_BUS_NO_SUCH_PROPERTY;
+        }
+        lock.Unlock(MUTEX_CONTEXT);
+        return status;
+    }
+
+    void SetCounter(uint32_t value)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        counter = value;
+        lock.Unlock(MUTEX_CONTEXT);
+        MsgArg val("u", value);
+        EmitPropChanged(CACHE_INTERFACE_NAME, "counter", val, 0);
+    }
+
+    qcc::Mutex lock;
+    uint32_t counter;
+    uint32_t getCount;
+};
+
+class ProxyBusObjectCacheUpdater : public Thread {
+  public:
+    ProxyBusObjectCacheUpdater(ProxyBusObjectCacheTestObject& obj) : Thread("ProxyBusObjectCacheUpdater"), obj(obj) { }
+
+  protected:
+    qcc::ThreadReturn STDCALL Run(void* arg)
+    {
+        for (uint32_t i = 1; i <= CACHE_NUM_UPDATES; ++i) {
+            obj.SetCounter(i);
+        }
+        return 0;
+    }
+
+  private:
+    ProxyBusObjectCacheTestObject& obj;
+};
+
+/*
+ * Reads of a cached property must be answered locally and must converge on the value the remote
+ * object has after it stops changing, even while PropertiesChanged signals race with the reads.
+ */
+TEST_F(ProxyBusObjectTest, PropertyCache) {
+    status = servicebus.Start();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    CreateCacheInterface(servicebus);
+    CreateCacheInterface(bus);
+    ProxyBusObjectCacheTestObject testObj(servicebus);
+    status = servicebus.RegisterBusObject(testObj);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject proxy(bus, servicebus.GetUniqueName().c_str(), CACHE_OBJECT_PATH, 0);
+    status = proxy.AddInterface(CACHE_INTERFACE_NAME);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.EnablePropertyCaching(CACHE_INTERFACE_NAME);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    /* The initial GetAll populated the cache so this read is local */
+    MsgArg val;
+    uint32_t hits;
+    uint32_t misses;
+    status = proxy.GetProperty(CACHE_INTERFACE_NAME, "counter", val);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ((uint32_t)0, val.v_variant.val->v_uint32);
+    proxy.GetPropertyCacheStats(hits, misses);
+    EXPECT_EQ((uint32_t)1, hits);
+
+    /* Properties without the EmitsChangedSignal annotation always go to the remote object */
+    uint32_t getCount = testObj.getCount;
+    status = proxy.GetProperty(CACHE_INTERFACE_NAME, "uncached", val);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.GetProperty(CACHE_INTERFACE_NAME, "uncached", val);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(getCount + 2, testObj.getCount);
+
+    /* Read concurrently with the updates */
+    ProxyBusObjectCacheUpdater updater(testObj);
+    updater.Start();
+    uint32_t last = 0;
+    for (uint32_t msecs = 0; msecs < 5000; msecs += 1) {
+        status = proxy.GetProperty(CACHE_INTERFACE_NAME, "counter", val);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        last = val.v_variant.val->v_uint32;
+        EXPECT_LE(last, CACHE_NUM_UPDATES);
+        if (!updater.IsRunning() && (last == CACHE_NUM_UPDATES)) {
+            break;
+        }
+        qcc::Sleep(1);
+    }
+    updater.Join();
+    EXPECT_EQ(CACHE_NUM_UPDATES, last);
+
+    /* Almost all of the reads were answered locally */
+    proxy.GetPropertyCacheStats(hits, misses);
+    EXPECT_LT(misses, hits);
+
+    proxy.DisablePropertyCaching();
+    proxy.GetPropertyCacheStats(hits, misses);
+    EXPECT_EQ((uint32_t)0, hits);
+    EXPECT_EQ((uint32_t)0, misses);
+
+    servicebus.UnregisterBusObject(testObj);
+    servicebus.Stop();
+    servicebus.Join();
+}
+
+/*
+ * Cached values must not be returned once the bus attachment that owned the service name when caching
+ * was enabled has given the name up.
+ */
+TEST_F(ProxyBusObjectTest, PropertyCacheOwnerChange) {
+    static const char* wellKnownName = "org.alljoyn.test.ProxyBusObjectTest.CacheOwner";
+    status = servicebus.Start();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    CreateCacheInterface(servicebus);
+    CreateCacheInterface(bus);
+    ProxyBusObjectCacheTestObject testObj(servicebus);
+    status = servicebus.RegisterBusObject(testObj);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RequestName(wellKnownName, DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject proxy(bus, wellKnownName, CACHE_OBJECT_PATH, 0);
+    status = proxy.AddInterface(CACHE_INTERFACE_NAME);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.EnablePropertyCaching(CACHE_INTERFACE_NAME);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    MsgArg val;
+    uint32_t hits;
+    uint32_t misses;
+    status = proxy.GetProperty(CACHE_INTERFACE_NAME, "counter", val);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    proxy.GetPropertyCacheStats(hits, misses);
+    EXPECT_EQ((uint32_t)1, hits);
+
+    /* Once the name has no owner reads go to the remote object and fail */
+    status = servicebus.ReleaseName(wellKnownName);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    for (uint32_t msecs = 0; msecs < 2000; msecs += 10) {
+        status = proxy.GetProperty(CACHE_INTERFACE_NAME, "counter", val);
+        if (status != ER_OK) {
+            break;
+        }
+        qcc::Sleep(10);
+    }
+    EXPECT_NE(ER_OK, status);
+
+    proxy.DisablePropertyCaching();
+    servicebus.UnregisterBusObject(testObj);
+    servicebus.Stop();
+    servicebus.Join();
+}
+
+static const char* BATCH_INTERFACE_NAME = "org.alljoyn.test.ProxyBusObjectTest.Batch";
+static const char* BATCH_OBJECT_PATH = "/org/alljoyn/test/ProxyObjectTest/Batch";
+static const uint32_t BATCH_NUM_OBJECTS = 200;
+
+static void CreateBatchInterface(BusAttachment& bus)
+{
+    InterfaceDescription* testIntf = NULL;
+    QStatus status = bus.CreateInterface(BATCH_INTERFACE_NAME, testIntf, false);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = testIntf->AddProperty("value", "u", PROP_ACCESS_RW);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = testIntf->AddProperty("index", "u", PROP_ACCESS_READ);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    testIntf->Activate();
+}
+
+class ProxyBusObjectBatchTestObject : public BusObject {
+  public:
+    ProxyBusObjectBatchTestObject(BusAttachment& bus, const qcc::String& path, uint32_t index) :
+        BusObject(path.c_str()), index(index), value(index * 10)
+    {
+        AddInterface(*bus.GetInterface(BATCH_INTERFACE_NAME));
+    }
+
+    QStatus Get(const char* ifcName, const char* propName, MsgArg& val)
+    {
+        if (strcmp(propName, "value") == 0) {
+            return val.Set("u", value);
+        } else if (strcmp(propName, "index") == 0) {
+            return val.Set("u", index);
+        }
+        return ER_BUS_NO_SUCH_PROPERTY;
+    }
+
+    QStatus Set(const char* ifcName, const char* propName, MsgArg& val)
+    {
+        if (strcmp(propName, "value") == 0) {
+            return val.Get("u", &value);
+        }
+        return ER_BUS_NO_SUCH_PROPERTY;
+    }
+
+    uint32_t index;
+    uint32_t value;
+};
+
+/*
+ * Reading two properties from each of many objects in a batch must return the same values as
+ * reading them one at a time, report per-property errors, and take far fewer round trips.
+ */
+TEST_F(ProxyBusObjectTest, BatchProperties) {
+    status = servicebus.Start();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    CreateBatchInterface(servicebus);
+    CreateBatchInterface(bus);
+
+    ProxyBusObjectBatchTestObject* objects[BATCH_NUM_OBJECTS];
+    ProxyBusObject* proxies[BATCH_NUM_OBJECTS];
+    qcc::String paths[BATCH_NUM_OBJECTS];
+    for (uint32_t i = 0; i < BATCH_NUM_OBJECTS; ++i) {
+        paths[i] = qcc::String(BATCH_OBJECT_PATH) + "/o" + qcc::U32ToString(i);
+        objects[i] = new ProxyBusObjectBatchTestObject(servicebus, paths[i], i);
+        status = servicebus.RegisterBusObject(*objects[i]);
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        proxies[i] = new ProxyBusObject(bus, servicebus.GetUniqueName().c_str(), paths[i].c_str(), 0);
+        proxies[i]->AddInterface(BATCH_INTERFACE_NAME);
+    }
+
+    /* One property at a time */
+    MsgArg val;
+    uint64_t start = qcc::GetTimestamp64();
+    for (uint32_t i = 0; i < BATCH_NUM_OBJECTS; ++i) {
+        uint32_t u;
+        status = proxies[i]->GetProperty(BATCH_INTERFACE_NAME, "value", val);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        EXPECT_EQ(ER_OK, val.Get("u", &u));
+        EXPECT_EQ(i * 10, u);
+        status = proxies[i]->GetProperty(BATCH_INTERFACE_NAME, "index", val);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        EXPECT_EQ(ER_OK, val.Get("u", &u));
+        EXPECT_EQ(i, u);
+    }
+    uint64_t single = qcc::GetTimestamp64() - start;
+
+    /* The same properties in one batch through any one of the proxies */
+    ProxyBusObject::BatchProperty* props = new ProxyBusObject::BatchProperty[2 * BATCH_NUM_OBJECTS];
+    for (uint32_t i = 0; i < BATCH_NUM_OBJECTS; ++i) {
+        props[2 * i].path = paths[i].c_str();
+        props[2 * i].iface = BATCH_INTERFACE_NAME;
+        props[2 * i].property = "value";
+        props[2 * i + 1].path = paths[i].c_str();
+        props[2 * i + 1].iface = BATCH_INTERFACE_NAME;
+        props[2 * i + 1].property = "index";
+    }
+    start = qcc::GetTimestamp64();
+    status = proxies[0]->GetProperties(props, 2 * BATCH_NUM_OBJECTS);
+    uint64_t batched = qcc::GetTimestamp64() - start;
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    for (uint32_t i = 0; i < BATCH_NUM_OBJECTS; ++i) {
+        uint32_t u;
+        EXPECT_EQ(ER_OK, props[2 * i].status) << "  Actual Status: " << QCC_StatusText(props[2 * i].status);
+        EXPECT_EQ(ER_OK, props[2 * i].value.Get("u", &u));
+        EXPECT_EQ(i * 10, u);
+        EXPECT_EQ(ER_OK, props[2 * i + 1].status) << "  Actual Status: " << QCC_StatusText(props[2 * i + 1].status);
+        EXPECT_EQ(ER_OK, props[2 * i + 1].value.Get("u", &u));
+        EXPECT_EQ(i, u);
+    }
+    printf("Read %u properties: %llu ms one at a time, %llu ms batched\n", 2 * BATCH_NUM_OBJECTS,
+           (unsigned long long)single, (unsigned long long)batched);
+    delete [] props;
+
+    /* Writes are batched the same way and each property reports its own result */
+    ProxyBusObject::BatchProperty writes[3];
+    writes[0].path = paths[1].c_str();
+    writes[0].iface = BATCH_INTERFACE_NAME;
+    writes[0].property = "value";
+    writes[0].value.Set("u", 1234);
+    writes[1].path = paths[2].c_str();
+    writes[1].iface = BATCH_INTERFACE_NAME;
+    writes[1].property = "index";
+    writes[1].value.Set("u", 1);
+    writes[2].path = "/org/alljoyn/test/ProxyObjectTest/Batch/none";
+    writes[2].iface = BATCH_INTERFACE_NAME;
+    writes[2].property = "value";
+    writes[2].value.Set("u", 1);
+    status = proxies[0]->SetProperties(writes, ArraySize(writes));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(ER_OK, writes[0].status) << "  Actual Status: " << QCC_StatusText(writes[0].status);
+    EXPECT_EQ(ER_BUS_PROPERTY_ACCESS_DENIED, writes[1].status) << "  Actual Status: " << QCC_StatusText(writes[1].status);
+    EXPECT_EQ(ER_BUS_NO_SUCH_OBJECT, writes[2].status) << "  Actual Status: " << QCC_StatusText(writes[2].status);
+    EXPECT_EQ((uint32_t)1234, objects[1]->value);
+
+    for (uint32_t i = 0; i < BATCH_NUM_OBJECTS; ++i) {
+        delete proxies[i];
+        servicebus.UnregisterBusObject(*objects[i]);
+        delete objects[i];
+    }
+    servicebus.Stop();
+    servicebus.Join();
+}
@@ -0,0 +1,183 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+#include "ajTestCommon.h"
+#include <alljoyn/Message.h>
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusObject.h>
+#include <alljoyn/ProxyBusObject.h>
+#include <alljoyn/InterfaceDescription.h>
+#include <alljoyn/DBusStd.h>
+#include <qcc/Thread.h>
+
+using namespace ajn;
+using namespace qcc;
+
+/*constants*/
+static const char* INTERFACE_NAME = "org.alljoyn.test.SecureSignalTest";
+static const char* OBJECT_NAME =    "org.alljoyn.test.SecureSignalTest";
+static const char* OBJECT_PATH =   "/org/alljoyn/test/SecureSignalTest";
+static const uint32_t NUM_RECEIVERS = 3;
+static const uint32_t NUM_SIGNALS = 50;
+
+class SecureSignalTestAuthListener : public AuthListener {
+
+    QStatus RequestCredentialsAsync(const char* authMechanism, const char* authPeer, uint16_t authCount, const char* userId, uint16_t credMask, void* context)
+    {
+        Credentials creds;
+        creds.SetPassword("123456");
+        return RequestCredentialsResponse(context, true, creds);
+    }
+
+    void AuthenticationComplete(const char* authMechanism, const char* authPeer, bool success) {
+        EXPECT_STREQ("ALLJOYN_SRP_KEYX", authMechanism);
+        EXPECT_TRUE(success);
+    }
+};
+
+class SecureSignalTestBusObject : public BusObject {
+  public:
+    SecureSignalTestBusObject(BusAttachment& bus) : BusObject(OBJECT_PATH), tick(NULL)
+    {
+        const InterfaceDescription* intf = bus.GetInterface(INTERFACE_NAME);
+        EXPECT_TRUE(intf != NULL);
+        if (intf) {
+            AddInterface(*intf);
+            tick = intf->GetMember("tick");
+        }
+    }
+
+    QStatus SendTick(uint32_t seq)
+    {
+        MsgArg arg("u", seq);
+        return Signal(NULL, 0, *tick, &arg, 1);
+    }
+
+  private:
+    const InterfaceDescription::Member* tick;
+};
+
+class SecureSignalTestReceiver : public MessageReceiver {
+  public:
+    SecureSignalTestReceiver() : count(0), inOrder(true), allEncrypted(true) { }
+
+    void TickHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+    {
+        /* Every receiver must get every signal exactly once and in order */
+        if (msg->GetArg(0)->v_uint32 != count) {
+            inOrder = false;
+        }
+        if (!msg->IsEncrypted()) {
+            allEncrypted = false;
+        }
+        ++count;
+    }
+
+    volatile uint32_t count;
+    bool inOrder;
+    bool allEncrypted;
+};
+
+static void CreateTestInterface(BusAttachment& bus)
+{
+    InterfaceDescription* testIntf = NULL;
+    QStatus status = bus.CreateInterface(INTERFACE_NAME, testIntf, true);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = testIntf->AddSignal("tick", "u", "seq", 0);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    testIntf->Activate();
+}
+
+/*
+ * A secure broadcast signal is encrypted once with the sender's group key and the same ciphertext
+ * is delivered to every receiver. Each receiver must still be able to decrypt it and must still
+ * see every serial number exactly once.
+ */
+TEST(SecureSignalTest, BroadcastToManyReceivers) {
+    QStatus status;
+    BusAttachment servicebus("SecureSignalTestService", false);
+    CreateTestInterface(servicebus);
+    SecureSignalTestBusObject testObj(servicebus);
+
+    status = servicebus.Start();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RegisterBusObject(testObj);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RequestName(OBJECT_NAME, 0);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.EnablePeerSecurity("ALLJOYN_SRP_KEYX", new SecureSignalTestAuthListener());
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    servicebus.ClearKeyStore();
+
+    BusAttachment* receivers[NUM_RECEIVERS];
+    SecureSignalTestReceiver handlers[NUM_RECEIVERS];
+    for (uint32_t i = 0; i < NUM_RECEIVERS; ++i) {
+        receivers[i] = new BusAttachment("SecureSignalTestReceiver", false);
+        BusAttachment& bus = *receivers[i];
+        CreateTestInterface(bus);
+        status = bus.Start();
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = bus.Connect(ajn::getConnectArg().c_str());
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = bus.EnablePeerSecurity("ALLJOYN_SRP_KEYX", new SecureSignalTestAuthListener());
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        bus.ClearKeyStore();
+        status = bus.RegisterSignalHandler(&handlers[i],
+                                           static_cast<MessageReceiver::SignalHandler>(&SecureSignalTestReceiver::TickHandler),
+                                           bus.GetInterface(INTERFACE_NAME)->GetMember("tick"),
+                                           NULL);
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        status = bus.AddMatch("type='signal',interface='org.alljoyn.test.SecureSignalTest'");
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+        /* Authenticating exchanges group keys with the service */
+        ProxyBusObject proxy(bus, OBJECT_NAME, OBJECT_PATH, 0);
+        status = proxy.SecureConnection();
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+
+    for (uint32_t seq = 0; seq < NUM_SIGNALS; ++seq) {
+        status = testObj.SendTick(seq);
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+
+    for (uint32_t msecs = 0; msecs < 5000; msecs += 10) {
+        bool done = true;
+        for (uint32_t i = 0; i < NUM_RECEIVERS; ++i) {
+            done = done && (handlers[i].count >= NUM_SIGNALS);
+        }
+        if (done) {
+            break;
+        }
+        qcc::Sleep(10);
+    }
+
+    for (uint32_t i = 0; i < NUM_RECEIVERS; ++i) {
+        EXPECT_EQ(NUM_SIGNALS, handlers[i].count) << "  Receiver " << i;
+        EXPECT_TRUE(handlers[i].inOrder) << "  Receiver " << i;
+        EXPECT_TRUE(handlers[i].allEncrypted) << "  Receiver " << i;
+    }
+
+    for (uint32_t i = 0; i < NUM_RECEIVERS; ++i) {
+        receivers[i]->Stop();
+        receivers[i]->Join();
+        delete receivers[i];
+    }
+    servicebus.Stop();
+    servicebus.Join();
+}
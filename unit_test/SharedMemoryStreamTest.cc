@@ -0,0 +1,304 @@
+/**
+ * @file
+ *
+ * This file tests the shared memory stream over a socket pair
+ */
+
+/******************************************************************************
+ *
+ *
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_LINUX) && !defined(QCC_OS_ANDROID)
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <vector>
+
+#include <qcc/Socket.h>
+#include <qcc/Util.h>
+
+#include "SharedMemoryStream.h"
+
+#include <alljoyn/Status.h>
+
+#include <gtest/gtest.h>
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+/* Smallest ring size the stream accepts, used so the tests wrap the rings quickly */
+static const uint32_t testRingSize = 4096;
+
+/* Offset of the ring size in the shared memory header */
+static const size_t ringSizeOffset = 8;
+
+class SharedMemoryStreamTest : public testing::Test {
+  public:
+    SharedMemoryStream* connector;
+    SharedMemoryStream* acceptor;
+
+    virtual void SetUp() {
+        SocketFd sockFds[2];
+        ASSERT_EQ(ER_OK, SocketPair(sockFds));
+        connector = new SharedMemoryStream(sockFds[0]);
+        acceptor = new SharedMemoryStream(sockFds[1]);
+    }
+
+    virtual void TearDown() {
+        delete connector;
+        delete acceptor;
+    }
+
+    /* Create the shared memory and attach both ends to it */
+    void Attach(uint32_t ringSize) {
+        SocketFd shmFd = -1;
+        SocketFd spaceFds[2] = { -1, -1 };
+        ASSERT_EQ(ER_OK, SharedMemoryStream::Create(ringSize, shmFd, spaceFds));
+        SocketFd peerShmFd = dup(shmFd);
+        ASSERT_NE(-1, peerShmFd);
+        ASSERT_EQ(ER_OK, acceptor->Attach(peerShmFd, spaceFds[1], false));
+        ASSERT_EQ(ER_OK, connector->Attach(shmFd, spaceFds[0], true));
+        EXPECT_TRUE(connector->IsAttached());
+        EXPECT_TRUE(acceptor->IsAttached());
+    }
+
+    /* Offer a shared memory descriptor to the acceptor */
+    QStatus Offer(SocketFd shmFd) {
+        SocketFd spaceFds[2];
+        QStatus status = SocketPair(spaceFds);
+        if (status == ER_OK) {
+            qcc::Close(spaceFds[0]);
+            status = acceptor->Attach(shmFd, spaceFds[1], false);
+        }
+        return status;
+    }
+};
+
+TEST_F(SharedMemoryStreamTest, push_pull) {
+    Attach(testRingSize);
+
+    const char data[] = "shared memory stream";
+    size_t numSent = 0;
+    EXPECT_EQ(ER_OK, connector->PushBytes(data, sizeof(data), numSent));
+    EXPECT_EQ(sizeof(data), numSent);
+
+    char buf[sizeof(data)];
+    size_t actual = 0;
+    EXPECT_EQ(ER_OK, acceptor->PullBytes(buf, sizeof(buf), actual, 0));
+    EXPECT_EQ(sizeof(data), actual);
+    EXPECT_EQ(0, memcmp(data, buf, sizeof(data)));
+
+    /* Nothing more to read */
+    EXPECT_EQ(ER_TIMEOUT, acceptor->PullBytes(buf, sizeof(buf), actual, 0));
+
+    /* And the other direction */
+    EXPECT_EQ(ER_OK, acceptor->PushBytes(data, sizeof(data), numSent));
+    EXPECT_EQ(ER_OK, connector->PullBytes(buf, sizeof(buf), actual, 0));
+    EXPECT_EQ(sizeof(data), actual);
+    EXPECT_EQ(0, memcmp(data, buf, sizeof(data)));
+}
+
+TEST_F(SharedMemoryStreamTest, wraparound) {
+    Attach(testRingSize);
+
+    /* Odd sized pushes so records and their headers straddle the end of the ring */
+    vector<uint8_t> data(1499);
+    vector<uint8_t> buf(data.size());
+    for (uint32_t round = 0; round < 50; ++round) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = (uint8_t)(round + i);
+        }
+        size_t numSent = 0;
+        ASSERT_EQ(ER_OK, connector->PushBytes(&data[0], data.size(), numSent));
+        ASSERT_EQ(data.size(), numSent);
+
+        size_t total = 0;
+        while (total < buf.size()) {
+            size_t actual = 0;
+            ASSERT_EQ(ER_OK, acceptor->PullBytes(&buf[total], buf.size() - total, actual, 0));
+            total += actual;
+        }
+        ASSERT_EQ(0, memcmp(&data[0], &buf[0], data.size()));
+    }
+}
+
+TEST_F(SharedMemoryStreamTest, full_ring) {
+    Attach(testRingSize);
+    connector->SetSendTimeout(0);
+
+    /* A push larger than the ring is cut short to the space available */
+    vector<uint8_t> data(2 * testRingSize, 0x5A);
+    size_t numSent = 0;
+    EXPECT_EQ(ER_OK, connector->PushBytes(&data[0], data.size(), numSent));
+    EXPECT_GT(numSent, (size_t)0);
+    EXPECT_LT(numSent, (size_t)testRingSize);
+
+    /* With the ring full and no send timeout the next push times out */
+    size_t more = 0;
+    EXPECT_EQ(ER_TIMEOUT, connector->PushBytes(&data[0], data.size(), more));
+    EXPECT_EQ((size_t)0, more);
+
+    /* Reading makes space again */
+    vector<uint8_t> buf(data.size());
+    size_t actual = 0;
+    EXPECT_EQ(ER_OK, acceptor->PullBytes(&buf[0], buf.size(), actual, 0));
+    EXPECT_EQ(numSent, actual);
+    EXPECT_EQ(ER_OK, connector->PushBytes(&data[0], 16, more));
+    EXPECT_EQ((size_t)16, more);
+}
+
+TEST_F(SharedMemoryStreamTest, record_boundaries) {
+    Attach(testRingSize);
+
+    const char first[] = "first record";
+    const char second[] = "second";
+    size_t numSent = 0;
+    EXPECT_EQ(ER_OK, connector->PushBytes(first, sizeof(first), numSent));
+    EXPECT_EQ(ER_OK, connector->PushBytes(second, sizeof(second), numSent));
+
+    /* A pull never crosses a record boundary so the records come back in pieces */
+    char buf[64];
+    size_t actual = 0;
+    EXPECT_EQ(ER_OK, acceptor->PullBytes(buf, 5, actual, 0));
+    EXPECT_EQ((size_t)5, actual);
+    EXPECT_EQ(0, memcmp(buf, first, 5));
+    EXPECT_EQ(ER_OK, acceptor->PullBytes(buf, sizeof(buf), actual, 0));
+    EXPECT_EQ(sizeof(first) - 5, actual);
+    EXPECT_EQ(0, memcmp(buf, first + 5, actual));
+    EXPECT_EQ(ER_OK, acceptor->PullBytes(buf, sizeof(buf), actual, 0));
+    EXPECT_EQ(sizeof(second), actual);
+    EXPECT_EQ(0, memcmp(buf, second, actual));
+}
+
+TEST_F(SharedMemoryStreamTest, descriptors_match_records) {
+    Attach(testRingSize);
+    connector->EnableHandlePassing(true);
+    acceptor->EnableHandlePassing(true);
+
+    int pipeFds[2];
+    ASSERT_EQ(0, pipe(pipeFds));
+
+    const char plain[] = "plain";
+    const char withFd[] = "with descriptor";
+    size_t numSent = 0;
+    SocketFd sendFd = pipeFds[1];
+    EXPECT_EQ(ER_OK, connector->PushBytes(plain, sizeof(plain), numSent));
+    EXPECT_EQ(ER_OK, connector->PushBytesAndFds(withFd, sizeof(withFd), numSent, &sendFd, 1));
+    EXPECT_EQ(ER_OK, connector->PushBytes(plain, sizeof(plain), numSent));
+
+    char buf[64];
+    size_t actual = 0;
+    SocketFd fds[4];
+    size_t numFds = ArraySize(fds);
+
+    /* The descriptor is already on the socket but belongs to the second record */
+    EXPECT_EQ(ER_OK, acceptor->PullBytesAndFds(buf, sizeof(buf), actual, fds, numFds, 0));
+    EXPECT_EQ(sizeof(plain), actual);
+    EXPECT_EQ((size_t)0, numFds);
+
+    numFds = ArraySize(fds);
+    EXPECT_EQ(ER_OK, acceptor->PullBytesAndFds(buf, sizeof(buf), actual, fds, numFds, 0));
+    EXPECT_EQ(sizeof(withFd), actual);
+    EXPECT_EQ(0, memcmp(buf, withFd, actual));
+    ASSERT_EQ((size_t)1, numFds);
+
+    /* The received descriptor is the write end of the pipe */
+    char byte = 'x';
+    EXPECT_EQ(1, write(fds[0], &byte, 1));
+    byte = 0;
+    EXPECT_EQ(1, read(pipeFds[0], &byte, 1));
+    EXPECT_EQ('x', byte);
+    qcc::Close(fds[0]);
+
+    numFds = ArraySize(fds);
+    EXPECT_EQ(ER_OK, acceptor->PullBytesAndFds(buf, sizeof(buf), actual, fds, numFds, 0));
+    EXPECT_EQ(sizeof(plain), actual);
+    EXPECT_EQ((size_t)0, numFds);
+
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+}
+
+TEST_F(SharedMemoryStreamTest, descriptors_before_handle_passing) {
+    Attach(testRingSize);
+    connector->EnableHandlePassing(true);
+
+    int pipeFds[2];
+    ASSERT_EQ(0, pipe(pipeFds));
+    size_t numSent = 0;
+    SocketFd sendFd = pipeFds[1];
+    EXPECT_EQ(ER_OK, connector->PushBytesAndFds("x", 1, numSent, &sendFd, 1));
+
+    /* The acceptor has not negotiated handle passing so the record fails the stream */
+    char buf[8];
+    size_t actual = 0;
+    EXPECT_EQ(ER_READ_ERROR, acceptor->PullBytes(buf, sizeof(buf), actual, 0));
+
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+}
+
+TEST_F(SharedMemoryStreamTest, peer_closed) {
+    Attach(testRingSize);
+
+    size_t numSent = 0;
+    EXPECT_EQ(ER_OK, connector->PushBytes("x", 1, numSent));
+    connector->Close();
+
+    /* Data written before the close can still be read */
+    char buf[8];
+    size_t actual = 0;
+    EXPECT_EQ(ER_OK, acceptor->PullBytes(buf, sizeof(buf), actual, 0));
+    EXPECT_EQ((size_t)1, actual);
+    EXPECT_EQ(ER_SOCK_OTHER_END_CLOSED, acceptor->PullBytes(buf, sizeof(buf), actual, 0));
+}
+
+TEST_F(SharedMemoryStreamTest, reject_unsealed_memory) {
+    int fd = memfd_create("alljoyn-test", MFD_CLOEXEC);
+    ASSERT_NE(-1, fd);
+    ASSERT_EQ(0, ftruncate(fd, 4 * testRingSize));
+
+    EXPECT_EQ(ER_BUS_BAD_TRANSPORT_ARGS, Offer(fd));
+    EXPECT_FALSE(acceptor->IsAttached());
+}
+
+TEST_F(SharedMemoryStreamTest, reject_bad_ring_size) {
+    /* Ring sizes that are too large, not a power of two or larger than the memory offered */
+    const uint32_t badSizes[] = { 32 * 1024 * 1024, testRingSize + 1, 2 * testRingSize };
+    for (size_t i = 0; i < ArraySize(badSizes); ++i) {
+        SocketFd shmFd = -1;
+        SocketFd spaceFds[2] = { -1, -1 };
+        ASSERT_EQ(ER_OK, SharedMemoryStream::Create(testRingSize, shmFd, spaceFds));
+        qcc::Close(spaceFds[0]);
+        qcc::Close(spaceFds[1]);
+
+        /* The seals stop resizing, not writing, so the offering end can lie about the ring size */
+        void* mem = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+        ASSERT_NE(MAP_FAILED, mem);
+        memcpy((uint8_t*)mem + ringSizeOffset, &badSizes[i], sizeof(uint32_t));
+        munmap(mem, 4096);
+
+        EXPECT_EQ(ER_BUS_BAD_TRANSPORT_ARGS, Offer(shmFd));
+        EXPECT_FALSE(acceptor->IsAttached());
+    }
+}
+
+#endif